@@ -5,7 +5,6 @@
 
 #define MIN_TRANSPARENCY_THRESHOLD	0.05
 #define MAX_TRANSPARENCY_THRESHOLD	0.75
-#define MAX_LIGHTS					32
 
 struct transparencyNode{
 	vec4 color;
@@ -24,11 +23,16 @@ layout (location = 4) in vec4 inColor0;
 // Per Instance
 layout (location = 7) flat in uint inMaterialIndex;
 
+layout (location = 8) in vec4 inTangent;
+
 // Scene bindings
 layout (set = 0, binding = 0) uniform UBOScene {
 	mat4 view;
 	mat4 projection;
 	vec3 camPos;
+	vec2 haltonJitter;
+	vec2 planeData;
+	uint clusteredView;
 } scene;
 
 // Environment bindings
@@ -122,10 +126,12 @@ vec3 getIBLContribution(vec3 diffuseColor, vec3 specularColor, float roughness,
 	return diffuse + specular;
 }
 
-float interpolateCascades(float dist, int cascadeIndex) {
-	float cascadeStart = cascadeDistances[cascadeIndex];
-    float cascadeEnd = cascadeDistances[cascadeIndex + 1];
-    return (dist - cascadeStart) / (cascadeEnd - cascadeStart);
+// blends the last part of a cascade into the next one
+float interpolateCascades(float viewDepth, int cascadeIndex) {
+	float cascadeStart = (cascadeIndex > 0) ? lighting.cascadeSplits[cascadeIndex - 1] : 0.0;
+	float cascadeEnd = lighting.cascadeSplits[cascadeIndex];
+	float blendStart = mix(cascadeStart, cascadeEnd, 0.9);
+	return clamp((viewDepth - blendStart) / (cascadeEnd - blendStart), 0.0, 1.0);
 }
 
 float filterPCF(vec3 shadowCoord, vec2 offset, uint distanceIndex) {
@@ -154,17 +160,7 @@ float getShadow(vec3 fragmentPosition, int distanceIndex) {
 	int count = 0;
 	int range = 4 - distanceIndex;
 
-	float FOVMultiplier = 1.0;
-
-	for (int i = 0; i < distanceIndex; i++) {
-		FOVMultiplier *= (i < 1) ? SHADOWFOVMULT : SHADOWFOVMULT * SHADOWFOVMULT;
-	}
-
-	mat4 newProjection = lighting.lightOrthoMatrix;
-	newProjection[0][0] *= FOVMultiplier;	
-	newProjection[1][1] *= FOVMultiplier;
-
-	vec4 shadowPosition = newProjection * lighting.lightViews[0] * vec4(fragmentPosition, 1.0);
+	vec4 shadowPosition = lighting.cascadeViewProjections[distanceIndex] * vec4(fragmentPosition, 1.0);
 	shadowPosition /= shadowPosition.w;
 
 	vec3 shadowCoord = vec3((shadowPosition.x * 0.5 + 0.5), 1.0 - (shadowPosition.y * 0.5 + 0.5), shadowPosition.z);
@@ -184,23 +180,9 @@ float getShadow(vec3 fragmentPosition, int distanceIndex) {
 	return shadow / count;
 }
 
-vec3 getNormal(int textureSet) {
-	vec3 tangentNormal = vec3(vec2(texture(samplers[materialBlocks[inMaterialIndex].samplerIndex[NORMALMAP]], textureSet == 0 ? inUV0 : inUV1).rg * 2.0 - 1.0), 1.0);
-
-	vec3 q1 = dFdx(inWorldPos);
-	vec3 q2 = dFdy(inWorldPos);
-	vec2 st1 = dFdx(inUV0);
-	vec2 st2 = dFdy(inUV0);
-
-	vec3 N = normalize(inNormal);
-	vec3 T = normalize(q1 * st2.t - q2 * st1.t);
-	vec3 B = -normalize(cross(N, T));
-	mat3 TBN = mat3(T, B, N);
+#include "include/normal.glsl"
 
-	return normalize(TBN * tangentNormal) * materialBlocks[inMaterialIndex].bumpIntensity;
-}
-
-vec3 getLight(uint index, vec3 worldPos, vec3 diffuseColor, vec3 specularColor, vec3 V, vec3 normal, float roughness) {
+vec3 getLight(vec3 lightLocation, vec4 lightProperties, vec3 worldPos, vec3 diffuseColor, vec3 specularColor, vec3 V, vec3 normal, float roughness) {
 	float alphaRoughness = roughness * roughness;
 
 	// For typical incident reflectance range (between 4% to 100%) set the grazing reflectance to 100% for typical fresnel effect.
@@ -210,8 +192,7 @@ vec3 getLight(uint index, vec3 worldPos, vec3 diffuseColor, vec3 specularColor,
 	vec3 specularEnvironmentR0 = specularColor.rgb;
 	vec3 specularEnvironmentR90 = vec3(1.0, 1.0, 1.0) * reflectance90;
 
-	vec3 L = normalize(lighting.lightLocations[index].xyz - worldPos);
-	//vec3 L = normalize(lighting.lightLocations[index].xyz);	// Vector from surface point to light
+	vec3 L = normalize(lightLocation - worldPos);
 	vec3 H = normalize(L + V);								// Half vector between both l and v
 
 	float NdotL = clamp(dot(normal, L), 0.001, 1.0);
@@ -230,7 +211,7 @@ vec3 getLight(uint index, vec3 worldPos, vec3 diffuseColor, vec3 specularColor,
 	vec3 specContrib = F * G * D / (4.0 * NdotL * NdotV);
 
 	// Obtain final intensity as reflectance (BRDF) scaled by the energy of the light (cosine law)
-	vec3 lightColor = NdotL * lighting.lightColor[index].rgb * (diffuseContrib + specContrib) * lighting.lightColor[index].a;
+	vec3 lightColor = NdotL * lightProperties.rgb * (diffuseContrib + specContrib) * lightProperties.a;
 
 	return lightColor;
 }
@@ -280,7 +261,7 @@ vec4 getColor(vec4 baseColor) {
 	vec3 color = getIBLContribution(diffuseColor, specularColor, perceptualRoughness, V, normal);
 
 	if (lighting.lightColor[0].a > 0.001) {
-		color += getLight(0, inWorldPos, diffuseColor, specularColor, V, normal, perceptualRoughness);
+		color += getLight(lighting.lightLocations[0].xyz, lighting.lightColor[0], inWorldPos, diffuseColor, specularColor, V, normal, perceptualRoughness);
 	}
 	
 	// Get ambient occlusion from the texture if available
@@ -300,19 +281,23 @@ vec4 getColor(vec4 baseColor) {
 	emissiveColor += materialBlocks[inMaterialIndex].glowColor.rgb;
 
 	// Calculate shadow and its color
-	float relativeDistance = length(scene.camPos - inWorldPos);
-	float shadowA = 0.0f;
+	// Fragments beyond the last cascade split are not shadowed
+	float viewDepth = (scene.view * vec4(inWorldPos, 1.0)).z;
+	float shadowA = 1.0f;
 
 	int distanceIndex;
-	for (distanceIndex = MAXCASCADES - 1; distanceIndex > -1; distanceIndex--) {
-		if (relativeDistance > cascadeDistances[distanceIndex]) { 
+	for (distanceIndex = 0; distanceIndex < MAXCASCADES; distanceIndex++) {
+		if (viewDepth <= lighting.cascadeSplits[distanceIndex]) {
 			shadowA = getShadow(inWorldPos, distanceIndex);
 
 			// Smoothly interpolate shadow cascades
-			if (distanceIndex < MAXCASCADES - 1) {
-				float interpolation = interpolateCascades(relativeDistance, distanceIndex);
-				float shadowB = getShadow(inWorldPos, distanceIndex + 1);
-				shadowA = mix(shadowA, shadowB, interpolation);
+			if (distanceIndex < MAXCASCADES - 1 && lighting.cascadeSplits[distanceIndex + 1] > 0.0) {
+				float interpolation = interpolateCascades(viewDepth, distanceIndex);
+
+				if (interpolation > 0.0) {
+					float shadowB = getShadow(inWorldPos, distanceIndex + 1);
+					shadowA = mix(shadowA, shadowB, interpolation);
+				}
 			}
 			break;
 		}
@@ -322,18 +307,16 @@ vec4 getColor(vec4 baseColor) {
 	shadow = clamp(shadow, 0.0, 1.0);
 	color *= shadow;
 
-	// Process point lights within a reasonable fragment's distance to save performance
-	if (lighting.lightCount > 1) {
-		// Limit number of lights per transparent object for Forward+ rendering
-		uint lightCount = (lighting.lightCount < MAX_LIGHTS) ? lighting.lightCount : MAX_LIGHTS;
+	// Process point lights of the fragment's cluster within their radius of influence
+	const uvec2 lightCluster = getLightCluster(inWorldPos, scene.clusteredView);
 
-		for (uint index = 1; index < lightCount; ++index) {
-			float lightDistance = length(lighting.lightLocations[index].xyz - inWorldPos);
+	for (uint index = 0; index < lightCluster.y; ++index) {
+		const PointLight light = getClusterLight(lightCluster, index);
+		float lightDistance = length(light.location.xyz - inWorldPos);
+
+		if (lightDistance < light.location.w) {
 			float lightAttenuation = 1.0 / (lightDistance * lightDistance);
-			
-			if (lightAttenuation > 0.1) {
-				color += getLight(index, inWorldPos, diffuseColor, specularColor, V, normal, perceptualRoughness) * lightAttenuation;
-			}
+			color += getLight(light.location.xyz, light.color, inWorldPos, diffuseColor, specularColor, V, normal, perceptualRoughness) * lightAttenuation;
 		}
 	}
 
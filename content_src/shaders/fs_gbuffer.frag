@@ -15,6 +15,8 @@ layout (location = 6) in vec4 inPrevWorldPos;
 // Per Instance
 layout (location = 7) flat in uint inMaterialIndex;
 
+layout (location = 8) in vec4 inTangent;
+
 layout (location = 0) out vec4 outPosition;
 layout (location = 1) out vec4 outColor;
 layout (location = 2) out vec4 outNormal;
@@ -45,22 +47,7 @@ vec2 getVelocity(vec4 prevPos, vec4 currentPos){
 	return (currentPos - prevPos).xy;
 }
 
-vec3 getNormal(int textureSet) {
-	vec3 tangentNormal = vec3(vec2(texture(samplers[materialBlocks[inMaterialIndex].samplerIndex[NORMALMAP]],
-		textureSet == 0 ? inUV0 : inUV1).rg * 2.0 - 1.0), 1.0);
-
-	vec3 q1 = dFdx(inWorldPos);
-	vec3 q2 = dFdy(inWorldPos);
-	vec2 st1 = dFdx(inUV0);
-	vec2 st2 = dFdy(inUV0);
-
-	vec3 N = normalize(inNormal);
-	vec3 T = normalize(q1 * st2.t - q2 * st1.t);
-	vec3 B = -normalize(cross(N, T));
-	mat3 TBN = mat3(T, B, N);
-
-	return normalize(TBN * tangentNormal) * materialBlocks[inMaterialIndex].bumpIntensity;
-}
+#include "include/normal.glsl"
 
 void main() {
 	float perceptualRoughness;
@@ -17,6 +17,7 @@ layout (set = 0, binding = 0) uniform UBOScene {
 	vec3 camPos;
 	vec2 haltonJitter;
 	vec2 planeData;
+	uint clusteredView;
 } scene;
 
 // environment bindings
@@ -106,10 +107,12 @@ vec3 getIBLContribution(vec3 diffuseColor, vec3 specularColor, float roughness,
 	return diffuse + specular;
 }
 
-float interpolateCascades(float dist, int cascadeIndex) {
-	float cascadeStart = cascadeDistances[cascadeIndex];
-    float cascadeEnd = cascadeDistances[cascadeIndex + 1];
-    return (dist - cascadeStart) / (cascadeEnd - cascadeStart);
+// blends the last part of a cascade into the next one
+float interpolateCascades(float viewDepth, int cascadeIndex) {
+	float cascadeStart = (cascadeIndex > 0) ? lighting.cascadeSplits[cascadeIndex - 1] : 0.0;
+	float cascadeEnd = lighting.cascadeSplits[cascadeIndex];
+	float blendStart = mix(cascadeStart, cascadeEnd, 0.9);
+	return clamp((viewDepth - blendStart) / (cascadeEnd - blendStart), 0.0, 1.0);
 }
 
 float filterPCF(vec3 shadowCoord, vec2 offset, uint distanceIndex) {
@@ -132,17 +135,7 @@ float getShadow(vec3 fragmentPosition, int distanceIndex, float facing) {
 	int count = 0;
 	int range = 4 - distanceIndex;
 
-	float FOVMultiplier = 1.0;
-
-	for (int i = 0; i < distanceIndex; i++) {
-		FOVMultiplier *= (i < 1) ? SHADOWFOVMULT : SHADOWFOVMULT * SHADOWFOVMULT;
-	}
-
-	mat4 newProjection = lighting.lightOrthoMatrix;
-	newProjection[0][0] *= FOVMultiplier;	
-	newProjection[1][1] *= FOVMultiplier;
-
-	vec4 shadowPosition = newProjection * lighting.lightViews[0] * vec4(fragmentPosition, 1.0);
+	vec4 shadowPosition = lighting.cascadeViewProjections[distanceIndex] * vec4(fragmentPosition, 1.0);
 	shadowPosition /= shadowPosition.w;
 
 	vec3 shadowCoord = vec3((shadowPosition.x * 0.5 + 0.5), 1.0 - (shadowPosition.y * 0.5 + 0.5), shadowPosition.z);
@@ -173,7 +166,7 @@ float getShadow(vec3 fragmentPosition, int distanceIndex, float facing) {
 	return shadow / count;
 }
 
-vec3 getLight(uint index, vec3 worldPos, vec3 diffuseColor, vec3 specularColor, vec3 V, vec3 normal, float roughness) {
+vec3 getLight(vec3 lightLocation, vec4 lightProperties, vec3 worldPos, vec3 diffuseColor, vec3 specularColor, vec3 V, vec3 normal, float roughness) {
 	float alphaRoughness = roughness * roughness;
 
 	// For typical incident reflectance range (between 4% to 100%) set the grazing reflectance to 100% for typical fresnel effect.
@@ -183,7 +176,7 @@ vec3 getLight(uint index, vec3 worldPos, vec3 diffuseColor, vec3 specularColor,
 	vec3 specularEnvironmentR0 = specularColor.rgb;
 	vec3 specularEnvironmentR90 = vec3(1.0, 1.0, 1.0) * reflectance90;
 
-	vec3 L = normalize(lighting.lightLocations[index].xyz - worldPos);
+	vec3 L = normalize(lightLocation - worldPos);
 	vec3 H = normalize(L + V);								// Half vector between both l and v
 
 	float NdotL = clamp(dot(normal, L), 0.001, 1.0);
@@ -202,7 +195,7 @@ vec3 getLight(uint index, vec3 worldPos, vec3 diffuseColor, vec3 specularColor,
 	vec3 specContrib = F * G * D / (4.0 * NdotL * NdotV);
 
 	// Obtain final intensity as reflectance (BRDF) scaled by the energy of the light (cosine law)
-	vec3 lightColor = NdotL * lighting.lightColor[index].rgb * (diffuseContrib + specContrib) * lighting.lightColor[index].a;
+	vec3 lightColor = NdotL * lightProperties.rgb * (diffuseContrib + specContrib) * lightProperties.a;
 
 	return lightColor;
 }
@@ -373,25 +366,29 @@ void main() {
 	vec3 color = getIBLContribution(diffuseColor, specularColor, perceptualRoughness, V, normal);
 
 	if (lighting.lightColor[0].a > 0.001) {
-		color += getLight(0, worldPos.xyz, diffuseColor, specularColor, V, normal, perceptualRoughness);
+		color += getLight(lighting.lightLocations[0].xyz, lighting.lightColor[0], worldPos.xyz, diffuseColor, specularColor, V, normal, perceptualRoughness);
 	}
 
 	color = mix(color, color * ao, occlusionStrength);
 
 	// Calculate shadow and its color
-	float relativeDistance = length(scene.camPos - worldPos.xyz);
-	float shadowA = 0.0f;
+	// Fragments beyond the last cascade split are not shadowed
+	float viewDepth = (scene.view * vec4(worldPos.xyz, 1.0)).z;
+	float shadowA = 1.0f;
 
 	int distanceIndex;
-	for (distanceIndex = MAXCASCADES - 1; distanceIndex > -1; distanceIndex--) {
-		if (relativeDistance > cascadeDistances[distanceIndex]) { 
+	for (distanceIndex = 0; distanceIndex < MAXCASCADES; distanceIndex++) {
+		if (viewDepth <= lighting.cascadeSplits[distanceIndex]) {
 			shadowA = getShadow(worldPos.xyz, distanceIndex, facing);
 
 			// Smoothly interpolate shadow cascades
-			if (distanceIndex < MAXCASCADES - 1) {
-				float interpolation = interpolateCascades(relativeDistance, distanceIndex);
-				float shadowB = getShadow(worldPos.xyz, distanceIndex + 1, facing);
-				shadowA = mix(shadowA, shadowB, interpolation);
+			if (distanceIndex < MAXCASCADES - 1 && lighting.cascadeSplits[distanceIndex + 1] > 0.0) {
+				float interpolation = interpolateCascades(viewDepth, distanceIndex);
+
+				if (interpolation > 0.0) {
+					float shadowB = getShadow(worldPos.xyz, distanceIndex + 1, facing);
+					shadowA = mix(shadowA, shadowB, interpolation);
+				}
 			}
 			break;
 		}
@@ -401,15 +398,16 @@ void main() {
 	shadow = clamp(shadow, 0.0, 1.0);
 	color *= shadow;
 
-	// Process point lights within a reasonable fragment's distance to save performance
-	if (lighting.lightCount > 1) {
-		for (uint index = 1; index < lighting.lightCount; ++index) {
-			float lightDistance = length(lighting.lightLocations[index].xyz - worldPos.xyz);
+	// Process point lights of the fragment's cluster within their radius of influence
+	const uvec2 lightCluster = getLightCluster(worldPos.xyz, scene.clusteredView);
+
+	for (uint index = 0; index < lightCluster.y; ++index) {
+		const PointLight light = getClusterLight(lightCluster, index);
+		float lightDistance = length(light.location.xyz - worldPos.xyz);
+
+		if (lightDistance < light.location.w) {
 			float lightAttenuation = 1.0 / (lightDistance * lightDistance);
-			
-			if (lightAttenuation > 0.1) {
-				color += getLight(index, worldPos.xyz, diffuseColor, specularColor, V, normal, perceptualRoughness) * lightAttenuation;
-			}
+			color += getLight(light.location.xyz, light.color, worldPos.xyz, diffuseColor, specularColor, V, normal, perceptualRoughness) * lightAttenuation;
 		}
 	}
 	
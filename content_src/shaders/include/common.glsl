@@ -4,7 +4,6 @@
 #define MAXLIGHTS 32
 #define MAXSHADOWCASTERS 4
 #define MAXCASCADES 4
-#define SHADOWFOVMULT 0.5
 #define UNSHADOWEDVALUE 0.3
 #define SUNLIGHTINDEX 0
 #define BLOOMTHRESHOLD 0.86
@@ -27,11 +26,6 @@ const float M_PI = 3.141592653589793;
 const float TWO_PI = M_PI * 2.0;
 const float HALF_PI = M_PI * 0.5;
 
-// Shadow cascade data
-// Distances should be proportionally tied to the size of the shadow view frustum
-// By default it's nextDistance = prevDistance * 2. First distance value is 0.
-const float cascadeDistances[MAXCASCADES] = { 0.0, 2.0, 4.0, 8.0 };
-
 float max3(vec3 v) {
   return max(max(v.x, v.y), v.z);
 }
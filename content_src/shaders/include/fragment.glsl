@@ -1,3 +1,5 @@
+#include "lighting.glsl"
+
 #define AO_NONE		0
 #define AO_SSAO		1
 #define AO_HBAO		2
@@ -13,23 +15,6 @@ struct MaterialData {
 	vec4 glowColor;
 };
 
-layout (std430, set = 0, binding = 1) uniform UBOLighting {
-	vec4 lightLocations[MAXLIGHTS];
-    vec4 lightColor[MAXLIGHTS];
-	mat4 lightViews[MAXSHADOWCASTERS];
-	mat4 lightOrthoMatrix;
-	uint samplerIndex[MAXSHADOWCASTERS];
-	uint lightCount;
-	vec4 shadowColor;
-	float averageLuminance;
-	float bloomIntensity;
-	float exposure;
-	float gamma;
-	float prefilteredCubeMipLevels;
-	float scaleIBLAmbient;
-	uint aoMode;
-} lighting;
-
 layout (set = 2, binding = 0) buffer materialBlock {
 	MaterialData materialBlocks[];
 };
@@ -58,4 +43,34 @@ int getTextureSet(int textureType, uint materialIndex) {
 	if ((checkTextureSet & secondSetLookup) == secondSetLookup) return 1;
 	if ((checkTextureSet & firstSetLookup) == firstSetLookup) return 0;
 	return -1;
+}
+
+// first index of a light range going over the whole point light list
+#define UNCLUSTERED_LIGHTS 0xFFFFFFFFu
+
+// range of the light index list shading a world position, positions outside
+// of the clustered view are not lit by point lights, views other than the
+// clustered one get all point lights
+uvec2 getLightCluster(vec3 worldPos, uint clusteredView) {
+	if (lighting.clusterGrid.w == 0) return uvec2(0);
+	if (clusteredView == 0) return uvec2(UNCLUSTERED_LIGHTS, lighting.clusterGrid.w);
+
+	const float depth = dot(lighting.clusterDepthPlane, vec4(worldPos, 1.0));
+	if (depth < lighting.clusterDepthParams.x || depth > lighting.clusterDepthParams.y) return uvec2(0);
+
+	const vec4 clipPos = lighting.clusterViewProjection * vec4(worldPos, 1.0);
+	const vec2 ndc = clipPos.xy / clipPos.w;
+	if (any(greaterThan(abs(ndc), vec2(1.0)))) return uvec2(0);
+
+	const uvec3 grid = lighting.clusterGrid.xyz;
+	const float slice = log(depth) * lighting.clusterDepthParams.z + lighting.clusterDepthParams.w;
+	const uvec3 cluster = min(uvec3(max(vec3((ndc * 0.5 + 0.5) * vec2(grid.xy), slice), 0.0)), grid - 1);
+
+	return lighting.lightClusters.clusters[(cluster.z * grid.y + cluster.y) * grid.x + cluster.x];
+}
+
+// point light of a range returned by getLightCluster()
+PointLight getClusterLight(uvec2 lightCluster, uint index) {
+	if (lightCluster.x == UNCLUSTERED_LIGHTS) return lighting.pointLights.lights[index];
+	return lighting.pointLights.lights[lighting.lightIndices.indices[lightCluster.x + index]];
 }
\ No newline at end of file
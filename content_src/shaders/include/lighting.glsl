@@ -0,0 +1,46 @@
+#extension GL_EXT_buffer_reference : require
+
+// point light of the clustered light list
+struct PointLight {
+	vec4 location;			// w is radius of influence
+	vec4 color;				// alpha is intensity
+};
+
+layout (buffer_reference, std430, buffer_reference_align = 16) readonly buffer PointLightBuffer {
+	PointLight lights[];
+};
+
+// x - first index of the light index list, y - light count
+layout (buffer_reference, std430, buffer_reference_align = 8) readonly buffer LightClusterBuffer {
+	uvec2 clusters[];
+};
+
+layout (buffer_reference, std430, buffer_reference_align = 4) readonly buffer LightIndexBuffer {
+	uint indices[];
+};
+
+layout (std430, set = 0, binding = 1) uniform UBOLighting {
+	vec4 lightLocations[MAXLIGHTS];
+    vec4 lightColor[MAXLIGHTS];
+	mat4 lightViews[MAXSHADOWCASTERS];
+	mat4 lightOrthoMatrix;
+	uint samplerIndex[MAXSHADOWCASTERS];
+	uint lightCount;
+	vec4 shadowColor;
+	float averageLuminance;
+	float bloomIntensity;
+	float exposure;
+	float gamma;
+	float prefilteredCubeMipLevels;
+	float scaleIBLAmbient;
+	uint aoMode;
+	mat4 clusterViewProjection;
+	vec4 clusterDepthPlane;		// world space plane returning view depth
+	vec4 clusterDepthParams;	// x - near, y - far, z - slice scale, w - slice bias
+	uvec4 clusterGrid;			// x, y, z - cluster counts, w - point light count
+	PointLightBuffer pointLights;
+	LightClusterBuffer lightClusters;
+	LightIndexBuffer lightIndices;
+	mat4 cascadeViewProjections[MAXCASCADES];
+	vec4 cascadeSplits;			// far view depth of every cascade, 0 if unused
+} lighting;
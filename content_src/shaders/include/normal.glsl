@@ -0,0 +1,30 @@
+// Normal mapping shared by the geometry passes, the including shader declares
+// inWorldPos, inNormal, inTangent, inUV0, inUV1 and inMaterialIndex inputs
+// and includes fragment.glsl before this file
+
+vec3 getNormal(int textureSet) {
+	vec3 tangentNormal = vec3(vec2(texture(samplers[materialBlocks[inMaterialIndex].samplerIndex[NORMALMAP]],
+		textureSet == 0 ? inUV0 : inUV1).rg * 2.0 - 1.0), 1.0);
+
+	vec3 N = normalize(inNormal);
+	vec3 T;
+	vec3 B;
+
+	// Use vertex tangents if the primitive has them, w stores bitangent handedness
+	if (dot(inTangent.xyz, inTangent.xyz) > 0.0) {
+		T = normalize(inTangent.xyz - N * dot(N, inTangent.xyz));
+		B = cross(N, T) * inTangent.w;
+	} else {
+		vec3 q1 = dFdx(inWorldPos);
+		vec3 q2 = dFdy(inWorldPos);
+		vec2 st1 = dFdx(inUV0);
+		vec2 st2 = dFdy(inUV0);
+
+		T = normalize(q1 * st2.t - q2 * st1.t);
+		B = -normalize(cross(N, T));
+	}
+
+	mat3 TBN = mat3(T, B, N);
+
+	return normalize(TBN * tangentNormal) * materialBlocks[inMaterialIndex].bumpIntensity;
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#extension GL_EXT_buffer_reference : require
+
+// instance attribute value of vertices skinned by their vertex shader
+#define NOTPRESKINNED 0x80000000u
+
+// vertex of the skinning pre-pass, positions and normals are in node space
+struct SkinnedVertex {
+	vec4 position;
+	vec4 prevPosition;
+	vec4 normal;
+	vec4 tangent;
+};
+
+layout (buffer_reference, std430, buffer_reference_align = 16) readonly buffer SkinnedVertexBuffer {
+	SkinnedVertex vertices[];
+};
@@ -4,6 +4,7 @@
 #extension GL_EXT_buffer_reference: require
 
 #include "include/vertex.glsl"
+#include "include/skinning.glsl"
 
 // Per Vertex
 layout (location = 0) in vec3 inPos;
@@ -13,9 +14,11 @@ layout (location = 3) in vec2 inUV1;
 layout (location = 4) in vec4 inJoint;
 layout (location = 5) in vec4 inWeight;
 layout (location = 6) in vec4 inColor0;
+layout (location = 8) in vec4 inTangent;				// w - bitangent handedness, zero if not generated
 
 // Per Instance
 layout (location = 7) in uvec4 inInstanceIndices;		// x - model, y - node, z - skin, w - material
+layout (location = 9) in int inSkinnedVertexBase;		// pre-skinned vertex index minus vertex index
 
 layout (location = 0) out vec3 outWorldPos;
 layout (location = 1) out vec3 outNormal;
@@ -25,16 +28,33 @@ layout (location = 4) out vec4 outColor0;
 layout (location = 5) out vec4 outCurrentMVPPos;
 layout (location = 6) out vec4 outPrevMVPPos;
 layout (location = 7) flat out uint outMaterialIndex;
+layout (location = 8) out vec4 outTangent;
+
+layout (push_constant) uniform Scene {
+	uint cascadeIndex;
+	uint padding;
+	SkinnedVertexBuffer skinnedVertices;
+} pushBlock;
 
 void main() {
 	const uint modelIndex = inInstanceIndices.x;
 	const uint nodeIndex = inInstanceIndices.y;
 	const uint skinIndex = inInstanceIndices.z;
 
+	const uint skinnedVertexBase = uint(inSkinnedVertexBase);
+
 	vec4 worldPos;
 	vec4 prevWorldPos;
 
-	if (node.block[nodeIndex].jointCount > 0.0) {
+	if (skinnedVertexBase != NOTPRESKINNED) {
+		const SkinnedVertex skinnedVertex = pushBlock.skinnedVertices.vertices[skinnedVertexBase + uint(gl_VertexIndex)];
+		const mat4 nodeMatrix = model.block[modelIndex].matrix * node.block[nodeIndex].matrix;
+
+		worldPos = nodeMatrix * skinnedVertex.position;
+		prevWorldPos = model.block[modelIndex].prevMatrix * node.block[nodeIndex].prevMatrix * skinnedVertex.prevPosition;
+		outNormal = normalize(transpose(inverse(mat3(nodeMatrix))) * skinnedVertex.normal.xyz);
+		outTangent = vec4(mat3(nodeMatrix) * skinnedVertex.tangent.xyz, skinnedVertex.tangent.w);
+	} else if (node.block[nodeIndex].jointCount > 0.0) {
 		mat4 skinMatrix = 
 			inWeight.x * skin.block[skinIndex].jointMatrix[int(inJoint.x)] +
 			inWeight.y * skin.block[skinIndex].jointMatrix[int(inJoint.y)] +
@@ -50,10 +70,12 @@ void main() {
 		worldPos = model.block[modelIndex].matrix * node.block[nodeIndex].matrix * skinMatrix * vec4(inPos, 1.0);
 		prevWorldPos = model.block[modelIndex].prevMatrix * node.block[nodeIndex].prevMatrix * prevSkinMatrix * vec4(inPos, 1.0);
 		outNormal = normalize(transpose(inverse(mat3(model.block[modelIndex].matrix * node.block[nodeIndex].matrix * skinMatrix))) * inNormal);
+		outTangent = vec4(mat3(model.block[modelIndex].matrix * node.block[nodeIndex].matrix * skinMatrix) * inTangent.xyz, inTangent.w);
 	} else {
 		worldPos = model.block[modelIndex].matrix * node.block[nodeIndex].matrix * vec4(inPos, 1.0);
 		prevWorldPos = model.block[modelIndex].prevMatrix * node.block[nodeIndex].prevMatrix * vec4(inPos, 1.0);
 		outNormal = normalize(transpose(inverse(mat3(model.block[modelIndex].matrix * node.block[nodeIndex].matrix))) * inNormal);
+		outTangent = vec4(mat3(model.block[modelIndex].matrix * node.block[nodeIndex].matrix) * inTangent.xyz, inTangent.w);
 	}
 
 	outWorldPos = worldPos.xyz / worldPos.w;
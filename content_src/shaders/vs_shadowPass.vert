@@ -2,6 +2,8 @@
 
 #include "include/common.glsl"
 #include "include/vertex.glsl"
+#include "include/skinning.glsl"
+#include "include/lighting.glsl"
 
 // Per vertex
 layout (location = 0) in vec3 inPos;
@@ -13,12 +15,15 @@ layout (location = 6) in vec4 inColor0;
 
 // Per Instance
 layout (location = 7) in uvec4 inInstanceIndices;		// x - model, y - node, z - skin, w - material
+layout (location = 9) in int inSkinnedVertexBase;		// pre-skinned vertex index minus vertex index
 
 layout (location = 2) out vec2 outUV0;
 layout (location = 7) flat out uint outMaterialIndex;
 
 layout (push_constant) uniform Scene {
 	uint cascadeIndex;
+	uint padding;
+	SkinnedVertexBuffer skinnedVertices;
 } pushBlock;
 
 void main(){
@@ -26,9 +31,14 @@ void main(){
 	const uint nodeIndex = inInstanceIndices.y;
 	const uint skinIndex = inInstanceIndices.z;
 
+	const uint skinnedVertexBase = uint(inSkinnedVertexBase);
+
 	vec4 worldPos;
 
-	if (node.block[nodeIndex].jointCount > 0.0) {
+	if (skinnedVertexBase != NOTPRESKINNED) {
+		const vec4 skinnedPos = pushBlock.skinnedVertices.vertices[skinnedVertexBase + uint(gl_VertexIndex)].position;
+		worldPos = model.block[modelIndex].matrix * node.block[nodeIndex].matrix * skinnedPos;
+	} else if (node.block[nodeIndex].jointCount > 0.0) {
 		mat4 skinMatrix = 
 			inWeight.x * skin.block[skinIndex].jointMatrix[int(inJoint.x)] +
 			inWeight.y * skin.block[skinIndex].jointMatrix[int(inJoint.y)] +
@@ -42,18 +52,8 @@ void main(){
 
 	worldPos = vec4(worldPos.xyz / worldPos.w, 1.0);
 	outUV0 = inUV0;
-
-	float FOVMultiplier = 1.0;
-
-	for (uint i = 0; i < pushBlock.cascadeIndex; i++) {
-		FOVMultiplier *= (i < 1) ? SHADOWFOVMULT : SHADOWFOVMULT * SHADOWFOVMULT;
-	}
-
-	mat4 newProjection = scene.projection;
-	newProjection[0][0] *= FOVMultiplier;	
-	newProjection[1][1] *= FOVMultiplier;
-
 	outMaterialIndex = inInstanceIndices.w;
 
-	gl_Position = newProjection * scene.view * worldPos;
+	// cascades are fitted to the main camera view on the CPU
+	gl_Position = lighting.cascadeViewProjections[pushBlock.cascadeIndex] * worldPos;
 }
\ No newline at end of file
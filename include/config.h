@@ -6,15 +6,19 @@
 #define RE_ERRORLIMIT           RE_ERROR        // Terminate program if some error exceeds this level
 #define MAX_FRAMES_IN_FLIGHT    2u
 #define MAX_TRANSFER_BUFFERS    2u
-#define RE_MAXLIGHTS            32u             // Includes directional light, always at index 0
+#define RE_MAXLIGHTS            32u             // Lighting UBO light slots, directional light is always at index 0, point lights are clustered
 #define RE_MAXSHADOWCASTERS     4u
+#define RE_MAXCASCADES          4u              // Directional light shadow cascades, matches MAXCASCADES of shaders
 #define RE_MAXTRANSPARENTLAYERS 4u
 #define RE_OCCLUSIONSAMPLES     64u
+#define RE_MESHLETMAXVERTICES   64u             // Unique vertices per meshlet
+#define RE_MESHLETMAXTRIANGLES  124u            // Triangles per meshlet
 
 // render targets
 #define RTGT_PRESENT            "RT2D_Present"      // Final swapchain target
 #define RTGT_DEPTH              "RT2D_Depth"        // Active camera depth render target
 #define RTGT_SHADOW             "RT2D_Shadow"       // Shadow render target (depth)
+#define RTGT_SHADOWCACHE        "RT2D_ShadowCache"  // Static shadow casters of every cascade (depth)
 #define RTGT_ENVSRC             "RT2D_EnvSrc"       // Source texture for environment cubemaps
 #define RTGT_PPTAA              "RT2D_TAA"          // PBR + velocity and history images
 #define RTGT_PPBLOOM            "RT2D_PPBloom"      // Post processing bloom target
@@ -69,27 +73,43 @@ extern uint32_t renderHeight;
 extern float viewDistance;                      // aka FarZ
 extern float FOV;
 extern bool bDevMode;
+extern bool bHeadless;                          // simulation only, no window or device
+extern uint32_t jobWorkers;                     // 0 uses all hardware threads
+extern float simulationRate;                    // fixed ticks per second, 0 ticks once per frame
 extern float pitchLimit;                        // camera pitch limit
 extern uint32_t shadowResolution;
 extern uint32_t shadowCascades;
+extern float shadowDistance;                    // view depth covered by shadow cascades
 extern float maxAnisotropy;
 extern uint32_t ambientOcclusionMode;
 
 // scene buffer values
 namespace scene {
-// expected unique vertices and indices
-// that scene vertex and index buffers will be allocated for
+// unique vertices and indices per scene geometry page, additional pages
+// are allocated when existing ones can't fit a model
 // TODO: set these through map configuration
 //
-// TODO: if ever needed - allocate new scene vertex and index buffers when
-// buffer overflow happens NOTE: on device 96 bytes per vertex / 4 bytes per
-// index
+// NOTE: on device 112 bytes per vertex / 4 bytes per index
 
-const size_t vertexBudget = 10000000u;                  // ~960 MBs for vertex data
-const size_t indexBudget = 100000000u;                  // ~400 MBs for index data
+const size_t vertexBudget = 2000000u;                   // ~224 MBs for vertex data per page
+const size_t indexBudget = 20000000u;                   // ~80 MBs for index data per page
+const float defragmentationThreshold = 0.5f;            // Share of page free space outside its largest range
 const size_t entityBudget = 1000u;                      // ~64 KBs for root transformation matrices
 const size_t nodeBudget = RE_MAXJOINTS * entityBudget;  // ~16 MBs for node transformation matrices
 const size_t cameraBudget = 64u;                        // ~9 KBs for camera MVP data
+const size_t skinnedVertexBudget = 262144u;             // ~16 MBs per frame in flight for pre-skinned vertices
+const size_t uploadRingSize = 64u * 1024u * 1024u;      // 64 MBs of staging memory for batched uploads
+const uint32_t occlusionBufferWidth = 256u;             // CPU occlusion culling depth buffer
+const uint32_t occlusionBufferHeight = 144u;
+const size_t pointLightBudget = 4096u;                 // 128 KBs per frame in flight for clustered point lights
+const size_t lightIndexBudget = 262144u;               // 1 MB per frame in flight for cluster light indices
+
+// texture streaming, streamed textures always keep their mips of tail extent
+// and smaller resident, finer levels are loaded on demand within the budget
+extern size_t textureBudget;                            // device memory for streamed texture mips
+const size_t textureUploadLimit = 32u * 1024u * 1024u;  // streamed mip data made resident per frame
+const uint32_t textureTailExtent = 128u;
+const float textureMipBias = 0.0f;                      // negative values select more detailed mips
 
 extern uint32_t sampledImageBudget;
 extern uint32_t storageImageBudget;
@@ -138,6 +158,7 @@ extern VkDeviceSize descriptorBufferOffsetAlignment;
 constexpr bool applyGLTFLeftHandedFix = false;
 constexpr uint32_t maxSampler2DDescriptors = 4096u; // amount of allowed variable index descriptors
 constexpr uint8_t haltonSequenceCount = 16u;
+constexpr uint32_t maxTimestampScopes = 64u;          // GPU timed scopes per frame
 }
 }  // namespace core
 
@@ -1,14 +1,18 @@
 #pragma once
 
 #include "config.h"
+#include "core/managers/jobs.h"
 
+// runs bound functions as a single job of the job system each time it's
+// updated, a new update while the job is still running repeats it once done
 class RAsync {
-  std::thread thread;
   std::mutex mutex;
-  std::condition_variable conditional;
+  RJobCounter counter;
   std::vector<TFuncPtr> boundFunctions;
+  const char* name = nullptr;
   bool cue = false;
-  bool execute = true;
+  bool isRunning = false;
+  bool execute = false;
 
   void loop();
 
@@ -21,12 +25,12 @@ class RAsync {
 
   void unbindFunctions() { boundFunctions.clear(); }
 
-  // bind function before calling start()
-  void start();
+  // bind function before calling start(), name is shown by the profiler
+  void start(const char* threadName = nullptr);
 
-  // immediately stop this thread
+  // waits for the running job and stops accepting updates
   void stop();
 
   // execute bound function
   void update();
-};
\ No newline at end of file
+};
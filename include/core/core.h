@@ -20,12 +20,21 @@ extern class MActors& actors;
 // animations manager, provides animations to models
 extern class MAnimations& animations;
 
+// benchmark manager, plays scripted benchmarks and reports frame statistics
+extern class MBenchmark& benchmark;
+
 // debug manager, handles debugger integration
 extern class MDebug& debug;
 
+// job system, runs work on all cores with work stealing workers
+extern class MJobs& jobs;
+
 // materials manager, manages textures, shaders and materials
 extern class MResources& resources;
 
+// profiler, collects CPU and GPU timings of frames
+extern class MProfiler& profiler;
+
 // player manager, provides interaction between the player and everything else
 extern class MPlayer& player;
 
@@ -0,0 +1,57 @@
+#pragma once
+
+// frame times over a sliding window with percentiles, histogram and hitch
+// detection, has no device dependencies
+class RFrameStatistics {
+ public:
+  static constexpr uint32_t histogramBucketCount = 32u;   // last one is overflow
+
+  // times are in milliseconds
+  struct RSummary {
+    uint32_t frameCount = 0u;
+    float averageTime = 0.0f;
+    float minTime = 0.0f;
+    float p50Time = 0.0f;
+    float p95Time = 0.0f;
+    float p99Time = 0.0f;
+    float worstTime = 0.0f;
+    uint64_t worstFrame = 0u;       // index of the frame since the last reset
+    uint32_t hitchCount = 0u;
+    float hitchTime = 0.0f;         // frames slower than this are hitches
+    float histogramBucketWidth = 0.0f;
+    std::array<uint32_t, histogramBucketCount> histogram{};
+  };
+
+ private:
+  std::vector<float> m_samples;     // ring, oldest sample at m_nextSample when full
+  std::vector<uint64_t> m_frames;
+  uint32_t m_windowSize = 0u;
+  uint32_t m_nextSample = 0u;
+  uint64_t m_frameIndex = 0u;
+  float m_histogramBucketWidth = 2.0f;
+  float m_hitchFactor = 2.0f;
+  float m_minHitchTime = 8.0f;
+
+ public:
+  RFrameStatistics(const uint32_t windowSize = 600u);
+
+  void addFrame(const float frameTime);
+
+  // summarizes frames in the window, sorts a copy of the samples
+  RSummary getSummary() const;
+
+  // drops samples and restarts frame indices, e.g. after a warmup
+  void reset();
+
+  // also drops all samples
+  void setWindowSize(const uint32_t windowSize);
+
+  // hitch is a frame slower than factor times the median, but not faster than
+  // minimum time, which ignores jitter of very fast frames
+  void setHitchThreshold(const float factor, const float minimumTime);
+
+  void setHistogramBucketWidth(const float width);
+
+  uint32_t getWindowSize() const { return m_windowSize; }
+  uint32_t getSampleCount() const { return static_cast<uint32_t>(m_samples.size()); }
+};
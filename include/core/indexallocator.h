@@ -0,0 +1,30 @@
+#pragma once
+
+// constant time allocator of single indices inside a fixed capacity, e.g.
+// bindless descriptor slots, released indices are handed out first
+class RIndexAllocator {
+  std::vector<uint32_t> m_freeIndices;   // stack, lowest index on top initially
+  std::vector<uint64_t> m_usedBits;      // one bit per index, guards releases
+  uint32_t m_capacity = 0u;
+
+ public:
+  static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+  RIndexAllocator() = default;
+  RIndexAllocator(const uint32_t capacity);
+
+  // drops all allocations
+  void reset(const uint32_t capacity);
+
+  // returns invalidIndex if all indices are used
+  uint32_t allocate();
+
+  // returns false if the index wasn't allocated
+  bool release(const uint32_t index);
+
+  bool isAllocated(const uint32_t index) const;
+  uint32_t getCapacity() const { return m_capacity; }
+  uint32_t getAllocatedCount() const {
+    return m_capacity - static_cast<uint32_t>(m_freeIndices.size());
+  }
+};
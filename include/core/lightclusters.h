@@ -0,0 +1,91 @@
+#pragma once
+
+struct RPointLight;
+
+// range of the light index list shading a single cluster
+struct RLightCluster {
+  uint32_t firstLight = 0u;
+  uint32_t lightCount = 0u;
+};
+
+// bins point lights into a grid of view frustum clusters, screen tiles split
+// by exponential depth slices, spheres of influence are tested against view
+// space bounds of every cluster 8 lights at a time, has no device dependencies,
+// clusters over a limit keep the lights nearest to their center
+class RLightClusters {
+ public:
+  static constexpr uint32_t gridX = 16u;
+  static constexpr uint32_t gridY = 9u;
+  static constexpr uint32_t gridZ = 24u;               // depth slices
+  static constexpr uint32_t clusterCount = gridX * gridY * gridZ;
+  static constexpr uint32_t maxClusterLights = 64u;    // lights shading a single cluster
+
+ private:
+  struct RSlice {
+    std::vector<uint32_t> lights;     // candidates overlapping the slice depth range
+    std::vector<uint32_t> counts;     // lights of every cluster of the slice
+    std::vector<uint32_t> indices;    // maxClusterLights per cluster
+    std::vector<float> x, y, z;       // candidates padded to a multiple of 8
+    std::vector<float> radius2;
+    std::vector<uint32_t> overflow;   // all lights of a cluster over maxClusterLights
+    std::array<float, gridX * 2> columnBounds;   // view space x range of every column
+    std::array<float, gridY * 2> rowBounds;      // view space y range of every row
+    uint32_t cappedCount = 0u;        // clusters of the slice over maxClusterLights
+  };
+
+  glm::mat4 m_view = glm::mat4(1.0f);
+  glm::mat4 m_projection = glm::mat4(1.0f);
+  float m_near = 0.1f;
+  float m_far = 1000.0f;
+
+  std::vector<glm::vec4> m_viewLights;   // view space position, w is squared radius
+
+  std::array<float, gridZ + 1> m_sliceDepths;
+  std::array<RSlice, gridZ> m_slices;
+
+  std::vector<RLightCluster> m_clusters;
+  std::vector<uint32_t> m_indices;
+
+  uint32_t m_cappedClusterCount = 0u;
+  uint32_t m_truncatedClusterCount = 0u;
+
+  // view space center of a cluster of a slice
+  glm::vec3 getClusterCenter(const uint32_t sliceIndex, const uint32_t clusterIndex) const;
+
+  // moves keepCount lights nearest to the center to the front of the list
+  void keepNearestLights(const glm::vec3& center, uint32_t* pLights,
+                         const uint32_t lightCount, const uint32_t keepCount) const;
+
+ public:
+  RLightClusters();
+
+  // transforms lights into the view space of a left handed perspective camera
+  // and sorts them into depth slices, radius is stored in the location alpha
+  void prepare(const glm::mat4& view, const glm::mat4& projection,
+               const float nearPlane, const float farPlane,
+               const RPointLight* pLights, const uint32_t lightCount);
+
+  // assigns lights to clusters of a slice, different slices may be
+  // built in parallel
+  void buildSlice(const uint32_t sliceIndex);
+
+  // packs light indices of all slices into a single list, a cluster not fitting
+  // into the capacity keeps its nearest lights that still fit, returns the
+  // number of indices
+  uint32_t finalize(const uint32_t indexCapacity);
+
+  // cluster index is (z * gridY + y) * gridX + x, y grows with clip space y
+  const std::vector<RLightCluster>& getClusters() const { return m_clusters; }
+  const std::vector<uint32_t>& getIndices() const { return m_indices; }
+
+  // clusters of the last build that lost lights to maxClusterLights and to
+  // the index capacity
+  uint32_t getCappedClusterCount() const { return m_cappedClusterCount; }
+  uint32_t getTruncatedClusterCount() const { return m_truncatedClusterCount; }
+
+  float getNearPlane() const { return m_near; }
+  float getFarPlane() const { return m_far; }
+
+  // z slice of a view depth is log(depth) * scale + bias
+  glm::vec2 getSliceScaleAndBias() const;
+};
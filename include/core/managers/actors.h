@@ -33,8 +33,10 @@ class MActors {
  private:
   MActors();
 
-  // method should be called only by renderer
-  void updateLightingUBO(RLightingUBO* pLightingBuffer);
+  // method should be called only by renderer, visible point lights are
+  // collected for clustering instead of being stored in the uniform buffer
+  void updateLightingUBO(RLightingUBO* pLightingBuffer,
+                         std::vector<RPointLight>& outPointLights);
 
  public:
   static MActors& get() {
@@ -41,6 +41,39 @@ class MAnimations {
     bool bounce = false;
     bool isReversed = false;
     int32_t queueIndex = 0;
+
+    // entity binding slot of every animated node of the clip, -1 if missing
+    std::vector<int32_t> nodeBindingSlots;
+
+    // offset from the pose sharing clock, snapped to one of the phase buckets
+    float sharedPhase = 0.0f;
+    uint32_t sharedPhaseBuckets = 0u;   // bucket count sharedPhase was snapped to
+  };
+
+  struct SharedPoseKey {
+    const WAnimation* pAnimation = nullptr;
+    int32_t skinIndex = -1;
+    float time = 0.0f;    // quantized sample time
+
+    bool operator==(const SharedPoseKey& other) const {
+      return pAnimation == other.pAnimation && skinIndex == other.skinIndex &&
+             time == other.time;
+    }
+  };
+
+  struct SharedPoseKeyHash {
+    size_t operator()(const SharedPoseKey& key) const {
+      size_t hash = std::hash<const WAnimation*>()(key.pAnimation);
+      hash ^= std::hash<int32_t>()(key.skinIndex) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      hash ^= std::hash<float>()(key.time) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      return hash;
+    }
+  };
+
+  // joint palette evaluated once and referenced by all entities in the pose
+  struct SharedPose {
+    AEntity::AnimatedSkinBinding skinBinding;
+    uint64_t lastUsedFrame = 0u;
   };
 
   // stores all loaded animations
@@ -53,6 +86,9 @@ class MAnimations {
 
   int32_t m_availableQueueIndex = 0;
 
+  // animation time offset by timeOffset, wrapped to the entry's range
+  static float getSampleTime(const QueueEntry& queueEntry, const float timeOffset);
+
   // Index of a node in a node transform buffer (a pointer acts as a UID)
   std::vector<AEntity::AnimatedNodeBinding*> m_nodeTransformBufferIndices;
 
@@ -62,6 +98,35 @@ class MAnimations {
   // Index of a skin in a skin transform buffer
   std::vector<AEntity::AnimatedSkinBinding*> m_skinTransformBufferIndices;
 
+  struct {
+    std::atomic<bool> isEnabled = false;
+    float quantization = 1.0f / 30.0f;
+    uint32_t phaseBuckets = 0u;
+    double clock = 0.0;     // advanced by simulation ticks, phases are relative to it
+    uint64_t frame = 0u;
+    uint32_t usedPoseCount = 0u;
+    std::unordered_map<SharedPoseKey, std::unique_ptr<SharedPose>, SharedPoseKeyHash> poses;
+  } m_poseSharing;
+
+  // interpolates joint matrices of a skin, false if time is outside of the clip
+  static bool sampleSkin(const std::vector<WAnimation::KeyFrame>& keyFrames,
+                         const int32_t skinIndex, const float time,
+                         std::vector<glm::mat4>& outJointMatrices);
+
+  // sample time of a looping entry moved to its phase bucket
+  float getSharedSampleTime(QueueEntry& queueEntry, const float sampleTime);
+
+  // finds or evaluates the shared palette, nullptr if the skin buffer is full,
+  // first user in a frame writes the previous half of the palette from the
+  // palette it has shown during the last frame, the source of motion vectors
+  const AEntity::AnimatedSkinBinding* getSharedSkin(const QueueEntry& queueEntry,
+                                                    const int32_t skinIndex,
+                                                    const float sampleTime,
+                                                    const AEntity::AnimatedSkinBinding* pShownSkin);
+
+  // frees skin buffer slots of poses no longer used by frames in flight
+  void releaseUnusedPoses();
+
   MAnimations();
 
  public:
@@ -86,13 +151,31 @@ class MAnimations {
 
   // must not be used standalone, use WModel::playAnimation() instead
   int32_t addAnimationToQueue(const WAnimationInfo* pAnimationInfo);
-  void runAnimationQueue();
+
+  // advances queued animations by a single simulation tick
+  void advanceAnimationQueue(const float deltaTime);
+
+  // writes poses of queued animations, timeOffset is added to animation time
+  // without advancing it, e.g. to sample between the last two ticks
+  void runAnimationQueue(const float timeOffset = 0.0f);
   void cleanupQueue();
 
+  // entities sampling a clip at the same quantized time share one joint
+  // palette in the skin transform buffer, so sampling and upload scale with
+  // distinct poses, phaseBuckets > 0 snaps looping clips to that many phases
+  // so that entities which started at different times share them too
+  void setPoseSharing(const bool enable, const float quantization = 1.0f / 30.0f,
+                      const uint32_t phaseBuckets = 0u);
+  bool isPoseSharingEnabled() const { return m_poseSharing.isEnabled; }
+
+  // shared palettes used during the last frame
+  uint32_t getSharedPoseCount() const { return m_poseSharing.usedPoseCount; }
+
   // returns true if actor was registered, false if already present
   bool getOrRegisterActorOffsetIndex(class AEntity* pActor, uint32_t& outIndex);
   // returns true if node was registered, false if already present
   bool getOrRegisterNodeOffsetIndex(AEntity::AnimatedNodeBinding* pNode, uint32_t& outIndex);
+  // returns false and an invalid index if the skin transform buffer is full
   bool getOrRegisterSkinOffsetIndex(AEntity::AnimatedSkinBinding* pSkin, uint32_t& outIndex);
 };
 }  // namespace core
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "config.h"
+
+namespace core {
+
+// plays a scripted camera path with a fixed timestep and reports frame time
+// statistics and profiler scopes as JSON, e.g. to track regressions
+class MBenchmark {
+ private:
+  struct RCameraKey {
+    float time = 0.0f;              // seconds since the end of the warmup
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f);
+  };
+
+  struct {
+    std::string name = "benchmark";
+    std::string cameraName = RCAM_MAIN;
+    std::vector<RCameraKey> cameraPath;
+    float timestep = 1.0f / 60.0f;
+    uint32_t warmupFrames = 60u;
+    uint32_t frameCount = 0u;       // measured frames
+    std::string tracePath;          // Chrome trace is exported if set
+  } m_script;
+
+  std::string m_reportPath;
+  uint32_t m_frameIndex = 0u;
+  bool m_isLoaded = false;
+  bool m_isRunning = false;
+  std::chrono::steady_clock::time_point m_startTimePoint;
+
+  MBenchmark();
+
+  void updateCamera(const float time);
+
+ public:
+  static MBenchmark& get() {
+    static MBenchmark _sInstance;
+    return _sInstance;
+  }
+
+  MBenchmark(const MBenchmark&) = delete;
+  MBenchmark& operator=(const MBenchmark&) = delete;
+
+  // reads benchmark script, report is written to reportPath or next to the
+  // working directory using the benchmark name
+  TResult loadScript(const wchar_t* path, const char* reportPath = nullptr);
+
+  // must be called after the map is loaded
+  void start();
+
+  // positions the camera for the next frame, should be called once per frame
+  // before drawing, returns false once the benchmark has finished
+  bool update();
+
+  TResult writeReport(const std::string& path);
+
+  bool isLoaded() { return m_isLoaded; }
+  bool isRunning() { return m_isRunning; }
+};
+}  // namespace core
@@ -0,0 +1,102 @@
+#pragma once
+
+namespace core {
+class MJobs;
+}
+
+class RJobCounter;
+
+struct RJob {
+  std::function<void()> function;
+  RJobCounter* pCounter = nullptr;    // decremented once the job has finished
+};
+
+// number of unfinished jobs, must outlive its jobs and be waited for before
+// it's destroyed, jobs depending on it are released when it reaches zero
+class RJobCounter {
+  friend class core::MJobs;
+
+  std::atomic<uint32_t> m_count = 0u;
+  std::mutex m_mutex;
+  std::vector<RJob> m_dependents;
+
+ public:
+  RJobCounter() = default;
+  RJobCounter(const RJobCounter&) = delete;
+  RJobCounter& operator=(const RJobCounter&) = delete;
+
+  bool isDone() const { return m_count.load() == 0u; }
+};
+
+namespace core {
+
+// work stealing job system, every worker owns a queue it takes its newest
+// jobs from while idle workers steal the oldest jobs of other queues,
+// threads waiting for jobs help executing them and sleep when none are left
+class MJobs {
+ public:
+  static constexpr uint32_t invalidQueue = std::numeric_limits<uint32_t>::max();
+
+ private:
+  struct RQueue {
+    std::mutex mutex;
+    std::deque<RJob> jobs;
+  };
+
+  // index 0 belongs to the thread that initialized the system
+  std::vector<std::unique_ptr<RQueue>> m_queues;
+  std::vector<std::thread> m_workers;
+  std::vector<std::string> m_workerNames;
+
+  // workers sleep until jobs are queued, waiting threads also until their
+  // counter reaches zero
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wakeCondition;
+  std::atomic<uint32_t> m_queuedJobCount = 0u;
+  std::atomic<uint32_t> m_nextQueue = 0u;
+  std::atomic<bool> m_isRunning = false;
+
+  MJobs();
+
+  void workerLoop(const uint32_t queueIndex);
+  void push(RJob&& job);
+
+  // own queue is used first, other queues are stolen from
+  bool pop(RJob& outJob);
+  void execute(RJob& job);
+  void finish(RJobCounter* pCounter);
+
+ public:
+  static MJobs& get() {
+    static MJobs _sInstance;
+    return _sInstance;
+  }
+
+  MJobs(const MJobs&) = delete;
+  MJobs& operator=(const MJobs&) = delete;
+
+  // calling thread owns the first queue, 0 workers uses a worker per
+  // hardware thread except for the calling one, at least one is created
+  void initialize(uint32_t workerCount = 0u);
+
+  // finishes queued jobs and joins workers
+  void deinitialize();
+
+  uint32_t getWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+  // job is queued once pDependency reaches zero, pCounter is incremented
+  // immediately, jobs run in place if the system isn't initialized
+  void run(std::function<void()> function, RJobCounter* pCounter = nullptr,
+           RJobCounter* pDependency = nullptr);
+
+  // executes other jobs until the counter reaches zero, sleeps while there
+  // are none to take
+  void wait(RJobCounter* pCounter);
+
+  // splits [0, count) into ranges of batchSize passed to function(begin, end),
+  // calling thread takes part and returns when all ranges are done,
+  // 0 batchSize makes a few ranges per thread so they can be stolen
+  void parallelFor(const uint32_t count, uint32_t batchSize,
+                   const std::function<void(uint32_t, uint32_t)>& function);
+};
+}  // namespace core
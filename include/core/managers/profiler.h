@@ -0,0 +1,120 @@
+#pragma once
+
+#define RE_PROFILE_CONCAT_(a, b) a##b
+#define RE_PROFILE_CONCAT(a, b) RE_PROFILE_CONCAT_(a, b)
+
+// times the rest of the enclosing block on the calling thread,
+// name must outlive the profiler, e.g. a string literal
+#define RE_PROFILE_SCOPE(name) \
+  RProfileScope RE_PROFILE_CONCAT(_profileScope, __LINE__)(name)
+
+namespace core {
+
+// collects CPU scopes of all threads and GPU timings reported by the renderer,
+// keeps rolling per frame statistics and recent frames for trace export,
+// has no device dependencies
+class MProfiler {
+ public:
+  static constexpr uint32_t statisticsWindow = 120u;    // frames per average
+  static constexpr uint32_t capturedFrames = 240u;      // frames kept for export
+  static constexpr uint32_t maxFrameEvents = 65536u;    // e.g. while loading
+
+  enum class ETimeline : uint8_t { CPU, GPU };
+
+  struct REvent {
+    const char* name = nullptr;
+    uint64_t startTime = 0u;    // nanoseconds since profiler creation
+    uint64_t duration = 0u;
+    uint32_t threadId = 0u;     // unused by GPU events
+    ETimeline timeline = ETimeline::CPU;
+  };
+
+  // milliseconds, events of the same name are summed per frame
+  struct RStatistics {
+    float lastTime = 0.0f;
+    float averageTime = 0.0f;
+    float minTime = 0.0f;
+    float maxTime = 0.0f;
+    uint32_t sampleCount = 0u;
+  };
+
+ private:
+  struct RFrame {
+    uint64_t index = 0u;
+    uint64_t startTime = 0u;
+    uint64_t endTime = 0u;
+    std::vector<REvent> events;
+  };
+
+  struct RHistory {
+    std::array<float, statisticsWindow> samples{};
+    uint32_t nextSample = 0u;
+    uint32_t sampleCount = 0u;
+    float frameTime = 0.0f;     // accumulated during the frame being closed
+    bool isUsed = false;
+  };
+
+  std::chrono::steady_clock::time_point m_initialTimePoint;
+  mutable std::mutex m_mutex;
+
+  RFrame m_currentFrame;
+  std::deque<RFrame> m_frames;
+  std::unordered_map<std::string, RHistory> m_history[2];   // per timeline
+  std::vector<std::pair<uint32_t, std::string>> m_threadNames;
+  std::atomic<uint32_t> m_nextThreadId = 0u;
+  std::atomic<bool> m_isEnabled = true;
+
+  MProfiler();
+
+  void closeFrame(const uint64_t endTime);
+
+ public:
+  static MProfiler& get() {
+    static MProfiler _sInstance;
+    return _sInstance;
+  }
+
+  MProfiler(const MProfiler&) = delete;
+  MProfiler& operator=(const MProfiler&) = delete;
+
+  // nanoseconds since profiler creation
+  uint64_t getTime() const;
+
+  // small sequential id of the calling thread
+  uint32_t getThreadId();
+  void setThreadName(const char* name);
+
+  // closes the previous frame and starts a new one, should be called once
+  // per frame by the thread that renders
+  void beginFrame();
+
+  void addEvent(const char* name, const uint64_t startTime,
+                const uint64_t duration, const ETimeline timeline);
+
+  RStatistics getStatistics(const char* name,
+                            const ETimeline timeline = ETimeline::CPU) const;
+  std::vector<std::pair<std::string, RStatistics>> getAllStatistics(
+      const ETimeline timeline = ETimeline::CPU) const;
+
+  // writes captured frames in Chrome trace event format (chrome://tracing)
+  TResult exportChromeTrace(const std::string& path) const;
+
+  void setEnabled(const bool enable) { m_isEnabled = enable; }
+  bool isEnabled() const { return m_isEnabled; }
+
+  // drops captured frames and statistics
+  void reset();
+};
+}  // namespace core
+
+class RProfileScope {
+  const char* m_name;
+  uint64_t m_startTime;
+
+ public:
+  RProfileScope(const char* name);
+  ~RProfileScope();
+
+  RProfileScope(const RProfileScope&) = delete;
+  RProfileScope& operator=(const RProfileScope&) = delete;
+};
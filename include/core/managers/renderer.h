@@ -2,7 +2,14 @@
 
 #include "vk_mem_alloc.h"
 #include "core/objects.h"
-#include "core/async.h"
+#include "core/lightclusters.h"
+#include "core/rangeallocator.h"
+#include "core/shadowcascades.h"
+#include "core/occlusion.h"
+#include "core/skinning.h"
+#include "core/managers/jobs.h"
+#include "core/managers/profiler.h"
+#include "core/managers/time.h"
 #include "common.h"
 #include "core/world/actors/camera.h"
 
@@ -33,6 +40,54 @@ class MRenderer {
     std::vector<RComputeJobInfo> jobs;
   } compute;
 
+  // skinned primitive instances are skinned once per frame by a compute
+  // pre-pass, all later passes read the skinned vertices
+  struct {
+    RSkinningScheduler scheduler;                   // used by the instance buffer update
+    std::vector<RBuffer> vertexBuffers;             // per frame in flight skinned vertices
+    std::vector<RBuffer> batchBuffers;              // per frame in flight batches
+    std::vector<std::vector<RSkinningDispatch>> dispatches;   // per frame in flight
+    std::atomic<bool> isEnabled = true;
+  } skinning;
+
+  // entities hidden from the main camera by occluder models or outside of its
+  // view are packed after visible instances, only other views draw them,
+  // written by the frame update job after it has updated entity bounds and
+  // read by recording only after renderFrame has joined that job
+  struct {
+    ROcclusionCuller culler;                        // used by the instance buffer update
+    std::vector<uint8_t> entityVisibility;          // per entity binding
+    const ACamera* pCameras[MAX_FRAMES_IN_FLIGHT] = {};  // culling view per frame in flight
+    std::atomic<bool> isEnabled = true;
+  } occlusion;
+
+  // meshlets of unskinned primitives are culled against the main camera by the
+  // frame update job for all visible instances, views of that camera draw only
+  // index ranges of visible meshlets, statistics are summed on the main thread
+  struct {
+    std::vector<WPrimitive*> primitives;            // used by the instance buffer update
+    const ACamera* pCameras[MAX_FRAMES_IN_FLIGHT] = {};  // culling view per frame in flight
+    std::unordered_map<std::string, RMeshletStatistics> statistics;   // per model name
+    std::atomic<bool> isEnabled = true;
+  } meshlets;
+
+  // cascades are fitted to the main camera by the instance buffer update,
+  // only cascades scheduled for the frame are rendered, others keep their maps,
+  // a schedule is committed once its frame is submitted, static casters are
+  // rendered into a cache copied under the dynamic ones
+  struct {
+    RShadowCascades cascades;
+    RTexture* pStaticCache = nullptr;
+    std::vector<uint8_t> entityCascades;            // per entity binding cascade bits
+    std::vector<uint8_t> entityStatic;              // per entity binding static caster flag
+    std::vector<uint64_t> entitySignatures;         // per entity binding bounds hash
+    uint32_t updateMasks[MAX_FRAMES_IN_FLIGHT] = {};  // cascades rendered per frame in flight
+    uint32_t cacheMasks[MAX_FRAMES_IN_FLIGHT] = {};   // cascades rendering their static casters
+    std::array<RShadowCascade, RE_MAXCASCADES> frameCascades[MAX_FRAMES_IN_FLIGHT];
+    std::atomic<bool> isSchedulingEnabled = true;
+    std::atomic<bool> isStaticCachingEnabled = true;
+  } shadows;
+
   struct REnvironmentData {
     VkDescriptorSet LUTDescriptorSet;
     VkImageSubresourceRange subresourceRange;
@@ -51,9 +106,18 @@ class MRenderer {
     } tracking;
   } environment;
 
+  // point lights are binned into clusters of the main camera view, shaders
+  // read lights of a cluster through device addresses stored in the UBO,
+  // views of other cameras go over all point lights
   struct RLightingData {
     std::vector<RBuffer> buffers;
+    std::vector<RBuffer> pointLightBuffers;         // per frame in flight RPointLight
+    std::vector<RBuffer> clusterBuffers;            // per frame in flight RLightCluster
+    std::vector<RBuffer> lightIndexBuffers;         // per frame in flight light indices
+    std::vector<RPointLight> pointLights;
+    RLightClusters clusters;
     RLightingUBO data;
+    bool isClusterCapReported = false;    // dropped lights are logged once
   } lighting;
 
   struct RMaterialData {
@@ -68,15 +132,33 @@ class MRenderer {
   } material;
 
   struct RSceneBuffers {
-    RBuffer vertexBuffer;
+    // vertex and index storage, a new page is created when existing ones are full
+    struct RGeometryPage {
+      RBuffer vertexBuffer;
+      RBuffer indexBuffer;
+      RRangeAllocator vertexRanges;
+      RRangeAllocator indexRanges;
+      std::unordered_set<WModel*> pModels;
+    };
+
+    // released ranges may still be read by frames in flight
+    struct RGeometryRelease {
+      uint32_t pageIndex = 0u;
+      uint32_t vertexOffset = 0u;
+      uint32_t vertexCount = 0u;
+      uint32_t indexOffset = 0u;
+      uint32_t indexCount = 0u;
+      uint32_t releaseFrame = 0u;
+    };
+
+    std::vector<RGeometryPage> geometryPages;
+    std::vector<RGeometryRelease> geometryReleases;
+    bool isDefragmentationPending = false;   // set when retired ranges fragment a page
     std::vector<RBuffer> instanceBuffers;
-    RBuffer indexBuffer;
     RBuffer rootTransformBuffer;
     RBuffer nodeTransformBuffer;
     RBuffer skinTransformBuffer;
     RBuffer generalBuffer;
-    uint32_t currentVertexOffset = 0u;
-    uint32_t currentIndexOffset = 0u;
     size_t totalInstances = 0u;
     uint32_t currentInstanceUID = 0;
     VkDescriptorSet transformDescriptorSet;
@@ -131,15 +213,82 @@ class MRenderer {
     std::vector<VkSemaphore> semImgAvailable;
     std::vector<VkSemaphore> semRenderFinished;
     std::vector<VkFence> fenceInFlight;
-    RAsync asyncUpdateEntities;
-    RAsync asyncUpdateInstanceBuffers;
+    // entity and instance buffer update of the next frame, queued once a
+    // frame is submitted and joined before the next one is prepared
+    RJobCounter frameUpdate;
+
+    // held for every queue submit, present and wait, upload flushes may
+    // submit from loader threads while a frame is submitted
+    std::mutex queueMutex;
   } sync;
 
+  // batched transfer queue uploads through a persistent staging ring
+  struct RUploadData {
+    struct RUploadCopy {
+      VkBuffer dstBuffer;
+      VkBufferCopy region;
+    };
+
+    struct RUploadImageCopy {
+      VkImage dstImage;
+      VkBufferImageCopy region;
+      VkImageSubresourceRange subresourceRange;  // whole image, used by layout transitions
+      bool isFirst = false;             // image is transitioned to transfer layout before copying
+      bool isLast = false;              // image is transitioned to shader read layout after copying
+    };
+
+    // mip levels of a resident image copied to a smaller one on the graphics queue
+    struct RUploadMipCopy {
+      VkImage srcImage;
+      VkImage dstImage;
+      uint32_t srcBaseMip = 0u;
+      uint32_t levelCount = 0u;
+      uint32_t layerCount = 0u;
+      VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      VkExtent2D extent;                // of destination level 0
+    };
+
+    struct RUploadSubmit {
+      uint64_t timelineValue = 0u;
+      VkDeviceSize ringBytes = 0u;      // ring space freed when the graphics submit completes
+      VkCommandBuffer transferCommandBuffer = VK_NULL_HANDLE;
+      VkCommandBuffer graphicsCommandBuffer = VK_NULL_HANDLE;
+    };
+
+    RBuffer stagingRing;
+    uint8_t* pRingData = nullptr;
+    VkDeviceSize ringSize = 0u;
+    VkDeviceSize ringHead = 0u;         // next write position
+    VkDeviceSize ringUsed = 0u;         // written but not yet consumed by the GPU
+    VkDeviceSize pendingRingBytes = 0u; // written since the last submit
+
+    std::vector<RUploadCopy> pendingCopies;
+    std::vector<RUploadImageCopy> pendingImageCopies;
+    std::vector<RUploadMipCopy> pendingMipCopies;
+    std::vector<RUploadSubmit> submits;
+    std::vector<VkCommandBuffer> freeTransferCommandBuffers;
+    std::vector<VkCommandBuffer> freeGraphicsCommandBuffers;
+
+    VkSemaphore timeline = VK_NULL_HANDLE;
+    VkSemaphore graphicsTimeline = VK_NULL_HANDLE;  // same values, signaled after mip copies and acquires
+    uint64_t submittedValue = 0u;       // value signaled by the latest transfer submit
+    std::recursive_mutex mutex;
+  } upload;
+
+  // shader modules shared by pipelines, released once pipelines are created
+  struct {
+    std::unordered_map<std::string, VkShaderModule> modulesByPath;
+    std::unordered_map<uint64_t, VkShaderModule> modulesByHash;
+    std::mutex mutex;
+  } shaders;
+
   // render system data - passes, pipelines, mesh data to render
   struct {
     std::unordered_map<EDynamicRenderingPass, RDynamicRenderingPass> dynamicRenderingPasses;
     std::unordered_map<EPipelineLayout, VkPipelineLayout> layouts;
     std::unordered_map<EComputePipeline, VkPipeline> computePipelines;
+    std::vector<RGraphicsPipelineInfo> pendingPipelines;   // created together with all passes
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
     std::vector<RViewport> viewports;
     std::vector<glm::vec2> haltonJitter;
     std::vector<glm::vec4> occlusionOffsets;
@@ -153,10 +302,38 @@ class MRenderer {
 
     VkQueryPool queryPool;
 
+    // copy of the frame's simulation ticks, read by the entity update thread
+    core::MTime::RSimulationStep simulationStep;
+
+    // backing memory of host visible buffers in headless mode
+    std::vector<std::unique_ptr<uint8_t[]>> hostMemory;
+
     bool asyncComputeSupport = false;
     int32_t computeQueue = -1;
   } system;
 
+  // GPU timestamps written around passes, read back once the frame's fence is
+  // signaled and reported to the profiler
+  struct {
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    double timestampPeriod = 0.0;       // nanoseconds per tick
+    uint64_t timestampMask = 0u;
+    std::array<std::vector<const char*>, MAX_FRAMES_IN_FLIGHT> scopeNames;
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> submitTimes{};  // profiler time
+    std::vector<uint32_t> openScopes;
+    bool isSupported = false;
+  } timestamps;
+
+  // profiler scope that also times commands recorded while it exists
+  class RTimedScope {
+    RProfileScope m_cpuScope;
+    VkCommandBuffer m_commandBuffer;
+
+   public:
+    RTimedScope(VkCommandBuffer commandBuffer, const char* name);
+    ~RTimedScope();
+  };
+
   // current camera view data
   struct {
     RCameraInfo cameraSettings;
@@ -185,9 +362,11 @@ class MRenderer {
     uint32_t currentFrameIndex = 0;
     uint32_t frameInFlight = 0;
     uint32_t framesRendered = 0;
+    int32_t boundGeometryPage = -1;
     bool generateEnvironmentMapsImmediate = false;  // queue single pass environment map gen (slow)
     bool generateEnvironmentMaps = false;           // queue sequenced environment map gen (fast)
     bool isEnvironmentPass = false;                 // is in the process of generating
+    EShadowCasters shadowCasters = EShadowCasters::All;  // casters drawn by shadow passes
 
     void refresh() {
       pCurrentMaterial = nullptr;
@@ -212,6 +391,25 @@ class MRenderer {
   TResult createSceneBuffers();
   void destroySceneBuffers();
 
+  TResult createUploadResources();
+  void destroyUploadResources();
+
+  // returns ring space and command buffers of completed uploads
+  void reclaimUploads();
+
+  // reserves aligned space in the staging ring, may flush and wait if full
+  VkDeviceSize allocateUploadRange(const VkDeviceSize size);
+
+  // allocates a new pair of scene vertex and index buffers
+  TResult createGeometryPage(const uint32_t vertexCount, const uint32_t indexCount);
+
+  // returns released ranges to page allocators once no frame can use them,
+  // requests defragmentation if a page is left fragmented or empty
+  void retireGeometryReleases(const bool force);
+
+  // binds vertex and index buffers of the page if not already bound
+  void bindGeometryPage(VkCommandBuffer commandBuffer, const uint32_t pageIndex);
+
   TResult createUniformBuffers();
   void destroyUniformBuffers();
 
@@ -246,6 +444,11 @@ class MRenderer {
   TResult initialize();
   void deinitialize();
 
+  // null backend, host visible buffers are plain host memory, device buffers,
+  // textures and uploads are skipped, no window or device is required
+  TResult initializeHeadless();
+  void deinitializeHeadless();
+
   // returns descriptor set used by the current frame in flight by default
   const VkDescriptorSet getSceneDescriptorSet(uint32_t frameInFlight = -1);
 
@@ -287,9 +490,18 @@ class MRenderer {
   TResult createPipelineLayouts();
   VkPipelineLayout& getPipelineLayout(EPipelineLayout type);
 
+  // pipeline cache is loaded from disk if it was saved by a compatible device
+  // and driver, saved after pipelines are created
+  TResult createPipelineCache();
+  void savePipelineCache();
+  void destroyPipelineCache();
+
   TResult createComputePipelines();
   void destroyComputePipelines();
   TResult createGraphicsPipeline(RGraphicsPipelineInfo* pipelineInfo);
+
+  // creates pipelines queued by createDynamicRenderingPass() using all threads
+  TResult createPendingGraphicsPipelines();
   VkPipeline& getComputePipeline(EComputePipeline type);
 
   // check if pass flag is present in the pass array
@@ -323,9 +535,11 @@ class MRenderer {
 
   TResult getDepthStencilFormat(VkFormat desiredFormat, VkFormat& outFormat);
 
+  // shader modules are shared by path and by content until destroyShaderModules()
   VkPipelineShaderStageCreateInfo loadShader(const char* path,
                                              VkShaderStageFlagBits stage);
   VkShaderModule createShaderModule(std::vector<char>& shaderCode);
+  void destroyShaderModules();
 
   TResult checkInstanceValidationLayers();
   std::vector<const char*> getRequiredInstanceExtensions();
@@ -336,9 +550,41 @@ class MRenderer {
   TResult createQueryPool();
   void destroyQueryPool();
 
+  TResult createTimestampQueryPool();
+  void destroyTimestampQueryPool();
+  void resetTimestamps(VkCommandBuffer commandBuffer);
+  void beginTimestamp(VkCommandBuffer commandBuffer, const char* name);
+  void endTimestamp(VkCommandBuffer commandBuffer);
+
+  // reports timings of the frame that last used the current frame in flight
+  void collectTimestamps();
+
   void updateBoundEntities();
   void updateExposureLevel();
 
+  // requests texture detail for bound entities visible to the main camera
+  // and lets the resources manager stream mip levels accordingly
+  void updateTextureStreaming();
+
+  // rasterizes occluders of bound entities from the main camera and tests
+  // bounds of all bound entities against them on job workers
+  void cullOccludedEntities(const uint32_t frameIndex);
+
+  // bins visible point lights into clusters of the main camera on job workers
+  // and uploads them along with the light index list
+  void clusterPointLights(const uint32_t frameIndex);
+
+  // tests meshlets of primitives with packed visible instances against the
+  // main camera on job workers
+  void cullMeshlets(const uint32_t frameIndex);
+
+  // adds triangle counts of meshlet culling done for the frame to statistics
+  void updateMeshletStatistics(const uint32_t frameIndex);
+
+  // fits shadow cascades to the main camera, culls casters of every cascade
+  // on job workers and picks cascades rendered this frame
+  void updateShadowCascades(const uint32_t frameIndex);
+
 public:
   TResult copyImage(VkCommandBuffer cmdBuffer, VkImage srcImage,
                     VkImage dstImage, VkImageLayout srcImageLayout,
@@ -399,6 +645,13 @@ public:
 
   void uploadModelToSceneBuffer(WModel* pModel);
 
+  // frees model vertex and index ranges in scene buffers
+  void releaseModelFromSceneBuffer(WModel* pModel);
+
+  // repacks fragmented geometry pages and removes empty ones, waits for device idle,
+  // a page keeps its current buffers if new ones can't be created
+  TResult defragmentSceneBuffers();
+
   // set camera from create cameras by name
   void setCamera(const char* name);
   void setCamera(ACamera* pCamera);
@@ -413,6 +666,26 @@ public:
   void setShadowColor(const glm::vec3& color);
   void setBloomIntensity(const float intensity);
 
+  // disabled pre-pass makes every pass skin vertices from joint palettes again
+  void setSkinningPrePass(const bool enable);
+
+  // disabled culling draws every instance in every pass
+  void setOcclusionCulling(const bool enable);
+
+  // disabled culling draws whole primitives in every pass
+  void setMeshletCulling(const bool enable);
+
+  // triangles tested and culled per model since the last reset, e.g. for the
+  // benchmark report
+  const std::unordered_map<std::string, RMeshletStatistics>& getMeshletStatistics() const;
+  void resetMeshletStatistics();
+
+  // disabled scheduling renders every shadow cascade every frame
+  void setShadowCascadeScheduling(const bool enable);
+
+  // disabled caching renders static shadow casters with every cascade update
+  void setStaticShadowCaching(const bool enable);
+
   //
   // ***BUFFER
   //
@@ -426,6 +699,10 @@ public:
    TResult createBuffer(EBufferType type, VkDeviceSize size, RBuffer& outBuffer,
      void* inData);
 
+   // headless mode buffer, host visible types get host memory as mapped data
+   TResult createHostBuffer(EBufferType type, VkDeviceSize size, RBuffer& outBuffer,
+     void* inData);
+
    // copy buffer with SRC and DST bits, uses transfer command buffer and pool
    TResult copyBuffer(VkBuffer srcBuffer, VkBuffer& dstBuffer,
      VkBufferCopy* copyRegion, uint32_t cmdBufferId = 0);
@@ -440,7 +717,35 @@ public:
 
    void copyDataToBuffer(void* pData, VkDeviceSize dataSize, RBuffer* pDstBuffer, VkDeviceSize offset = 0u);
 
-   void updateInstanceBuffer();
+   // copies data to the staging ring and queues a device buffer copy,
+   // nothing is submitted until flushUploads() is called or the ring is full
+   TResult queueBufferUpload(RBuffer* pDstBuffer, const void* pData,
+                             VkDeviceSize size, VkDeviceSize dstOffset = 0u);
+
+   // copies image regions to the staging ring, region buffer offsets are relative
+   // to pData, image must be in undefined layout and is transitioned to shader
+   // read only layout by the submit that copies its last region
+   TResult queueImageUpload(RVulkanTexture* pDstTexture, const void* pData,
+                            const std::vector<VkBufferImageCopy>& regions,
+                            const std::vector<VkDeviceSize>& regionSizes);
+
+   // copies mip levels starting at srcBaseMip of a sampled image to every level
+   // of pDstTexture, no staging is used, source must be in shader read only
+   // layout and destination in undefined layout, both end up in shader read
+   // only layout before the frames submitted after the next flushUploads()
+   TResult queueImageMipCopy(const RVulkanTexture* pSrcTexture,
+                             RVulkanTexture* pDstTexture, const uint32_t srcBaseMip);
+
+   // submits queued copies to the transfer queue without waiting,
+   // returns the timeline value signaled on completion
+   uint64_t flushUploads();
+
+   // both check the graphics queue part of the upload, which runs after its copies
+   bool isUploadComplete(const uint64_t timelineValue);
+   void waitForUpload(const uint64_t timelineValue);
+
+   // builds instances, cascade ranges and skinning work of the frame
+   void updateInstanceBuffer(const uint32_t frameIndex);
 
   //
   // ***PHYSICAL DEVICE
@@ -564,7 +869,9 @@ public:
   // Draw bound entities using specific pipeline
   void drawBoundEntities(VkCommandBuffer commandBuffer, EDynamicRenderingPass passOverride = EDynamicRenderingPass::Null);
 
-  void renderPrimitive(VkCommandBuffer cmdBuffer, WPrimitive* pPrimitive, WModel* pModel);
+  // cascade index selects instances culled for a shadow cascade
+  void renderPrimitive(VkCommandBuffer cmdBuffer, WPrimitive* pPrimitive, WModel* pModel,
+                       const bool drawHiddenInstances = true, const int32_t cascadeIndex = -1);
 
   void renderEnvironmentMaps(VkCommandBuffer commandBuffer,
                              const uint32_t frameInterval = 1u);
@@ -574,7 +881,17 @@ public:
   void executeRenderingPass(VkCommandBuffer commandBuffer, EDynamicRenderingPass passId,
                             RMaterial* pPushMaterial = nullptr, bool renderQuad = false);
 
-  void executeShadowPass(VkCommandBuffer commandBuffer, const uint32_t cascadeIndex);
+  // skins visible skinned instances scheduled for this frame in flight
+  void executeSkinningPass(VkCommandBuffer commandBuffer, const uint32_t frameIndex);
+
+  // renders cascades scheduled for this frame, outdated static casters are
+  // rendered into the cache which is copied under the dynamic casters
+  void executeShadowCascades(VkCommandBuffer commandBuffer);
+
+  // draws casters of a cascade into a layer of a depth target, the layer keeps
+  // its contents if not cleared, target must be a depth attachment
+  void executeShadowPass(VkCommandBuffer commandBuffer, RTexture* pTarget, const uint32_t cascadeIndex,
+                         const EShadowCasters casters, const bool clearDepth);
 
   void executeAOBlurPass(VkCommandBuffer commandBuffer);
 
@@ -588,6 +905,9 @@ public:
  public:
   void renderFrame();
   void renderInitFrame();
+
+  // headless frame, runs the work of the update threads in place
+  void simulateFrame();
 };
 
 }  // namespace core
\ No newline at end of file
@@ -2,8 +2,11 @@
 
 #include "common.h"
 #include "core/objects.h"
+#include "core/indexallocator.h"
+#include "core/managers/jobs.h"
 #include "core/material/material.h"
 #include "core/material/texture.h"
+#include "core/material/texturestreamer.h"
 
 class WPrimitive;
 
@@ -23,10 +26,70 @@ class MResources {
 
   std::vector<RMaterial*> m_materialIndices;
   std::vector<RTexture*> m_samplerIndices;
+  RIndexAllocator m_materialSlots;
+  RIndexAllocator m_samplerSlots;
+
+  // combined sampler descriptors written together before the frame is submitted
+  std::vector<std::pair<uint32_t, VkDescriptorImageInfo>> m_samplerWrites;
+
+  // paths of textures with the same content and sampler as an already loaded one
+  std::unordered_map<std::string, std::string> m_textureAliases;
+  std::unordered_map<uint64_t, std::string> m_textureHashes;
+
+  // resources of deleted materials, released once frames in flight are done
+  // with them, textures are kept if they were referenced again meanwhile
+  struct RResourceRelease {
+    std::string textureName;
+    uint32_t materialIndex = -1;
+    uint32_t releaseFrame = 0u;
+  };
+
+  std::vector<RResourceRelease> m_releases;
+
+  // device data of streamed textures replaced by a different mip range,
+  // destroyed once frames in flight are done with it
+  struct RRetiredTexture {
+    RVulkanTexture texture;
+    VmaAllocation allocation = nullptr;
+    uint32_t combinedSamplerIndex = -1;
+    uint32_t retireFrame = 0u;
+  };
+
+  // KTX file of a streamed texture read by a job worker
+  struct RStreamingRead {
+    RJobCounter counter;
+    ktxTexture* pKTXTexture = nullptr;
+  };
+
+  struct {
+    RTextureStreamer streamer;
+    std::vector<RTexture*> pTextures;   // indexed by streaming id
+    std::unordered_map<uint32_t, std::unique_ptr<RStreamingRead>> pendingReads;
+    std::vector<RRetiredTexture> retiredTextures;
+    std::vector<RTextureStreamer::RResidencyChange> changes;
+  } m_streaming;
 
  private:
   MResources();
 
+  void writeCombinedSamplerDescriptor(RTexture* pTexture, const uint32_t index);
+  void releaseCombinedSamplerIndex(const uint32_t index);
+
+  // finds texture by its name or by the path of a deduplicated texture
+  RTexture* findTexture(const char* name) noexcept;
+
+  // drops a material reference, queues unreferenced texture for destruction
+  void releaseTexture(RTexture* pTexture, const bool destroyUnused);
+
+  // points materials using the texture to its current sampler index
+  void updateMaterialSamplerIndex(RTexture* pTexture);
+
+  // recreates device image of a streamed texture with its new resident mips,
+  // without KTX data the new mips are copied from the resident image,
+  // which is only possible if mips are dropped
+  TResult swapStreamedTexture(RTexture* pTexture, ktxTexture* pKTXTexture);
+  void destroyRetiredTextures(const bool force);
+
  public:
   static MResources &get() {
     static MResources _sInstance;
@@ -34,9 +97,15 @@ class MResources {
   }
 
   void initialize();
+
+  // reserves a bindless sampler slot, returns -1 if none are left
   uint32_t getFreeCombinedSamplerIndex();
   void updateMaterialDescriptorSet(RTexture* pTexture, EResourceType resourceType);
 
+  // writes queued descriptors, must be called before submitting work that
+  // uses the material descriptor set
+  void flushDescriptorWrites();
+
   // MATERIALS
 
   // create new material, returns pointer to the new material
@@ -56,6 +125,12 @@ class MResources {
   TResult loadTexture(const std::string& filePath, RSamplerInfo* pSamplerInfo,
                       const bool createExtraViews = false);
 
+  // load multiple KTX files, reading and Basis transcoding is done by worker
+  // threads while the calling thread queues finished textures for upload,
+  // files with the same content as a loaded texture share it and its sampler,
+  // returns the number of successfully loaded textures
+  uint32_t loadTextures(std::vector<RTextureLoadInfo>& loadInfos);
+
   // load KTX texture to staging buffer only
   TResult loadTextureToBuffer(const std::string& filePath, RBuffer& outBuffer);
 
@@ -72,7 +147,7 @@ class MResources {
   // write to texture, must have proper layout
   TResult writeTexture(RTexture* pTexture, void* pData, VkDeviceSize dataSize);
 
-  // unconditional destruction of texture object if 'force' is true
+  // textures assigned to materials are only destroyed if 'force' is true
   bool destroyTexture(const char* name, bool force = false) noexcept;
 
   // should be used only for changing settings within texture object
@@ -83,5 +158,21 @@ class MResources {
   RTexture* const assignTexture(const char* name) noexcept;
 
   void destroyAllTextures();
+
+  // destroys resources of deleted materials that are no longer used by
+  // frames in flight, should be called once per frame
+  void destroyReleasedResources(const bool force = false);
+
+  // TEXTURE STREAMING
+
+  // request detail for streamed textures of a material used by a primitive
+  // covering screenSize pixels during the current frame
+  void requestTextureDetail(RMaterial* pMaterial, const float screenSize);
+
+  // applies requests of the current frame, should be called once per frame
+  void updateTextureStreaming();
+
+  void setTextureBudget(const uint64_t budget);
+  const RTextureStreamer& getTextureStreamer() const;
 };
 }  // namespace core
\ No newline at end of file
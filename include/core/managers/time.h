@@ -1,15 +1,37 @@
 #pragma once
 
+#include "core/framestatistics.h"
+
 namespace core {
 
   class MTime {
+  public:
+    // how the simulation advances during the current frame
+    struct RSimulationStep {
+      uint32_t tickCount = 1u;        // fixed ticks to run
+      float tickDeltaTime = 0.0f;     // seconds per tick
+      float interpolation = 1.0f;     // rendered state between the last two ticks
+    };
+
+  private:
     double m_initialTimePoint;
     double m_oldTimePoint;
     double m_currentTimePoint;
     float m_lastDeltaTime = 0.0f;
+    float m_fixedDeltaTime = 0.0f;
+
+    // 0 runs a single variable length tick per frame
+    float m_tickDeltaTime = 0.0f;
+    double m_accumulatedTime = 0.0;
+    uint32_t m_maxTicksPerFrame = 4u;
+    RSimulationStep m_simulationStep;
+
+    RFrameStatistics m_frameStatistics;
 
     MTime();
 
+    void updateSimulationStep(const float deltaTime);
+
   public:
     static MTime& get() {
       static MTime _sInstance;
@@ -28,5 +50,26 @@ namespace core {
 
     // time since initial time point (engine initialization)
     float getTimeSinceInitialization();
+
+    // every tick reports this delta time instead of the measured one, frame
+    // statistics still use measured time, 0 restores measured delta time,
+    // resets time accumulated towards the next simulation tick
+    void setFixedDeltaTime(const float deltaTime);
+    float getFixedDeltaTime() { return m_fixedDeltaTime; }
+
+    // simulation advances in fixed ticks of this rate in Hz and rendering
+    // interpolates between the last two of them, 0 disables fixed ticks
+    void setSimulationRate(const float rate);
+    float getSimulationRate();
+
+    // time that would require more ticks during a frame is dropped,
+    // so a slow frame can't cause even slower ones
+    void setMaxTicksPerFrame(const uint32_t maxTicks);
+
+    // ticks of the current frame, updated by tickTimer()
+    const RSimulationStep& getSimulationStep() { return m_simulationStep; }
+
+    // measured times between ticks
+    RFrameStatistics& getFrameStatistics() { return m_frameStatistics; }
   };
-}
\ No newline at end of file
+}
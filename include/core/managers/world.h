@@ -24,10 +24,14 @@ class MWorld {
 
   // create a simple model using a chosen primitive and arguments
   TResult createModel(EPrimitiveType type, std::string name, int32_t arg0,
-                      int32_t arg1);
+                      int32_t arg1, const WModelConfigInfo* pConfigInfo = nullptr);
 
   WModel* getModel(const char* name);
 
+  // frees model scene buffer ranges for reuse, call after objects using
+  // this model are destroyed
+  TResult destroyModel(const char* name);
+
   // call after objects (pawns, statics) using models are already destroyed
   void destroyAllModels();
 };
@@ -23,6 +23,5 @@ struct RMaterial {
 
   // will materials manager automatically try to delete textures
   // from memory if unused by any other material
-  // !requires sharedPtr code, currently unused!
   bool manageTextures = false;
 };
\ No newline at end of file
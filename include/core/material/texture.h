@@ -2,6 +2,16 @@
 
 #include "core/objects.h"
 
+// texture file to be loaded by MResources::loadTextures()
+struct RTextureLoadInfo {
+  std::string filePath = "";
+  RSamplerInfo samplerInfo = RSamplerInfo{};
+  bool createSampler = true;      // no sampler and descriptor are created if false
+  bool createExtraViews = false;
+  bool enableStreaming = false;   // only tail mips are loaded, finer ones are streamed on demand
+  TResult result = RE_ERROR;      // set by the loader
+};
+
 // NOTE: if texture is loaded using KTX library - VMA allocations are not used
 struct RTexture {
   std::string name = "";
@@ -11,13 +21,22 @@ struct RTexture {
   bool isKTX = false;
   bool isCubemap = false;
 
-  // Trying to track how many times texture is assigned to material
-  // to see if it should be deleted if owning material is deleted
+  // Number of material slots the texture is assigned to, unreferenced
+  // textures of deleted materials that manage them are destroyed
   uint32_t references = 0;
 
+  // Hash of loaded image data and load options, textures with equal content
+  // and sampler are shared once their files compare equal
+  uint64_t contentHash = 0u;
+
   // Texture index in the sampler2D variable index descriptor set
   uint32_t combinedSamplerIndex = -1;
 
+  // Streamed textures keep only levels from residentMip on the device,
+  // texture extent and level count describe the resident levels
+  uint32_t streamingId = -1;
+  uint32_t residentMip = 0u;
+
   TResult createImageViews(const bool createExtraViews = false, const bool createCubemapFaceViews = false);
   TResult setSampler(RSamplerInfo *pSamplerInfo);
   TResult createDescriptor();
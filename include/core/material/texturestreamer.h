@@ -0,0 +1,75 @@
+#pragma once
+
+// CPU side residency bookkeeping of streamed texture mip levels, decides which
+// levels should be resident under a memory budget, has no device dependencies
+class RTextureStreamer {
+ public:
+  static constexpr uint32_t invalidId = std::numeric_limits<uint32_t>::max();
+
+  struct RResidencyChange {
+    uint32_t id;
+    uint32_t residentMip;   // new most detailed resident level
+  };
+
+ private:
+  struct RStreamedTexture {
+    std::vector<uint64_t> levelSizes;   // bytes per mip level, all layers included
+    uint32_t width = 0u;                // extent of mip level 0
+    uint32_t height = 0u;
+    uint32_t tailMip = 0u;              // this level and coarser ones are always resident
+    uint32_t residentMip = 0u;
+    uint32_t requestedMip = 0u;         // most detailed level requested this frame
+    uint64_t lastUsedFrame = 0u;
+    bool isActive = false;
+  };
+
+  std::vector<RStreamedTexture> m_textures;
+  std::vector<uint32_t> m_freeIds;
+  uint64_t m_budget = 0u;
+  uint64_t m_residentSize = 0u;
+  uint64_t m_frame = 1u;
+
+  uint64_t getLevelRangeSize(const RStreamedTexture& texture,
+                             const uint32_t firstMip) const;
+
+ public:
+  // texture starts with only its tail levels resident, returns streaming id
+  uint32_t addTexture(const std::vector<uint64_t>& levelSizes,
+                      const uint32_t width, const uint32_t height,
+                      const uint32_t tailMip);
+  void removeTexture(const uint32_t id);
+
+  // most detailed request of a frame is used, levels are clamped to the tail
+  void requestMip(const uint32_t id, const uint32_t mipLevel);
+  void requestScreenSize(const uint32_t id, const float screenSize,
+                         const float mipBias = 0.0f);
+
+  // applies requests made since the last update and advances the frame,
+  // least recently used levels are evicted when over budget, uploadLimit caps
+  // bytes that can become resident during a single update
+  void update(std::vector<RResidencyChange>& outChanges,
+              const uint64_t uploadLimit);
+
+  // overrides residency, e.g. if the device side change has failed
+  void setResidentMip(const uint32_t id, const uint32_t mipLevel);
+
+  void setBudget(const uint64_t budget) { m_budget = budget; }
+  uint64_t getBudget() const { return m_budget; }
+  uint64_t getResidentSize() const { return m_residentSize; }
+  uint32_t getResidentMip(const uint32_t id) const;
+  uint32_t getTailMip(const uint32_t id) const;
+  uint32_t getTextureCount() const;
+
+  // most detailed mip level worth sampling when the texture covers screenSize
+  // pixels, negative bias selects more detailed levels
+  static uint32_t getDesiredMip(const uint32_t width, const uint32_t height,
+                                const uint32_t levelCount,
+                                const float screenSize,
+                                const float mipBias = 0.0f);
+
+  // projected diameter in pixels of a bounding sphere, projectionScale is
+  // element [1][1] of the perspective projection matrix
+  static float getScreenSize(const float radius, const float distance,
+                             const float projectionScale,
+                             const float viewportHeight);
+};
@@ -31,6 +31,38 @@ class WAnimation {
     float duration = 0.0f;
   } stagingData;
 
+  // node transformation while resampling, only used by the resampling thread
+  struct ResamplingNode {
+    int32_t parent = -1;                    // parents precede their children
+    glm::mat4 restMatrix = glm::mat4(1.0f); // applied after translation, rotation and scale
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(glm::vec3(0.0f));
+    glm::vec3 scale = glm::vec3(1.0f);
+    glm::mat4 matrix = glm::mat4(1.0f);     // accumulated transformation
+  };
+
+  // staged channel with its node resolved, the cursor only moves forward
+  struct ResamplingTrack {
+    const StagingTransformBlock* pBlock = nullptr;
+    int32_t poseIndex = -1;
+    size_t cursor = 0;
+  };
+
+  struct ResamplingSkin {
+    int32_t skinIndex = -1;
+    std::vector<int32_t> jointPoseIndices;
+    const std::vector<glm::mat4>* pInverseBindMatrices = nullptr;
+  };
+
+  // scratch pose of the whole model, resampling doesn't modify the model
+  struct ResamplingPose {
+    std::vector<ResamplingNode> nodes;
+    std::vector<ResamplingTrack> tracks;
+    std::vector<std::pair<int32_t, int32_t>> meshNodes;   // node index, pose index
+    std::vector<ResamplingSkin> skins;
+    int32_t skinCount = 0;
+  };
+
   struct AnimatedNode {
     std::string name = "";
     int32_t index = 0;
@@ -56,8 +88,9 @@ class WAnimation {
   // contains time stamps and animated node matrices
   std::vector<KeyFrame> m_keyFrames;
 
-  void processFrame(WModel* pModel, const float time);
-  void addKeyFrame(WModel* pModel, const float timeStamp);
+  void createResamplingPose(WModel* pModel, ResamplingPose& outPose);
+  void processFrame(ResamplingPose& pose, const float time);
+  void addKeyFrame(const ResamplingPose& pose, const float timeStamp);
 
  public:
   WAnimation(const std::string& name) : m_name(name){};
@@ -76,6 +109,8 @@ class WAnimation {
   std::vector<StagingTransformBlock>& getStagingTransformData();
   void clearStagingTransformData();
 
+  // model is only read, animations of the same model can be resampled
+  // by different threads at the same time
   void resampleKeyFrames(WModel* pModel, const float framerate,
                          const float speed = 1.0f);
   const std::vector<KeyFrame>& getKeyFrames();
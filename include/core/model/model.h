@@ -22,6 +22,7 @@ class WModel {
   friend class core::MRenderer;
   friend class core::MWorld;
   friend class AEntity;
+  friend class WAnimation;
   friend class WPrimitive;
   struct Node;
 
@@ -34,12 +35,17 @@ class WModel {
     size_t bufferIndex = -1;   // Index into skin buffer
     size_t bufferOffset = -1;  // Offset in bytes into skin buffer
 
-    RSkinUBO stagingTransformBlock;   // Used only for preprocessing animations
-
     struct {
       std::vector<glm::mat4> inverseBindMatrices;
-      bool recalculateSkinMatrices = true;
     } staging;
+
+    // bounds of vertices weighted to each joint before skinning, joints
+    // without weighted vertices are left out
+    struct {
+      std::vector<glm::vec4> centers;
+      std::vector<glm::vec4> extents;   // half sizes
+      std::vector<uint32_t> jointIndices;
+    } jointBounds;
   };
 
   struct Mesh {
@@ -49,6 +55,13 @@ class WModel {
 
     RNodeUBO stagingTransformBlock;   // Used only for preprocessing animations
                                       // Storing node transformation only for nodes with mesh data
+
+    // opaque geometry in node space rasterized by CPU occlusion culling,
+    // empty unless the model was imported as an occluder
+    struct {
+      std::vector<glm::vec4> positions;
+      std::vector<uint32_t> indices;
+    } occluder;
     struct {
       glm::vec3 min = glm::vec3(0.0f);
       glm::vec3 max = glm::vec3(0.0f);
@@ -74,41 +87,33 @@ class WModel {
     std::unique_ptr<Mesh> pMesh;
     Skin* pSkin = nullptr;
 
-    // node transformations (used only when resampling glTF animations)
+    // rest pose node transformations (used only when resampling glTF animations)
     struct {
       glm::mat4 nodeMatrix = glm::mat4(1.0f);
       glm::vec3 translation = glm::vec3(0.0f);
       glm::quat rotation = glm::quat(glm::vec3(0.0f));
       glm::vec3 scale = glm::vec3(1.0f);
     } staging;
-    
-    glm::mat4 transformedNodeMatrix = staging.nodeMatrix;
 
     // transform matrix only for this node
     glm::mat4 getLocalMatrix();
 
     Node(WModel::Node* pParentNode, uint32_t index, const std::string& name);
-
-    // propagate transformation through all nodes and their children
-    void propagateTransformation(
-        const glm::mat4& accumulatedMatrix = glm::mat4(1.0f));
-
-    void updateStagingNodeMatrices(WAnimation* pOutAnimation);
   };
 
   struct {
     const tinygltf::Model* pInModel = nullptr;
     uint32_t currentVertexOffset = 0u;
     uint32_t currentIndexOffset = 0u;
+    uint32_t weldedVertexCount = 0u;  // vertices removed by welding
+    bool weldVertices = true;
     std::vector<RVertex> vertices;
     std::vector<uint32_t> indices;
-    RBuffer vertexBuffer;
-    RBuffer indexBuffer;
-    bool isClean = true;
   } staging;
 
   std::string m_name = "$NONAMEMODEL$";
 
+  int32_t m_sceneGeometryPage = -1;   // scene vertex/index buffer pair index
   uint32_t m_sceneVertexOffset = 0u;
   uint32_t m_sceneIndexOffset = 0u;
   uint32_t m_vertexCount = 0u;
@@ -141,10 +146,12 @@ class WModel {
  private:
   // common
 
-  TResult createStagingBuffers();
   TResult validateStagingData();
   void clearStagingData();
 
+  // generates tangents for primitives requesting them, runs on multiple threads
+  void createTangentSpaceData();
+
   // sorts primitives
   void sortPrimitivesByMaterial();
 
@@ -184,6 +191,15 @@ class WModel {
 
   void loadSkins();
 
+  // per joint bounds from staging vertices of primitives using the skin
+  void createJointBounds(Skin* pSkin);
+
+  // copies vertex streams of skinned primitives from staging vertices
+  void createSkinningStreams();
+
+  // copies opaque geometry of unskinned meshes from staging data
+  void createOccluderData();
+
   // Node
 
   // create simple node with a single empty mesh
@@ -14,14 +14,58 @@ class WPrimitive {
   RMaterial* pInitialMaterial = nullptr;
   void* pOwnerNode = nullptr;
 
+  // tangents are still pending generation for this primitive's vertex data
+  bool createTangentSpaceData = false;
+
   std::vector<WPrimitiveInstanceData> instanceData;
 
+  // packed instances per frame in flight, instances hidden from the main
+  // camera follow the visible ones
+  struct {
+    uint32_t firstInstance = 0u;
+    uint32_t visibleCount = 0u;
+    uint32_t count = 0u;
+  } instanceRanges[MAX_FRAMES_IN_FLIGHT];
+
+  // packed instances casting shadows into a cascade rendered in the frame,
+  // static casters come first
+  struct {
+    uint32_t firstInstance = 0u;
+    uint32_t staticCount = 0u;
+    uint32_t count = 0u;
+  } cascadeRanges[MAX_FRAMES_IN_FLIGHT][RE_MAXCASCADES];
+
   struct {
     glm::vec3 min = glm::vec3(0.0f);
     glm::vec3 max = glm::vec3(0.0f);
     bool isValid = false;
   } extent;
 
+  // vertex streams of skinned primitives kept for CPU skinning after the
+  // vertex data is uploaded, empty for other primitives
+  struct {
+    std::vector<glm::vec4> positions;   // w is 1.0
+    std::vector<glm::vec4> normals;
+    std::vector<uint32_t> joints;       // 4 packed 8 bit joint indices
+    std::vector<glm::vec4> weights;
+  } skinningStreams;
+
+  // meshlet clusters generated at import, all indices are local to this primitive
+  struct {
+    std::vector<WMeshlet> meshlets;
+    std::vector<uint32_t> vertexIndices;   // meshlet vertex -> primitive vertex
+    std::vector<uint8_t> triangleIndices;  // 3 per triangle, index into meshlet vertices
+  } meshletData;
+
+  // index ranges of meshlets visible to the main camera per frame in flight,
+  // views of that camera draw them instead of the whole primitive
+  struct {
+    std::vector<glm::uvec2> indexRanges;   // x - first primitive index, y - index count
+    uint32_t triangleCount = 0u;           // tested triangles of all visible instances
+    uint32_t culledTriangleCount = 0u;
+    bool isValid = false;
+  } meshletRanges[MAX_FRAMES_IN_FLIGHT];
+
  public:
   WPrimitive() = delete;
   WPrimitive(RPrimitiveInfo* pCreateInfo);
@@ -50,4 +94,36 @@ class WPrimitive {
   bool getBoundingBoxExtent(glm::vec3& outMin, glm::vec3& outMax) const;
 
   void setNormalsFromVertices(std::vector<RVertex>& vertexData);
+
+  // merges vertices with equal quantized attributes and remaps indices,
+  // returns the number of removed vertices
+  static uint32_t weldVertices(std::vector<RVertex>& vertexData,
+                               std::vector<uint32_t>& indexData) noexcept;
+
+  // MikkTSpace style per vertex tangents from tex0, written to RVertex::tangent
+  static void generateTangents(RVertex* pVertices, const size_t vertexCount,
+                               const uint32_t* pIndices,
+                               const size_t indexCount) noexcept;
+
+  // split primitive triangles into meshlets with bounding spheres and normal cones
+  void generateMeshlets(const std::vector<RVertex>& vertexData,
+                        const std::vector<uint32_t>& indexData);
+
+  // frustum planes and camera location must be in primitive local space,
+  // normal cone should only be tested for back face culled materials
+  bool isMeshletVisible(const WMeshlet& meshlet, const glm::vec4* pFrustumPlanes,
+                        const glm::vec3& cameraLocation,
+                        const bool testNormalCone) const;
+
+  // tests meshlets against the view of every instance, meshlets visible to
+  // any of them are written as index ranges merging neighbouring meshlets,
+  // returns the number of culled triangles of a single instance
+  uint32_t cullMeshlets(const glm::mat4* pModelMatrices, const uint32_t instanceCount,
+                        const glm::mat4& projectionView, const glm::vec3& cameraLocation,
+                        const bool testNormalCone,
+                        std::vector<glm::uvec2>& outIndexRanges) const;
+
+ private:
+  void setMeshletBounds(WMeshlet& meshlet,
+                        const std::vector<RVertex>& vertexData);
 };
\ No newline at end of file
@@ -74,7 +74,8 @@ enum class EComputePipeline {
   Null,
   ImageLUT,
   ImageEnvIrradiance,
-  ImageEnvFilter
+  ImageEnvFilter,
+  Skinning
 };
 
 enum class EControlMode {
@@ -121,7 +122,8 @@ enum class EPipelineLayout {
   PBR,
   Environment,
   Shadow,
-  ComputeImage
+  ComputeImage,
+  ComputeSkinning
 };
 
 enum class EPrimitiveType {
@@ -138,6 +140,12 @@ enum class EResourceType {
   Image2D
 };
 
+enum class EShadowCasters {  // casters drawn by a shadow pass
+  All,
+  Static,     // cached between cascade updates
+  Dynamic     // drawn over the cached static casters
+};
+
 enum class ETransformType { Translation, Rotation, Scale, Weight, Undefined };
 
 enum EViewport { vpEnvironment, vpEnvIrrad, vpShadow, vpMain, vpCount };  // 'Count' is a hack
@@ -254,7 +262,11 @@ struct RGraphicsPipelineInfo {
   std::string vertexShader;
   std::string fragmentShader;
   std::string geometryShader;
-  VkPipelineRenderingCreateInfo* pDynamicPipelineInfo = nullptr;
+
+  // owned so that the pipeline can be created later on another thread,
+  // attachment formats are pointed to when the pipeline is created
+  VkPipelineRenderingCreateInfo renderingInfo{};
+  std::vector<VkFormat> colorAttachmentFormats;
   VkBool32 enableBlending = VK_FALSE;
   VkBool32 enableDepthWrite = VK_TRUE;
   VkBool32 enableDepthTest = VK_TRUE;
@@ -276,6 +288,10 @@ struct RInstanceData {
   int32_t nodeMatrixId = -1;
   int32_t skinMatrixId = -1;
   int32_t materialId = -1;
+
+  // skinned vertex buffer index minus the drawn vertex index, set per frame
+  // for instances skinned by the compute pre-pass
+  int32_t skinnedVertexBase = std::numeric_limits<int32_t>::min();
 };
 
 struct RLightInfo {
@@ -284,6 +300,7 @@ struct RLightInfo {
   float intensity = 1.0f;
   glm::vec3 direction = {0.0f, 0.0f, 0.0f};   // used by directional light only
   glm::vec3 translation = {0.0f, 0.0f, 0.0f}; // used by point light only, both may be used by spotlight
+  float radius = 3.1623f;                     // point light radius of influence
   bool isShadowCaster = false;
 };
 
@@ -387,12 +404,21 @@ struct RVertex {
   glm::vec2 tex1;    // TEXCOORD1
   glm::vec4 joint;   // JOINT
   glm::vec4 weight;  // WEIGHT
-  glm::vec4 color;   // COLOR      aligned to 96 bytes per vertex on device
+  glm::vec4 color;   // COLOR
+  glm::vec4 tangent = glm::vec4(0.0f);  // TANGENT    w is bitangent sign, aligned to 112 bytes per vertex on device
 
   static std::vector<VkVertexInputBindingDescription> getBindingDescs();
   static std::vector<VkVertexInputAttributeDescription> getAttributeDescs();
 };
 
+// output of the skinning pre-pass, positions and normals are in node space
+struct RSkinnedVertex {
+  glm::vec4 position;
+  glm::vec4 prevPosition;
+  glm::vec4 normal;
+  glm::vec4 tangent;      // w is bitangent sign
+};
+
 struct RVkLogicalDevice {
   VkDevice device;
 
@@ -454,8 +480,14 @@ struct RComputeImagePCB {
 };
 
 // lighting data uniform buffer object
+// point light of the clustered light list
+struct RPointLight {
+  glm::vec4 location;   // w is radius of influence
+  glm::vec4 color;      // alpha is intensity
+};
+
 struct RLightingUBO {
-  glm::vec4 lightLocations[RE_MAXLIGHTS];     // w is unused
+  glm::vec4 lightLocations[RE_MAXLIGHTS];     // w is unused, point lights are clustered separately
   glm::vec4 lightColors[RE_MAXLIGHTS];        // alpha is intensity
   glm::mat4 lightViews[RE_MAXSHADOWCASTERS];  // 0 - directional, 1 - 5 point light reserved
   glm::mat4 lightOrthoMatrix;                 // default orthogonal projection matrix for light views
@@ -469,6 +501,15 @@ struct RLightingUBO {
   float prefilteredCubeMipLevels;
   float scaleIBLAmbient = 1.0f;
   uint32_t aoMode = (uint32_t)EAOMode::None;
+  glm::mat4 clusterViewProjection;             // camera the point lights were clustered for
+  glm::vec4 clusterDepthPlane;                 // world space plane returning view depth
+  glm::vec4 clusterDepthParams;                // x - near, y - far, z - slice scale, w - slice bias
+  glm::uvec4 clusterGrid;                      // x, y, z - cluster counts, w - point light count
+  VkDeviceAddress pointLightAddress = 0u;      // RPointLight
+  VkDeviceAddress clusterAddress = 0u;         // RLightCluster
+  VkDeviceAddress lightIndexAddress = 0u;      // uint32_t
+  glm::mat4 cascadeViewProjections[RE_MAXCASCADES];
+  glm::vec4 cascadeSplits;                     // far view depth of every cascade, 0 if unused
 };
 
 // Push constant block used by the scene fragment shader
@@ -488,7 +529,15 @@ struct RSceneFragmentPCB {
 // (16 bytes, 64 bytes total of 128 Vulkan spec)
 struct RSceneVertexPCB {
   uint32_t cascadeIndex = 0u;
-  float padding[3];
+  uint32_t padding = 0u;
+  VkDeviceAddress skinnedVertexAddress = 0u;
+};
+
+struct RComputeSkinningPCB {
+  VkDeviceAddress vertexAddress = 0u;
+  VkDeviceAddress skinnedVertexAddress = 0u;
+  VkDeviceAddress skinAddress = 0u;
+  VkDeviceAddress batchAddress = 0u;    // first batch of the dispatch
 };
 
 struct RModelUBO {
@@ -507,6 +556,7 @@ struct RSceneUBO {
   alignas(16) glm::vec3 cameraPosition = glm::vec3(0.0f);
   alignas(16) glm::vec2 haltonJitter = glm::vec2(0.0f);
   glm::vec2 clipData = glm::vec2(0.0f);
+  uint32_t isClusteredView = 0u;    // point lights were clustered for this camera
 };
 
 struct RSkinUBO {
@@ -531,6 +581,29 @@ struct WAttachmentInfo {
   bool attachToForwardVector = false;
 };
 
+// cluster of primitive triangles, bounds are stored in primitive local space
+struct WMeshlet {
+  uint32_t vertexOffset = 0u;     // first entry in primitive meshlet vertex indices
+  uint32_t triangleOffset = 0u;   // first entry in primitive meshlet triangle indices
+  uint32_t vertexCount = 0u;
+  uint32_t triangleCount = 0u;
+  uint32_t indexOffset = 0u;      // range of primitive indices holding the triangles
+  uint32_t indexCount = 0u;
+
+  glm::vec3 center = glm::vec3(0.0f);
+  float radius = 0.0f;
+  glm::vec3 coneAxis = glm::vec3(0.0f);
+  float coneCutoff = 1.0f;        // sine of normal cone spread, 1.0 disables backface test
+};
+
+// triangles of a model's meshlet culled primitives summed over frames,
+// instanced triangles are counted once per instance
+struct RMeshletStatistics {
+  uint32_t frameCount = 0u;
+  uint64_t triangleCount = 0u;
+  uint64_t culledTriangleCount = 0u;
+};
+
 struct WModelConfigInfo {
   // see EAnimationLoadMode definition for information
   EAnimationLoadMode animationLoadMode = EAnimationLoadMode::OnDemand;
@@ -540,11 +613,17 @@ struct WModelConfigInfo {
   float framerate = 15.0f;
   // speed up extracted animations while sampling, will apply to all
   float speed = 1.0f;
+  // merge split vertices with equal attributes when importing primitives
+  bool weldVertices = true;
+  // keep opaque geometry of unskinned meshes to hide other entities behind
+  // it on the CPU, meant for simplified hull models
+  bool isOccluder = false;
 };
 
 struct WPrimitiveInstanceData {
   uint32_t instanceIndex = 0;
   uint32_t passFlags = 0;
+  int32_t bindingIndex = -1;    // renderer binding of the owning entity
   bool isVisible = true;
 
   RInstanceData instanceBufferBlock;
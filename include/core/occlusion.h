@@ -0,0 +1,70 @@
+#pragma once
+
+// low resolution depth buffer of occluder triangles rasterized on the CPU,
+// boxes behind occluders or outside of the view are reported as hidden,
+// depth is stored in 8x8 pixel tiles with the farthest depth of every tile
+// kept as a coarser level, has no device dependencies
+class ROcclusionCuller {
+ public:
+  static constexpr uint32_t tileSize = 8u;    // pixels per tile row and column
+  static constexpr float minW = 1e-3f;        // clip space w of the near plane used for clipping
+
+ private:
+  // screen space triangle, edge functions are positive inside
+  struct RTriangle {
+    float edgeA[3];
+    float edgeB[3];
+    float edgeC[3];
+    float depthA, depthB, depthC;   // depth = a * x + b * y + c
+    int32_t minX, minY, maxX, maxY; // covered pixels
+  };
+
+  uint32_t m_width = 0u;
+  uint32_t m_height = 0u;
+  uint32_t m_tileCountX = 0u;
+  uint32_t m_tileCountY = 0u;
+
+  glm::mat4 m_viewProjection = glm::mat4(1.0f);
+
+  std::vector<float> m_depth;             // tile after tile, rows of tileSize pixels
+  std::vector<float> m_tileDepth;         // farthest depth of every tile
+  std::vector<RTriangle> m_triangles;
+  std::vector<std::vector<uint32_t>> m_bandTriangles;
+  std::vector<glm::vec4> m_clipVertices;  // scratch for addOccluder()
+  std::vector<glm::vec3> m_screenVertices;
+
+  // pixel coordinates and normalized device depth
+  glm::vec3 toScreen(const glm::vec4& clip) const;
+  void addTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2);
+
+ public:
+  ROcclusionCuller() = default;
+  ROcclusionCuller(const uint32_t width, const uint32_t height);
+
+  // size is rounded up to whole tiles
+  void resize(const uint32_t width, const uint32_t height);
+
+  // drops occluders and clears depth, matrix maps world space to clip space
+  void reset(const glm::mat4& viewProjection);
+
+  // transforms, clips and bins triangles of an occluder, positions are in
+  // model space, not thread safe
+  void addOccluder(const glm::mat4& modelMatrix, const glm::vec4* pPositions,
+                   const uint32_t vertexCount, const uint32_t* pIndices,
+                   const uint32_t indexCount);
+
+  // a band is a row of tiles, different bands may be rasterized in parallel
+  void rasterizeBand(const uint32_t bandIndex);
+
+  // world space box, false if it's outside of the view or behind rasterized
+  // occluders, safe to call from multiple threads once all bands are done
+  bool isVisible(const glm::vec3& min, const glm::vec3& max) const;
+
+  uint32_t getWidth() const { return m_width; }
+  uint32_t getHeight() const { return m_height; }
+  uint32_t getBandCount() const { return m_tileCountY; }
+  uint32_t getTriangleCount() const { return static_cast<uint32_t>(m_triangles.size()); }
+
+  // normalized device depth of a pixel, max float if nothing was rasterized
+  float getDepth(const uint32_t x, const uint32_t y) const;
+};
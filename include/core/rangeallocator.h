@@ -0,0 +1,34 @@
+#pragma once
+
+// best fit allocator of element ranges inside a fixed capacity,
+// released ranges are merged with their free neighbours
+class RRangeAllocator {
+  std::map<uint32_t, uint32_t> m_freeByOffset;        // offset -> size
+  std::multimap<uint32_t, uint32_t> m_freeBySize;     // size -> offset
+  uint32_t m_capacity = 0u;
+  uint32_t m_allocated = 0u;
+
+  void insertFreeRange(const uint32_t offset, const uint32_t size);
+  void eraseFreeRange(std::map<uint32_t, uint32_t>::iterator it);
+
+ public:
+  static constexpr uint32_t invalidOffset = std::numeric_limits<uint32_t>::max();
+
+  RRangeAllocator() = default;
+  RRangeAllocator(const uint32_t capacity);
+
+  // drops all allocations
+  void reset(const uint32_t capacity);
+
+  // returns invalidOffset if no free range is large enough
+  uint32_t allocate(const uint32_t size);
+  void release(const uint32_t offset, const uint32_t size);
+
+  uint32_t getCapacity() const { return m_capacity; }
+  uint32_t getAllocatedSize() const { return m_allocated; }
+  uint32_t getFreeSize() const { return m_capacity - m_allocated; }
+  uint32_t getLargestFreeRange() const;
+
+  // 0.0 if all free space is a single range, approaches 1.0 when scattered
+  float getFragmentation() const;
+};
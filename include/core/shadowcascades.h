@@ -0,0 +1,110 @@
+#pragma once
+
+#include "config.h"
+
+// light space box a cascade is rendered with, the box reaches back towards
+// the light to include casters outside of the covered view
+struct RShadowCascade {
+  glm::mat4 viewProjection = glm::mat4(1.0f);
+  glm::mat4 lightView = glm::mat4(1.0f);      // rotation only
+  glm::vec3 worldCenter = glm::vec3(0.0f);    // center of the covered view frustum slice
+  glm::vec3 center = glm::vec3(0.0f);         // light space, snapped to shadow map texels
+  float radius = 0.0f;                        // half size of the box
+  float coverRadius = 0.0f;                   // bounding sphere of the covered slice
+  float nearZ = 0.0f;                         // light space depth range
+  float farZ = 0.0f;
+  float splitDepth = 0.0f;                    // far view depth of the covered slice
+};
+
+// fits directional light shadow cascades to slices of a view frustum split by
+// the practical split scheme, cascades are bounding spheres of the slices so
+// their size doesn't change with view rotation and their centers are snapped
+// to shadow map texels, schedules cascade updates: a cascade is rendered again
+// only when its light, box or casters changed and distant cascades are updated
+// every few frames unless the view moved out of them, static casters of every
+// cascade are cached and only rendered again when the cascade box or the set
+// of static casters changed, a schedule takes effect once the frame rendering
+// it is committed, has no device dependencies
+class RShadowCascades {
+ public:
+  static constexpr uint32_t maxCascades = RE_MAXCASCADES;
+  static constexpr float lightDirectionTolerance = 0.99999f; // cosine of ignored sun movement
+  static constexpr float scheduledMargin = 0.1f;            // box growth of cascades not updated every frame
+  static constexpr uint32_t staticCasterFrames = 60u;       // unchanged frames before a caster is cached
+
+ private:
+  struct RState {
+    RShadowCascade rendered;
+    uint64_t casterSignature = 0u;
+    bool isValid = false;
+
+    // box and static casters of the static cache
+    glm::mat4 cachedViewProjection = glm::mat4(1.0f);
+    uint64_t staticSignature = 0u;
+    bool isCacheValid = false;
+  };
+
+  uint32_t m_cascadeCount = 0u;
+  uint32_t m_resolution = 1u;
+  float m_splitLambda = 0.75f;
+  float m_casterDistance = 0.0f;
+  uint64_t m_frame = 0u;
+  glm::vec3 m_lightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+
+  std::array<uint32_t, maxCascades> m_updateIntervals;
+  std::array<RShadowCascade, maxCascades> m_fitted;
+  std::array<RState, maxCascades> m_states;      // shadow map contents of committed frames
+  std::array<RState, maxCascades> m_scheduled;   // states once the last schedule is rendered
+
+  // true if the rendered box still contains the slice of the fitted cascade
+  static bool covers(const RShadowCascade& rendered, const RShadowCascade& fitted);
+
+ public:
+  RShadowCascades();
+
+  // invalidates all cascades
+  void setup(const uint32_t cascadeCount, const uint32_t resolution);
+
+  // blend of logarithmic (1) and uniform (0) splits
+  void setSplitLambda(const float lambda);
+
+  // cascade may skip frames between updates, 1 updates it every frame
+  void setUpdateInterval(const uint32_t cascadeIndex, const uint32_t frameInterval);
+
+  // forces an update of all cascades on the next schedule
+  void invalidate();
+
+  // forces static casters of all cascades to be rendered on their next update
+  void invalidateStaticCache();
+
+  // fits cascades to the view between its near plane and the shadow distance,
+  // casters up to the shadow distance towards the light are included, view
+  // space of the engine is left handed
+  void fit(const glm::mat4& view, const glm::mat4& projection, const float nearPlane,
+           const float shadowDistance, const glm::vec3& lightDirection);
+
+  // world space box against the fitted cascade, safe to call from multiple threads
+  bool intersects(const uint32_t cascadeIndex, const glm::vec3& min, const glm::vec3& max) const;
+
+  // picks cascades to render this frame, signatures identify casters of every
+  // fitted cascade, dirty cascades have casters changing without moving e.g.
+  // animated ones, returns a bit per rendered cascade, cascades stay scheduled
+  // until committed
+  uint32_t schedule(const uint64_t* pCasterSignatures, const uint32_t dirtyMask);
+
+  // cascades and static caches of the last schedule are in the shadow map,
+  // call once the frame rendering them is submitted
+  void commit(const uint32_t updateMask);
+
+  // picks cascades of the last schedule which need their static casters
+  // rendered again, signatures identify static casters of every cascade,
+  // returns a bit per cascade with an outdated static cache, caches stay
+  // outdated until their cascade update is committed
+  uint32_t scheduleStaticCache(const uint64_t* pStaticSignatures, const uint32_t updateMask);
+
+  uint32_t getCascadeCount() const { return m_cascadeCount; }
+  const RShadowCascade& getFittedCascade(const uint32_t cascadeIndex) const { return m_fitted[cascadeIndex]; }
+
+  // cascade the shadow map contains once the last schedule is rendered
+  const RShadowCascade& getRenderedCascade(const uint32_t cascadeIndex) const { return m_scheduled[cascadeIndex].rendered; }
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+struct RVertex;
+struct RSkinnedVertex;
+
+// up to RSkinningScheduler::batchSize consecutive vertices of a primitive
+// instance, skinned by a single compute workgroup
+struct RSkinningBatch {
+  uint32_t srcVertexOffset = 0u;    // vertex index inside the geometry page
+  uint32_t dstVertexOffset = 0u;    // vertex index inside the skinned vertex buffer
+  uint32_t vertexCount = 0u;
+  uint32_t skinIndex = 0u;          // block of the skin transform buffer
+};
+
+// consecutive batches reading the same geometry page
+struct RSkinningDispatch {
+  uint32_t pageIndex = 0u;
+  uint32_t firstBatch = 0u;
+  uint32_t batchCount = 0u;
+};
+
+// plans a frame of skinning work, assigns ranges of the skinned vertex buffer
+// to skinned primitive instances and splits them into batches grouped by
+// geometry page, instances using the same vertices and joint palette e.g.
+// entities sharing a pose are skinned once, has no device dependencies
+class RSkinningScheduler {
+ public:
+  static constexpr uint32_t batchSize = 64u;    // local size of cs_skinning
+  static constexpr uint32_t invalidOffset = std::numeric_limits<uint32_t>::max();
+
+ private:
+  struct RWork {
+    uint32_t pageIndex = 0u;
+    uint32_t srcVertexOffset = 0u;
+    uint32_t vertexCount = 0u;
+    uint32_t skinIndex = 0u;
+    uint32_t dstVertexOffset = 0u;
+
+    bool operator==(const RWork& other) const {
+      return pageIndex == other.pageIndex &&
+             srcVertexOffset == other.srcVertexOffset &&
+             vertexCount == other.vertexCount && skinIndex == other.skinIndex;
+    }
+  };
+
+  struct RWorkHash {
+    size_t operator()(const RWork& work) const {
+      size_t hash = std::hash<uint32_t>()(work.pageIndex);
+      hash ^= std::hash<uint32_t>()(work.srcVertexOffset) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      hash ^= std::hash<uint32_t>()(work.vertexCount) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      hash ^= std::hash<uint32_t>()(work.skinIndex) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      return hash;
+    }
+  };
+
+  std::unordered_set<RWork, RWorkHash> m_work;
+  std::vector<RSkinningBatch> m_batches;
+  std::vector<RSkinningDispatch> m_dispatches;
+  uint32_t m_vertexCapacity = 0u;
+  uint32_t m_vertexCount = 0u;
+  uint32_t m_requestCount = 0u;
+
+ public:
+  RSkinningScheduler() = default;
+  RSkinningScheduler(const uint32_t vertexCapacity);
+
+  // drops the work of the previous frame
+  void reset(const uint32_t vertexCapacity);
+
+  // returns the first skinned vertex of the instance or invalidOffset
+  // if the skinned vertex buffer can't fit it
+  uint32_t schedule(const uint32_t pageIndex, const uint32_t srcVertexOffset,
+                    const uint32_t vertexCount, const uint32_t skinIndex);
+
+  // builds batches and dispatches of the scheduled work
+  void finalize();
+
+  const std::vector<RSkinningBatch>& getBatches() const { return m_batches; }
+  const std::vector<RSkinningDispatch>& getDispatches() const { return m_dispatches; }
+
+  uint32_t getVertexCapacity() const { return m_vertexCapacity; }
+  uint32_t getSkinnedVertexCount() const { return m_vertexCount; }
+
+  // scheduled instances, including those sharing skinned vertices
+  uint32_t getRequestCount() const { return m_requestCount; }
+
+  // CPU path of cs_skinning through math::skinVertices(), skins vertices of
+  // the same joint palette, normals are normalized since only their direction
+  // is used by the shaders reading skinned vertices
+  static void skinVertices(const RVertex* pVertices, const uint32_t vertexCount,
+                           const glm::mat4* pJointMatrices,
+                           const glm::mat4* pPrevJointMatrices,
+                           RSkinnedVertex* pOutVertices);
+
+  // runs finalized batches on the CPU, pages are the vertex data of geometry
+  // pages, skin blocks are laid out like the skin transform buffer
+  void execute(const RVertex* const* pPageVertices, const uint8_t* pSkinBlocks,
+               const size_t skinBlockSize, RSkinnedVertex* pOutVertices) const;
+};
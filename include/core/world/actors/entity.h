@@ -3,6 +3,8 @@
 #include "core/world/actors/base.h"
 
 class WModel;
+class WPrimitive;
+class ROcclusionCuller;
 
 namespace core {
 class MAnimations;
@@ -18,6 +20,9 @@ class AEntity : public ABase {
      uint32_t skinTransformBufferOffset = -1;
 
      RSkinUBO transformBufferBlock;
+
+     // palette shared by entities in the same pose, used instead of this one
+     const AnimatedSkinBinding* pSharedSkin = nullptr;
    };
 
   struct AnimatedNodeBinding {
@@ -33,10 +38,9 @@ class AEntity : public ABase {
     bool requiresTransformBufferBlockUpdate = true;
   };
 
+  // model matrix of the rendered frame, interpolated between simulation ticks
   glm::mat4 m_modelMatrix = glm::mat4(1.0f);
 
-  EActorType m_typeId = EActorType::Entity;
-
   WModel* m_pModel = nullptr;
   
   // Renderer bind index
@@ -49,23 +53,66 @@ class AEntity : public ABase {
   uint32_t m_rootTransformBufferIndex = -1;
   uint32_t m_rootTransformBufferOffset = -1;
 
+  // root transformations at the end of the last two simulation ticks
+  struct {
+    glm::vec3 translation = {0.0f, 0.0f, 0.0f};
+    glm::quat rotation = {0.0f, 0.0f, 0.0f, 1.0f};
+    glm::vec3 scaling = {1.0f, 1.0f, 1.0f};
+  } m_tickTransforms[2];
+  uint32_t m_storedTickCount = 0u;
+
+  // rendered frames since the root transformation last changed
+  uint32_t m_unchangedFrameCount = 0u;
+
   std::vector<AnimatedSkinBinding> m_animatedSkins;
   std::vector<AnimatedNodeBinding> m_animatedNodes;
 
+  // m_animatedNodes slot of every model node index, -1 if node has no mesh
+  std::vector<int32_t> m_nodeBindingSlots;
+
+  // world space bounds of the rendered pose, updated with the model
+  struct {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+    bool isValid = false;
+  } m_bounds;
+
   // Currently active animations (name / index in update queue)
   std::unordered_map<std::string, int32_t> m_playingAnimations;
 
   AnimatedSkinBinding* getAnimatedSkinBinding(const int32_t skinIndex);
   AnimatedNodeBinding* getAnimatedNodeBinding(const int32_t nodeIndex);
+  AnimatedNodeBinding* getAnimatedNodeBindingAt(const int32_t slot);
+
+  // -1 if the node isn't animated
+  int32_t getAnimatedNodeSlot(const int32_t nodeIndex) const;
   void updateTransformBuffers() noexcept;
 
+  // skinned meshes use joint bounds posed by current joint matrices, other
+  // meshes use their bind pose extent
+  void updateBounds(const glm::mat4& modelMatrix) noexcept;
+
+  // points instances of the skin at a shared palette, nullptr restores own
+  // palette with a copy of the shared one
+  void setSharedSkin(const int32_t skinIndex, const AnimatedSkinBinding* pSharedSkin);
+
  public:
-  AEntity() noexcept {};
+  AEntity() noexcept { m_typeId = EActorType::Entity; };
   virtual ~AEntity() override{};
 
   virtual void setModel(WModel* pModel);
   virtual WModel* getModel();
-  virtual void updateModel();
+  // writes root matrix to the transform buffer, interpolation blends
+  // between the last two simulation ticks, 1 uses current transformation
+  virtual void updateModel(const float interpolation = 1.0f);
+
+  // check return value first, has to be true for valid world space bounds
+  bool getBoundingBox(glm::vec3& outMin, glm::vec3& outMax) const;
+
+  // advances the simulated transformation by a tick, weight is the part of
+  // the way to the current transformation covered by this tick, so movement
+  // of a frame is spread over its ticks instead of landing on the first one
+  void storeTickTransform(const float weight);
   virtual void bindToRenderer();
   virtual void unbindFromRenderer();
   int32_t getRendererBindingIndex();
@@ -85,4 +132,28 @@ class AEntity : public ABase {
     const bool loop = true, const bool isReversed = false);
 
   void playAnimation(const WAnimationInfo* pAnimationInfo);
+
+  // pose may change every frame without the entity moving
+  bool hasPlayingAnimations() const { return !m_playingAnimations.empty(); }
+
+  // entities not moving for a while are cached by shadow cascades
+  uint32_t getUnchangedFrameCount() const { return m_unchangedFrameCount; }
+
+  // primitive of a skinned mesh posed on the CPU, in entity model space
+  struct SkinnedPrimitive {
+    const WPrimitive* pPrimitive = nullptr;
+    std::vector<glm::vec4> positions;
+    std::vector<glm::vec4> normals;
+  };
+
+  // skins primitives of skinned meshes with current joint matrices, e.g. for
+  // picking or mesh queries, primitives are skinned in parallel, returns the
+  // number of skinned vertices
+  uint32_t skinPrimitives(std::vector<SkinnedPrimitive>& outPrimitives);
+
+  // adds occluder geometry of the model with the rendered transformations
+  void addOccluders(ROcclusionCuller& culler);
+
+  // world matrix a model node is rendered with, false if the node has no mesh
+  bool getRenderedNodeMatrix(const int32_t nodeIndex, glm::mat4& outMatrix) const;
 };
\ No newline at end of file
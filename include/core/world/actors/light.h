@@ -10,6 +10,9 @@ class ALight : public ACamera {
   // r, g, b = color, a = intensity
   glm::vec4 m_lightProperties;
 
+  // point light influence, default matches 0.1 of inverse square attenuation
+  float m_lightRadius = 3.1623f;
+
   bool m_isShadowCaster = false;
 
  public:
@@ -17,10 +20,12 @@ class ALight : public ACamera {
   void setLightColor(float r, float g, float b);
   void setLightIntensity(float newIntensity);
   void setLightProperties(const glm::vec4& newProperties);
+  void setLightRadius(float newRadius);
 
   const glm::vec4& getLightProperties();
   const glm::vec3 getLightColor();
   const float getLightIntensity();
+  const float getLightRadius();
 
   void setAsShadowCaster(const bool isShadowCaster);
   bool isShadowCaster();
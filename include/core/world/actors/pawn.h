@@ -3,10 +3,7 @@
 #include "core/world/actors/entity.h"
 
 class APawn : public AEntity {
- protected:
-  EActorType m_typeId = EActorType::Pawn;
-
  public:
-  APawn() noexcept {};
+  APawn() noexcept { m_typeId = EActorType::Pawn; };
   virtual ~APawn() override{};
 };
\ No newline at end of file
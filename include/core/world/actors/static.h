@@ -3,10 +3,7 @@
 #include "core/world/actors/entity.h"
 
 class AStatic : public AEntity {
- protected:
-  EActorType m_typeId = EActorType::Static;
-
  public:
-  AStatic() noexcept {};
+  AStatic() noexcept { m_typeId = EActorType::Static; };
   virtual ~AStatic() override{};
 };
\ No newline at end of file
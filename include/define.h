@@ -34,6 +34,7 @@ constexpr bool enableGPUAssistedValidation = false;
 #define RE_PATH_TEXTURES    "content/textures/"
 #define RE_PATH_ANIMATIONS  "content/animations/"
 #define RE_PATH_SHADERS     "content/shaders/"
+#define RE_PATH_PIPELINECACHE "config/pipeline.cache"
 #define RE_PATH_SHDRC       "development\\compileShaders_Win_x64_DEBUG.bat"
 
 #define RE_FEXT_ANIMATIONS  ".anm"
@@ -10,14 +10,20 @@
 
 // standard library headers
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <conio.h>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <random>
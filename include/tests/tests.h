@@ -0,0 +1,40 @@
+#pragma once
+
+// records a failed check with the expression and its location
+#define RE_CHECK(context, condition) \
+  (context).check((condition), #condition, __FILE__, __LINE__)
+
+namespace tests {
+
+// counts checks of the running test, failures are logged as they happen
+class RTestContext {
+  const char* m_testName = nullptr;
+  uint32_t m_checkCount = 0u;
+  uint32_t m_failedCount = 0u;
+
+ public:
+  void begin(const char* testName);
+  bool check(const bool condition, const char* expression, const char* file,
+             const int32_t line);
+
+  uint32_t getCheckCount() const { return m_checkCount; }
+  uint32_t getFailedCount() const { return m_failedCount; }
+};
+
+// engine systems that work without a window or a device
+void testProfiler(RTestContext& context);
+void testFrameStatistics(RTestContext& context);
+void testJobs(RTestContext& context);
+void testRangeAllocator(RTestContext& context);
+void testIndexAllocator(RTestContext& context);
+void testTextureStreamer(RTestContext& context);
+void testSkinning(RTestContext& context);
+void testSkinningScheduler(RTestContext& context);
+void testOcclusion(RTestContext& context);
+void testMeshlets(RTestContext& context);
+void testLightClusters(RTestContext& context);
+void testShadowCascades(RTestContext& context);
+
+// runs all tests, returns the number of failed checks
+uint32_t run();
+}  // namespace tests
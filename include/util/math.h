@@ -99,4 +99,37 @@ uint32_t getMipLevels(uint32_t dimension);
 
 void getHaltonJitter(std::vector<glm::vec2>& outVector, const int32_t width, const int32_t height);
 
+// extract 6 normalized frustum planes (left, right, bottom, top, near, far) from
+// a projection matrix with 0..1 depth range, planes are in the space the matrix transforms from
+void getFrustumPlanes(const glm::mat4& matrix, glm::vec4* pOutPlanes);
+
+// expand bounds by a box of center and half extent transformed by the matrix,
+// w components are ignored, function uses FMA3 instruction set
+void expandBounds(const glm::mat4& matrix, const glm::vec4& center,
+                  const glm::vec4& extent, glm::vec4& outMin, glm::vec4& outMax);
+
+// expand bounds by per joint boxes transformed by their joint matrices, skinned
+// vertices are weighted sums of these transforms and stay inside the result
+void expandSkinnedBounds(const glm::mat4* pJointMatrices, const uint32_t jointCount,
+                         const glm::vec4* pCenters, const glm::vec4* pExtents,
+                         const uint32_t* pJointIndices, const size_t boxCount,
+                         glm::vec4& outMin, glm::vec4& outMax);
+
+// true if the CPU and OS support AVX2 and FMA3, checked once
+bool isAVX2Supported();
+
+// skin positions (w is 1.0) and normals by their 4 weighted joint matrices,
+// joints are 8 bit palette indices packed per vertex, output normals are
+// normalized, uses AVX2 if supported and skinVerticesScalar() otherwise
+void skinVertices(const glm::mat4* pJointMatrices, const glm::vec4* pPositions,
+                  const glm::vec4* pNormals, const uint32_t* pJoints,
+                  const glm::vec4* pWeights, const uint32_t vertexCount,
+                  glm::vec4* pOutPositions, glm::vec4* pOutNormals);
+
+// scalar reference of skinVertices()
+void skinVerticesScalar(const glm::mat4* pJointMatrices, const glm::vec4* pPositions,
+                        const glm::vec4* pNormals, const uint32_t* pJoints,
+                        const glm::vec4* pWeights, const uint32_t vertexCount,
+                        glm::vec4* pOutPositions, glm::vec4* pOutNormals);
+
 }  // namespace math
\ No newline at end of file
@@ -12,6 +12,10 @@ std::wstring toWString(const char* string);
 const VkDeviceSize getVulkanAlignedSize(VkDeviceSize originalSize,
                                         VkDeviceSize minAlignmanet);
 
+// 64-bit content hash of a memory block, not suitable for cryptography
+uint64_t hashData(const void* pData, const size_t dataSize,
+                  const uint64_t seed = 0xcbf29ce484222325ull);
+
 template<typename T>
 size_t hash(T input) {
   std::hash<T> hasher;
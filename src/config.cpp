@@ -10,9 +10,13 @@ uint32_t config::renderHeight = 720u;
 float config::viewDistance = 1000.0f;
 float config::FOV = 90.0f;
 bool config::bDevMode = false;
+bool config::bHeadless = false;
+uint32_t config::jobWorkers = 0u;
+float config::simulationRate = 60.0f;
 float config::pitchLimit = glm::radians(88.0f);
 uint32_t config::shadowResolution = 4096u;
 uint32_t config::shadowCascades = 4u;
+float config::shadowDistance = 64.0f;
 float config::maxAnisotropy = 16.0f;
 uint32_t config::ambientOcclusionMode = (uint32_t)EAOMode::HBAO;
 
@@ -45,6 +49,8 @@ VkFormat core::vulkan::formatShadow;
 VkDeviceSize core::vulkan::minUniformBufferAlignment = 64u;
 VkDeviceSize core::vulkan::descriptorBufferOffsetAlignment = 64u;
 
+size_t config::scene::textureBudget = 1024u * 1024u * 1024u;
+
 uint32_t config::scene::sampledImageBudget = 64u;
 uint32_t config::scene::storageImageBudget = 64u;
 
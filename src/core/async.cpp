@@ -1,31 +1,37 @@
 #include "pch.h"
 #include "util/util.h"
+#include "core/core.h"
+#include "core/managers/profiler.h"
 #include "core/async.h"
 
 void RAsync::loop() {
-  while (execute) {
-    std::unique_lock<std::mutex> lock(mutex);
-    conditional.wait(lock, [this]() { return cue || !execute; });
+  RE_PROFILE_SCOPE(name ? name : "Async update");
 
-    if (!execute) {
-      break;
+  while (true) {
+    for (const auto& function : boundFunctions) {
+      function->exec();
     }
 
-    cue = false;
+    std::lock_guard<std::mutex> lock(mutex);
 
-    for (const auto& function : boundFunctions) {
-      function->exec();
+    if (!cue || !execute) {
+      isRunning = false;
+      return;
     }
+
+    cue = false;
   }
 }
 
-void RAsync::start() {
+void RAsync::start(const char* threadName) {
   if (boundFunctions.empty()) {
     RE_LOG(Error, "Can't start async object, no function is bound.");
     return;
   }
 
-  thread = std::thread(&RAsync::loop, this);
+  std::lock_guard<std::mutex> lock(mutex);
+  name = threadName;
+  execute = true;
 }
 
 void RAsync::stop() {
@@ -33,15 +39,25 @@ void RAsync::stop() {
     std::lock_guard<std::mutex> lock(mutex);
     execute = false;
   }
-  conditional.notify_all();
 
-  if (thread.joinable()) {
-    thread.join();
-  }
+  core::jobs.wait(&counter);
 }
 
 void RAsync::update() {
-  std::unique_lock<std::mutex> lock(mutex);
-  cue = true;
-  conditional.notify_all();
-}
\ No newline at end of file
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!execute) {
+      return;
+    }
+
+    if (isRunning) {
+      cue = true;
+      return;
+    }
+
+    isRunning = true;
+  }
+
+  core::jobs.run([this]() { loop(); }, &counter);
+}
@@ -4,9 +4,12 @@
 #include "core/managers/renderer.h"
 #include "core/managers/debug.h"
 #include "core/managers/input.h"
+#include "core/managers/jobs.h"
 #include "core/managers/actors.h"
 #include "core/managers/animations.h"
+#include "core/managers/benchmark.h"
 #include "core/managers/player.h"
+#include "core/managers/profiler.h"
 #include "core/managers/script.h"
 #include "core/managers/ref.h"
 #include "core/managers/time.h"
@@ -18,9 +21,12 @@ class core::MWindow& core::window = MWindow::get();
 class core::MInput& core::input = MInput::get();
 class core::MScript& core::script = MScript::get();
 class core::MActors& core::actors = MActors::get();
+class core::MBenchmark& core::benchmark = MBenchmark::get();
 class core::MDebug& core::debug = MDebug::get();
+class core::MJobs& core::jobs = MJobs::get();
 class core::MResources& core::resources = MResources::get();
 class core::MPlayer& core::player = MPlayer::get();
+class core::MProfiler& core::profiler = MProfiler::get();
 class core::MRef& core::ref = MRef::get();
 class core::MTime& core::time = MTime::get();
 class core::MWorld& core::world = MWorld::get();
@@ -29,11 +35,15 @@ class core::MAnimations& core::animations = MAnimations::get();
 void core::run() {
 
   loadCoreConfig();
+  core::time.setSimulationRate(config::simulationRate);
 
 #ifndef NDEBUG
   loadDevelopmentConfig();
-  core::debug.compileDebugShaders();
-  core::debug.initializeRenderDoc();
+
+  if (!config::bHeadless) {
+    core::debug.compileDebugShaders();
+    core::debug.initializeRenderDoc();
+  }
 #endif
 
   RE_LOG(Log, "Creating renderer.");
@@ -166,6 +176,10 @@ void core::run() {
   core::renderer.renderView.generateEnvironmentMaps = true;
   // ---------------------------- */
 
+  if (core::benchmark.isLoaded()) {
+    core::benchmark.start();
+  }
+
   RE_LOG(Log, "Launching main event loop.");
 
   mainEventLoop();
@@ -174,9 +188,24 @@ void core::run() {
 }
 
 void core::mainEventLoop() {
+  // runs until a benchmark finishes or the process is terminated
+  if (config::bHeadless) {
+    while (!core::benchmark.isRunning() || core::benchmark.update()) {
+      core::drawFrame();
+    }
+
+    return;
+  }
+
   while (!glfwWindowShouldClose(core::window.getWindow())) {
     glfwPollEvents();
     core::input.scanInput();
+
+    // scripted camera overrides player input
+    if (core::benchmark.isRunning() && !core::benchmark.update()) {
+      break;
+    }
+
     core::drawFrame();
   }
 }
@@ -190,10 +219,13 @@ void core::stop(TResult cause) {
     RE_LOG(Log, "Exiting program normally.");
   }
   else {
-    RE_LOG(
-        Log,
-        "Shutting down due to error. Press any key to terminate the program.");
-    _getch();
+    RE_LOG(Log, "Shutting down due to error.");
+
+    // nobody may be there to press a key in headless mode
+    if (!config::bHeadless) {
+      RE_LOG(Log, "Press any key to terminate the program.");
+      _getch();
+    }
   }
   
   exit(cause);
@@ -204,6 +236,18 @@ TResult core::create() {
 
   TResult chkResult = 0;
 
+  core::jobs.initialize(config::jobWorkers);
+
+  if (config::bHeadless) {
+    chkResult = core::renderer.initializeHeadless();
+    RE_CHECK(chkResult);
+
+    core::resources.initialize();
+    core::world.initialize();
+
+    return chkResult;
+  }
+
   // initialize Vulkan API using GLFW
   glfwInit();
 
@@ -236,12 +280,24 @@ TResult core::create() {
 }
 
 void core::destroy() {
+  if (config::bHeadless) {
+    core::renderer.deinitializeHeadless();
+    core::jobs.deinitialize();
+    return;
+  }
+
   core::renderer.deinitialize();
+  core::jobs.deinitialize();
   core::window.destroyWindow();
   glfwTerminate();
 }
 
 void core::drawFrame() {
+  if (config::bHeadless) {
+    core::renderer.simulateFrame();
+    return;
+  }
+
   core::renderer.renderFrame();
 }
 
@@ -270,6 +326,10 @@ void core::loadCoreConfig(const wchar_t* path) {
       --requirements;
     }
 
+    if (coreData.contains("simulationRate")) {
+      coreData.at("simulationRate").get_to(config::simulationRate);
+    }
+
     --requirements;
   }
 
@@ -285,6 +345,10 @@ void core::loadCoreConfig(const wchar_t* path) {
     if (graphicsData.contains("FOV")) {
       graphicsData.at("FOV").get_to(config::FOV);
     }
+
+    if (graphicsData.contains("shadowDistance")) {
+      graphicsData.at("shadowDistance").get_to(config::shadowDistance);
+    }
   }
 
   RE_LOG(Log, "Parsing input bindings.");
@@ -0,0 +1,97 @@
+#include "pch.h"
+#include "core/framestatistics.h"
+
+RFrameStatistics::RFrameStatistics(const uint32_t windowSize) {
+  setWindowSize(windowSize);
+}
+
+void RFrameStatistics::addFrame(const float frameTime) {
+  if (m_samples.size() < m_windowSize) {
+    m_samples.emplace_back(frameTime);
+    m_frames.emplace_back(m_frameIndex++);
+    return;
+  }
+
+  m_samples[m_nextSample] = frameTime;
+  m_frames[m_nextSample] = m_frameIndex++;
+  m_nextSample = (m_nextSample + 1) % m_windowSize;
+}
+
+RFrameStatistics::RSummary RFrameStatistics::getSummary() const {
+  RSummary summary{};
+  summary.histogramBucketWidth = m_histogramBucketWidth;
+
+  if (m_samples.empty()) {
+    return summary;
+  }
+
+  std::vector<float> sortedSamples = m_samples;
+  std::sort(sortedSamples.begin(), sortedSamples.end());
+
+  const size_t sampleCount = sortedSamples.size();
+
+  // nearest rank, a percentile is always one of the measured frames
+  auto fGetPercentile = [&sortedSamples, sampleCount](const float percentile) {
+    const size_t rank = static_cast<size_t>(
+        std::ceil(percentile * 0.01f * static_cast<float>(sampleCount)));
+    return sortedSamples[std::clamp(rank, size_t(1), sampleCount) - 1];
+  };
+
+  summary.frameCount = static_cast<uint32_t>(sampleCount);
+  summary.minTime = sortedSamples.front();
+  summary.p50Time = fGetPercentile(50.0f);
+  summary.p95Time = fGetPercentile(95.0f);
+  summary.p99Time = fGetPercentile(99.0f);
+  summary.hitchTime = std::max(summary.p50Time * m_hitchFactor, m_minHitchTime);
+
+  double totalTime = 0.0;
+
+  for (size_t i = 0; i < sampleCount; ++i) {
+    const float sample = m_samples[i];
+    totalTime += sample;
+
+    // earliest of equally slow frames is reported
+    if (sample > summary.worstTime ||
+        (sample == summary.worstTime && m_frames[i] < summary.worstFrame)) {
+      summary.worstTime = sample;
+      summary.worstFrame = m_frames[i];
+    }
+
+    if (sample > summary.hitchTime) {
+      ++summary.hitchCount;
+    }
+
+    const uint32_t bucket = static_cast<uint32_t>(
+        std::min(sample / m_histogramBucketWidth,
+                 static_cast<float>(histogramBucketCount - 1)));
+    ++summary.histogram[bucket];
+  }
+
+  summary.averageTime = static_cast<float>(totalTime / sampleCount);
+
+  return summary;
+}
+
+void RFrameStatistics::reset() {
+  m_samples.clear();
+  m_frames.clear();
+  m_nextSample = 0u;
+  m_frameIndex = 0u;
+}
+
+void RFrameStatistics::setWindowSize(const uint32_t windowSize) {
+  m_windowSize = std::max(windowSize, 1u);
+  m_samples.reserve(m_windowSize);
+  m_frames.reserve(m_windowSize);
+  reset();
+}
+
+void RFrameStatistics::setHitchThreshold(const float factor,
+                                         const float minimumTime) {
+  m_hitchFactor = factor;
+  m_minHitchTime = minimumTime;
+}
+
+void RFrameStatistics::setHistogramBucketWidth(const float width) {
+  m_histogramBucketWidth = std::max(width, 0.001f);
+}
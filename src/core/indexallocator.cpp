@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "core/indexallocator.h"
+
+RIndexAllocator::RIndexAllocator(const uint32_t capacity) { reset(capacity); }
+
+void RIndexAllocator::reset(const uint32_t capacity) {
+  m_capacity = capacity;
+  m_usedBits.assign((capacity + 63u) / 64u, 0u);
+  m_freeIndices.resize(capacity);
+
+  // lowest indices are allocated first, same as a linear search would do
+  for (uint32_t i = 0; i < capacity; ++i) {
+    m_freeIndices[i] = capacity - 1u - i;
+  }
+}
+
+uint32_t RIndexAllocator::allocate() {
+  if (m_freeIndices.empty()) {
+    return invalidIndex;
+  }
+
+  const uint32_t index = m_freeIndices.back();
+  m_freeIndices.pop_back();
+  m_usedBits[index / 64u] |= 1ull << (index % 64u);
+
+  return index;
+}
+
+bool RIndexAllocator::release(const uint32_t index) {
+  if (!isAllocated(index)) {
+    return false;
+  }
+
+  m_usedBits[index / 64u] &= ~(1ull << (index % 64u));
+  m_freeIndices.emplace_back(index);
+
+  return true;
+}
+
+bool RIndexAllocator::isAllocated(const uint32_t index) const {
+  if (index >= m_capacity) {
+    return false;
+  }
+
+  return (m_usedBits[index / 64u] >> (index % 64u)) & 1ull;
+}
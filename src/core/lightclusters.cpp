@@ -0,0 +1,247 @@
+#include "pch.h"
+#include "core/objects.h"
+#include "core/lightclusters.h"
+#include <bit>
+
+RLightClusters::RLightClusters() {
+  m_clusters.resize(clusterCount);
+
+  for (RSlice& slice : m_slices) {
+    slice.counts.assign(gridX * gridY, 0u);
+    slice.indices.resize(gridX * gridY * maxClusterLights);
+  }
+}
+
+void RLightClusters::prepare(const glm::mat4& view, const glm::mat4& projection,
+                             const float nearPlane, const float farPlane,
+                             const RPointLight* pLights, const uint32_t lightCount) {
+  m_view = view;
+  m_projection = projection;
+  m_near = std::max(nearPlane, 1e-4f);
+  m_far = std::max(farPlane, m_near * 1.001f);
+
+  for (uint32_t i = 0; i <= gridZ; ++i) {
+    m_sliceDepths[i] = m_near * powf(m_far / m_near, static_cast<float>(i) / gridZ);
+  }
+
+  for (RSlice& slice : m_slices) {
+    slice.lights.clear();
+    std::fill(slice.counts.begin(), slice.counts.end(), 0u);
+    slice.cappedCount = 0u;
+  }
+
+  m_viewLights.resize(lightCount);
+
+  const glm::vec2 sliceScaleAndBias = getSliceScaleAndBias();
+  const int32_t lastSlice = static_cast<int32_t>(gridZ) - 1;
+
+  for (uint32_t i = 0; i < lightCount; ++i) {
+    const float radius = pLights[i].location.w;
+    const glm::vec4 position = view * glm::vec4(glm::vec3(pLights[i].location), 1.0f);
+
+    m_viewLights[i] = glm::vec4(glm::vec3(position), radius * radius);
+
+    if (radius <= 0.0f || position.z + radius < m_near || position.z - radius > m_far) {
+      continue;
+    }
+
+    // depth range of the sphere mapped to slices, view space z is depth
+    const float minDepth = std::max(position.z - radius, m_near);
+    const float maxDepth = std::min(position.z + radius, m_far);
+
+    const int32_t firstSlice = std::clamp(static_cast<int32_t>(
+      logf(minDepth) * sliceScaleAndBias.x + sliceScaleAndBias.y), 0, lastSlice);
+    const int32_t endSlice = std::clamp(static_cast<int32_t>(
+      logf(maxDepth) * sliceScaleAndBias.x + sliceScaleAndBias.y), 0, lastSlice);
+
+    for (int32_t slice = firstSlice; slice <= endSlice; ++slice) {
+      m_slices[slice].lights.emplace_back(i);
+    }
+  }
+}
+
+void RLightClusters::buildSlice(const uint32_t sliceIndex) {
+  RSlice& slice = m_slices[sliceIndex];
+  const uint32_t candidateCount = static_cast<uint32_t>(slice.lights.size());
+
+  if (candidateCount == 0u) {
+    return;
+  }
+
+  // structure of arrays of candidates, padding never passes the test
+  const uint32_t paddedCount = (candidateCount + 7u) & ~7u;
+  slice.x.assign(paddedCount, 0.0f);
+  slice.y.assign(paddedCount, 0.0f);
+  slice.z.assign(paddedCount, 0.0f);
+  slice.radius2.assign(paddedCount, -1.0f);
+
+  for (uint32_t i = 0; i < candidateCount; ++i) {
+    const glm::vec4& light = m_viewLights[slice.lights[i]];
+    slice.x[i] = light.x;
+    slice.y[i] = light.y;
+    slice.z[i] = light.z;
+    slice.radius2[i] = light.w;
+  }
+
+  // view space x of clip space x at a depth, same for y, the projection
+  // has no skew so columns and rows are bounded independently
+  const float depths[2] = {m_sliceDepths[sliceIndex], m_sliceDepths[sliceIndex + 1]};
+  std::array<float, gridX * 2>& columnBounds = slice.columnBounds;
+  std::array<float, gridY * 2>& rowBounds = slice.rowBounds;
+
+  auto getBounds = [&](const float clipMin, const float clipMax, const int32_t axis,
+                       float& outMin, float& outMax) {
+    outMin = std::numeric_limits<float>::max();
+    outMax = -std::numeric_limits<float>::max();
+
+    for (const float depth : depths) {
+      const float w = m_projection[2][3] * depth + m_projection[3][3];
+      const float offset = m_projection[2][axis] * depth + m_projection[3][axis];
+
+      for (const float clip : {clipMin, clipMax}) {
+        const float value = (clip * w - offset) / m_projection[axis][axis];
+        outMin = std::min(outMin, value);
+        outMax = std::max(outMax, value);
+      }
+    }
+  };
+
+  for (uint32_t x = 0; x < gridX; ++x) {
+    getBounds(2.0f * x / gridX - 1.0f, 2.0f * (x + 1u) / gridX - 1.0f, 0,
+              columnBounds[x * 2], columnBounds[x * 2 + 1]);
+  }
+
+  for (uint32_t y = 0; y < gridY; ++y) {
+    getBounds(2.0f * y / gridY - 1.0f, 2.0f * (y + 1u) / gridY - 1.0f, 1,
+              rowBounds[y * 2], rowBounds[y * 2 + 1]);
+  }
+
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 minZ = _mm256_set1_ps(depths[0]);
+  const __m256 maxZ = _mm256_set1_ps(depths[1]);
+
+  // distance from the slice along z only depends on the light
+  for (uint32_t i = 0; i < paddedCount; i += 8u) {
+    const __m256 z = _mm256_loadu_ps(&slice.z[i]);
+    const __m256 dz = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minZ, z),
+                                                  _mm256_sub_ps(z, maxZ)), zero);
+    _mm256_storeu_ps(&slice.z[i], _mm256_mul_ps(dz, dz));
+  }
+
+  for (uint32_t y = 0; y < gridY; ++y) {
+    const __m256 minY = _mm256_set1_ps(rowBounds[y * 2]);
+    const __m256 maxY = _mm256_set1_ps(rowBounds[y * 2 + 1]);
+
+    for (uint32_t x = 0; x < gridX; ++x) {
+      const __m256 minX = _mm256_set1_ps(columnBounds[x * 2]);
+      const __m256 maxX = _mm256_set1_ps(columnBounds[x * 2 + 1]);
+
+      const uint32_t clusterIndex = y * gridX + x;
+      uint32_t* pIndices = &slice.indices[clusterIndex * maxClusterLights];
+      uint32_t count = 0u;
+      slice.overflow.clear();
+
+      for (uint32_t i = 0; i < paddedCount; i += 8u) {
+        const __m256 lightX = _mm256_loadu_ps(&slice.x[i]);
+        const __m256 lightY = _mm256_loadu_ps(&slice.y[i]);
+
+        const __m256 dx = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minX, lightX),
+                                                      _mm256_sub_ps(lightX, maxX)), zero);
+        const __m256 dy = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minY, lightY),
+                                                      _mm256_sub_ps(lightY, maxY)), zero);
+        const __m256 distance2 = _mm256_add_ps(_mm256_loadu_ps(&slice.z[i]),
+          _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(
+          _mm256_cmp_ps(distance2, _mm256_loadu_ps(&slice.radius2[i]), _CMP_LE_OQ)));
+
+        while (mask) {
+          const uint32_t lightIndex = slice.lights[i + std::countr_zero(mask)];
+          mask &= mask - 1u;
+
+          if (count < maxClusterLights) {
+            pIndices[count++] = lightIndex;
+          } else {
+            slice.overflow.emplace_back(lightIndex);
+          }
+        }
+      }
+
+      // too many lights overlap the cluster, the nearest ones are shaded
+      if (!slice.overflow.empty()) {
+        slice.overflow.insert(slice.overflow.end(), pIndices, pIndices + count);
+        keepNearestLights(getClusterCenter(sliceIndex, clusterIndex), slice.overflow.data(),
+                          static_cast<uint32_t>(slice.overflow.size()), maxClusterLights);
+        std::copy_n(slice.overflow.begin(), maxClusterLights, pIndices);
+        ++slice.cappedCount;
+      }
+
+      slice.counts[clusterIndex] = count;
+    }
+  }
+}
+
+uint32_t RLightClusters::finalize(const uint32_t indexCapacity) {
+  m_indices.clear();
+  m_cappedClusterCount = 0u;
+  m_truncatedClusterCount = 0u;
+
+  for (uint32_t z = 0; z < gridZ; ++z) {
+    RSlice& slice = m_slices[z];
+    m_cappedClusterCount += slice.cappedCount;
+
+    for (uint32_t i = 0; i < gridX * gridY; ++i) {
+      RLightCluster& cluster = m_clusters[z * gridX * gridY + i];
+      uint32_t* pIndices = &slice.indices[i * maxClusterLights];
+      uint32_t count = slice.counts[i];
+
+      const uint32_t capacity = indexCapacity - static_cast<uint32_t>(m_indices.size());
+
+      if (count > capacity) {
+        keepNearestLights(getClusterCenter(z, i), pIndices, count, capacity);
+        count = capacity;
+        ++m_truncatedClusterCount;
+      }
+
+      cluster.firstLight = static_cast<uint32_t>(m_indices.size());
+      cluster.lightCount = count;
+      m_indices.insert(m_indices.end(), pIndices, pIndices + count);
+    }
+  }
+
+  return static_cast<uint32_t>(m_indices.size());
+}
+
+glm::vec3 RLightClusters::getClusterCenter(const uint32_t sliceIndex,
+                                           const uint32_t clusterIndex) const {
+  const RSlice& slice = m_slices[sliceIndex];
+  const uint32_t x = clusterIndex % gridX;
+  const uint32_t y = clusterIndex / gridX;
+
+  return {(slice.columnBounds[x * 2] + slice.columnBounds[x * 2 + 1]) * 0.5f,
+          (slice.rowBounds[y * 2] + slice.rowBounds[y * 2 + 1]) * 0.5f,
+          (m_sliceDepths[sliceIndex] + m_sliceDepths[sliceIndex + 1]) * 0.5f};
+}
+
+void RLightClusters::keepNearestLights(const glm::vec3& center, uint32_t* pLights,
+                                       const uint32_t lightCount,
+                                       const uint32_t keepCount) const {
+  if (keepCount == 0u || keepCount >= lightCount) {
+    return;
+  }
+
+  auto fDistance2 = [this, &center](const uint32_t lightIndex) {
+    const glm::vec3 offset = glm::vec3(m_viewLights[lightIndex]) - center;
+    return glm::dot(offset, offset);
+  };
+
+  std::nth_element(pLights, pLights + keepCount - 1u, pLights + lightCount,
+                   [&fDistance2](const uint32_t first, const uint32_t second) {
+                     return fDistance2(first) < fDistance2(second);
+                   });
+}
+
+glm::vec2 RLightClusters::getSliceScaleAndBias() const {
+  const float scale = static_cast<float>(gridZ) / logf(m_far / m_near);
+  return {scale, -logf(m_near) * scale};
+}
@@ -11,7 +11,8 @@ core::MActors::MActors() {
   RE_LOG(Log, "Creating actors manager.");
 }
 
-void core::MActors::updateLightingUBO(RLightingUBO* pLightingBuffer) {
+void core::MActors::updateLightingUBO(RLightingUBO* pLightingBuffer,
+                                      std::vector<RPointLight>& outPointLights) {
   if (!pLightingBuffer) {
     RE_LOG(Error,
            "Couldn't update lighting uniform buffer object data. No buffer was "
@@ -19,9 +20,6 @@ void core::MActors::updateLightingUBO(RLightingUBO* pLightingBuffer) {
     return;
   }
 
-  uint32_t lightCount = 1;
-  float lightType = 1.0f;
-
   // Index 0 is expected to be the directional 'sun' light
   if (m_pSunLight) {
     pLightingBuffer->lightLocations[0] = glm::vec4(m_pSunLight->getLocation(), 1.0f);
@@ -31,19 +29,17 @@ void core::MActors::updateLightingUBO(RLightingUBO* pLightingBuffer) {
   }
 
   // Currently all other lights are expected to be point lights
+  outPointLights.clear();
+
   for (const auto& pLight : m_linearActors.pLights) {
     if (pLight->isVisible() && pLight != m_pSunLight) {
-      pLightingBuffer->lightLocations[lightCount] = glm::vec4(pLight->getLocation(), 1.0f);
-      pLightingBuffer->lightColors[lightCount] = glm::vec4(pLight->getLightColor(), pLight->getLightIntensity());
-
-      ++lightCount;
+      RPointLight& pointLight = outPointLights.emplace_back();
+      pointLight.location = glm::vec4(pLight->getLocation(), pLight->getLightRadius());
+      pointLight.color = glm::vec4(pLight->getLightColor(), pLight->getLightIntensity());
     }
-
-    // stop if max visible lights limit was reached
-    if (lightCount == RE_MAXLIGHTS) break;
   }
 
-  pLightingBuffer->lightCount = lightCount;
+  pLightingBuffer->lightCount = 1;
 }
 
 ACamera* core::MActors::createCamera(const char* name,
@@ -134,6 +130,7 @@ ALight* core::MActors::createLight(const char* name, RLightInfo* pInfo) {
     pNewLight->setLightType(pInfo->type);
     pNewLight->setLightColor(pInfo->color);
     pNewLight->setLightIntensity(pInfo->intensity);
+    pNewLight->setLightRadius(pInfo->radius);
     pNewLight->setLocation(pInfo->translation);
     pNewLight->setRotation(pInfo->direction);
 
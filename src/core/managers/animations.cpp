@@ -8,6 +8,15 @@
 #include "core/managers/time.h"
 #include "core/managers/animations.h"
 
+namespace {
+// current joint matrices, previous ones follow after RE_MAXJOINTS matrices
+int8_t* getSkinMemoryAddress(const AEntity::AnimatedSkinBinding& skinBinding) {
+  return static_cast<int8_t*>(core::renderer.getSceneBuffers()
+                                  ->skinTransformBuffer.allocInfo.pMappedData) +
+         skinBinding.skinTransformBufferOffset;
+}
+}  // namespace
+
 core::MAnimations::MAnimations() {
   m_rootTransformBufferIndices.resize(config::scene::entityBudget);
   m_nodeTransformBufferIndices.resize(config::scene::nodeBudget);
@@ -93,68 +102,279 @@ int32_t core::MAnimations::addAnimationToQueue(const WAnimationInfo* pAnimationI
   entry.queueIndex =
       (pExistingEntry) ? pExistingEntry->queueIndex : m_availableQueueIndex;
 
+  // resolve entity bindings once instead of every frame
+  const auto& animatedNodes = pAnimation->getAnimatedNodes();
+  entry.nodeBindingSlots.reserve(animatedNodes.size());
+
+  for (const auto& node : animatedNodes) {
+    entry.nodeBindingSlots.emplace_back(entry.pEntity->getAnimatedNodeSlot(node.index));
+  }
+
+  const int32_t queueIndex = entry.queueIndex;
+
   if (!pExistingEntry) {
-    m_animationQueue.emplace_back(entry);
+    m_animationQueue.emplace_back(std::move(entry));
     ++m_availableQueueIndex;
   } else {
     entry.time = pExistingEntry->time;
-    memcpy(pExistingEntry, &entry, sizeof(entry));
+    *pExistingEntry = std::move(entry);
+  }
+
+  return queueIndex;
+}
+
+float core::MAnimations::getSampleTime(const QueueEntry& queueEntry,
+                                      const float timeOffset) {
+  const float offset = timeOffset * queueEntry.speed;
+  float time = queueEntry.time + ((queueEntry.isReversed) ? -offset : offset);
+
+  if (time >= queueEntry.startTime && time <= queueEntry.endTime) {
+    return time;
+  }
+
+  // offset crossed the range boundary during the last tick, undo the wrap
+  if (queueEntry.loop) {
+    if (queueEntry.bounce) {
+      time = (time < queueEntry.startTime) ? 2.0f * queueEntry.startTime - time
+                                           : 2.0f * queueEntry.endTime - time;
+    } else {
+      time += (time < queueEntry.startTime) ? queueEntry.duration
+                                            : -queueEntry.duration;
+    }
+  }
+
+  return std::clamp(time, queueEntry.startTime, queueEntry.endTime);
+}
+
+void core::MAnimations::advanceAnimationQueue(const float deltaTime) {
+  m_poseSharing.clock += deltaTime;
+
+  for (auto& queueEntry : m_animationQueue) {
+    // finished entry is waiting for cleanup
+    if (std::find(m_cleanupQueue.begin(), m_cleanupQueue.end(),
+                  queueEntry.queueIndex) != m_cleanupQueue.end()) {
+      continue;
+    }
+
+    const float timeStep = deltaTime * queueEntry.speed;
+    queueEntry.time += (queueEntry.isReversed) ? -timeStep : timeStep;
+
+    if ((!queueEntry.isReversed && queueEntry.time > queueEntry.endTime) ||
+        (queueEntry.isReversed && queueEntry.time < queueEntry.startTime)) {
+      switch (queueEntry.loop) {
+        case true: {
+          switch (queueEntry.bounce) {
+            case true: {
+              queueEntry.isReversed = !queueEntry.isReversed;
+              break;
+            }
+            case false: {
+              queueEntry.time -= (queueEntry.isReversed) ? -queueEntry.duration
+                                                         : queueEntry.duration;
+              break;
+            }
+          }
+
+          break;
+        }
+        case false: {
+          m_cleanupQueue.emplace_back(queueEntry.queueIndex);
+          break;
+        }
+      }
+    }
+  }
+}
+
+bool core::MAnimations::sampleSkin(const std::vector<WAnimation::KeyFrame>& keyFrames,
+                                   const int32_t skinIndex, const float time,
+                                   std::vector<glm::mat4>& outJointMatrices) {
+  for (size_t keyFrame = 0; keyFrame + 1 < keyFrames.size(); ++keyFrame) {
+    if ((time >= keyFrames[keyFrame].timeStamp) &&
+        (time <= keyFrames[keyFrame + 1].timeStamp)) {
+      // get interpolation coefficient based on time between frames
+      const float u =
+          std::max(0.0f, time - keyFrames[keyFrame].timeStamp) /
+          (keyFrames[keyFrame + 1].timeStamp - keyFrames[keyFrame].timeStamp);
+
+      const auto& jointMatrices = keyFrames[keyFrame].skinMatrices[skinIndex];
+      const auto& nextJointMatrices = keyFrames[keyFrame + 1].skinMatrices[skinIndex];
+      const size_t jointCount = std::min(jointMatrices.size(), outJointMatrices.size());
+
+      for (size_t jointIndex = 0; jointIndex < jointCount; ++jointIndex) {
+        math::interpolate(jointMatrices[jointIndex], nextJointMatrices[jointIndex], u,
+                          outJointMatrices[jointIndex]);
+      }
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+float core::MAnimations::getSharedSampleTime(QueueEntry& queueEntry,
+                                             const float sampleTime) {
+  const uint32_t phaseBuckets = m_poseSharing.phaseBuckets;
+
+  // only forward looping clips repeat with the clock
+  if (phaseBuckets == 0u || !queueEntry.loop || queueEntry.bounce ||
+      queueEntry.isReversed || queueEntry.duration <= 0.0f) {
+    return sampleTime;
+  }
+
+  const double duration = queueEntry.duration;
+  const double clockTime = std::fmod(m_poseSharing.clock * queueEntry.speed, duration);
+
+  // phase is snapped once, so the entity doesn't jump between buckets
+  if (queueEntry.sharedPhaseBuckets != phaseBuckets) {
+    const double bucketLength = duration / phaseBuckets;
+    double phase = std::fmod(sampleTime - queueEntry.startTime - clockTime, duration);
+    phase += (phase < 0.0) ? duration : 0.0;
+
+    queueEntry.sharedPhase = static_cast<float>(
+        std::fmod(std::round(phase / bucketLength) * bucketLength, duration));
+    queueEntry.sharedPhaseBuckets = phaseBuckets;
+  }
+
+  return queueEntry.startTime +
+         static_cast<float>(std::fmod(clockTime + queueEntry.sharedPhase, duration));
+}
+
+const AEntity::AnimatedSkinBinding* core::MAnimations::getSharedSkin(
+    const QueueEntry& queueEntry, const int32_t skinIndex, const float sampleTime,
+    const AEntity::AnimatedSkinBinding* pShownSkin) {
+  const float quantization = m_poseSharing.quantization;
+  const float duration = queueEntry.pAnimation->m_duration;
+  const float time = std::clamp(std::round(sampleTime / quantization) * quantization,
+                                0.0f, duration);
+
+  SharedPoseKey key{queueEntry.pAnimation, skinIndex, time};
+  auto& pPose = m_poseSharing.poses[key];
+
+  if (!pPose) {
+    pPose = std::make_unique<SharedPose>();
+    AEntity::AnimatedSkinBinding& skinBinding = pPose->skinBinding;
+
+    if (!getOrRegisterSkinOffsetIndex(&skinBinding, skinBinding.skinTransformBufferIndex)) {
+      m_poseSharing.poses.erase(key);
+      return nullptr;
+    }
+
+    const auto& keyFrames = queueEntry.pAnimation->getKeyFrames();
+
+    skinBinding.skinIndex = skinIndex;
+    skinBinding.skinTransformBufferOffset =
+        skinBinding.skinTransformBufferIndex * config::scene::skinBlockSize;
+    skinBinding.transformBufferBlock.jointMatrices.resize(
+        keyFrames[0].skinMatrices[skinIndex].size(), glm::mat4(1.0f));
+
+    sampleSkin(keyFrames, skinIndex, time, skinBinding.transformBufferBlock.jointMatrices);
+
+    // pose never changes, so its current half is uploaded only once
+    memcpy(getSkinMemoryAddress(skinBinding),
+           skinBinding.transformBufferBlock.jointMatrices.data(),
+           sizeof(glm::mat4) * skinBinding.transformBufferBlock.jointMatrices.size());
   }
 
-  return entry.queueIndex;
+  if (pPose->lastUsedFrame != m_poseSharing.frame) {
+    pPose->lastUsedFrame = m_poseSharing.frame;
+    ++m_poseSharing.usedPoseCount;
+
+    // an unchanged pose gets no motion, entities usually share the pose they
+    // have shown with the others that share the current one
+    const std::vector<glm::mat4>& shownJointMatrices =
+        pShownSkin->transformBufferBlock.jointMatrices;
+    const size_t jointCount = std::min(
+        shownJointMatrices.size(), pPose->skinBinding.transformBufferBlock.jointMatrices.size());
+
+    memcpy(getSkinMemoryAddress(pPose->skinBinding) + sizeof(glm::mat4) * RE_MAXJOINTS,
+           shownJointMatrices.data(), sizeof(glm::mat4) * jointCount);
+  }
+
+  return &pPose->skinBinding;
+}
+
+void core::MAnimations::releaseUnusedPoses() {
+  for (auto it = m_poseSharing.poses.begin(); it != m_poseSharing.poses.end();) {
+    // frames in flight may still read the palette
+    if (m_poseSharing.frame - it->second->lastUsedFrame <= MAX_FRAMES_IN_FLIGHT) {
+      ++it;
+      continue;
+    }
+
+    m_skinTransformBufferIndices[it->second->skinBinding.skinTransformBufferIndex] = nullptr;
+    it = m_poseSharing.poses.erase(it);
+  }
 }
 
-void core::MAnimations::runAnimationQueue() {
+void core::MAnimations::runAnimationQueue(const float timeOffset) {
   cleanupQueue();
+
+  const bool isSharingPoses = m_poseSharing.isEnabled;
+  ++m_poseSharing.frame;
+  m_poseSharing.usedPoseCount = 0u;
   
   for (auto& queueEntry : m_animationQueue) {
     // Get a list of all nodes affected by the animation
     const auto& animatedNodes = queueEntry.pAnimation->getAnimatedNodes();
     const auto& keyFrames = queueEntry.pAnimation->getKeyFrames();
+    const float sampleTime = getSampleTime(queueEntry, timeOffset);
+
+    if (keyFrames.empty()) {
+      m_cleanupQueue.emplace_back(queueEntry.queueIndex);
+      continue;
+    }
+
+    // palettes can only be shared by entities drawn through instance data
+    const bool isSharingEntry = isSharingPoses && queueEntry.pEntity->m_instanceIndex != -1;
+    const float sharedSampleTime =
+        (isSharingEntry) ? getSharedSampleTime(queueEntry, sampleTime) : sampleTime;
 
     // Update skins, each skinMatrices vector's index per frame corresponds to skin's index
     for (int32_t skinIndex = 0; skinIndex < keyFrames[0].skinMatrices.size(); ++skinIndex) {
-      for (size_t keyFrame = 0; keyFrame < keyFrames.size() - 1; ++keyFrame) {
-        if ((queueEntry.time >= keyFrames[keyFrame].timeStamp) &&
-          (queueEntry.time <= keyFrames[keyFrame + 1].timeStamp)) {
-          // get interpolation coefficient based on time between frames
-          float u =
-            std::max(0.0f, queueEntry.time - keyFrames[keyFrame].timeStamp) /
-            (keyFrames[keyFrame + 1].timeStamp - keyFrames[keyFrame].timeStamp);
+      AEntity::AnimatedSkinBinding* pSkinBinding =
+          queueEntry.pEntity->getAnimatedSkinBinding(skinIndex);
 
-          if (u <= 1.0f) {
-            const size_t jointCount =
-              keyFrames.at(keyFrame).skinMatrices.at(skinIndex).size();
-
-            for (size_t jointIndex = 0; jointIndex < jointCount; ++jointIndex) {
-              math::interpolate(
-                keyFrames[keyFrame].skinMatrices[skinIndex][jointIndex],
-                keyFrames[keyFrame + 1].skinMatrices[skinIndex][jointIndex], u,
-                queueEntry.pEntity->getAnimatedSkinBinding(skinIndex)->transformBufferBlock.jointMatrices[jointIndex]);
-            }
-          }
+      if (!pSkinBinding) {
+        continue;
+      }
 
-          // frame update finished, exit loop
-          break;
+      if (isSharingEntry) {
+        const AEntity::AnimatedSkinBinding* pShownSkin =
+            (pSkinBinding->pSharedSkin) ? pSkinBinding->pSharedSkin : pSkinBinding;
+
+        if (const AEntity::AnimatedSkinBinding* pSharedSkin =
+                getSharedSkin(queueEntry, skinIndex, sharedSampleTime, pShownSkin)) {
+          queueEntry.pEntity->setSharedSkin(skinIndex, pSharedSkin);
+          continue;
         }
       }
+
+      queueEntry.pEntity->setSharedSkin(skinIndex, nullptr);
+      sampleSkin(keyFrames, skinIndex, sampleTime,
+                 pSkinBinding->transformBufferBlock.jointMatrices);
     }
 
-    for (const auto& node : animatedNodes) {
-      AEntity::AnimatedNodeBinding* pNodeBinding = queueEntry.pEntity->getAnimatedNodeBinding(node.index);
+    for (size_t nodeIndex = 0; nodeIndex < animatedNodes.size(); ++nodeIndex) {
+      const auto& node = animatedNodes[nodeIndex];
+      AEntity::AnimatedNodeBinding* pNodeBinding =
+          (nodeIndex < queueEntry.nodeBindingSlots.size())
+              ? queueEntry.pEntity->getAnimatedNodeBindingAt(queueEntry.nodeBindingSlots[nodeIndex])
+              : nullptr;
 
-      if (keyFrames.empty() || !pNodeBinding) {
+      if (!pNodeBinding) {
         m_cleanupQueue.emplace_back(queueEntry.queueIndex);
         break;
       }
 
       // write interpolated frame data directly to node's mesh uniform block
       for (size_t i = 0; i < keyFrames.size() - 1; ++i) {
-        if ((queueEntry.time >= keyFrames[i].timeStamp) &&
-            (queueEntry.time <= keyFrames[i + 1].timeStamp)) {
+        if ((sampleTime >= keyFrames[i].timeStamp) &&
+            (sampleTime <= keyFrames[i + 1].timeStamp)) {
           // get interpolation coefficient based on time between frames
           float u =
-              std::max(0.0f, queueEntry.time - keyFrames[i].timeStamp) /
+              std::max(0.0f, sampleTime - keyFrames[i].timeStamp) /
               (keyFrames[i + 1].timeStamp - keyFrames[i].timeStamp);
 
           if (u <= 1.0f) {
@@ -170,43 +390,53 @@ void core::MAnimations::runAnimationQueue() {
 
       pNodeBinding->requiresTransformBufferBlockUpdate = true;
     }
+  }
 
-    const float timeStep = core::time.getDeltaTime() * queueEntry.speed;
-    queueEntry.time += (queueEntry.isReversed) ? -timeStep : timeStep;
+  if (!m_poseSharing.poses.empty()) {
+    releaseUnusedPoses();
+  }
+}
 
-    if ((!queueEntry.isReversed && queueEntry.time > queueEntry.endTime) ||
-        (queueEntry.isReversed && queueEntry.time < queueEntry.startTime)) {
-      switch (queueEntry.loop) {
-        case true: {
-          switch (queueEntry.bounce) {
-            case true: {
-              queueEntry.isReversed = !queueEntry.isReversed;
-              break;
-            }
-            case false: {
-              queueEntry.time -= (queueEntry.isReversed) ? -queueEntry.duration
-                                                         : queueEntry.duration;
-              break;
-            }
-          }
+void core::MAnimations::cleanupQueue() {
+  // cleanup queue stores queue indices, not positions in the animation queue
+  for (int32_t queueIndex : m_cleanupQueue) {
+    auto it = std::find_if(m_animationQueue.begin(), m_animationQueue.end(),
+                           [queueIndex](const QueueEntry& queueEntry) {
+                             return queueEntry.queueIndex == queueIndex;
+                           });
+
+    // entry may have been queued for removal more than once
+    if (it == m_animationQueue.end()) {
+      continue;
+    }
 
-          break;
-        }
-        case false: {
-          m_cleanupQueue.emplace_back(queueEntry.queueIndex);
-          break;
-        }
-      }
+    // removed entity continues from the shared pose with its own palette
+    AEntity* pEntity = it->pEntity;
+
+    for (int32_t skinIndex = 0;
+         static_cast<size_t>(skinIndex) < pEntity->m_animatedSkins.size(); ++skinIndex) {
+      pEntity->setSharedSkin(skinIndex, nullptr);
     }
+
+    m_animationQueue.erase(it);
   }
+
+  m_cleanupQueue.clear();
 }
 
-void core::MAnimations::cleanupQueue() {
-  for (int32_t entry : m_cleanupQueue) {
-    m_animationQueue.erase(m_animationQueue.begin() + entry);
+void core::MAnimations::setPoseSharing(const bool enable, const float quantization,
+                                       const uint32_t phaseBuckets) {
+  if (quantization <= 0.0f) {
+    RE_LOG(Error, "Failed to set pose sharing, quantization must be above 0.");
+    return;
   }
 
-  m_cleanupQueue.clear();
+  m_poseSharing.quantization = quantization;
+  m_poseSharing.phaseBuckets = phaseBuckets;
+  m_poseSharing.isEnabled = enable;
+
+  RE_LOG(Log, "Pose sharing is %s (%.4f s quantization, %d phase buckets).",
+         (enable) ? "enabled" : "disabled", quantization, phaseBuckets);
 }
 
 bool core::MAnimations::getOrRegisterActorOffsetIndex(AEntity* pActor,
@@ -263,6 +493,11 @@ bool core::MAnimations::getOrRegisterSkinOffsetIndex(AEntity::AnimatedSkinBindin
     }
   }
 
+  if (freeIndex == -1) {
+    outIndex = -1;
+    return false;  // skin transform buffer is full
+  }
+
   m_skinTransformBufferIndices[freeIndex] = pSkin;
   outIndex = freeIndex;
 
@@ -0,0 +1,266 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/managers/actors.h"
+#include "core/managers/benchmark.h"
+#include "core/managers/jobs.h"
+#include "core/managers/profiler.h"
+#include "core/managers/renderer.h"
+#include "core/managers/script.h"
+#include "core/managers/time.h"
+#include "core/world/actors/camera.h"
+#include "util/util.h"
+
+core::MBenchmark::MBenchmark() { RE_LOG(Log, "Created benchmark manager."); }
+
+TResult core::MBenchmark::loadScript(const wchar_t* path,
+                                     const char* reportPath) {
+  using json = nlohmann::json;
+
+  m_isLoaded = false;
+  m_script = {};
+
+  json* data = core::script.jsonLoad(path, "cfgBenchmark");
+
+  if (!data) {
+    RE_LOG(Error, "Failed to load benchmark script.");
+    return RE_ERROR;
+  }
+
+  if (data->contains("name")) {
+    data->at("name").get_to(m_script.name);
+  }
+
+  if (data->contains("timestep")) {
+    data->at("timestep").get_to(m_script.timestep);
+  }
+
+  if (data->contains("warmupFrames")) {
+    data->at("warmupFrames").get_to(m_script.warmupFrames);
+  }
+
+  if (data->contains("trace")) {
+    data->at("trace").get_to(m_script.tracePath);
+  }
+
+  if (data->contains("camera")) {
+    const auto& cameraData = data->at("camera");
+
+    if (cameraData.contains("name")) {
+      cameraData.at("name").get_to(m_script.cameraName);
+    }
+
+    if (cameraData.contains("path")) {
+      for (const auto& it : cameraData.at("path")) {
+        RCameraKey& key = m_script.cameraPath.emplace_back();
+        float translation[3] = {0.0f, 0.0f, 0.0f};
+        float rotation[3] = {0.0f, 0.0f, 0.0f};
+
+        it.at("time").get_to(key.time);
+
+        if (it.contains("translation")) {
+          it.at("translation").get_to(translation);
+        }
+
+        if (it.contains("rotation")) {
+          it.at("rotation").get_to(rotation);
+        }
+
+        key.translation = {translation[0], translation[1], translation[2]};
+        key.rotation = {rotation[0], rotation[1], rotation[2]};
+      }
+    }
+  }
+
+  std::stable_sort(m_script.cameraPath.begin(), m_script.cameraPath.end(),
+                   [](const RCameraKey& a, const RCameraKey& b) {
+                     return a.time < b.time;
+                   });
+
+  if (m_script.timestep <= 0.0f) {
+    RE_LOG(Error, "Benchmark '%s' has invalid timestep.", m_script.name.c_str());
+    return RE_ERROR;
+  }
+
+  // duration defaults to the camera path
+  float duration = m_script.cameraPath.empty() ? 0.0f : m_script.cameraPath.back().time;
+
+  if (data->contains("duration")) {
+    data->at("duration").get_to(duration);
+  }
+
+  m_script.frameCount = static_cast<uint32_t>(std::ceil(duration / m_script.timestep));
+
+  if (m_script.frameCount == 0u) {
+    RE_LOG(Error, "Benchmark '%s' has no frames to run.", m_script.name.c_str());
+    return RE_ERROR;
+  }
+
+  m_reportPath = reportPath ? reportPath : m_script.name + "_report.json";
+  m_isLoaded = true;
+
+  RE_LOG(Log, "Loaded benchmark '%s', %d frames at %.2f ms.", m_script.name.c_str(),
+         m_script.frameCount, m_script.timestep * 1000.0f);
+
+  return RE_OK;
+}
+
+void core::MBenchmark::updateCamera(const float time) {
+  ACamera* pCamera = core::actors.getCamera(m_script.cameraName.c_str());
+
+  if (!pCamera || m_script.cameraPath.empty()) {
+    return;
+  }
+
+  const std::vector<RCameraKey>& path = m_script.cameraPath;
+
+  auto it = std::upper_bound(path.begin(), path.end(), time,
+                             [](const float time, const RCameraKey& key) {
+                               return time < key.time;
+                             });
+
+  if (it == path.begin() || it == path.end()) {
+    const RCameraKey& key = (it == path.begin()) ? path.front() : path.back();
+    pCamera->setLocation(key.translation);
+    pCamera->setRotation(key.rotation);
+    return;
+  }
+
+  const RCameraKey& nextKey = *it;
+  const RCameraKey& key = *(it - 1);
+  const float interval = nextKey.time - key.time;
+  const float weight = (interval > 0.0f) ? (time - key.time) / interval : 1.0f;
+
+  pCamera->setLocation(glm::mix(key.translation, nextKey.translation, weight));
+  pCamera->setRotation(glm::mix(key.rotation, nextKey.rotation, weight));
+}
+
+void core::MBenchmark::start() {
+  if (!m_isLoaded) {
+    RE_LOG(Error, "Can't start benchmark, no script is loaded.");
+    return;
+  }
+
+  // simulation advances by the same step every frame regardless of frame time
+  core::time.setFixedDeltaTime(m_script.timestep);
+
+  m_frameIndex = 0u;
+  m_isRunning = true;
+
+  RE_LOG(Log, "Starting benchmark '%s'.", m_script.name.c_str());
+}
+
+bool core::MBenchmark::update() {
+  if (!m_isRunning) {
+    return false;
+  }
+
+  // measurement starts with the first frame after the warmup
+  if (m_frameIndex == m_script.warmupFrames) {
+    core::time.getFrameStatistics().setWindowSize(m_script.frameCount);
+    core::profiler.reset();
+    core::renderer.resetMeshletStatistics();
+    m_startTimePoint = std::chrono::steady_clock::now();
+  }
+
+  if (m_frameIndex == m_script.warmupFrames + m_script.frameCount) {
+    writeReport(m_reportPath);
+
+    if (!m_script.tracePath.empty()) {
+      core::profiler.exportChromeTrace(m_script.tracePath);
+    }
+
+    core::time.setFixedDeltaTime(0.0f);
+    m_isRunning = false;
+
+    return false;
+  }
+
+  const uint32_t measuredFrame =
+      (m_frameIndex >= m_script.warmupFrames) ? m_frameIndex - m_script.warmupFrames : 0u;
+  updateCamera(static_cast<float>(measuredFrame) * m_script.timestep);
+
+  ++m_frameIndex;
+
+  return true;
+}
+
+TResult core::MBenchmark::writeReport(const std::string& path) {
+  using json = nlohmann::json;
+
+  const RFrameStatistics::RSummary summary =
+      core::time.getFrameStatistics().getSummary();
+
+  const double wallTime =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTimePoint)
+          .count();
+
+  auto fGetScopes = [](const MProfiler::ETimeline timeline) {
+    json scopes = json::object();
+
+    for (const auto& it : core::profiler.getAllStatistics(timeline)) {
+      scopes[it.first] = {{"average", it.second.averageTime},
+                          {"min", it.second.minTime},
+                          {"max", it.second.maxTime},
+                          {"samples", it.second.sampleCount}};
+    }
+
+    return scopes;
+  };
+
+  json report;
+  report["name"] = m_script.name;
+  report["timestep"] = m_script.timestep;
+  report["warmupFrames"] = m_script.warmupFrames;
+  report["frames"] = m_script.frameCount;
+  report["wallTime"] = wallTime;
+  report["jobWorkers"] = core::jobs.getWorkerCount();
+  report["frameTime"] = {{"average", summary.averageTime},
+                         {"min", summary.minTime},
+                         {"p50", summary.p50Time},
+                         {"p95", summary.p95Time},
+                         {"p99", summary.p99Time},
+                         {"worst", summary.worstTime},
+                         {"worstFrame", summary.worstFrame},
+                         {"hitches", summary.hitchCount},
+                         {"hitchThreshold", summary.hitchTime},
+                         {"histogramBucketWidth", summary.histogramBucketWidth},
+                         {"histogram", summary.histogram}};
+
+  // profiler statistics cover its own rolling window, not the whole run
+  report["cpu"] = fGetScopes(MProfiler::ETimeline::CPU);
+  report["gpu"] = fGetScopes(MProfiler::ETimeline::GPU);
+
+  // triangles of the main camera views per model, averaged over the frames it was drawn in
+  json meshletCulling = json::object();
+
+  for (const auto& it : core::renderer.getMeshletStatistics()) {
+    const RMeshletStatistics& statistics = it.second;
+    const double frameCount = static_cast<double>(std::max(statistics.frameCount, 1u));
+    const double culledPercent =
+        (statistics.triangleCount > 0u)
+            ? 100.0 * static_cast<double>(statistics.culledTriangleCount) / statistics.triangleCount
+            : 0.0;
+
+    meshletCulling[it.first] = {{"frames", statistics.frameCount},
+                                {"triangles", statistics.triangleCount / frameCount},
+                                {"culledTriangles", statistics.culledTriangleCount / frameCount},
+                                {"culledPercent", culledPercent}};
+  }
+
+  report["meshletCulling"] = meshletCulling;
+
+  std::ofstream file(path, std::ios::out | std::ios::trunc);
+
+  if (!file.is_open()) {
+    RE_LOG(Error, "Failed to open '%s' for writing benchmark report.", path.c_str());
+    return RE_ERROR;
+  }
+
+  file << report.dump(2);
+
+  RE_LOG(Log, "Benchmark '%s' finished: %.3f ms average, %.3f ms p99, %d hitches. "
+         "Report written to '%s'.", m_script.name.c_str(), summary.averageTime,
+         summary.p99Time, summary.hitchCount, path.c_str());
+
+  return RE_OK;
+}
@@ -0,0 +1,270 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/managers/profiler.h"
+#include "core/managers/jobs.h"
+
+namespace {
+// queue owned by the calling thread
+thread_local uint32_t tQueueIndex = core::MJobs::invalidQueue;
+}  // namespace
+
+core::MJobs::MJobs() { RE_LOG(Log, "Creating job system."); }
+
+void core::MJobs::initialize(uint32_t workerCount) {
+  if (m_isRunning) {
+    RE_LOG(Warning, "Job system is already initialized.");
+    return;
+  }
+
+  // the calling thread executes jobs while waiting, doesn't need a worker
+  if (workerCount == 0u) {
+    workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1u;
+  }
+
+  tQueueIndex = 0u;
+
+  m_queues.clear();
+  m_queues.reserve(workerCount + 1u);
+
+  for (uint32_t i = 0; i < workerCount + 1u; ++i) {
+    m_queues.emplace_back(std::make_unique<RQueue>());
+  }
+
+  m_workerNames.resize(workerCount);
+  m_workers.reserve(workerCount);
+  m_isRunning = true;
+
+  for (uint32_t i = 0; i < workerCount; ++i) {
+    m_workerNames[i] = "Job worker " + std::to_string(i + 1u);
+    m_workers.emplace_back(&MJobs::workerLoop, this, i + 1u);
+  }
+
+  RE_LOG(Log, "Started %d job workers.", workerCount);
+}
+
+void core::MJobs::deinitialize() {
+  if (!m_isRunning) {
+    return;
+  }
+
+  // jobs may still queue other jobs, let workers drain the queues
+  RJob job;
+  while (m_queuedJobCount.load() > 0u) {
+    if (pop(job)) {
+      execute(job);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_isRunning = false;
+  }
+  m_wakeCondition.notify_all();
+
+  for (auto& worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+
+  m_workers.clear();
+  m_queues.clear();
+
+  RE_LOG(Log, "Stopped job workers.");
+}
+
+void core::MJobs::workerLoop(const uint32_t queueIndex) {
+  tQueueIndex = queueIndex;
+  core::profiler.setThreadName(m_workerNames[queueIndex - 1u].c_str());
+
+  RJob job;
+
+  while (m_isRunning) {
+    if (pop(job)) {
+      execute(job);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_wakeCondition.wait(lock, [this]() {
+      return m_queuedJobCount.load() > 0u || !m_isRunning;
+    });
+  }
+}
+
+void core::MJobs::push(RJob&& job) {
+  // system isn't initialized, jobs run in place
+  if (!m_isRunning) {
+    execute(job);
+    return;
+  }
+
+  const uint32_t queueIndex =
+      (tQueueIndex < m_queues.size())
+          ? tQueueIndex
+          : m_nextQueue.fetch_add(1) % static_cast<uint32_t>(m_queues.size());
+
+  // counted before another thread can pop it, the unsigned count never wraps
+  {
+    std::lock_guard<std::mutex> lock(m_queues[queueIndex]->mutex);
+    m_queuedJobCount.fetch_add(1);
+    m_queues[queueIndex]->jobs.emplace_back(std::move(job));
+  }
+
+  // sleeping workers check the count under this lock, wake up isn't lost
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+  }
+  m_wakeCondition.notify_one();
+}
+
+bool core::MJobs::pop(RJob& outJob) {
+  if (m_queuedJobCount.load() == 0u) {
+    return false;
+  }
+
+  const uint32_t queueCount = static_cast<uint32_t>(m_queues.size());
+  const bool hasQueue = (tQueueIndex < queueCount);
+
+  // newest job of the own queue is likely to use data still in cache
+  if (hasQueue) {
+    RQueue& queue = *m_queues[tQueueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (!queue.jobs.empty()) {
+      outJob = std::move(queue.jobs.back());
+      queue.jobs.pop_back();
+      m_queuedJobCount.fetch_sub(1);
+      return true;
+    }
+  }
+
+  // oldest jobs of other queues are usually the largest ones
+  const uint32_t firstQueue = hasQueue ? tQueueIndex + 1u : 0u;
+
+  for (uint32_t i = 0; i < queueCount; ++i) {
+    const uint32_t queueIndex = (firstQueue + i) % queueCount;
+
+    if (queueIndex == tQueueIndex) {
+      continue;
+    }
+
+    RQueue& queue = *m_queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (!queue.jobs.empty()) {
+      outJob = std::move(queue.jobs.front());
+      queue.jobs.pop_front();
+      m_queuedJobCount.fetch_sub(1);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void core::MJobs::execute(RJob& job) {
+  job.function();
+  job.function = nullptr;
+
+  finish(job.pCounter);
+}
+
+void core::MJobs::finish(RJobCounter* pCounter) {
+  if (!pCounter) {
+    return;
+  }
+
+  std::vector<RJob> dependents;
+
+  {
+    // held while reaching zero so a waiting thread can't destroy the counter
+    std::lock_guard<std::mutex> lock(pCounter->m_mutex);
+
+    if (pCounter->m_count.fetch_sub(1) != 1u) {
+      return;
+    }
+
+    dependents.swap(pCounter->m_dependents);
+  }
+
+  for (RJob& dependent : dependents) {
+    push(std::move(dependent));
+  }
+
+  // counter may be destroyed by now, only wakes threads waiting for it
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+  }
+  m_wakeCondition.notify_all();
+}
+
+void core::MJobs::run(std::function<void()> function, RJobCounter* pCounter,
+                      RJobCounter* pDependency) {
+  if (pCounter) {
+    pCounter->m_count.fetch_add(1);
+  }
+
+  RJob job{std::move(function), pCounter};
+
+  if (pDependency) {
+    std::lock_guard<std::mutex> lock(pDependency->m_mutex);
+
+    if (pDependency->m_count.load() > 0u) {
+      pDependency->m_dependents.emplace_back(std::move(job));
+      return;
+    }
+  }
+
+  push(std::move(job));
+}
+
+void core::MJobs::wait(RJobCounter* pCounter) {
+  if (!pCounter) {
+    return;
+  }
+
+  RJob job;
+
+  while (!pCounter->isDone()) {
+    if (pop(job)) {
+      execute(job);
+      continue;
+    }
+
+    // remaining jobs of the counter run on other threads or wait for
+    // dependencies, woken up by new jobs or by the counter reaching zero
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_wakeCondition.wait(lock, [this, pCounter]() {
+      return pCounter->isDone() || m_queuedJobCount.load() > 0u;
+    });
+  }
+
+  // last job may still be releasing dependents of the counter
+  std::lock_guard<std::mutex> lock(pCounter->m_mutex);
+}
+
+void core::MJobs::parallelFor(
+    const uint32_t count, uint32_t batchSize,
+    const std::function<void(uint32_t, uint32_t)>& function) {
+  if (count == 0u) {
+    return;
+  }
+
+  if (batchSize == 0u) {
+    const uint32_t batchCount = (getWorkerCount() + 1u) * 4u;
+    batchSize = std::max((count + batchCount - 1u) / batchCount, 1u);
+  }
+
+  RJobCounter counter;
+
+  for (uint32_t begin = batchSize; begin < count; begin += batchSize) {
+    const uint32_t end = std::min(begin + batchSize, count);
+    run([&function, begin, end]() { function(begin, end); }, &counter);
+  }
+
+  // first range is done by the calling thread
+  function(0u, std::min(batchSize, count));
+
+  wait(&counter);
+}
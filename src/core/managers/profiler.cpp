@@ -0,0 +1,249 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/managers/profiler.h"
+
+core::MProfiler::MProfiler() {
+  RE_LOG(Log, "Creating profiler.");
+
+  m_initialTimePoint = std::chrono::steady_clock::now();
+}
+
+uint64_t core::MProfiler::getTime() const {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - m_initialTimePoint)
+          .count());
+}
+
+uint32_t core::MProfiler::getThreadId() {
+  thread_local uint32_t threadId = m_nextThreadId.fetch_add(1);
+  return threadId;
+}
+
+void core::MProfiler::setThreadName(const char* name) {
+  const uint32_t threadId = getThreadId();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  for (auto& threadName : m_threadNames) {
+    if (threadName.first == threadId) {
+      threadName.second = name;
+      return;
+    }
+  }
+
+  m_threadNames.emplace_back(threadId, name);
+}
+
+void core::MProfiler::closeFrame(const uint64_t endTime) {
+  m_currentFrame.endTime = endTime;
+
+  for (const REvent& event : m_currentFrame.events) {
+    RHistory& history =
+        m_history[static_cast<uint8_t>(event.timeline)][event.name];
+    history.frameTime += static_cast<float>(event.duration) * 1e-6f;
+    history.isUsed = true;
+  }
+
+  // scopes that didn't run during the frame keep their previous samples
+  for (auto& timelineHistory : m_history) {
+    for (auto& it : timelineHistory) {
+      RHistory& history = it.second;
+
+      if (!history.isUsed) {
+        continue;
+      }
+
+      history.samples[history.nextSample] = history.frameTime;
+      history.nextSample = (history.nextSample + 1) % statisticsWindow;
+      history.sampleCount = std::min(history.sampleCount + 1, statisticsWindow);
+      history.frameTime = 0.0f;
+      history.isUsed = false;
+    }
+  }
+
+  m_frames.emplace_back(std::move(m_currentFrame));
+
+  while (m_frames.size() > capturedFrames) {
+    m_frames.pop_front();
+  }
+}
+
+void core::MProfiler::beginFrame() {
+  const uint64_t time = getTime();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  const uint64_t frameIndex = m_currentFrame.index;
+  closeFrame(time);
+
+  m_currentFrame = RFrame{};
+  m_currentFrame.index = frameIndex + 1;
+  m_currentFrame.startTime = time;
+}
+
+void core::MProfiler::addEvent(const char* name, const uint64_t startTime,
+                               const uint64_t duration,
+                               const ETimeline timeline) {
+  if (!m_isEnabled) {
+    return;
+  }
+
+  REvent event;
+  event.name = name;
+  event.startTime = startTime;
+  event.duration = duration;
+  event.threadId = (timeline == ETimeline::CPU) ? getThreadId() : 0u;
+  event.timeline = timeline;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (m_currentFrame.events.size() < maxFrameEvents) {
+    m_currentFrame.events.emplace_back(event);
+  }
+}
+
+core::MProfiler::RStatistics core::MProfiler::getStatistics(
+    const char* name, const ETimeline timeline) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  const auto& timelineHistory = m_history[static_cast<uint8_t>(timeline)];
+  auto it = timelineHistory.find(name);
+
+  RStatistics statistics{};
+
+  if (it == timelineHistory.end() || it->second.sampleCount == 0) {
+    return statistics;
+  }
+
+  const RHistory& history = it->second;
+  const uint32_t lastSample =
+      (history.nextSample + statisticsWindow - 1) % statisticsWindow;
+
+  statistics.lastTime = history.samples[lastSample];
+  statistics.minTime = std::numeric_limits<float>::max();
+  statistics.sampleCount = history.sampleCount;
+
+  // samples fill the window from index 0 until it wraps
+  for (uint32_t i = 0; i < history.sampleCount; ++i) {
+    const float sample = history.samples[i];
+    statistics.averageTime += sample;
+    statistics.minTime = std::min(statistics.minTime, sample);
+    statistics.maxTime = std::max(statistics.maxTime, sample);
+  }
+
+  statistics.averageTime /= static_cast<float>(history.sampleCount);
+
+  return statistics;
+}
+
+std::vector<std::pair<std::string, core::MProfiler::RStatistics>>
+core::MProfiler::getAllStatistics(const ETimeline timeline) const {
+  std::vector<std::string> names;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (const auto& it : m_history[static_cast<uint8_t>(timeline)]) {
+      names.emplace_back(it.first);
+    }
+  }
+
+  std::sort(names.begin(), names.end());
+
+  std::vector<std::pair<std::string, RStatistics>> allStatistics;
+  allStatistics.reserve(names.size());
+
+  for (const auto& name : names) {
+    allStatistics.emplace_back(name, getStatistics(name.c_str(), timeline));
+  }
+
+  return allStatistics;
+}
+
+TResult core::MProfiler::exportChromeTrace(const std::string& path) const {
+  using json = nlohmann::json;
+
+  // CPU threads and the GPU are shown as separate processes
+  constexpr uint32_t cpuProcessId = 1u;
+  constexpr uint32_t gpuProcessId = 2u;
+
+  json traceEvents = json::array();
+
+  auto fAddMetadata = [&traceEvents](const char* type, const uint32_t processId,
+                                     const uint32_t threadId,
+                                     const std::string& name) {
+    traceEvents.push_back({{"name", type},
+                           {"ph", "M"},
+                           {"pid", processId},
+                           {"tid", threadId},
+                           {"args", {{"name", name}}}});
+  };
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  fAddMetadata("process_name", cpuProcessId, 0u, "CPU");
+  fAddMetadata("process_name", gpuProcessId, 0u, "GPU");
+  fAddMetadata("thread_name", gpuProcessId, 0u, "Graphics queue");
+
+  for (const auto& threadName : m_threadNames) {
+    fAddMetadata("thread_name", cpuProcessId, threadName.first, threadName.second);
+  }
+
+  uint32_t eventCount = 0u;
+
+  for (const RFrame& frame : m_frames) {
+    for (const REvent& event : frame.events) {
+      const bool isGPU = (event.timeline == ETimeline::GPU);
+
+      // timestamps are in microseconds
+      traceEvents.push_back(
+          {{"name", event.name},
+           {"cat", isGPU ? "gpu" : "cpu"},
+           {"ph", "X"},
+           {"ts", static_cast<double>(event.startTime) * 1e-3},
+           {"dur", static_cast<double>(event.duration) * 1e-3},
+           {"pid", isGPU ? gpuProcessId : cpuProcessId},
+           {"tid", event.threadId},
+           {"args", {{"frame", frame.index}}}});
+
+      ++eventCount;
+    }
+  }
+
+  std::ofstream file(path, std::ios::out | std::ios::trunc);
+
+  if (!file.is_open()) {
+    RE_LOG(Error, "Failed to open '%s' for writing profiler trace.", path.c_str());
+    return RE_ERROR;
+  }
+
+  file << json{{"traceEvents", traceEvents}, {"displayTimeUnit", "ms"}}.dump();
+
+  RE_LOG(Log, "Exported %d profiler events of %d frames to '%s'.", eventCount,
+         static_cast<int32_t>(m_frames.size()), path.c_str());
+
+  return RE_OK;
+}
+
+void core::MProfiler::reset() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  const uint64_t frameIndex = m_currentFrame.index;
+
+  m_frames.clear();
+  m_history[0].clear();
+  m_history[1].clear();
+  m_currentFrame = RFrame{};
+  m_currentFrame.index = frameIndex;
+  m_currentFrame.startTime = getTime();
+}
+
+RProfileScope::RProfileScope(const char* name)
+    : m_name(name), m_startTime(core::profiler.getTime()) {}
+
+RProfileScope::~RProfileScope() {
+  core::profiler.addEvent(m_name, m_startTime,
+                          core::profiler.getTime() - m_startTime,
+                          core::MProfiler::ETimeline::CPU);
+}
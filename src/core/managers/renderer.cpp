@@ -150,15 +150,10 @@ TResult core::MRenderer::createSceneBuffers() {
   config::scene::skinBlockSize =
       static_cast<uint32_t>(util::getVulkanAlignedSize(sizeof(glm::mat4) * RE_MAXJOINTS * 2, core::vulkan::minUniformBufferAlignment));
 
-  RE_LOG(Log, "Allocating scene storage vertex buffer for %d vertices.",
-    config::scene::vertexBudget);
-  createBuffer(EBufferType::DGPU_VERTEX, config::scene::getVertexBufferSize(),
-    scene.vertexBuffer, nullptr);
-
-  RE_LOG(Log, "Allocating scene buffer for %d indices.",
-         config::scene::indexBudget);
-  createBuffer(EBufferType::DGPU_INDEX, config::scene::getIndexBufferSize(),
-               scene.indexBuffer, nullptr);
+  if (createGeometryPage(static_cast<uint32_t>(config::scene::vertexBudget),
+                         static_cast<uint32_t>(config::scene::indexBudget)) != RE_OK) {
+    return RE_ERROR;
+  }
 
   RE_LOG(Log, "Allocating scene buffer for %d entities with transformation.",
          config::scene::entityBudget);
@@ -186,6 +181,27 @@ TResult core::MRenderer::createSceneBuffers() {
       scene.instanceBuffers[instanceBufferId], nullptr);
   }
 
+  RE_LOG(Log, "Allocating skinned vertex buffers for %d vertices.",
+         config::scene::skinnedVertexBudget);
+  skinning.vertexBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+  skinning.batchBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+  skinning.dispatches.resize(MAX_FRAMES_IN_FLIGHT);
+  skinning.scheduler.reset(static_cast<uint32_t>(config::scene::skinnedVertexBudget));
+
+  occlusion.culler.resize(config::scene::occlusionBufferWidth, config::scene::occlusionBufferHeight);
+  shadows.cascades.setup(config::shadowCascades, config::shadowResolution);
+
+  // a batch is made for every started block of vertices of an instance
+  const size_t skinningBatchBudget =
+      config::scene::skinnedVertexBudget / RSkinningScheduler::batchSize + config::scene::nodeBudget;
+
+  for (int8_t frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; ++frameIndex) {
+    createBuffer(EBufferType::DGPU_STORAGE, sizeof(RSkinnedVertex) * config::scene::skinnedVertexBudget,
+      skinning.vertexBuffers[frameIndex], nullptr);
+    createBuffer(EBufferType::CPU_STORAGE, sizeof(RSkinningBatch) * skinningBatchBudget,
+      skinning.batchBuffers[frameIndex], nullptr);
+  }
+
   RE_LOG(Log, "Creating material storage buffer.");
   createBuffer(EBufferType::CPU_STORAGE, sizeof(RSceneFragmentPCB) * (config::scene::sampledImageBudget / RE_MAXTEXTURES),
     material.buffer, nullptr);
@@ -208,13 +224,47 @@ TResult core::MRenderer::createSceneBuffers() {
   return RE_OK;
 }
 
+TResult core::MRenderer::createGeometryPage(const uint32_t vertexCount,
+                                           const uint32_t indexCount) {
+  RE_LOG(Log,
+         "Allocating scene geometry page %d for %d vertices and %d indices.",
+         static_cast<int32_t>(scene.geometryPages.size()), vertexCount,
+         indexCount);
+
+  auto& page = scene.geometryPages.emplace_back();
+
+  if (createBuffer(EBufferType::DGPU_VERTEX, sizeof(RVertex) * vertexCount,
+                   page.vertexBuffer, nullptr) != RE_OK) {
+    scene.geometryPages.pop_back();
+    return RE_ERROR;
+  }
+
+  if (createBuffer(EBufferType::DGPU_INDEX, sizeof(uint32_t) * indexCount,
+                   page.indexBuffer, nullptr) != RE_OK) {
+    vmaDestroyBuffer(memAlloc, page.vertexBuffer.buffer,
+                     page.vertexBuffer.allocation);
+    scene.geometryPages.pop_back();
+    return RE_ERROR;
+  }
+
+  page.vertexRanges.reset(vertexCount);
+  page.indexRanges.reset(indexCount);
+
+  return RE_OK;
+}
+
 void core::MRenderer::destroySceneBuffers() {
   RE_LOG(Log, "Destroying scene buffers.");
 
-  vmaDestroyBuffer(memAlloc, scene.vertexBuffer.buffer,
-                   scene.vertexBuffer.allocation);
-  vmaDestroyBuffer(memAlloc, scene.indexBuffer.buffer,
-                   scene.indexBuffer.allocation);
+  for (auto& page : scene.geometryPages) {
+    vmaDestroyBuffer(memAlloc, page.vertexBuffer.buffer,
+                     page.vertexBuffer.allocation);
+    vmaDestroyBuffer(memAlloc, page.indexBuffer.buffer,
+                     page.indexBuffer.allocation);
+  }
+
+  scene.geometryPages.clear();
+  scene.geometryReleases.clear();
   vmaDestroyBuffer(memAlloc, scene.rootTransformBuffer.buffer,
                    scene.rootTransformBuffer.allocation);
   vmaDestroyBuffer(memAlloc, scene.nodeTransformBuffer.buffer,
@@ -226,6 +276,17 @@ void core::MRenderer::destroySceneBuffers() {
     vmaDestroyBuffer(memAlloc, scene.instanceBuffers[instanceBufferId].buffer,
                      scene.instanceBuffers[instanceBufferId].allocation);
   }
+
+  for (int8_t frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; ++frameIndex) {
+    vmaDestroyBuffer(memAlloc, skinning.vertexBuffers[frameIndex].buffer,
+                     skinning.vertexBuffers[frameIndex].allocation);
+    vmaDestroyBuffer(memAlloc, skinning.batchBuffers[frameIndex].buffer,
+                     skinning.batchBuffers[frameIndex].allocation);
+  }
+
+  skinning.vertexBuffers.clear();
+  skinning.batchBuffers.clear();
+  skinning.dispatches.clear();
   
   vmaDestroyBuffer(memAlloc, material.buffer.buffer, material.buffer.allocation);
   vmaDestroyBuffer(memAlloc, scene.transparencyLinkedListBuffer.buffer, scene.transparencyLinkedListBuffer.allocation);
@@ -253,6 +314,9 @@ core::MRenderer::RSceneBuffers* core::MRenderer::getSceneBuffers() {
 TResult core::MRenderer::createUniformBuffers() {
   scene.sceneBuffers.resize(MAX_FRAMES_IN_FLIGHT);
   lighting.buffers.resize(MAX_FRAMES_IN_FLIGHT);
+  lighting.pointLightBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+  lighting.clusterBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+  lighting.lightIndexBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
   core::vulkan::minUniformBufferAlignment = physicalDevice.deviceProperties.properties.limits.minUniformBufferOffsetAlignment;
   core::vulkan::descriptorBufferOffsetAlignment = physicalDevice.descriptorBufferProperties.descriptorBufferOffsetAlignment;
@@ -266,6 +330,12 @@ TResult core::MRenderer::createUniformBuffers() {
                  scene.sceneBuffers[i], nullptr);
     createBuffer(EBufferType::CPU_UNIFORM, uboLightingSize, lighting.buffers[i],
                  &lighting.data);
+    createBuffer(EBufferType::CPU_STORAGE, sizeof(RPointLight) * config::scene::pointLightBudget,
+                 lighting.pointLightBuffers[i], nullptr);
+    createBuffer(EBufferType::CPU_STORAGE, sizeof(RLightCluster) * RLightClusters::clusterCount,
+                 lighting.clusterBuffers[i], nullptr);
+    createBuffer(EBufferType::CPU_STORAGE, sizeof(uint32_t) * config::scene::lightIndexBudget,
+                 lighting.lightIndexBuffers[i], nullptr);
   }
 
   return RE_OK;
@@ -280,6 +350,12 @@ void core::MRenderer::destroyUniformBuffers() {
     vmaDestroyBuffer(memAlloc, it.buffer, it.allocation);
   }
 
+  for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+    vmaDestroyBuffer(memAlloc, lighting.pointLightBuffers[i].buffer, lighting.pointLightBuffers[i].allocation);
+    vmaDestroyBuffer(memAlloc, lighting.clusterBuffers[i].buffer, lighting.clusterBuffers[i].allocation);
+    vmaDestroyBuffer(memAlloc, lighting.lightIndexBuffers[i].buffer, lighting.lightIndexBuffers[i].allocation);
+  }
+
   vmaDestroyBuffer(memAlloc, postprocess.exposureStorageBuffer.buffer, postprocess.exposureStorageBuffer.allocation);
 }
 
@@ -626,20 +702,16 @@ TResult core::MRenderer::createSyncObjects() {
     }
   }
 
-  // Create asynchronously running threads
-  RE_LOG(Log, "Creating entity update thread.");
-  sync.asyncUpdateEntities.bindFunction(this, &MRenderer::updateBoundEntities);
-  sync.asyncUpdateEntities.start();
-
-  sync.asyncUpdateInstanceBuffers.bindFunction(this, &MRenderer::updateInstanceBuffer);
-  sync.asyncUpdateInstanceBuffers.start();
-
   return RE_OK;
 }
 
 void core::MRenderer::destroySyncObjects() {
   RE_LOG(Log, "Destroying synchronization objects.");
 
+  // entity update waits on a frame fence before writing its buffers
+  RE_LOG(Log, "Waiting for entity update.");
+  core::jobs.wait(&sync.frameUpdate);
+
   for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
     vkDestroySemaphore(logicalDevice.device, sync.semImgAvailable[i], nullptr);
     vkDestroySemaphore(logicalDevice.device, sync.semRenderFinished[i],
@@ -647,12 +719,6 @@ void core::MRenderer::destroySyncObjects() {
 
     vkDestroyFence(logicalDevice.device, sync.fenceInFlight[i], nullptr);
   }
-
-  RE_LOG(Log, "Stopping entity update thread.");
-  sync.asyncUpdateEntities.stop();
-
-  RE_LOG(Log, "Stopping instance buffers update thread.");
-  sync.asyncUpdateInstanceBuffers.stop();
 }
 
 void core::MRenderer::updateSceneUBO(uint32_t currentImage) {
@@ -662,6 +728,9 @@ void core::MRenderer::updateSceneUBO(uint32_t currentImage) {
   scene.sceneBufferObject.haltonJitter = system.haltonJitter[renderView.framesRendered % core::vulkan::haltonSequenceCount];
   scene.sceneBufferObject.clipData = view.pActiveCamera->getNearAndFarPlane();
 
+  // other views, e.g. environment map faces, go over all point lights
+  scene.sceneBufferObject.isClusteredView = (view.pActiveCamera == core::actors.getCamera(RCAM_MAIN));
+
   uint8_t* pSceneUBO = static_cast<uint8_t*>(scene.sceneBuffers[currentImage].allocInfo.pMappedData) +
                        config::scene::cameraBlockSize * view.pActiveCamera->getViewBufferIndex();
 
@@ -669,6 +738,7 @@ void core::MRenderer::updateSceneUBO(uint32_t currentImage) {
 }
 
 void core::MRenderer::waitForSystemIdle() {
+  std::lock_guard<std::mutex> queueLock(sync.queueMutex);
   vkQueueWaitIdle(logicalDevice.queues.graphics);
   vkQueueWaitIdle(logicalDevice.queues.compute);
   vkQueueWaitIdle(logicalDevice.queues.present);
@@ -697,21 +767,28 @@ TResult core::MRenderer::initialize() {
   updateAspectRatio();
   if (chkResult <= RE_ERRORLIMIT) chkResult = createCoreCommandPools();
   if (chkResult <= RE_ERRORLIMIT) chkResult = createCoreCommandBuffers();
+  if (chkResult <= RE_ERRORLIMIT) chkResult = createUploadResources();
   if (chkResult <= RE_ERRORLIMIT) chkResult = setRendererDefaults();
   if (chkResult <= RE_ERRORLIMIT) chkResult = createSceneBuffers();
   if (chkResult <= RE_ERRORLIMIT) chkResult = createDescriptorSetLayouts();
   if (chkResult <= RE_ERRORLIMIT) chkResult = createPipelineLayouts();
   if (chkResult <= RE_ERRORLIMIT) chkResult = createViewports();
 
+  if (chkResult <= RE_ERRORLIMIT) chkResult = createPipelineCache();
   if (chkResult <= RE_ERRORLIMIT) chkResult = createDynamicRenderingPasses();
   if (chkResult <= RE_ERRORLIMIT) chkResult = createComputePipelines();
 
+  // all pipelines exist at this point, next startup reuses compiled shaders
+  if (chkResult <= RE_ERRORLIMIT) savePipelineCache();
+  destroyShaderModules();
+
   if (chkResult <= RE_ERRORLIMIT) chkResult = createSyncObjects();
   if (chkResult <= RE_ERRORLIMIT) chkResult = createUniformBuffers();
   if (chkResult <= RE_ERRORLIMIT) chkResult = createDescriptorPool();
   if (chkResult <= RE_ERRORLIMIT) chkResult = createDescriptorSets();
 
   if (chkResult <= RE_ERRORLIMIT) chkResult = createQueryPool();
+  if (chkResult <= RE_ERRORLIMIT) chkResult = createTimestampQueryPool();
 
   return chkResult;
 }
@@ -721,10 +798,12 @@ void core::MRenderer::deinitialize() {
 
   destroySwapChain();
   destroySyncObjects();
+  destroyUploadResources();
   destroyCoreCommandBuffers();
   destroyCoreCommandPools();
   destroyComputePipelines();
   destroyDynamicRenderingPasses();
+  destroyPipelineCache();
   destroySceneBuffers();
   destroySurface();
   core::actors.destroyAllPawns();
@@ -733,6 +812,7 @@ void core::MRenderer::deinitialize() {
   destroySamplers();
   destroyDescriptorPool();
   destroyQueryPool();
+  destroyTimestampQueryPool();
   destroyUniformBuffers();
   destroyMemAlloc();
   if(requireValidationLayers) MDebug::get().destroy(APIInstance);
@@ -740,6 +820,46 @@ void core::MRenderer::deinitialize() {
   destroyInstance();
 }
 
+TResult core::MRenderer::initializeHeadless() {
+  RE_LOG(Log, "Initializing headless renderer, nothing will be drawn.");
+
+  // no device limits apply, material slots are bound by host memory only
+  config::scene::sampledImageBudget = 262144u;
+
+  TResult chkResult = createSceneBuffers();
+
+  if (chkResult != RE_OK) {
+    return chkResult;
+  }
+
+  RCameraInfo cameraInfo{};
+  cameraInfo.FOV = config::FOV;
+  cameraInfo.aspectRatio = 1.0f;
+  cameraInfo.nearZ = RE_NEARZ;
+  cameraInfo.farZ = config::viewDistance;
+
+  ACamera* pCamera = core::actors.createCamera(RCAM_MAIN, &cameraInfo);
+
+  if (!pCamera) {
+    return RE_CRITICAL;
+  }
+
+  setCamera(pCamera);
+  view.cameraSettings.aspectRatio = config::getAspectRatio();
+
+  return RE_OK;
+}
+
+void core::MRenderer::deinitializeHeadless() {
+  core::actors.destroyAllPawns();
+  core::world.destroyAllModels();
+  core::resources.destroyAllTextures();
+
+  scene.geometryPages.clear();
+  scene.geometryReleases.clear();
+  system.hostMemory.clear();
+}
+
 const VkDescriptorSet core::MRenderer::getSceneDescriptorSet(
     uint32_t frameInFlight) {
   return frameInFlight == -1 ? scene.descriptorSets[renderView.frameInFlight]
@@ -755,10 +875,19 @@ core::MRenderer::REnvironmentData* core::MRenderer::getEnvironmentData() {
 }
 
 void core::MRenderer::updateLightingUBO(const int32_t frameIndex) {
-  core::actors.updateLightingUBO(&lighting.data);
+  core::actors.updateLightingUBO(&lighting.data, lighting.pointLights);
 
   lighting.data.aoMode = config::ambientOcclusionMode;
 
+  // cascades as they are in the shadow map after this frame's shadow passes
+  for (uint32_t i = 0; i < RE_MAXCASCADES; ++i) {
+    const bool isCascade = i < shadows.cascades.getCascadeCount();
+    lighting.data.cascadeViewProjections[i] = shadows.frameCascades[frameIndex][i].viewProjection;
+    lighting.data.cascadeSplits[i] = isCascade ? shadows.frameCascades[frameIndex][i].splitDepth : 0.0f;
+  }
+
+  clusterPointLights(frameIndex);
+
   memcpy(lighting.buffers[frameIndex].allocInfo.pMappedData, &lighting.data,
          sizeof(RLightingUBO));
 }
@@ -6,7 +6,11 @@
 
 TResult core::MRenderer::createBuffer(EBufferType type, VkDeviceSize size, RBuffer& outBuffer, void* inData) {
   outBuffer.type = type;
-  RBuffer stagingBuffer;
+
+  if (config::bHeadless) {
+    return createHostBuffer(type, size, outBuffer, inData);
+  }
+
   VmaAllocationCreateInfo allocInfo{};
   VkBufferCreateInfo bufferCreateInfo{};
   bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -159,7 +163,9 @@ TResult core::MRenderer::createBuffer(EBufferType type, VkDeviceSize size, RBuff
   }
 
   case (uint8_t)EBufferType::DGPU_VERTEX: {
-    bufferCreateInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    // skinning pre-pass reads vertices through their device address
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+                             | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
     bufferCreateInfo.size = size;
     bufferCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
     bufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
@@ -178,21 +184,17 @@ TResult core::MRenderer::createBuffer(EBufferType type, VkDeviceSize size, RBuff
     };
 
     if (inData) {
-      VkBufferCopy copyInfo{};
-      copyInfo.srcOffset = 0;
-      copyInfo.dstOffset = 0;
-      copyInfo.size = size;
-
-      createBuffer(EBufferType::STAGING, size, stagingBuffer, inData);
-      copyBuffer(stagingBuffer.buffer, outBuffer.buffer, &copyInfo);
-      vmaDestroyBuffer(memAlloc, stagingBuffer.buffer, stagingBuffer.allocation);
+      queueBufferUpload(&outBuffer, inData, size);
     }
 
+    bdaInfo.buffer = outBuffer.buffer;
+    outBuffer.deviceAddress = vkGetBufferDeviceAddress(logicalDevice.device, &bdaInfo);
+
     return RE_OK;
   }
 
   case (uint8_t)EBufferType::DGPU_INDEX: {
-    bufferCreateInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
     bufferCreateInfo.size = size;
     bufferCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
     bufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
@@ -210,14 +212,7 @@ TResult core::MRenderer::createBuffer(EBufferType type, VkDeviceSize size, RBuff
     };
 
     if (inData) {
-      VkBufferCopy copyInfo{};
-      copyInfo.srcOffset = 0;
-      copyInfo.dstOffset = 0;
-      copyInfo.size = size;
-
-      createBuffer(EBufferType::STAGING, size, stagingBuffer, inData);
-      copyBuffer(stagingBuffer.buffer, outBuffer.buffer, &copyInfo);
-      vmaDestroyBuffer(memAlloc, stagingBuffer.buffer, stagingBuffer.allocation);
+      queueBufferUpload(&outBuffer, inData, size);
     }
 
     return RE_OK;
@@ -225,7 +220,7 @@ TResult core::MRenderer::createBuffer(EBufferType type, VkDeviceSize size, RBuff
   case (uint8_t)EBufferType::DGPU_UNIFORM: {
     bufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
     bufferCreateInfo.size = size;
-    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
     bufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
     bufferCreateInfo.queueFamilyIndexCount =
       static_cast<uint32_t>(queueFamilyIndices.size());
@@ -242,14 +237,7 @@ TResult core::MRenderer::createBuffer(EBufferType type, VkDeviceSize size, RBuff
     };
 
     if (inData) {
-      VkBufferCopy copyInfo{};
-      copyInfo.srcOffset = 0;
-      copyInfo.dstOffset = 0;
-      copyInfo.size = size;
-
-      createBuffer(EBufferType::STAGING, size, stagingBuffer, inData);
-      copyBuffer(stagingBuffer.buffer, outBuffer.buffer, &copyInfo);
-      vmaDestroyBuffer(memAlloc, stagingBuffer.buffer, stagingBuffer.allocation);
+      queueBufferUpload(&outBuffer, inData, size);
     }
 
     bdaInfo.buffer = outBuffer.buffer;
@@ -260,7 +248,7 @@ TResult core::MRenderer::createBuffer(EBufferType type, VkDeviceSize size, RBuff
   case (uint8_t)EBufferType::DGPU_STORAGE: {
     bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
     bufferCreateInfo.size = size;
-    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
     bufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
     bufferCreateInfo.queueFamilyIndexCount =
       static_cast<uint32_t>(queueFamilyIndices.size());
@@ -277,14 +265,7 @@ TResult core::MRenderer::createBuffer(EBufferType type, VkDeviceSize size, RBuff
     };
 
     if (inData) {
-      VkBufferCopy copyInfo{};
-      copyInfo.srcOffset = 0;
-      copyInfo.dstOffset = 0;
-      copyInfo.size = size;
-
-      createBuffer(EBufferType::STAGING, size, stagingBuffer, inData);
-      copyBuffer(stagingBuffer.buffer, outBuffer.buffer, &copyInfo);
-      vmaDestroyBuffer(memAlloc, stagingBuffer.buffer, stagingBuffer.allocation);
+      queueBufferUpload(&outBuffer, inData, size);
     }
 
     bdaInfo.buffer = outBuffer.buffer;
@@ -313,14 +294,7 @@ TResult core::MRenderer::createBuffer(EBufferType type, VkDeviceSize size, RBuff
     };
 
     if (inData) {
-      VkBufferCopy copyInfo{};
-      copyInfo.srcOffset = 0;
-      copyInfo.dstOffset = 0;
-      copyInfo.size = size;
-
-      createBuffer(EBufferType::STAGING, size, stagingBuffer, inData);
-      copyBuffer(stagingBuffer.buffer, outBuffer.buffer, &copyInfo);
-      vmaDestroyBuffer(memAlloc, stagingBuffer.buffer, stagingBuffer.allocation);
+      queueBufferUpload(&outBuffer, inData, size);
     }
 
     bdaInfo.buffer = outBuffer.buffer;
@@ -349,14 +323,7 @@ TResult core::MRenderer::createBuffer(EBufferType type, VkDeviceSize size, RBuff
     };
 
     if (inData) {
-      VkBufferCopy copyInfo{};
-      copyInfo.srcOffset = 0;
-      copyInfo.dstOffset = 0;
-      copyInfo.size = size;
-
-      createBuffer(EBufferType::STAGING, size, stagingBuffer, inData);
-      copyBuffer(stagingBuffer.buffer, outBuffer.buffer, &copyInfo);
-      vmaDestroyBuffer(memAlloc, stagingBuffer.buffer, stagingBuffer.allocation);
+      queueBufferUpload(&outBuffer, inData, size);
     }
 
     bdaInfo.buffer = outBuffer.buffer;
@@ -369,6 +336,37 @@ TResult core::MRenderer::createBuffer(EBufferType type, VkDeviceSize size, RBuff
   return RE_OK;
 }
 
+TResult core::MRenderer::createHostBuffer(EBufferType type, VkDeviceSize size,
+                                          RBuffer& outBuffer, void* inData) {
+  outBuffer.buffer = VK_NULL_HANDLE;
+  outBuffer.allocation = nullptr;
+  outBuffer.allocInfo = {};
+  outBuffer.deviceAddress = 0u;
+
+  // device local buffers are never mapped, nothing reads them without a device
+  switch (type) {
+    case EBufferType::DGPU_VERTEX:
+    case EBufferType::DGPU_INDEX:
+    case EBufferType::DGPU_UNIFORM:
+    case EBufferType::DGPU_STORAGE:
+    case EBufferType::DGPU_SAMPLER:
+    case EBufferType::DGPU_RESOURCE: {
+      return RE_OK;
+    }
+  }
+
+  auto& pMemory = system.hostMemory.emplace_back(std::make_unique<uint8_t[]>(size));
+
+  if (inData) {
+    memcpy(pMemory.get(), inData, size);
+  }
+
+  outBuffer.allocInfo.pMappedData = pMemory.get();
+  outBuffer.allocInfo.size = size;
+
+  return RE_OK;
+}
+
 TResult core::MRenderer::copyBuffer(VkBuffer srcBuffer, VkBuffer& dstBuffer,
   VkBufferCopy* copyRegion, uint32_t cmdBufferId) {
   if (cmdBufferId > MAX_TRANSFER_BUFFERS) {
@@ -392,8 +390,11 @@ TResult core::MRenderer::copyBuffer(VkBuffer srcBuffer, VkBuffer& dstBuffer,
   submitInfo.commandBufferCount = 1;
   submitInfo.pCommandBuffers = &command.buffersTransfer[cmdBufferId];
 
-  vkQueueSubmit(logicalDevice.queues.transfer, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(logicalDevice.queues.transfer);
+  {
+    std::lock_guard<std::mutex> queueLock(sync.queueMutex);
+    vkQueueSubmit(logicalDevice.queues.transfer, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(logicalDevice.queues.transfer);
+  }
 
   return RE_OK;
 }
@@ -458,17 +459,7 @@ TResult core::MRenderer::copyImageToBuffer(VkCommandBuffer commandBuffer, RTextu
 void core::MRenderer::copyDataToBuffer(void* pData, VkDeviceSize dataSize, RBuffer* pDstBuffer, VkDeviceSize offset) {
   switch (pDstBuffer->type) {
     case EBufferType::DGPU_STORAGE: {
-      RBuffer stagingBuffer;
-
-      VkBufferCopy copyInfo{};
-      copyInfo.srcOffset = 0;
-      copyInfo.dstOffset = offset;
-      copyInfo.size = dataSize;
-
-      createBuffer(EBufferType::STAGING, dataSize, stagingBuffer, pData);
-      copyBuffer(stagingBuffer.buffer, pDstBuffer->buffer, &copyInfo);
-      vmaDestroyBuffer(memAlloc, stagingBuffer.buffer, stagingBuffer.allocation);
-
+      queueBufferUpload(pDstBuffer, pData, dataSize, offset);
       break;
     }
   }
@@ -476,23 +467,147 @@ void core::MRenderer::copyDataToBuffer(void* pData, VkDeviceSize dataSize, RBuff
   // TODO: add other buffer types
 }
 
-// Runs in a dedicated thread
-void core::MRenderer::updateInstanceBuffer() {
-  std::vector<RInstanceData> instanceData(scene.totalInstances);
+// Runs in a job, joined before the frame is recorded
+void core::MRenderer::updateInstanceBuffer(const uint32_t frameIndex) {
+  RE_PROFILE_SCOPE("Update instance buffer");
+
+  const bool isSkinningEnabled = skinning.isEnabled;
+
+  cullOccludedEntities(frameIndex);
+  updateShadowCascades(frameIndex);
+
+  // cascades rendered this frame get their own copies of caster instances
+  // if the instance buffer can fit them, otherwise they draw all instances
+  // as dynamic casters
+  const uint32_t cascadeCount = shadows.cascades.getCascadeCount();
+  const uint32_t cascadeMask = shadows.updateMasks[frameIndex];
+  uint32_t cascadeUpdates = 0u;
+
+  for (uint32_t cascadeIndex = 0; cascadeIndex < cascadeCount; ++cascadeIndex) {
+    cascadeUpdates += (cascadeMask >> cascadeIndex) & 1u;
+  }
+
+  const bool isCullingCascades =
+      scene.totalInstances * (1u + cascadeUpdates) <= config::scene::nodeBudget;
+
+  std::vector<RInstanceData> instanceData(
+      scene.totalInstances * (isCullingCascades ? 1u + cascadeUpdates : 1u));
+
+  skinning.scheduler.reset(static_cast<uint32_t>(config::scene::skinnedVertexBudget));
 
   uint32_t index = 0u;
   for (auto& model : scene.pModelReferences) {
     for (auto& primitive : model->m_pLinearPrimitives) {
-      for (auto& instanceDataEntry : primitive->instanceData) {
-        if (instanceDataEntry.isVisible) {
-          instanceData[index] = instanceDataEntry.instanceBufferBlock;
+      const WModel::Node* pNode = reinterpret_cast<WModel::Node*>(primitive->pOwnerNode);
+      const bool isSkinned = isSkinningEnabled && model->m_sceneGeometryPage > -1 &&
+                             pNode && pNode->skinIndex > -1;
+      const uint32_t vertexOffset = model->m_sceneVertexOffset + primitive->vertexOffset;
+
+      auto& instanceRange = primitive->instanceRanges[frameIndex];
+      instanceRange.firstInstance = index;
+
+      // hidden instances are still skinned, shadow passes draw them
+      for (const bool isPackingHidden : {false, true}) {
+        for (auto& instanceDataEntry : primitive->instanceData) {
+          const bool isEntityVisible =
+              instanceDataEntry.bindingIndex < 0 ||
+              instanceDataEntry.bindingIndex >= static_cast<int32_t>(occlusion.entityVisibility.size()) ||
+              occlusion.entityVisibility[instanceDataEntry.bindingIndex];
+
+          if (!instanceDataEntry.isVisible || isEntityVisible == isPackingHidden) {
+            continue;
+          }
+
+          RInstanceData& instance = instanceData[index];
+          instance = instanceDataEntry.instanceBufferBlock;
           instanceDataEntry.instanceIndex = index;
           index++;
+
+          if (!isSkinned) {
+            continue;
+          }
+
+          // instances over the budget are skinned by their vertex shaders
+          const uint32_t skinnedVertexOffset = skinning.scheduler.schedule(
+              static_cast<uint32_t>(model->m_sceneGeometryPage), vertexOffset,
+              primitive->vertexCount, static_cast<uint32_t>(instance.skinMatrixId));
+
+          if (skinnedVertexOffset != RSkinningScheduler::invalidOffset) {
+            instance.skinnedVertexBase =
+                static_cast<int32_t>(skinnedVertexOffset) - static_cast<int32_t>(vertexOffset);
+          }
+        }
+
+        if (!isPackingHidden) {
+          instanceRange.visibleCount = index - instanceRange.firstInstance;
+        }
+      }
+
+      instanceRange.count = index - instanceRange.firstInstance;
+    }
+  }
+
+  cullMeshlets(frameIndex);
+
+  // static casters drawn as dynamic ones leave the cache empty
+  if (!isCullingCascades && cascadeMask) {
+    shadows.cascades.invalidateStaticCache();
+  }
+
+  for (uint32_t cascadeIndex = 0; cascadeIndex < cascadeCount; ++cascadeIndex) {
+    if (!(cascadeMask & (1u << cascadeIndex))) continue;
+
+    for (auto& model : scene.pModelReferences) {
+      for (auto& primitive : model->m_pLinearPrimitives) {
+        const auto& instanceRange = primitive->instanceRanges[frameIndex];
+        auto& cascadeRange = primitive->cascadeRanges[frameIndex][cascadeIndex];
+
+        if (!isCullingCascades) {
+          cascadeRange.firstInstance = instanceRange.firstInstance;
+          cascadeRange.staticCount = 0u;
+          cascadeRange.count = instanceRange.count;
+          continue;
         }
+
+        cascadeRange.firstInstance = index;
+
+        // copies keep the skinned vertices of the packed instance, static
+        // casters are packed before dynamic ones
+        for (const bool isPackingStatic : {true, false}) {
+          for (const auto& instanceDataEntry : primitive->instanceData) {
+            const int32_t bindingIndex = instanceDataEntry.bindingIndex;
+            const bool isBound =
+                bindingIndex > -1 && bindingIndex < static_cast<int32_t>(shadows.entityCascades.size());
+            const bool isCaster =
+                !isBound || (shadows.entityCascades[bindingIndex] & (1u << cascadeIndex));
+            const bool isStatic = isBound && shadows.entityStatic[bindingIndex];
+
+            if (!instanceDataEntry.isVisible || !isCaster || isStatic != isPackingStatic) continue;
+
+            instanceData[index++] = instanceData[instanceDataEntry.instanceIndex];
+          }
+
+          if (isPackingStatic) {
+            cascadeRange.staticCount = index - cascadeRange.firstInstance;
+          }
+        }
+
+        cascadeRange.count = index - cascadeRange.firstInstance;
       }
     }
   }
 
-  memcpy(scene.instanceBuffers[renderView.frameInFlight].allocInfo.pMappedData,
+  skinning.scheduler.finalize();
+
+  const std::vector<RSkinningBatch>& batches = skinning.scheduler.getBatches();
+
+  if (!batches.empty()) {
+    memcpy(skinning.batchBuffers[frameIndex].allocInfo.pMappedData, batches.data(),
+           sizeof(RSkinningBatch) * batches.size());
+  }
+
+  memcpy(scene.instanceBuffers[frameIndex].allocInfo.pMappedData,
          instanceData.data(), sizeof(RInstanceData) * instanceData.size());
+
+  skinning.dispatches[frameIndex] = skinning.scheduler.getDispatches();
 }
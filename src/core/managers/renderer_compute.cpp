@@ -260,4 +260,56 @@ void core::MRenderer::executeQueuedComputeJobs() {
   compute.jobs.erase(compute.jobs.begin());
 
   flushCommandBuffer(command.buffersCompute[renderView.frameInFlight], ECmdType::Compute);
-}
\ No newline at end of file
+}
+
+void core::MRenderer::executeSkinningPass(VkCommandBuffer commandBuffer,
+                                          const uint32_t frameIndex) {
+  // vertex shaders of all passes find the skinned vertices through this address
+  scene.vertexPushBlock.skinnedVertexAddress = skinning.vertexBuffers[frameIndex].deviceAddress;
+
+  // written by the instance buffer update, which is joined before recording
+  const std::vector<RSkinningDispatch>& dispatches = skinning.dispatches[frameIndex];
+
+  if (dispatches.empty()) {
+    return;
+  }
+
+  // guaranteed minimum of the maximum workgroup count
+  constexpr uint32_t maxGroupCount = 65535u;
+
+  VkPipelineLayout layout = getPipelineLayout(EPipelineLayout::ComputeSkinning);
+
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+    getComputePipeline(EComputePipeline::Skinning));
+
+  RComputeSkinningPCB pushBlock;
+  pushBlock.skinnedVertexAddress = skinning.vertexBuffers[frameIndex].deviceAddress;
+  pushBlock.skinAddress = scene.skinTransformBuffer.deviceAddress;
+
+  for (const RSkinningDispatch& dispatch : dispatches) {
+    if (dispatch.pageIndex >= static_cast<uint32_t>(scene.geometryPages.size())) {
+      continue;
+    }
+
+    pushBlock.vertexAddress = scene.geometryPages[dispatch.pageIndex].vertexBuffer.deviceAddress;
+
+    // every workgroup skins a single batch
+    for (uint32_t batch = 0u; batch < dispatch.batchCount; batch += maxGroupCount) {
+      pushBlock.batchAddress = skinning.batchBuffers[frameIndex].deviceAddress +
+                               sizeof(RSkinningBatch) * (dispatch.firstBatch + batch);
+
+      vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+        sizeof(RComputeSkinningPCB), &pushBlock);
+
+      vkCmdDispatch(commandBuffer, std::min(dispatch.batchCount - batch, maxGroupCount), 1, 1);
+    }
+  }
+
+  VkMemoryBarrier memoryBarrier{};
+  memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+}
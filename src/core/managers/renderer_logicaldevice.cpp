@@ -29,11 +29,17 @@ TResult core::MRenderer::initLogicalDevice(
   multiviewFeatures.multiviewGeometryShader = VK_FALSE;
   multiviewFeatures.multiviewTessellationShader = VK_FALSE;
 
+  // Vulkan 1.2: Enabling timeline semaphores, used for tracking uploads
+  VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+  timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+  timelineFeatures.timelineSemaphore = VK_TRUE;
+  timelineFeatures.pNext = &multiviewFeatures;
+
   // Vulkan 1.3 Enabling synchronization2 feature
   VkPhysicalDeviceSynchronization2Features sync2Features{};
   sync2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
   sync2Features.synchronization2 = VK_TRUE;
-  sync2Features.pNext = &multiviewFeatures;
+  sync2Features.pNext = &timelineFeatures;
 
   // Vulkan 1.3: Enabling descriptor indexing
   VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{};
@@ -86,19 +86,19 @@ TResult core::MRenderer::createDynamicRenderingPass(EDynamicRenderingPass passId
   pRenderPass->transitionDepthAttachmentLayout = pInfo->layoutInfo.transitionDepthAttachmentLayout;
   pRenderPass->colorAttachmentsOutLayout = pInfo->layoutInfo.colorAttachmentsOutLayout;
 
-  // Pipeline creation
-  std::vector<VkFormat> colorAttachmentFormats(colorAttachmentCount);
+  // Pipeline creation, pipelines of all passes are created together
+  RGraphicsPipelineInfo pipelineInfo{};
+  pipelineInfo.colorAttachmentFormats.resize(colorAttachmentCount);
 
   for (uint32_t j = 0; j < colorAttachmentCount; ++j) {
-    colorAttachmentFormats[j] = pInfo->colorAttachments[j].format;
+    pipelineInfo.colorAttachmentFormats[j] = pInfo->colorAttachments[j].format;
   }
 
-  VkPipelineRenderingCreateInfo pipelineCreateInfo{};
+  VkPipelineRenderingCreateInfo& pipelineCreateInfo = pipelineInfo.renderingInfo;
   pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
   pipelineCreateInfo.viewMask = 0;
 
   if (colorAttachmentCount) {
-    pipelineCreateInfo.pColorAttachmentFormats = colorAttachmentFormats.data();
     pipelineCreateInfo.colorAttachmentCount = (pInfo->singleColorAttachmentAtRuntime) ? 1u : colorAttachmentCount;
   }
 
@@ -110,9 +110,7 @@ TResult core::MRenderer::createDynamicRenderingPass(EDynamicRenderingPass passId
     pipelineCreateInfo.stencilAttachmentFormat = pInfo->stencilAttachment.format;
   }
 
-  RGraphicsPipelineInfo pipelineInfo{};
   pipelineInfo.pRenderPass = pRenderPass;
-  pipelineInfo.pDynamicPipelineInfo = &pipelineCreateInfo;
   pipelineInfo.vertexShader = pInfo->vertexShader;
   pipelineInfo.geometryShader = pInfo->geometryShader;
   pipelineInfo.fragmentShader = pInfo->fragmentShader;
@@ -126,7 +124,7 @@ TResult core::MRenderer::createDynamicRenderingPass(EDynamicRenderingPass passId
   // Hacky way of copying depth bias settings without defining a whole new struct
   memcpy(&pipelineInfo.depthBias, &pInfo->pipelineInfo.depthBias, sizeof(pInfo->pipelineInfo.depthBias));
 
-  RE_CHECK(createGraphicsPipeline(&pipelineInfo));
+  system.pendingPipelines.emplace_back(std::move(pipelineInfo));
 
   RE_LOG(Log, "Created dynamic rendering pass E%d.", passId);
   return RE_OK;
@@ -410,7 +408,7 @@ TResult core::MRenderer::createDynamicRenderingPasses() {
     createDynamicRenderingPass(EDynamicRenderingPass::Present, &info);
   }
 
-  return RE_OK;
+  return createPendingGraphicsPipelines();
 }
 
 RDynamicRenderingPass* core::MRenderer::getDynamicRenderingPass(EDynamicRenderingPass type) {
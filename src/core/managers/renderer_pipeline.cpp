@@ -1,9 +1,133 @@
 #include "pch.h"
 #include "vk_mem_alloc.h"
 #include "core/core.h"
+#include "core/managers/jobs.h"
 #include "core/managers/resources.h"
 #include "core/managers/renderer.h"
 
+namespace {
+// precedes Vulkan pipeline cache data in the file, the cache is only used on
+// the same device and driver it was created with
+struct RPipelineCacheHeader {
+  uint32_t magic = 0x43504552;   // "REPC"
+  uint32_t vendorID = 0u;
+  uint32_t deviceID = 0u;
+  uint32_t driverVersion = 0u;
+  uint8_t deviceUUID[VK_UUID_SIZE]{};
+  uint8_t pipelineCacheUUID[VK_UUID_SIZE]{};
+  uint64_t dataSize = 0u;
+  uint64_t dataHash = 0u;
+};
+
+RPipelineCacheHeader getPipelineCacheHeader(VkPhysicalDevice physicalDevice) {
+  VkPhysicalDeviceIDProperties idProperties{};
+  idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+  VkPhysicalDeviceProperties2 properties{};
+  properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties.pNext = &idProperties;
+
+  vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+  RPipelineCacheHeader header{};
+  header.vendorID = properties.properties.vendorID;
+  header.deviceID = properties.properties.deviceID;
+  header.driverVersion = properties.properties.driverVersion;
+  memcpy(header.deviceUUID, idProperties.deviceUUID, VK_UUID_SIZE);
+  memcpy(header.pipelineCacheUUID, properties.properties.pipelineCacheUUID,
+         VK_UUID_SIZE);
+
+  return header;
+}
+}  // namespace
+
+TResult core::MRenderer::createPipelineCache() {
+  const RPipelineCacheHeader deviceHeader =
+      getPipelineCacheHeader(physicalDevice.device);
+
+  std::vector<char> fileData;
+
+  if (std::filesystem::exists(RE_PATH_PIPELINECACHE)) {
+    fileData = util::readFile(std::string(RE_PATH_PIPELINECACHE));
+  }
+
+  VkPipelineCacheCreateInfo cacheInfo{};
+  cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+  if (fileData.size() >= sizeof(RPipelineCacheHeader)) {
+    RPipelineCacheHeader fileHeader;
+    memcpy(&fileHeader, fileData.data(), sizeof(RPipelineCacheHeader));
+
+    const char* pCacheData = fileData.data() + sizeof(RPipelineCacheHeader);
+    const size_t cacheSize = fileData.size() - sizeof(RPipelineCacheHeader);
+
+    const bool isCompatible =
+        fileHeader.magic == deviceHeader.magic &&
+        fileHeader.vendorID == deviceHeader.vendorID &&
+        fileHeader.deviceID == deviceHeader.deviceID &&
+        fileHeader.driverVersion == deviceHeader.driverVersion &&
+        !memcmp(fileHeader.deviceUUID, deviceHeader.deviceUUID, VK_UUID_SIZE) &&
+        !memcmp(fileHeader.pipelineCacheUUID, deviceHeader.pipelineCacheUUID,
+                VK_UUID_SIZE);
+
+    if (!isCompatible) {
+      RE_LOG(Log, "Pipeline cache was created by a different device or driver, discarding it.");
+    } else if (fileHeader.dataSize != cacheSize ||
+               fileHeader.dataHash != util::hashData(pCacheData, cacheSize)) {
+      RE_LOG(Warning, "Pipeline cache file is corrupted, discarding it.");
+    } else {
+      cacheInfo.initialDataSize = cacheSize;
+      cacheInfo.pInitialData = pCacheData;
+    }
+  }
+
+  if (vkCreatePipelineCache(logicalDevice.device, &cacheInfo, nullptr,
+                            &system.pipelineCache) != VK_SUCCESS) {
+    // pipelines can still be created without a cache
+    RE_LOG(Warning, "Failed to create pipeline cache.");
+    system.pipelineCache = VK_NULL_HANDLE;
+    return RE_WARNING;
+  }
+
+  RE_LOG(Log, "Created pipeline cache, %d bytes were loaded from disk.",
+         static_cast<int32_t>(cacheInfo.initialDataSize));
+
+  return RE_OK;
+}
+
+void core::MRenderer::savePipelineCache() {
+  if (system.pipelineCache == VK_NULL_HANDLE) {
+    return;
+  }
+
+  size_t cacheSize = 0u;
+  vkGetPipelineCacheData(logicalDevice.device, system.pipelineCache, &cacheSize,
+                         nullptr);
+
+  std::vector<char> fileData(sizeof(RPipelineCacheHeader) + cacheSize);
+  char* pCacheData = fileData.data() + sizeof(RPipelineCacheHeader);
+
+  if (cacheSize == 0u ||
+      vkGetPipelineCacheData(logicalDevice.device, system.pipelineCache,
+                             &cacheSize, pCacheData) != VK_SUCCESS) {
+    RE_LOG(Warning, "Failed to retrieve pipeline cache data.");
+    return;
+  }
+
+  RPipelineCacheHeader header = getPipelineCacheHeader(physicalDevice.device);
+  header.dataSize = cacheSize;
+  header.dataHash = util::hashData(pCacheData, cacheSize);
+  memcpy(fileData.data(), &header, sizeof(RPipelineCacheHeader));
+
+  util::writeFile(RE_PATH_PIPELINECACHE, "", fileData.data(),
+                  static_cast<int32_t>(fileData.size()));
+}
+
+void core::MRenderer::destroyPipelineCache() {
+  vkDestroyPipelineCache(logicalDevice.device, system.pipelineCache, nullptr);
+  system.pipelineCache = VK_NULL_HANDLE;
+}
+
 TResult core::MRenderer::createPipelineLayouts() {
   RE_LOG(Log, "Creating graphics pipelines.");
 
@@ -119,6 +243,33 @@ TResult core::MRenderer::createPipelineLayouts() {
     return RE_CRITICAL;
   }
 
+#ifndef NDEBUG
+  RE_LOG(Log, "Creating pipeline layout for \"Compute Skinning\".");
+#endif
+
+  // all skinning buffers are accessed through their device addresses
+  layoutType = EPipelineLayout::ComputeSkinning;
+  system.layouts.emplace(layoutType, VK_NULL_HANDLE);
+
+  VkPushConstantRange computeSkinningPushConstRange{};
+  computeSkinningPushConstRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+  computeSkinningPushConstRange.offset = 0;
+  computeSkinningPushConstRange.size = sizeof(RComputeSkinningPCB);
+
+  layoutInfo = VkPipelineLayoutCreateInfo{};
+  layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  layoutInfo.setLayoutCount = 0;
+  layoutInfo.pSetLayouts = nullptr;
+  layoutInfo.pushConstantRangeCount = 1;
+  layoutInfo.pPushConstantRanges = &computeSkinningPushConstRange;
+
+  if (vkCreatePipelineLayout(logicalDevice.device, &layoutInfo, nullptr,
+                             &getPipelineLayout(layoutType)) != VK_SUCCESS) {
+    RE_LOG(Critical, "Failed to create \"Compute Skinning\" pipeline layout.");
+
+    return RE_CRITICAL;
+  }
+
   return RE_OK;
 }
 
@@ -153,7 +304,7 @@ TResult core::MRenderer::createComputePipelines() {
     system.computePipelines.emplace(EComputePipeline::ImageLUT, VK_NULL_HANDLE);
 
     if (vkCreateComputePipelines(
-            logicalDevice.device, VK_NULL_HANDLE, 1, &computePipelineInfo,
+            logicalDevice.device, system.pipelineCache, 1, &computePipelineInfo,
             nullptr,
             &getComputePipeline(EComputePipeline::ImageLUT)) != VK_SUCCESS) {
       RE_LOG(Critical, "Failed to create Compute Image 'BRDF LUT' pipeline.");
@@ -161,7 +312,6 @@ TResult core::MRenderer::createComputePipelines() {
       return RE_CRITICAL;
     }
 
-    vkDestroyShaderModule(logicalDevice.device, shaderStage.module, nullptr);
   }
 
   //
@@ -183,7 +333,7 @@ TResult core::MRenderer::createComputePipelines() {
       VK_NULL_HANDLE);
 
     if (vkCreateComputePipelines(
-      logicalDevice.device, VK_NULL_HANDLE, 1, &computePipelineInfo,
+      logicalDevice.device, system.pipelineCache, 1, &computePipelineInfo,
       nullptr, &getComputePipeline(EComputePipeline::ImageEnvIrradiance)) !=
       VK_SUCCESS) {
       RE_LOG(Critical, "Failed to create Compute Image 'Environment Irradiance' pipeline.");
@@ -191,7 +341,6 @@ TResult core::MRenderer::createComputePipelines() {
       return RE_CRITICAL;
     }
 
-    vkDestroyShaderModule(logicalDevice.device, shaderStage.module, nullptr);
   }
 
   //
@@ -213,7 +362,7 @@ TResult core::MRenderer::createComputePipelines() {
       VK_NULL_HANDLE);
 
     if (vkCreateComputePipelines(
-      logicalDevice.device, VK_NULL_HANDLE, 1, &computePipelineInfo,
+      logicalDevice.device, system.pipelineCache, 1, &computePipelineInfo,
       nullptr, &getComputePipeline(EComputePipeline::ImageEnvFilter)) !=
       VK_SUCCESS) {
       RE_LOG(Critical, "Failed to create Compute Image 'Environment Prefiltered' pipeline.");
@@ -221,7 +370,34 @@ TResult core::MRenderer::createComputePipelines() {
       return RE_CRITICAL;
     }
 
-    vkDestroyShaderModule(logicalDevice.device, shaderStage.module, nullptr);
+  }
+
+  //
+  // Compute pipeline for skinning vertices once per frame before rendering
+  //
+  {
+    VkPipelineShaderStageCreateInfo shaderStage =
+      loadShader("cs_skinning.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+
+    VkComputePipelineCreateInfo computePipelineInfo{};
+    computePipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    computePipelineInfo.layout =
+      getPipelineLayout(EPipelineLayout::ComputeSkinning);
+    computePipelineInfo.stage = shaderStage;
+    computePipelineInfo.flags = 0;
+
+    system.computePipelines.emplace(EComputePipeline::Skinning,
+      VK_NULL_HANDLE);
+
+    if (vkCreateComputePipelines(
+      logicalDevice.device, system.pipelineCache, 1, &computePipelineInfo,
+      nullptr, &getComputePipeline(EComputePipeline::Skinning)) !=
+      VK_SUCCESS) {
+      RE_LOG(Critical, "Failed to create Compute 'Skinning' pipeline.");
+
+      return RE_CRITICAL;
+    }
+
   }
 
   return RE_OK;
@@ -235,7 +411,13 @@ void core::MRenderer::destroyComputePipelines() {
 
 TResult core::MRenderer::createGraphicsPipeline(RGraphicsPipelineInfo* pipelineInfo) {
   RDynamicRenderingPass* pRenderPass = pipelineInfo->pRenderPass;
-  const uint32_t colorAttachmentCount = pipelineInfo->pDynamicPipelineInfo->colorAttachmentCount;
+  const uint32_t colorAttachmentCount = pipelineInfo->renderingInfo.colorAttachmentCount;
+
+  // formats are owned by the pipeline info which may have been moved
+  pipelineInfo->renderingInfo.pColorAttachmentFormats =
+      pipelineInfo->colorAttachmentFormats.empty()
+          ? nullptr
+          : pipelineInfo->colorAttachmentFormats.data();
 
   VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
   inputAssemblyInfo.sType =
@@ -354,6 +536,14 @@ TResult core::MRenderer::createGraphicsPipeline(RGraphicsPipelineInfo* pipelineI
                                          VK_SHADER_STAGE_FRAGMENT_BIT));
   }
 
+  for (const auto& stage : shaderStages) {
+    if (stage.module == VK_NULL_HANDLE) {
+      RE_LOG(Critical, "Failed to create pipeline for dynamic render pass E%d. Shader is missing.",
+             pRenderPass->passId);
+      return RE_CRITICAL;
+    }
+  }
+
   if (shaderStages.empty()) {
     RE_LOG(Critical, "Failed to create pipeline for dynamic render pass E%d. No shaders were loaded.",
            pRenderPass->passId);
@@ -377,10 +567,10 @@ TResult core::MRenderer::createGraphicsPipeline(RGraphicsPipelineInfo* pipelineI
   graphicsPipelineInfo.subpass = 0u;
   graphicsPipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
   graphicsPipelineInfo.basePipelineIndex = -1;
-  graphicsPipelineInfo.pNext = pipelineInfo->pDynamicPipelineInfo;
+  graphicsPipelineInfo.pNext = &pipelineInfo->renderingInfo;
 
   if (vkCreateGraphicsPipelines(
-          logicalDevice.device, VK_NULL_HANDLE, 1, &graphicsPipelineInfo,
+          logicalDevice.device, system.pipelineCache, 1, &graphicsPipelineInfo,
           nullptr,
           &pRenderPass->pipeline) != VK_SUCCESS) {
     RE_LOG(Critical, "Failed to create pipeline for dynamic rendering pass E%d.", pRenderPass->passId);
@@ -388,11 +578,59 @@ TResult core::MRenderer::createGraphicsPipeline(RGraphicsPipelineInfo* pipelineI
     return RE_CRITICAL;
   }
 
-  for (auto& stage : shaderStages) {
-    vkDestroyShaderModule(logicalDevice.device, stage.module, nullptr);
+  return RE_OK;
+}
+
+TResult core::MRenderer::createPendingGraphicsPipelines() {
+  std::vector<RGraphicsPipelineInfo>& pipelineInfos = system.pendingPipelines;
+
+  if (pipelineInfos.empty()) {
+    return RE_OK;
   }
 
-  return RE_OK;
+  // driver compiles pipelines, creating them in parallel scales with cores
+  std::vector<TResult> results(pipelineInfos.size(), RE_OK);
+  std::vector<std::string> errors(pipelineInfos.size());
+
+  core::jobs.parallelFor(
+      static_cast<uint32_t>(pipelineInfos.size()), 1u,
+      [&](const uint32_t begin, const uint32_t end) {
+        for (uint32_t index = begin; index < end; ++index) {
+          RE_PROFILE_SCOPE("Create graphics pipeline");
+
+          // critical errors throw, an exception leaving a job worker would
+          // terminate the program, so it is reported by the calling thread
+          try {
+            results[index] = createGraphicsPipeline(&pipelineInfos[index]);
+          } catch (const std::exception& exception) {
+            results[index] = RE_CRITICAL;
+            errors[index] = exception.what();
+          }
+        }
+      });
+
+#ifndef NDEBUG
+  RE_LOG(Log, "Created %d graphics pipelines using %d job workers.",
+         static_cast<int32_t>(pipelineInfos.size()), core::jobs.getWorkerCount());
+#endif
+
+  TResult result = RE_OK;
+
+  for (size_t index = 0; index < results.size(); ++index) {
+    if (results[index] == RE_OK) continue;
+
+    RE_LOG(Error, "Failed to create graphics pipeline for dynamic rendering pass E%d. %s",
+           pipelineInfos[index].pRenderPass
+               ? static_cast<int32_t>(pipelineInfos[index].pRenderPass->passId)
+               : -1,
+           errors[index].c_str());
+
+    result = RE_CRITICAL;
+  }
+
+  pipelineInfos.clear();
+
+  return result;
 }
 
 VkPipeline& core::MRenderer::getComputePipeline(EComputePipeline type) {
@@ -16,27 +16,90 @@ void core::MRenderer::drawBoundEntities(VkCommandBuffer commandBuffer, EDynamicR
     passOverride = renderView.pCurrentPass->passId;
   }
 
+  // cascade index and the address of vertices skinned for this frame
+  vkCmdPushConstants(commandBuffer, renderView.pCurrentPass->layout, VK_SHADER_STAGE_VERTEX_BIT, 0u,
+                     sizeof(RSceneVertexPCB), &scene.vertexPushBlock);
+
+  // instances hidden from the main camera still cast shadows and may be seen by other views
+  const bool isShadowPass =
+      passOverride & (EDynamicRenderingPass::Shadow | EDynamicRenderingPass::ShadowDiscard);
+  const bool drawHiddenInstances =
+      isShadowPass || view.pActiveCamera != occlusion.pCameras[renderView.frameInFlight];
+  const int32_t cascadeIndex =
+      isShadowPass ? static_cast<int32_t>(scene.vertexPushBlock.cascadeIndex) : -1;
+
   for (WModel* pModel : scene.pModelReferences) {
     auto& primitives = pModel->getPrimitives();
 
+    if (pModel->m_sceneGeometryPage < 0) continue;
+
+    bindGeometryPage(commandBuffer, pModel->m_sceneGeometryPage);
+
     for (const auto& primitive : primitives) {
       if (!checkPass(primitive->pInitialMaterial->passFlags, passOverride)) continue;
 
-      renderPrimitive(commandBuffer, primitive, pModel);
+      renderPrimitive(commandBuffer, primitive, pModel, drawHiddenInstances, cascadeIndex);
     }
   }
 }
 
+void core::MRenderer::bindGeometryPage(VkCommandBuffer commandBuffer,
+                                       const uint32_t pageIndex) {
+  if (renderView.boundGeometryPage == static_cast<int32_t>(pageIndex)) return;
+
+  VkDeviceSize vbOffset = 0u;
+  vkCmdBindVertexBuffers(commandBuffer, 0, 1,
+                         &scene.geometryPages[pageIndex].vertexBuffer.buffer,
+                         &vbOffset);
+  vkCmdBindIndexBuffer(commandBuffer,
+                       scene.geometryPages[pageIndex].indexBuffer.buffer, 0,
+                       VK_INDEX_TYPE_UINT32);
+
+  renderView.boundGeometryPage = static_cast<int32_t>(pageIndex);
+}
+
 void core::MRenderer::renderPrimitive(VkCommandBuffer cmdBuffer,
                                       WPrimitive* pPrimitive,
-                                      WModel* pModel) {
-  uint32_t instanceCount = static_cast<uint32_t>(pPrimitive->instanceData.size());
+                                      WModel* pModel,
+                                      const bool drawHiddenInstances,
+                                      const int32_t cascadeIndex) {
+  const auto& instanceRange = pPrimitive->instanceRanges[renderView.frameInFlight];
+  uint32_t firstInstance = instanceRange.firstInstance;
+  uint32_t instanceCount = drawHiddenInstances ? instanceRange.count : instanceRange.visibleCount;
+
+  if (cascadeIndex > -1) {
+    const auto& cascadeRange = pPrimitive->cascadeRanges[renderView.frameInFlight][cascadeIndex];
+    firstInstance = cascadeRange.firstInstance;
+    instanceCount = cascadeRange.count;
+
+    if (renderView.shadowCasters == EShadowCasters::Static) {
+      instanceCount = cascadeRange.staticCount;
+    } else if (renderView.shadowCasters == EShadowCasters::Dynamic) {
+      firstInstance += cascadeRange.staticCount;
+      instanceCount -= cascadeRange.staticCount;
+    }
+  }
+
+  if (instanceCount == 0u) return;
+
   int32_t vertexOffset = (int32_t)pModel->m_sceneVertexOffset + (int32_t)pPrimitive->vertexOffset;
   uint32_t indexOffset = pModel->m_sceneIndexOffset + pPrimitive->indexOffset;
 
-  VkDeviceSize instanceOffset = sizeof(RInstanceData) * pPrimitive->instanceData[0].instanceIndex;
+  VkDeviceSize instanceOffset = sizeof(RInstanceData) * firstInstance;
   vkCmdBindVertexBuffers(cmdBuffer, 1, 1, &scene.instanceBuffers[renderView.frameInFlight].buffer, &instanceOffset);
 
+  // views of the main camera draw meshlets visible to any of the instances it sees
+  const auto& meshletRange = pPrimitive->meshletRanges[renderView.frameInFlight];
+
+  if (cascadeIndex < 0 && meshletRange.isValid && instanceCount == instanceRange.visibleCount &&
+      view.pActiveCamera == meshlets.pCameras[renderView.frameInFlight]) {
+    for (const glm::uvec2& indexRange : meshletRange.indexRanges) {
+      vkCmdDrawIndexed(cmdBuffer, indexRange.y, instanceCount, indexOffset + indexRange.x, vertexOffset, 0);
+    }
+
+    return;
+  }
+
   // TODO: implement draw indirect
   vkCmdDrawIndexed(cmdBuffer, pPrimitive->indexCount, instanceCount, indexOffset, vertexOffset, 0);
 }
@@ -203,10 +266,10 @@ void core::MRenderer::prepareFrameResources(VkCommandBuffer commandBuffer) {
   memcpy(scene.transparencyLinkedListDataBuffer.allocInfo.pMappedData, &scene.transparencyLinkedListData, sizeof(uint32_t));*/
 
   VkDeviceSize vbOffset = 0u;
-  vkCmdBindVertexBuffers(commandBuffer, 0, 1, &scene.vertexBuffer.buffer, &vbOffset);
   vkCmdBindVertexBuffers(commandBuffer, 1, 1, &scene.instanceBuffers[renderView.frameInFlight].buffer, &vbOffset);
 
-  vkCmdBindIndexBuffer(commandBuffer, scene.indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+  renderView.boundGeometryPage = -1;
+  bindGeometryPage(commandBuffer, 0u);
 
   uint32_t transformOffsets[3] = { 0u, 0u, 0u };
   vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -222,30 +285,87 @@ void core::MRenderer::prepareFrameResources(VkCommandBuffer commandBuffer) {
   vkCmdFillBuffer(commandBuffer, scene.transparencyLinkedListBuffer.buffer, 0, sizeof(uint32_t), 0);
 }
 
-void core::MRenderer::executeShadowPass(VkCommandBuffer commandBuffer, const uint32_t cascadeIndex) {
+void core::MRenderer::executeShadowCascades(VkCommandBuffer commandBuffer) {
+  const uint32_t cascadeMask = shadows.updateMasks[renderView.frameInFlight];
+  const uint32_t cacheMask = shadows.cacheMasks[renderView.frameInFlight];
+
+  RTexture* pShadowTexture = getDynamicRenderingPass(EDynamicRenderingPass::Shadow)->pImageReferences[0];
+  RTexture* pCacheTexture = shadows.pStaticCache;
+
+  // only cascades scheduled for this frame are rendered, the rest of the
+  // layers keep their contents through the layout transitions
+  VkImageSubresourceRange subRange{};
+  subRange.aspectMask = pShadowTexture->texture.aspectMask;
+  subRange.baseArrayLayer = 0u;
+  subRange.layerCount = pShadowTexture->texture.layerCount;
+  subRange.baseMipLevel = 0u;
+  subRange.levelCount = pShadowTexture->texture.levelCount;
+
+  // Static casters of cascades with outdated caches
+  if (cacheMask) {
+    setImageLayout(commandBuffer, pCacheTexture, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, subRange);
+
+    for (uint32_t cascadeIndex = 0; cascadeIndex < config::shadowCascades; ++cascadeIndex) {
+      if (cacheMask & (1u << cascadeIndex)) {
+        executeShadowPass(commandBuffer, pCacheTexture, cascadeIndex, EShadowCasters::Static, true);
+      }
+    }
+  }
+
+  // Cached static casters are the base of the rendered cascades
+  setImageLayout(commandBuffer, pCacheTexture, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, subRange);
+  setImageLayout(commandBuffer, pShadowTexture, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subRange);
+
+  VkImageCopy copyRegions[RE_MAXCASCADES];
+  uint32_t copyRegionCount = 0u;
+
+  for (uint32_t cascadeIndex = 0; cascadeIndex < config::shadowCascades; ++cascadeIndex) {
+    if (!(cascadeMask & (1u << cascadeIndex))) continue;
+
+    VkImageCopy& copyRegion = copyRegions[copyRegionCount++];
+    copyRegion = VkImageCopy{};
+    copyRegion.srcSubresource.aspectMask = pShadowTexture->texture.aspectMask;
+    copyRegion.srcSubresource.mipLevel = 0u;
+    copyRegion.srcSubresource.baseArrayLayer = cascadeIndex;
+    copyRegion.srcSubresource.layerCount = 1u;
+    copyRegion.dstSubresource = copyRegion.srcSubresource;
+    copyRegion.extent = {pShadowTexture->texture.width, pShadowTexture->texture.height, 1u};
+  }
+
+  vkCmdCopyImage(commandBuffer, pCacheTexture->texture.image, pCacheTexture->texture.imageLayout,
+                 pShadowTexture->texture.image, pShadowTexture->texture.imageLayout,
+                 copyRegionCount, copyRegions);
+
+  // Dynamic casters over the static ones
+  setImageLayout(commandBuffer, pShadowTexture, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, subRange);
+
+  for (uint32_t cascadeIndex = 0; cascadeIndex < config::shadowCascades; ++cascadeIndex) {
+    if (cascadeMask & (1u << cascadeIndex)) {
+      executeShadowPass(commandBuffer, pShadowTexture, cascadeIndex, EShadowCasters::Dynamic, false);
+    }
+  }
+
+  setImageLayout(commandBuffer, pShadowTexture, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subRange);
+
+  renderView.shadowCasters = EShadowCasters::All;
+}
+
+void core::MRenderer::executeShadowPass(VkCommandBuffer commandBuffer, RTexture* pTarget,
+                                        const uint32_t cascadeIndex,
+                                        const EShadowCasters casters, const bool clearDepth) {
   RDynamicRenderingPass* pRenderPass = getDynamicRenderingPass(EDynamicRenderingPass::Shadow);
   renderView.pCurrentPass = pRenderPass;
+  renderView.shadowCasters = casters;
 
   VkRenderingAttachmentInfo overrideAttachment = *pRenderPass->renderingInfo.pDepthAttachment;
-  overrideAttachment.imageView = pRenderPass->pImageReferences[0]->texture.extraViews[cascadeIndex].imageView;
+  overrideAttachment.imageView = pTarget->texture.extraViews[cascadeIndex].imageView;
+  overrideAttachment.imageLayout = pTarget->texture.imageLayout;
+  overrideAttachment.loadOp = clearDepth ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
 
   VkRenderingInfo overrideInfo{};
   overrideInfo = pRenderPass->renderingInfo;
   overrideInfo.pDepthAttachment = &overrideAttachment;
 
-  if (cascadeIndex == 0u) {
-    RTexture* pShadowTexture = pRenderPass->pImageReferences[0];
-
-    VkImageSubresourceRange subRange{};
-    subRange.aspectMask = pShadowTexture->texture.aspectMask;
-    subRange.baseArrayLayer = 0u;
-    subRange.layerCount = pShadowTexture->texture.layerCount;
-    subRange.baseMipLevel = 0u;
-    subRange.levelCount = pShadowTexture->texture.levelCount;
-
-    setImageLayout(commandBuffer, pShadowTexture, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, subRange);
-  }
-
   scene.vertexPushBlock.cascadeIndex = cascadeIndex;
 
   vkCmdBeginRendering(commandBuffer, &overrideInfo);
@@ -261,9 +381,6 @@ void core::MRenderer::executeShadowPass(VkCommandBuffer commandBuffer, const uin
   vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderView.pCurrentPass->layout, 0,
     1, &renderView.pCurrentSet, 1, &dynamicOffset);
 
-  vkCmdPushConstants(commandBuffer, renderView.pCurrentPass->layout, VK_SHADER_STAGE_VERTEX_BIT, 0u,
-                     sizeof(RSceneVertexPCB), &scene.vertexPushBlock);
-
   drawBoundEntities(commandBuffer);
 
   // Discard shadow pass
@@ -273,19 +390,6 @@ void core::MRenderer::executeShadowPass(VkCommandBuffer commandBuffer, const uin
   drawBoundEntities(commandBuffer, EDynamicRenderingPass::ShadowDiscard);
 
   vkCmdEndRendering(commandBuffer);
-
-  if (cascadeIndex == config::shadowCascades - 1) {
-    RTexture* pShadowTexture = pRenderPass->pImageReferences[0];
-
-    VkImageSubresourceRange subRange{};
-    subRange.aspectMask = pShadowTexture->texture.aspectMask;
-    subRange.baseArrayLayer = 0u;
-    subRange.layerCount = pShadowTexture->texture.layerCount;
-    subRange.baseMipLevel = 0u;
-    subRange.levelCount = pShadowTexture->texture.levelCount;
-
-    setImageLayout(commandBuffer, pShadowTexture, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subRange);
-  }
 }
 
 void core::MRenderer::executeAOBlurPass(VkCommandBuffer commandBuffer) {
@@ -472,19 +576,33 @@ void core::MRenderer::executePostProcessGetExposurePass(VkCommandBuffer commandB
 void core::MRenderer::executePostProcessPass(VkCommandBuffer commandBuffer) {
   const uint8_t levelCount = postprocess.pBloomTexture->texture.levelCount;
   
-  executePostProcessTAAPass(commandBuffer);
-  executePostProcessGetExposurePass(commandBuffer);
+  {
+    RTimedScope timedScope(commandBuffer, "TAA");
+    executePostProcessTAAPass(commandBuffer);
+  }
+
+  {
+    RTimedScope timedScope(commandBuffer, "Exposure");
+    executePostProcessGetExposurePass(commandBuffer);
+  }
 
-  for (uint8_t downsampleIndex = 0; downsampleIndex < levelCount; ++downsampleIndex) {
-    executePostProcessSamplingPass(commandBuffer, downsampleIndex, false);
+  {
+    RTimedScope timedScope(commandBuffer, "Bloom downsample");
 
+    for (uint8_t downsampleIndex = 0; downsampleIndex < levelCount; ++downsampleIndex) {
+      executePostProcessSamplingPass(commandBuffer, downsampleIndex, false);
+    }
   }
 
   // Upsample from the lower mip level and write to the one above it
   // Thus the initial index is the next to last one
-  for (uint8_t upsampleIndex = levelCount - 1; upsampleIndex > 0; --upsampleIndex) {
-    executePostProcessSamplingPass(commandBuffer, upsampleIndex - 1, true);
-  };
+  {
+    RTimedScope timedScope(commandBuffer, "Bloom upsample");
+
+    for (uint8_t upsampleIndex = levelCount - 1; upsampleIndex > 0; --upsampleIndex) {
+      executePostProcessSamplingPass(commandBuffer, upsampleIndex - 1, true);
+    }
+  }
 }
 
 void core::MRenderer::executePresentPass(VkCommandBuffer commandBuffer) {
@@ -529,9 +647,36 @@ void core::MRenderer::executePresentPass(VkCommandBuffer commandBuffer) {
 void core::MRenderer::renderFrame() {
   TResult chkResult = RE_OK;
 
-  vkWaitForFences(logicalDevice.device, 1,
-    &sync.fenceInFlight[renderView.frameInFlight], VK_TRUE,
-    UINT64_MAX);
+  core::profiler.beginFrame();
+  RE_PROFILE_SCOPE("Frame");
+
+  {
+    RE_PROFILE_SCOPE("Wait for frame fence");
+    vkWaitForFences(logicalDevice.device, 1,
+      &sync.fenceInFlight[renderView.frameInFlight], VK_TRUE,
+      UINT64_MAX);
+  }
+
+  // GPU timings of the frame that used this frame in flight are available now
+  collectTimestamps();
+
+  // Entities, instances and culling results of this frame were prepared
+  // while the previous frame was presented
+  {
+    RE_PROFILE_SCOPE("Wait for entity update");
+    core::jobs.wait(&sync.frameUpdate);
+  }
+
+  updateMeshletStatistics(renderView.frameInFlight);
+
+  // ranges of destroyed models are returned once no frame in flight reads them,
+  // pages they leave fragmented are repacked before anything is recorded
+  retireGeometryReleases(false);
+
+  if (scene.isDefragmentationPending) {
+    RE_PROFILE_SCOPE("Defragment scene buffers");
+    defragmentSceneBuffers();
+  }
 
   VkResult APIResult =
     vkAcquireNextImageKHR(logicalDevice.device, swapChain, UINT64_MAX,
@@ -561,7 +706,10 @@ void core::MRenderer::renderFrame() {
 
   vkResetCommandBuffer(command.buffersGraphics[renderView.frameInFlight], NULL);
 
-  executeQueuedComputeJobs();
+  {
+    RE_PROFILE_SCOPE("Queued compute jobs");
+    executeQueuedComputeJobs();
+  }
 
   VkCommandBuffer cmdBuffer = command.buffersGraphics[renderView.frameInFlight];
 
@@ -571,6 +719,25 @@ void core::MRenderer::renderFrame() {
   // Use this frame's scene descriptor set
   renderView.pCurrentSet = scene.descriptorSets[renderView.frameInFlight];
 
+  {
+    RE_PROFILE_SCOPE("Update resources");
+
+    // Destroy textures and material slots of deleted materials
+    core::resources.destroyReleasedResources();
+
+    // Stream texture mip levels for this frame's view, new images are uploaded
+    // with the rest of this frame's data
+    updateTextureStreaming();
+
+    // Write bindless descriptors of textures registered since the last frame
+    core::resources.flushDescriptorWrites();
+
+    // Submit pending uploads, graphics queue orders this frame after them
+    flushUploads();
+  }
+
+  RE_PROFILE_SCOPE("Record commands");
+
   VkCommandBufferBeginInfo beginInfo{};
   beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
   beginInfo.pInheritanceInfo = nullptr;
@@ -582,22 +749,35 @@ void core::MRenderer::renderFrame() {
     return;
   }
 
+  resetTimestamps(cmdBuffer);
+
   // Prepare and bind per frame resources
   prepareFrameResources(cmdBuffer);
 
+  // Skin vertices once for all passes of the frame
+  {
+    RTimedScope timedScope(cmdBuffer, "Skinning");
+    executeSkinningPass(cmdBuffer, renderView.frameInFlight);
+  }
+
   /* 1. Environment generation */
 
   if (renderView.generateEnvironmentMaps) {
+    RTimedScope timedScope(cmdBuffer, "Environment maps");
     renderEnvironmentMaps(cmdBuffer, environment.genInterval);
   }
 
   /* 2. Cascaded shadows */
 
-  setCamera(view.pSunCamera);
-  updateSceneUBO(renderView.frameInFlight);
+  const uint32_t cascadeMask = shadows.updateMasks[renderView.frameInFlight];
+
+  if (cascadeMask) {
+    RTimedScope timedScope(cmdBuffer, "Shadow cascades");
 
-  for (uint8_t cascadeIndex = 0; cascadeIndex < config::shadowCascades; ++cascadeIndex) {
-    executeShadowPass(cmdBuffer, cascadeIndex);
+    setCamera(view.pSunCamera);
+    updateSceneUBO(renderView.frameInFlight);
+
+    executeShadowCascades(cmdBuffer);
   }
 
   /* 3. Main scene */
@@ -606,20 +786,47 @@ void core::MRenderer::renderFrame() {
   updateSceneUBO(renderView.frameInFlight);
 
   // G-Buffer passes
-  executeRenderingPass(cmdBuffer, EDynamicRenderingPass::OpaqueCullBack);
-  executeRenderingPass(cmdBuffer, EDynamicRenderingPass::OpaqueCullNone);
-  executeRenderingPass(cmdBuffer, EDynamicRenderingPass::DiscardCullNone);
-  executeRenderingPass(cmdBuffer, EDynamicRenderingPass::BlendCullNone);
+  {
+    RTimedScope timedScope(cmdBuffer, "G-Buffer opaque");
+    executeRenderingPass(cmdBuffer, EDynamicRenderingPass::OpaqueCullBack);
+  }
+
+  {
+    RTimedScope timedScope(cmdBuffer, "G-Buffer opaque double sided");
+    executeRenderingPass(cmdBuffer, EDynamicRenderingPass::OpaqueCullNone);
+  }
+
+  {
+    RTimedScope timedScope(cmdBuffer, "G-Buffer discard");
+    executeRenderingPass(cmdBuffer, EDynamicRenderingPass::DiscardCullNone);
+  }
+
+  {
+    RTimedScope timedScope(cmdBuffer, "G-Buffer blend");
+    executeRenderingPass(cmdBuffer, EDynamicRenderingPass::BlendCullNone);
+  }
 
   // Deferred rendering pass using G-Buffer collected data
-  executeRenderingPass(cmdBuffer, EDynamicRenderingPass::PBR, material.pGBuffer, true);
+  {
+    RTimedScope timedScope(cmdBuffer, "PBR");
+    executeRenderingPass(cmdBuffer, EDynamicRenderingPass::PBR, material.pGBuffer, true);
+  }
 
   // Additional front rendering passes
-  executeRenderingPass(cmdBuffer, EDynamicRenderingPass::Skybox);
+  {
+    RTimedScope timedScope(cmdBuffer, "Skybox");
+    executeRenderingPass(cmdBuffer, EDynamicRenderingPass::Skybox);
+  }
 
-  executeAOBlurPass(cmdBuffer);
+  {
+    RTimedScope timedScope(cmdBuffer, "AO blur");
+    executeAOBlurPass(cmdBuffer);
+  }
 
-  executeRenderingPass(cmdBuffer, EDynamicRenderingPass::AlphaCompositing, material.pGPBR, true);
+  {
+    RTimedScope timedScope(cmdBuffer, "Alpha compositing");
+    executeRenderingPass(cmdBuffer, EDynamicRenderingPass::AlphaCompositing, material.pGPBR, true);
+  }
 
   /* 4. Postprocessing pass */
 
@@ -628,7 +835,10 @@ void core::MRenderer::renderFrame() {
 
   /* 5. Final presentation pass */
 
-  executePresentPass(cmdBuffer);
+  {
+    RTimedScope timedScope(cmdBuffer, "Present");
+    executePresentPass(cmdBuffer);
+  }
 
   // End writing commands and prepare to submit buffer to rendering queue
   if (vkEndCommandBuffer(cmdBuffer) != VK_SUCCESS) {
@@ -651,12 +861,19 @@ void core::MRenderer::renderFrame() {
   submitInfo.signalSemaphoreCount = 1;
   submitInfo.pSignalSemaphores = signalSems;  // Signal these after rendering is finished
 
+  timestamps.submitTimes[renderView.frameInFlight] = core::profiler.getTime();
+
   // Submit an array featuring command buffers to graphics queue and signal
   // Fence for CPU to wait for execution
+  std::unique_lock<std::mutex> queueLock(sync.queueMutex);
+
   if (vkQueueSubmit(logicalDevice.queues.graphics, 1, &submitInfo,
                     sync.fenceInFlight[renderView.frameInFlight]) !=
       VK_SUCCESS) {
     RE_LOG(Error, "Failed to submit data to graphics queue.");
+  } else {
+    // later frames are ordered after this one, cascades it renders can be reused
+    shadows.cascades.commit(cascadeMask);
   }
 
   VkSwapchainKHR swapChains[] = {swapChain};
@@ -671,6 +888,7 @@ void core::MRenderer::renderFrame() {
   presentInfo.pResults = nullptr;                             // For future use with more swapchains
 
   APIResult = vkQueuePresentKHR(logicalDevice.queues.present, &presentInfo);
+  queueLock.unlock();
 
   if (APIResult == VK_ERROR_OUT_OF_DATE_KHR || APIResult == VK_SUBOPTIMAL_KHR ||
       framebufferResized) {
@@ -687,9 +905,51 @@ void core::MRenderer::renderFrame() {
     return;
   }
 
-  // Synchronize CPU threads
-  sync.asyncUpdateEntities.update();
-  sync.asyncUpdateInstanceBuffers.update();
+  // Prepare the next frame on job workers, its index is fixed here so the
+  // job doesn't depend on when frameInFlight is advanced
+  system.simulationStep = core::time.getSimulationStep();
+
+  const uint32_t nextFrameIndex = (renderView.frameInFlight + 1) % MAX_FRAMES_IN_FLIGHT;
+
+  core::jobs.run(
+      [this, nextFrameIndex]() {
+        RE_PROFILE_SCOPE("Entity update");
+        updateBoundEntities();
+
+        // instance, skinning batch and dispatch buffers of the next frame in
+        // flight are still read by the frame submitted before this one
+        {
+          RE_PROFILE_SCOPE("Wait for frame fence");
+          vkWaitForFences(logicalDevice.device, 1, &sync.fenceInFlight[nextFrameIndex],
+                          VK_TRUE, UINT64_MAX);
+        }
+
+        updateInstanceBuffer(nextFrameIndex);
+      },
+      &sync.frameUpdate);
+
+  renderView.frameInFlight = ++renderView.frameInFlight % MAX_FRAMES_IN_FLIGHT;
+  ++renderView.framesRendered;
+}
+
+void core::MRenderer::simulateFrame() {
+  core::profiler.beginFrame();
+  RE_PROFILE_SCOPE("Frame");
+
+  core::time.tickTimer();
+  system.simulationStep = core::time.getSimulationStep();
+
+  // Release material slots of deleted materials
+  core::resources.destroyReleasedResources();
+
+  // Work of the update threads is done in place, it finishes within the frame
+  // and is measured by frame time statistics
+  updateBoundEntities();
+  updateInstanceBuffer(renderView.frameInFlight);
+  updateMeshletStatistics(renderView.frameInFlight);
+
+  // nothing is recorded, scheduled cascades count as rendered
+  shadows.cascades.commit(shadows.updateMasks[renderView.frameInFlight]);
 
   renderView.frameInFlight = ++renderView.frameInFlight % MAX_FRAMES_IN_FLIGHT;
   ++renderView.framesRendered;
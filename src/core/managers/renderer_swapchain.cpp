@@ -233,7 +233,10 @@ TResult core::MRenderer::recreateSwapChain() {
     glfwWaitEvents();
   }
 
-  vkDeviceWaitIdle(logicalDevice.device);
+  {
+    std::lock_guard<std::mutex> queueLock(sync.queueMutex);
+    vkDeviceWaitIdle(logicalDevice.device);
+  }
 
   destroySwapChain();
 
@@ -496,7 +496,8 @@ TResult core::MRenderer::createDepthTargets() {
   textureInfo.layerCount = config::shadowCascades;
   textureInfo.extraViews = true;
   textureInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-  textureInfo.usageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+  textureInfo.usageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+                           VK_IMAGE_USAGE_TRANSFER_DST_BIT;
   textureInfo.targetLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
   textureInfo.memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
   textureInfo.vmaMemoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
@@ -510,6 +511,25 @@ TResult core::MRenderer::createDepthTargets() {
     return RE_CRITICAL;
   }
 
+#ifndef NDEBUG
+  RE_LOG(Log, "Created depth target '%s'.", rtName.c_str());
+#endif
+
+  // Static shadow casters, copied to the shadow target before dynamic ones are rendered
+  rtName = RTGT_SHADOWCACHE;
+
+  textureInfo.name = rtName;
+  textureInfo.usageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+  pNewTexture = core::resources.createTexture(&textureInfo);
+
+  if (!pNewTexture) {
+    RE_LOG(Critical, "Failed to create texture \"%s\".", rtName.c_str());
+    return RE_CRITICAL;
+  }
+
+  shadows.pStaticCache = pNewTexture;
+
 #ifndef NDEBUG
   RE_LOG(Log, "Created depth target '%s'.", rtName.c_str());
 #endif
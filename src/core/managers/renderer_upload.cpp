@@ -0,0 +1,649 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/managers/renderer.h"
+
+namespace {
+constexpr VkDeviceSize uploadAlignment = 16u;
+constexpr VkDeviceSize invalidUploadOffset = std::numeric_limits<VkDeviceSize>::max();
+}  // namespace
+
+TResult core::MRenderer::createUploadResources() {
+  RE_LOG(Log, "Creating upload staging ring of %d MBs.",
+         static_cast<int32_t>(config::scene::uploadRingSize / 1048576u));
+
+  upload.ringSize = config::scene::uploadRingSize;
+
+  if (createBuffer(EBufferType::STAGING, upload.ringSize, upload.stagingRing,
+                   nullptr) != RE_OK) {
+    RE_LOG(Critical, "Failed to create upload staging ring.");
+    return RE_CRITICAL;
+  }
+
+  // ring stays mapped for the whole lifetime of the renderer
+  void* pData = nullptr;
+  if (vmaMapMemory(memAlloc, upload.stagingRing.allocation, &pData) != VK_SUCCESS) {
+    RE_LOG(Critical, "Failed to map upload staging ring.");
+    return RE_CRITICAL;
+  }
+
+  upload.pRingData = static_cast<uint8_t*>(pData);
+
+  VkSemaphoreTypeCreateInfo semTypeInfo{};
+  semTypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+  semTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+  semTypeInfo.initialValue = 0u;
+
+  VkSemaphoreCreateInfo semInfo{};
+  semInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  semInfo.pNext = &semTypeInfo;
+
+  if (vkCreateSemaphore(logicalDevice.device, &semInfo, nullptr,
+                        &upload.timeline) != VK_SUCCESS ||
+      vkCreateSemaphore(logicalDevice.device, &semInfo, nullptr,
+                        &upload.graphicsTimeline) != VK_SUCCESS) {
+    RE_LOG(Critical, "Failed to create upload timeline semaphores.");
+    return RE_CRITICAL;
+  }
+
+  return RE_OK;
+}
+
+void core::MRenderer::destroyUploadResources() {
+  RE_LOG(Log, "Destroying upload resources.");
+
+  std::lock_guard<std::recursive_mutex> lock(upload.mutex);
+
+  upload.pendingCopies.clear();
+  upload.pendingImageCopies.clear();
+  upload.pendingMipCopies.clear();
+  waitForUpload(upload.submittedValue);
+
+  if (!upload.freeTransferCommandBuffers.empty()) {
+    vkFreeCommandBuffers(logicalDevice.device, command.poolTransfer,
+                         static_cast<uint32_t>(upload.freeTransferCommandBuffers.size()),
+                         upload.freeTransferCommandBuffers.data());
+    upload.freeTransferCommandBuffers.clear();
+  }
+
+  if (!upload.freeGraphicsCommandBuffers.empty()) {
+    vkFreeCommandBuffers(logicalDevice.device, command.poolGraphics,
+                         static_cast<uint32_t>(upload.freeGraphicsCommandBuffers.size()),
+                         upload.freeGraphicsCommandBuffers.data());
+    upload.freeGraphicsCommandBuffers.clear();
+  }
+
+  vkDestroySemaphore(logicalDevice.device, upload.timeline, nullptr);
+  vkDestroySemaphore(logicalDevice.device, upload.graphicsTimeline, nullptr);
+  upload.timeline = VK_NULL_HANDLE;
+  upload.graphicsTimeline = VK_NULL_HANDLE;
+
+  vmaUnmapMemory(memAlloc, upload.stagingRing.allocation);
+  vmaDestroyBuffer(memAlloc, upload.stagingRing.buffer,
+                   upload.stagingRing.allocation);
+  upload.pRingData = nullptr;
+}
+
+void core::MRenderer::reclaimUploads() {
+  // the graphics submit waits for the transfer one, both are done once it is
+  uint64_t completedValue = 0u;
+  vkGetSemaphoreCounterValue(logicalDevice.device, upload.graphicsTimeline,
+                             &completedValue);
+
+  while (!upload.submits.empty() &&
+         upload.submits.front().timelineValue <= completedValue) {
+    RUploadData::RUploadSubmit& submit = upload.submits.front();
+
+    upload.ringUsed -= submit.ringBytes;
+    upload.freeTransferCommandBuffers.emplace_back(submit.transferCommandBuffer);
+    upload.freeGraphicsCommandBuffers.emplace_back(submit.graphicsCommandBuffer);
+
+    upload.submits.erase(upload.submits.begin());
+  }
+
+  // rewind when the ring is idle to avoid needless wrapping
+  if (upload.ringUsed == 0u) {
+    upload.ringHead = 0u;
+  }
+}
+
+VkDeviceSize core::MRenderer::allocateUploadRange(const VkDeviceSize size) {
+  const VkDeviceSize alignedSize =
+      (size + uploadAlignment - 1) & ~(uploadAlignment - 1);
+
+  if (alignedSize > upload.ringSize) {
+    RE_LOG(Error, "Upload of %d bytes does not fit into the staging ring.",
+           static_cast<int32_t>(size));
+    return invalidUploadOffset;
+  }
+
+  while (true) {
+    reclaimUploads();
+
+    // space at the end of the ring is skipped if the range doesn't fit there
+    const VkDeviceSize padding = (upload.ringHead + alignedSize > upload.ringSize)
+                                     ? upload.ringSize - upload.ringHead
+                                     : 0u;
+
+    if (padding + alignedSize <= upload.ringSize - upload.ringUsed) {
+      if (padding > 0u) {
+        upload.ringHead = 0u;
+      }
+
+      const VkDeviceSize offset = upload.ringHead;
+
+      upload.ringHead = (upload.ringHead + alignedSize) % upload.ringSize;
+      upload.ringUsed += padding + alignedSize;
+      upload.pendingRingBytes += padding + alignedSize;
+
+      return offset;
+    }
+
+    // ring is full, submit queued copies and wait for the oldest upload
+    flushUploads();
+
+    if (upload.submits.empty()) {
+      RE_LOG(Error, "Upload staging ring is full with nothing in flight.");
+      return invalidUploadOffset;
+    }
+
+    waitForUpload(upload.submits.front().timelineValue);
+  }
+}
+
+TResult core::MRenderer::queueBufferUpload(RBuffer* pDstBuffer,
+                                           const void* pData,
+                                           VkDeviceSize size,
+                                           VkDeviceSize dstOffset) {
+  // device buffers don't exist in headless mode
+  if (config::bHeadless) {
+    return RE_OK;
+  }
+
+  if (!pDstBuffer || !pData || size == 0u) {
+    RE_LOG(Error, "Failed to queue buffer upload, invalid arguments provided.");
+    return RE_ERROR;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(upload.mutex);
+
+  // large uploads are split so that the ring can keep several in flight
+  const VkDeviceSize maxChunkSize = upload.ringSize / 4;
+  const uint8_t* pSrcData = static_cast<const uint8_t*>(pData);
+
+  for (VkDeviceSize written = 0u; written < size;) {
+    const VkDeviceSize chunkSize = std::min(size - written, maxChunkSize);
+    const VkDeviceSize ringOffset = allocateUploadRange(chunkSize);
+
+    if (ringOffset == invalidUploadOffset) {
+      return RE_ERROR;
+    }
+
+    memcpy(upload.pRingData + ringOffset, pSrcData + written, chunkSize);
+    vmaFlushAllocation(memAlloc, upload.stagingRing.allocation, ringOffset,
+                       chunkSize);
+
+    RUploadData::RUploadCopy& copy = upload.pendingCopies.emplace_back();
+    copy.dstBuffer = pDstBuffer->buffer;
+    copy.region.srcOffset = ringOffset;
+    copy.region.dstOffset = dstOffset + written;
+    copy.region.size = chunkSize;
+
+    written += chunkSize;
+  }
+
+  return RE_OK;
+}
+
+TResult core::MRenderer::queueImageUpload(
+    RVulkanTexture* pDstTexture, const void* pData,
+    const std::vector<VkBufferImageCopy>& regions,
+    const std::vector<VkDeviceSize>& regionSizes) {
+  if (config::bHeadless) {
+    return RE_OK;
+  }
+
+  if (!pDstTexture || !pData || regions.empty() ||
+      regions.size() != regionSizes.size()) {
+    RE_LOG(Error, "Failed to queue image upload, invalid arguments provided.");
+    return RE_ERROR;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(upload.mutex);
+
+  VkImageSubresourceRange subresourceRange{};
+  subresourceRange.aspectMask = pDstTexture->aspectMask;
+  subresourceRange.baseMipLevel = 0u;
+  subresourceRange.levelCount = pDstTexture->levelCount;
+  subresourceRange.baseArrayLayer = 0u;
+  subresourceRange.layerCount = pDstTexture->layerCount;
+
+  const uint8_t* pSrcData = static_cast<const uint8_t*>(pData);
+
+  // every region is staged whole, image rows can't be split like buffer data
+  for (size_t i = 0; i < regions.size(); ++i) {
+    const VkDeviceSize ringOffset = allocateUploadRange(regionSizes[i]);
+
+    if (ringOffset == invalidUploadOffset) {
+      return RE_ERROR;
+    }
+
+    memcpy(upload.pRingData + ringOffset, pSrcData + regions[i].bufferOffset,
+           regionSizes[i]);
+    vmaFlushAllocation(memAlloc, upload.stagingRing.allocation, ringOffset,
+                       regionSizes[i]);
+
+    RUploadData::RUploadImageCopy& copy = upload.pendingImageCopies.emplace_back();
+    copy.dstImage = pDstTexture->image;
+    copy.region = regions[i];
+    copy.region.bufferOffset = ringOffset;
+    copy.subresourceRange = subresourceRange;
+    copy.isFirst = (i == 0);
+    copy.isLast = (i + 1 == regions.size());
+  }
+
+  pDstTexture->imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+  return RE_OK;
+}
+
+TResult core::MRenderer::queueImageMipCopy(const RVulkanTexture* pSrcTexture,
+                                           RVulkanTexture* pDstTexture,
+                                           const uint32_t srcBaseMip) {
+  if (config::bHeadless) {
+    return RE_OK;
+  }
+
+  if (!pSrcTexture || !pDstTexture ||
+      srcBaseMip + pDstTexture->levelCount > pSrcTexture->levelCount ||
+      pSrcTexture->layerCount != pDstTexture->layerCount) {
+    RE_LOG(Error, "Failed to queue image mip copy, invalid arguments provided.");
+    return RE_ERROR;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(upload.mutex);
+
+  RUploadData::RUploadMipCopy& copy = upload.pendingMipCopies.emplace_back();
+  copy.srcImage = pSrcTexture->image;
+  copy.dstImage = pDstTexture->image;
+  copy.srcBaseMip = srcBaseMip;
+  copy.levelCount = pDstTexture->levelCount;
+  copy.layerCount = pDstTexture->layerCount;
+  copy.aspectMask = pDstTexture->aspectMask;
+  copy.extent = {pDstTexture->width, pDstTexture->height};
+
+  pDstTexture->imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+  return RE_OK;
+}
+
+uint64_t core::MRenderer::flushUploads() {
+  if (config::bHeadless) {
+    return 0u;
+  }
+
+  RE_PROFILE_SCOPE("Flush uploads");
+  std::lock_guard<std::recursive_mutex> lock(upload.mutex);
+
+  reclaimUploads();
+
+  if (upload.pendingCopies.empty() && upload.pendingImageCopies.empty() &&
+      upload.pendingMipCopies.empty()) {
+    return upload.submittedValue;
+  }
+
+  const uint32_t transferFamily = physicalDevice.queueFamilyIndices.transfer[0];
+  const uint32_t graphicsFamily = physicalDevice.queueFamilyIndices.graphics[0];
+
+  RUploadData::RUploadSubmit submit;
+  submit.timelineValue = upload.submittedValue + 1u;
+  submit.ringBytes = upload.pendingRingBytes;
+
+  if (upload.freeTransferCommandBuffers.empty()) {
+    submit.transferCommandBuffer = createCommandBuffer(
+        ECmdType::Transfer, VK_COMMAND_BUFFER_LEVEL_PRIMARY, false);
+  } else {
+    submit.transferCommandBuffer = upload.freeTransferCommandBuffers.back();
+    upload.freeTransferCommandBuffers.pop_back();
+  }
+
+  if (upload.freeGraphicsCommandBuffers.empty()) {
+    submit.graphicsCommandBuffer = createCommandBuffer(
+        ECmdType::Graphics, VK_COMMAND_BUFFER_LEVEL_PRIMARY, false);
+  } else {
+    submit.graphicsCommandBuffer = upload.freeGraphicsCommandBuffers.back();
+    upload.freeGraphicsCommandBuffers.pop_back();
+  }
+
+  // group regions by destination so that every buffer gets a single copy command
+  std::stable_sort(upload.pendingCopies.begin(), upload.pendingCopies.end(),
+                   [](const RUploadData::RUploadCopy& a,
+                      const RUploadData::RUploadCopy& b) {
+                     return std::less<VkBuffer>()(a.dstBuffer, b.dstBuffer);
+                   });
+
+  std::vector<VkBufferCopy> regions;
+  std::vector<VkImageMemoryBarrier2> imageBarriers;
+  std::vector<VkImageMemoryBarrier2> releaseImageBarriers;
+  std::vector<VkImageMemoryBarrier2> acquireImageBarriers;
+
+  beginCommandBuffer(submit.transferCommandBuffer, true);
+
+  // images receiving their first region are prepared for copying
+  for (const RUploadData::RUploadImageCopy& copy : upload.pendingImageCopies) {
+    if (!copy.isFirst) {
+      continue;
+    }
+
+    VkImageMemoryBarrier2& barrier = imageBarriers.emplace_back();
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+    barrier.srcAccessMask = VK_ACCESS_2_NONE;
+    barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = copy.dstImage;
+    barrier.subresourceRange = copy.subresourceRange;
+  }
+
+  if (!imageBarriers.empty()) {
+    VkDependencyInfo dependencyInfo{};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependencyInfo.imageMemoryBarrierCount =
+        static_cast<uint32_t>(imageBarriers.size());
+    dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+
+    vkCmdPipelineBarrier2(submit.transferCommandBuffer, &dependencyInfo);
+  }
+
+  for (size_t i = 0; i < upload.pendingCopies.size(); ++i) {
+    const RUploadData::RUploadCopy& copy = upload.pendingCopies[i];
+    regions.emplace_back(copy.region);
+
+    if (i + 1 == upload.pendingCopies.size() ||
+        upload.pendingCopies[i + 1].dstBuffer != copy.dstBuffer) {
+      vkCmdCopyBuffer(submit.transferCommandBuffer, upload.stagingRing.buffer,
+                      copy.dstBuffer, static_cast<uint32_t>(regions.size()),
+                      regions.data());
+      regions.clear();
+    }
+  }
+
+  // image regions stay in queued order, consecutive regions share a command
+  std::vector<VkBufferImageCopy> imageRegions;
+
+  for (size_t i = 0; i < upload.pendingImageCopies.size(); ++i) {
+    const RUploadData::RUploadImageCopy& copy = upload.pendingImageCopies[i];
+    imageRegions.emplace_back(copy.region);
+
+    if (copy.isLast) {
+      // layout transition is done by the release on separate queue families
+      VkImageMemoryBarrier2 barrier{};
+      barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+      barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+      barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+      barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.image = copy.dstImage;
+      barrier.subresourceRange = copy.subresourceRange;
+
+      if (transferFamily != graphicsFamily) {
+        barrier.srcQueueFamilyIndex = transferFamily;
+        barrier.dstQueueFamilyIndex = graphicsFamily;
+
+        acquireImageBarriers.emplace_back(barrier);
+        acquireImageBarriers.back().srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        acquireImageBarriers.back().srcAccessMask = VK_ACCESS_2_NONE;
+        acquireImageBarriers.back().dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        acquireImageBarriers.back().dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+      }
+
+      releaseImageBarriers.emplace_back(barrier);
+    }
+
+    if (i + 1 == upload.pendingImageCopies.size() ||
+        upload.pendingImageCopies[i + 1].dstImage != copy.dstImage) {
+      vkCmdCopyBufferToImage(submit.transferCommandBuffer,
+                             upload.stagingRing.buffer, copy.dstImage,
+                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             static_cast<uint32_t>(imageRegions.size()),
+                             imageRegions.data());
+      imageRegions.clear();
+    }
+  }
+
+  if (!releaseImageBarriers.empty()) {
+    VkDependencyInfo dependencyInfo{};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependencyInfo.imageMemoryBarrierCount =
+        static_cast<uint32_t>(releaseImageBarriers.size());
+    dependencyInfo.pImageMemoryBarriers = releaseImageBarriers.data();
+
+    vkCmdPipelineBarrier2(submit.transferCommandBuffer, &dependencyInfo);
+  }
+
+  vkEndCommandBuffer(submit.transferCommandBuffer);
+
+  VkTimelineSemaphoreSubmitInfo signalInfo{};
+  signalInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  signalInfo.signalSemaphoreValueCount = 1;
+  signalInfo.pSignalSemaphoreValues = &submit.timelineValue;
+
+  VkSubmitInfo transferSubmitInfo{};
+  transferSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  transferSubmitInfo.pNext = &signalInfo;
+  transferSubmitInfo.commandBufferCount = 1;
+  transferSubmitInfo.pCommandBuffers = &submit.transferCommandBuffer;
+  transferSubmitInfo.signalSemaphoreCount = 1;
+  transferSubmitInfo.pSignalSemaphores = &upload.timeline;
+
+  std::unique_lock<std::mutex> queueLock(sync.queueMutex);
+
+  if (vkQueueSubmit(logicalDevice.queues.transfer, 1, &transferSubmitInfo,
+                    VK_NULL_HANDLE) != VK_SUCCESS) {
+    RE_LOG(Error, "Failed to submit uploads to transfer queue.");
+  }
+
+  queueLock.unlock();
+
+  // graphics queue waits for the copies on the GPU, its barrier orders every
+  // later graphics submit after the upload and acquires uploaded images
+  beginCommandBuffer(submit.graphicsCommandBuffer, true);
+
+  VkMemoryBarrier2 memoryBarrier{};
+  memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+  memoryBarrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+  memoryBarrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+  memoryBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+
+  VkDependencyInfo acquireInfo{};
+  acquireInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+  acquireInfo.memoryBarrierCount = 1;
+  acquireInfo.pMemoryBarriers = &memoryBarrier;
+  acquireInfo.imageMemoryBarrierCount =
+      static_cast<uint32_t>(acquireImageBarriers.size());
+  acquireInfo.pImageMemoryBarriers = acquireImageBarriers.data();
+
+  vkCmdPipelineBarrier2(submit.graphicsCommandBuffer, &acquireInfo);
+
+  // source images may still be sampled by frames in flight, the barriers wait
+  // for them and return the images to their shader read layout afterwards
+  if (!upload.pendingMipCopies.empty()) {
+    std::vector<VkImageMemoryBarrier2> copyBarriers;
+
+    for (const RUploadData::RUploadMipCopy& copy : upload.pendingMipCopies) {
+      VkImageMemoryBarrier2 barrier{};
+      barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+      barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+      barrier.srcAccessMask = VK_ACCESS_2_NONE;
+      barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+      barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+      barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+      barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.image = copy.srcImage;
+      barrier.subresourceRange = {copy.aspectMask, copy.srcBaseMip,
+                                  copy.levelCount, 0u, copy.layerCount};
+      copyBarriers.emplace_back(barrier);
+
+      barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+      barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+      barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      barrier.image = copy.dstImage;
+      barrier.subresourceRange.baseMipLevel = 0u;
+      copyBarriers.emplace_back(barrier);
+    }
+
+    VkDependencyInfo copyInfo{};
+    copyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    copyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(copyBarriers.size());
+    copyInfo.pImageMemoryBarriers = copyBarriers.data();
+
+    vkCmdPipelineBarrier2(submit.graphicsCommandBuffer, &copyInfo);
+
+    std::vector<VkImageCopy> levelCopies;
+
+    for (const RUploadData::RUploadMipCopy& copy : upload.pendingMipCopies) {
+      levelCopies.clear();
+
+      for (uint32_t level = 0; level < copy.levelCount; ++level) {
+        VkImageCopy& levelCopy = levelCopies.emplace_back();
+        levelCopy.srcSubresource = {copy.aspectMask, copy.srcBaseMip + level,
+                                    0u, copy.layerCount};
+        levelCopy.srcOffset = {0, 0, 0};
+        levelCopy.dstSubresource = {copy.aspectMask, level, 0u, copy.layerCount};
+        levelCopy.dstOffset = {0, 0, 0};
+        levelCopy.extent = {std::max(copy.extent.width >> level, 1u),
+                            std::max(copy.extent.height >> level, 1u), 1u};
+      }
+
+      vkCmdCopyImage(submit.graphicsCommandBuffer, copy.srcImage,
+                     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, copy.dstImage,
+                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                     static_cast<uint32_t>(levelCopies.size()), levelCopies.data());
+    }
+
+    for (VkImageMemoryBarrier2& barrier : copyBarriers) {
+      barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+      barrier.srcAccessMask = (barrier.newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+                                  ? VK_ACCESS_2_TRANSFER_WRITE_BIT
+                                  : VK_ACCESS_2_NONE;
+      barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+      barrier.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+      barrier.oldLayout = barrier.newLayout;
+      barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+
+    vkCmdPipelineBarrier2(submit.graphicsCommandBuffer, &copyInfo);
+  }
+
+  vkEndCommandBuffer(submit.graphicsCommandBuffer);
+
+  const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+  // command buffers and ring space are reclaimed once the graphics
+  // timeline reaches the value of this upload
+  VkTimelineSemaphoreSubmitInfo timelineInfo{};
+  timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timelineInfo.waitSemaphoreValueCount = 1;
+  timelineInfo.pWaitSemaphoreValues = &submit.timelineValue;
+  timelineInfo.signalSemaphoreValueCount = 1;
+  timelineInfo.pSignalSemaphoreValues = &submit.timelineValue;
+
+  VkSubmitInfo graphicsSubmitInfo{};
+  graphicsSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  graphicsSubmitInfo.pNext = &timelineInfo;
+  graphicsSubmitInfo.waitSemaphoreCount = 1;
+  graphicsSubmitInfo.pWaitSemaphores = &upload.timeline;
+  graphicsSubmitInfo.pWaitDstStageMask = &waitStage;
+  graphicsSubmitInfo.commandBufferCount = 1;
+  graphicsSubmitInfo.pCommandBuffers = &submit.graphicsCommandBuffer;
+  graphicsSubmitInfo.signalSemaphoreCount = 1;
+  graphicsSubmitInfo.pSignalSemaphores = &upload.graphicsTimeline;
+
+  queueLock.lock();
+
+  if (vkQueueSubmit(logicalDevice.queues.graphics, 1, &graphicsSubmitInfo,
+                    VK_NULL_HANDLE) != VK_SUCCESS) {
+    RE_LOG(Error, "Failed to submit upload acquire to graphics queue.");
+
+    // nothing will signal the value, waits for the transfer part instead
+    VkSemaphoreWaitInfo transferWaitInfo{};
+    transferWaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    transferWaitInfo.semaphoreCount = 1;
+    transferWaitInfo.pSemaphores = &upload.timeline;
+    transferWaitInfo.pValues = &submit.timelineValue;
+
+    vkWaitSemaphores(logicalDevice.device, &transferWaitInfo,
+                     std::numeric_limits<uint64_t>::max());
+
+    VkSemaphoreSignalInfo hostSignalInfo{};
+    hostSignalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+    hostSignalInfo.semaphore = upload.graphicsTimeline;
+    hostSignalInfo.value = submit.timelineValue;
+
+    vkSignalSemaphore(logicalDevice.device, &hostSignalInfo);
+  }
+
+  queueLock.unlock();
+
+#ifndef NDEBUG
+  RE_LOG(Log, "Submitted %d buffer and %d image upload regions, %d mip copies (%d KBs of staging ring).",
+         static_cast<int32_t>(upload.pendingCopies.size()),
+         static_cast<int32_t>(upload.pendingImageCopies.size()),
+         static_cast<int32_t>(upload.pendingMipCopies.size()),
+         static_cast<int32_t>(upload.pendingRingBytes / 1024u));
+#endif
+
+  upload.submittedValue = submit.timelineValue;
+  upload.pendingRingBytes = 0u;
+  upload.pendingCopies.clear();
+  upload.pendingImageCopies.clear();
+  upload.pendingMipCopies.clear();
+  upload.submits.emplace_back(submit);
+
+  return upload.submittedValue;
+}
+
+bool core::MRenderer::isUploadComplete(const uint64_t timelineValue) {
+  if (config::bHeadless) {
+    return true;
+  }
+
+  uint64_t completedValue = 0u;
+  vkGetSemaphoreCounterValue(logicalDevice.device, upload.graphicsTimeline,
+                             &completedValue);
+
+  return completedValue >= timelineValue;
+}
+
+void core::MRenderer::waitForUpload(const uint64_t timelineValue) {
+  if (config::bHeadless) {
+    return;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(upload.mutex);
+
+  // copies must be submitted before they can be waited on
+  if (timelineValue > upload.submittedValue) {
+    flushUploads();
+  }
+
+  const uint64_t waitValue = std::min(timelineValue, upload.submittedValue);
+
+  VkSemaphoreWaitInfo waitInfo{};
+  waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+  waitInfo.semaphoreCount = 1;
+  waitInfo.pSemaphores = &upload.graphicsTimeline;
+  waitInfo.pValues = &waitValue;
+
+  vkWaitSemaphores(logicalDevice.device, &waitInfo,
+                   std::numeric_limits<uint64_t>::max());
+
+  reclaimUploads();
+}
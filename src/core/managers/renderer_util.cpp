@@ -2,6 +2,7 @@
 #include "vk_mem_alloc.h"
 #include "core/core.h"
 #include "core/managers/animations.h"
+#include "core/managers/jobs.h"
 #include "core/managers/ref.h"
 #include "core/managers/renderer.h"
 #include "core/managers/actors.h"
@@ -9,6 +10,12 @@
 #include "core/material/texture.h"
 #include "core/model/model.h"
 #include "core/world/actors/camera.h"
+#include "util/math.h"
+
+namespace {
+// open GPU scope that wasn't given a timestamp query pair
+constexpr uint32_t invalidScope = std::numeric_limits<uint32_t>::max();
+}  // namespace
 
 // PRIVATE
 
@@ -152,15 +159,47 @@ TResult core::MRenderer::getDepthStencilFormat(VkFormat desiredFormat, VkFormat&
 
 
 VkPipelineShaderStageCreateInfo core::MRenderer::loadShader(const char* path, VkShaderStageFlagBits stage) {
-  std::string fullPath = RE_PATH_SHADERS + std::string(path);
-  std::vector<char> shaderCode = util::readFile(fullPath.c_str());
-
   VkPipelineShaderStageCreateInfo stageCreateInfo{};
   stageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
   stageCreateInfo.stage = stage;
-  stageCreateInfo.module = createShaderModule(shaderCode);
   stageCreateInfo.pName = "main";
 
+  // pipelines may be created by multiple threads
+  std::lock_guard<std::mutex> lock(shaders.mutex);
+
+  auto pathIt = shaders.modulesByPath.find(path);
+
+  if (pathIt != shaders.modulesByPath.end()) {
+    stageCreateInfo.module = pathIt->second;
+    return stageCreateInfo;
+  }
+
+  std::string fullPath = RE_PATH_SHADERS + std::string(path);
+  std::vector<char> shaderCode = util::readFile(fullPath.c_str());
+
+  if (shaderCode.empty()) {
+    stageCreateInfo.module = VK_NULL_HANDLE;
+    return stageCreateInfo;
+  }
+
+  // different files with the same SPIR-V share a module
+  const uint64_t codeHash = util::hashData(shaderCode.data(), shaderCode.size());
+  auto hashIt = shaders.modulesByHash.find(codeHash);
+
+  if (hashIt != shaders.modulesByHash.end()) {
+    stageCreateInfo.module = hashIt->second;
+  } else {
+    stageCreateInfo.module = createShaderModule(shaderCode);
+
+    if (stageCreateInfo.module != VK_NULL_HANDLE) {
+      shaders.modulesByHash.emplace(codeHash, stageCreateInfo.module);
+    }
+  }
+
+  if (stageCreateInfo.module != VK_NULL_HANDLE) {
+    shaders.modulesByPath.emplace(path, stageCreateInfo.module);
+  }
+
   return stageCreateInfo;
 }
 
@@ -179,6 +218,23 @@ VkShaderModule core::MRenderer::createShaderModule(std::vector<char>& shaderCode
   return shaderModule;
 }
 
+void core::MRenderer::destroyShaderModules() {
+  std::lock_guard<std::mutex> lock(shaders.mutex);
+
+  for (auto& it : shaders.modulesByHash) {
+    vkDestroyShaderModule(logicalDevice.device, it.second, nullptr);
+  }
+
+#ifndef NDEBUG
+  RE_LOG(Log, "Destroyed %d shader modules loaded from %d files.",
+         static_cast<int32_t>(shaders.modulesByHash.size()),
+         static_cast<int32_t>(shaders.modulesByPath.size()));
+#endif
+
+  shaders.modulesByHash.clear();
+  shaders.modulesByPath.clear();
+}
+
 TResult core::MRenderer::checkInstanceValidationLayers() {
   uint32_t layerCount = 0;
   std::vector<VkLayerProperties> availableValidationLayers;
@@ -280,12 +336,181 @@ void core::MRenderer::destroyQueryPool() {
   vkDestroyQueryPool(logicalDevice.device, system.queryPool, nullptr);
 }
 
-// Runs in a dedicated thread
+TResult core::MRenderer::createTimestampQueryPool() {
+  const int32_t queueFamily = physicalDevice.queueFamilyIndices.graphics[0];
+
+  uint32_t queueFamilyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice.device,
+                                           &queueFamilyCount, nullptr);
+  std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice.device,
+                                           &queueFamilyCount, queueFamilies.data());
+
+  const uint32_t validBits = queueFamilies[queueFamily].timestampValidBits;
+  const VkPhysicalDeviceLimits& limits = physicalDevice.deviceProperties.properties.limits;
+
+  if (validBits == 0u || limits.timestampPeriod == 0.0f) {
+    // profiling continues with CPU scopes only
+    RE_LOG(Warning, "Graphics queue doesn't support timestamps, GPU timings are disabled.");
+    return RE_OK;
+  }
+
+  timestamps.timestampPeriod = static_cast<double>(limits.timestampPeriod);
+  timestamps.timestampMask =
+      (validBits >= 64u) ? std::numeric_limits<uint64_t>::max()
+                         : (1ull << validBits) - 1ull;
+
+  VkQueryPoolCreateInfo poolCreate{};
+  poolCreate.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  poolCreate.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  poolCreate.queryCount = core::vulkan::maxTimestampScopes * 2u * MAX_FRAMES_IN_FLIGHT;
+
+  if (vkCreateQueryPool(logicalDevice.device, &poolCreate, nullptr,
+                        &timestamps.queryPool) != VK_SUCCESS) {
+    RE_LOG(Warning, "Failed to create timestamp query pool, GPU timings are disabled.");
+    return RE_OK;
+  }
+
+  timestamps.isSupported = true;
+
+  return RE_OK;
+}
+
+void core::MRenderer::destroyTimestampQueryPool() {
+  vkDestroyQueryPool(logicalDevice.device, timestamps.queryPool, nullptr);
+  timestamps.queryPool = VK_NULL_HANDLE;
+  timestamps.isSupported = false;
+}
+
+void core::MRenderer::resetTimestamps(VkCommandBuffer commandBuffer) {
+  timestamps.scopeNames[renderView.frameInFlight].clear();
+  timestamps.openScopes.clear();
+
+  if (!timestamps.isSupported) {
+    return;
+  }
+
+  const uint32_t queryCount = core::vulkan::maxTimestampScopes * 2u;
+  vkCmdResetQueryPool(commandBuffer, timestamps.queryPool,
+                      renderView.frameInFlight * queryCount, queryCount);
+}
+
+void core::MRenderer::beginTimestamp(VkCommandBuffer commandBuffer,
+                                     const char* name) {
+  std::vector<const char*>& scopeNames = timestamps.scopeNames[renderView.frameInFlight];
+
+  if (!timestamps.isSupported || scopeNames.size() >= core::vulkan::maxTimestampScopes) {
+    // unmatched scopes are skipped when ending them
+    timestamps.openScopes.emplace_back(invalidScope);
+    return;
+  }
+
+  const uint32_t scopeIndex = static_cast<uint32_t>(scopeNames.size());
+  const uint32_t firstQuery =
+      renderView.frameInFlight * core::vulkan::maxTimestampScopes * 2u;
+
+  scopeNames.emplace_back(name);
+  timestamps.openScopes.emplace_back(scopeIndex);
+
+  vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                      timestamps.queryPool, firstQuery + scopeIndex * 2u);
+}
+
+void core::MRenderer::endTimestamp(VkCommandBuffer commandBuffer) {
+  if (timestamps.openScopes.empty()) {
+    return;
+  }
+
+  const uint32_t scopeIndex = timestamps.openScopes.back();
+  timestamps.openScopes.pop_back();
+
+  if (scopeIndex == invalidScope) {
+    return;
+  }
+
+  const uint32_t firstQuery =
+      renderView.frameInFlight * core::vulkan::maxTimestampScopes * 2u;
+
+  vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                      timestamps.queryPool, firstQuery + scopeIndex * 2u + 1u);
+}
+
+void core::MRenderer::collectTimestamps() {
+  const std::vector<const char*>& scopeNames = timestamps.scopeNames[renderView.frameInFlight];
+
+  if (!timestamps.isSupported || scopeNames.empty()) {
+    return;
+  }
+
+  const uint32_t queryCount = static_cast<uint32_t>(scopeNames.size()) * 2u;
+  const uint32_t firstQuery =
+      renderView.frameInFlight * core::vulkan::maxTimestampScopes * 2u;
+
+  std::vector<uint64_t> results(queryCount);
+
+  // frame's fence is signaled, results are available without waiting
+  if (vkGetQueryPoolResults(logicalDevice.device, timestamps.queryPool, firstQuery,
+                            queryCount, sizeof(uint64_t) * queryCount,
+                            results.data(), sizeof(uint64_t),
+                            VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+    return;
+  }
+
+  // GPU clock is aligned to the CPU time the frame was submitted at
+  const uint64_t frameStart = results[0] & timestamps.timestampMask;
+  const uint64_t submitTime = timestamps.submitTimes[renderView.frameInFlight];
+
+  for (uint32_t i = 0; i < scopeNames.size(); ++i) {
+    const uint64_t start = results[i * 2u] & timestamps.timestampMask;
+    const uint64_t end = results[i * 2u + 1u] & timestamps.timestampMask;
+
+    if (end < start) {
+      continue;
+    }
+
+    core::profiler.addEvent(
+        scopeNames[i],
+        submitTime + static_cast<uint64_t>((start - frameStart) * timestamps.timestampPeriod),
+        static_cast<uint64_t>((end - start) * timestamps.timestampPeriod),
+        MProfiler::ETimeline::GPU);
+  }
+}
+
+core::MRenderer::RTimedScope::RTimedScope(VkCommandBuffer commandBuffer,
+                                          const char* name)
+    : m_cpuScope(name), m_commandBuffer(commandBuffer) {
+  core::renderer.beginTimestamp(commandBuffer, name);
+}
+
+core::MRenderer::RTimedScope::~RTimedScope() {
+  core::renderer.endTimestamp(m_commandBuffer);
+}
+
+// Runs in a job, joined before the frame is recorded
 void core::MRenderer::updateBoundEntities() {
+  RE_PROFILE_SCOPE("Update bound entities");
+
   AEntity* pEntity = nullptr;
+  const core::MTime::RSimulationStep& step = system.simulationStep;
+
+  // Advance simulation by fixed ticks, transformations at the end of each
+  // tick are stored for interpolation. Actors are moved once per frame by
+  // frame delta, every tick covers an equal part of the remaining movement
+  // and the last tick of the frame reaches the current transformation.
+  for (uint32_t tick = 0; tick < step.tickCount; ++tick) {
+    core::animations.advanceAnimationQueue(step.tickDeltaTime);
 
-  // Update animation matrices
-  core::animations.runAnimationQueue();
+    const float weight = 1.0f / static_cast<float>(step.tickCount - tick);
+
+    for (auto& bindInfo : system.bindings) {
+      if ((pEntity = bindInfo.pEntity) != nullptr) {
+        pEntity->storeTickTransform(weight);
+      }
+    }
+  }
+
+  // Update animation matrices, sampled between the last two ticks
+  core::animations.runAnimationQueue((step.interpolation - 1.0f) * step.tickDeltaTime);
 
   for (auto& bindInfo : system.bindings) {
     if ((pEntity = bindInfo.pEntity) == nullptr) {
@@ -293,13 +518,417 @@ void core::MRenderer::updateBoundEntities() {
     }
 
     // Update model matrices
-    pEntity->updateModel();
+    pEntity->updateModel(step.interpolation);
   }
 
   // Use this thread to also quickly process camera exposure level
   updateExposureLevel();
 }
 
+void core::MRenderer::updateTextureStreaming() {
+  RE_PROFILE_SCOPE("Texture streaming");
+
+  ACamera* pCamera = core::actors.getCamera(RCAM_MAIN);
+
+  if (pCamera) {
+    const glm::vec3 cameraLocation = pCamera->getLocation();
+    const float projectionScale = std::abs(pCamera->getProjection()[1][1]);
+    const float viewportHeight = static_cast<float>(config::renderHeight);
+
+    glm::vec4 frustumPlanes[6];
+    math::getFrustumPlanes(pCamera->getProjectionView(), frustumPlanes);
+
+    for (const auto& bindInfo : system.bindings) {
+      AEntity* pEntity = bindInfo.pEntity;
+      WModel* pModel = pEntity ? pEntity->getModel() : nullptr;
+
+      if (!pModel) continue;
+
+      const glm::mat4& rootMatrix = pEntity->getRootTransformationMatrix();
+
+      // bind pose extents don't follow animated skins, posed bounds do
+      glm::vec3 entityMin, entityMax;
+      const bool hasEntityBounds = pEntity->getBoundingBox(entityMin, entityMax);
+
+      for (WPrimitive* pPrimitive : pModel->getPrimitives()) {
+        const WModel::Node* pNode = reinterpret_cast<WModel::Node*>(pPrimitive->pOwnerNode);
+        glm::vec3 center;
+        float radius;
+
+        if (hasEntityBounds && pNode && pNode->skinIndex > -1) {
+          center = (entityMin + entityMax) * 0.5f;
+          radius = glm::length(entityMax - entityMin) * 0.5f;
+        } else {
+          glm::vec3 min, max;
+
+          // primitives without bounds are treated as covering the whole view
+          if (!pPrimitive->getBoundingBoxExtent(min, max)) {
+            core::resources.requestTextureDetail(pPrimitive->pInitialMaterial,
+                                                 viewportHeight);
+            continue;
+          }
+
+          // primitive bounds are local to their node
+          glm::mat4 modelMatrix = rootMatrix;
+
+          if (pNode) {
+            pEntity->getRenderedNodeMatrix(pNode->index, modelMatrix);
+          }
+
+          const float maxScale =
+              std::max({glm::length(glm::vec3(modelMatrix[0])),
+                        glm::length(glm::vec3(modelMatrix[1])),
+                        glm::length(glm::vec3(modelMatrix[2]))});
+
+          center = glm::vec3(modelMatrix * glm::vec4((min + max) * 0.5f, 1.0f));
+          radius = glm::length(max - min) * 0.5f * maxScale;
+        }
+
+        bool isVisible = true;
+
+        for (uint8_t i = 0; i < 6; ++i) {
+          if (glm::dot(glm::vec3(frustumPlanes[i]), center) + frustumPlanes[i].w < -radius) {
+            isVisible = false;
+            break;
+          }
+        }
+
+        if (!isVisible) continue;
+
+        core::resources.requestTextureDetail(
+            pPrimitive->pInitialMaterial,
+            RTextureStreamer::getScreenSize(radius, glm::distance(center, cameraLocation),
+                                            projectionScale, viewportHeight));
+      }
+    }
+  }
+
+  core::resources.updateTextureStreaming();
+}
+
+void core::MRenderer::cullOccludedEntities(const uint32_t frameIndex) {
+  RE_PROFILE_SCOPE("Occlusion culling");
+
+  occlusion.entityVisibility.assign(system.bindings.size(), 1u);
+  occlusion.pCameras[frameIndex] = nullptr;
+
+  ACamera* pCamera = core::actors.getCamera(RCAM_MAIN);
+
+  if (!occlusion.isEnabled || !pCamera) return;
+
+  occlusion.culler.reset(pCamera->getProjectionView());
+
+  for (const auto& bindInfo : system.bindings) {
+    if (bindInfo.pEntity) {
+      bindInfo.pEntity->addOccluders(occlusion.culler);
+    }
+  }
+
+  core::jobs.parallelFor(occlusion.culler.getBandCount(), 1u,
+                         [this](const uint32_t begin, const uint32_t end) {
+                           for (uint32_t band = begin; band < end; ++band) {
+                             occlusion.culler.rasterizeBand(band);
+                           }
+                         });
+
+  // entities without bounds are always visible
+  core::jobs.parallelFor(
+      static_cast<uint32_t>(system.bindings.size()), 0u,
+      [this](const uint32_t begin, const uint32_t end) {
+        glm::vec3 min, max;
+
+        for (uint32_t i = begin; i < end; ++i) {
+          AEntity* pEntity = system.bindings[i].pEntity;
+
+          if (pEntity && pEntity->getBoundingBox(min, max)) {
+            occlusion.entityVisibility[i] = occlusion.culler.isVisible(min, max);
+          }
+        }
+      });
+
+  occlusion.pCameras[frameIndex] = pCamera;
+}
+
+void core::MRenderer::cullMeshlets(const uint32_t frameIndex) {
+  RE_PROFILE_SCOPE("Meshlet culling");
+
+  meshlets.pCameras[frameIndex] = nullptr;
+  meshlets.primitives.clear();
+
+  ACamera* pCamera = core::actors.getCamera(RCAM_MAIN);
+  const bool isEnabled = meshlets.isEnabled && pCamera;
+
+  // skinned vertices move away from the meshlet bounds
+  for (WModel* pModel : scene.pModelReferences) {
+    for (WPrimitive* pPrimitive : pModel->m_pLinearPrimitives) {
+      const WModel::Node* pNode = reinterpret_cast<WModel::Node*>(pPrimitive->pOwnerNode);
+      pPrimitive->meshletRanges[frameIndex].isValid = false;
+
+      if (isEnabled && pNode && pNode->skinIndex < 0 &&
+          !pPrimitive->meshletData.meshlets.empty() &&
+          pPrimitive->instanceRanges[frameIndex].visibleCount > 0u) {
+        meshlets.primitives.emplace_back(pPrimitive);
+      }
+    }
+  }
+
+  if (meshlets.primitives.empty()) return;
+
+  const glm::mat4 projectionView = pCamera->getProjectionView();
+  const glm::vec3 cameraLocation = pCamera->getLocation();
+
+  core::jobs.parallelFor(
+      static_cast<uint32_t>(meshlets.primitives.size()), 0u,
+      [this, frameIndex, &projectionView, &cameraLocation](const uint32_t begin,
+                                                           const uint32_t end) {
+        std::vector<glm::mat4> modelMatrices;
+
+        for (uint32_t i = begin; i < end; ++i) {
+          WPrimitive* pPrimitive = meshlets.primitives[i];
+          const WModel::Node* pNode = reinterpret_cast<WModel::Node*>(pPrimitive->pOwnerNode);
+          const auto& instanceRange = pPrimitive->instanceRanges[frameIndex];
+          auto& meshletRange = pPrimitive->meshletRanges[frameIndex];
+
+          // instances packed as visible this frame, the same ones main camera views draw
+          modelMatrices.clear();
+          bool hasMatrices = true;
+
+          for (const auto& instanceDataEntry : pPrimitive->instanceData) {
+            const int32_t bindingIndex = instanceDataEntry.bindingIndex;
+
+            if (!instanceDataEntry.isVisible ||
+                instanceDataEntry.instanceIndex - instanceRange.firstInstance >= instanceRange.visibleCount) {
+              continue;
+            }
+
+            const AEntity* pEntity =
+                (bindingIndex > -1 && bindingIndex < static_cast<int32_t>(system.bindings.size()))
+                    ? system.bindings[bindingIndex].pEntity
+                    : nullptr;
+
+            hasMatrices = pEntity && pEntity->getRenderedNodeMatrix(pNode->index, modelMatrices.emplace_back());
+
+            if (!hasMatrices) break;
+          }
+
+          // instances without a known transformation draw the whole primitive
+          if (!hasMatrices || modelMatrices.size() != instanceRange.visibleCount) continue;
+
+          const bool testNormalCone =
+              pPrimitive->pInitialMaterial &&
+              (pPrimitive->pInitialMaterial->passFlags &
+               (EDynamicRenderingPass::OpaqueCullBack | EDynamicRenderingPass::MaskCullBack));
+
+          const uint32_t culledTriangleCount = pPrimitive->cullMeshlets(
+              modelMatrices.data(), instanceRange.visibleCount, projectionView, cameraLocation,
+              testNormalCone, meshletRange.indexRanges);
+
+          meshletRange.triangleCount = pPrimitive->indexCount / 3u * instanceRange.visibleCount;
+          meshletRange.culledTriangleCount = culledTriangleCount * instanceRange.visibleCount;
+          meshletRange.isValid = true;
+        }
+      });
+
+  meshlets.pCameras[frameIndex] = pCamera;
+}
+
+void core::MRenderer::updateMeshletStatistics(const uint32_t frameIndex) {
+  for (WModel* pModel : scene.pModelReferences) {
+    RMeshletStatistics* pStatistics = nullptr;
+
+    for (const WPrimitive* pPrimitive : pModel->m_pLinearPrimitives) {
+      const auto& meshletRange = pPrimitive->meshletRanges[frameIndex];
+
+      if (!meshletRange.isValid) continue;
+
+      if (!pStatistics) {
+        pStatistics = &meshlets.statistics[pModel->getName()];
+        ++pStatistics->frameCount;
+      }
+
+      pStatistics->triangleCount += meshletRange.triangleCount;
+      pStatistics->culledTriangleCount += meshletRange.culledTriangleCount;
+    }
+  }
+}
+
+void core::MRenderer::updateShadowCascades(const uint32_t frameIndex) {
+  RE_PROFILE_SCOPE("Shadow cascades");
+
+  const uint32_t cascadeCount = shadows.cascades.getCascadeCount();
+  const uint32_t bindingCount = static_cast<uint32_t>(system.bindings.size());
+
+  shadows.entityCascades.assign(bindingCount, 0u);
+  shadows.entityStatic.assign(bindingCount, 0u);
+  shadows.entitySignatures.assign(bindingCount, 0u);
+  shadows.updateMasks[frameIndex] = 0u;
+  shadows.cacheMasks[frameIndex] = 0u;
+
+  ACamera* pCamera = core::actors.getCamera(RCAM_MAIN);
+
+  if (!pCamera || !view.pSunCamera || cascadeCount == 0u) return;
+
+  shadows.cascades.fit(pCamera->getView(), pCamera->getProjection(),
+                       pCamera->getNearAndFarPlane().x, config::shadowDistance,
+                       view.pSunCamera->getForwardVector());
+
+  // entities without bounds cast shadows into every cascade
+  const uint8_t allCascades = static_cast<uint8_t>((1u << cascadeCount) - 1u);
+
+  core::jobs.parallelFor(bindingCount, 0u,
+      [this, cascadeCount, allCascades](const uint32_t begin, const uint32_t end) {
+        glm::vec3 min, max;
+
+        for (uint32_t i = begin; i < end; ++i) {
+          AEntity* pEntity = system.bindings[i].pEntity;
+
+          if (!pEntity) continue;
+
+          if (!pEntity->getBoundingBox(min, max)) {
+            shadows.entityCascades[i] = allCascades;
+            continue;
+          }
+
+          uint8_t cascades = 0u;
+
+          for (uint32_t cascadeIndex = 0; cascadeIndex < cascadeCount; ++cascadeIndex) {
+            if (shadows.cascades.intersects(cascadeIndex, min, max)) {
+              cascades |= static_cast<uint8_t>(1u << cascadeIndex);
+            }
+          }
+
+          // bounds identify a caster moving into, out of or within a cascade
+          uint64_t hash = 14695981039346656037ull ^ i;
+          const float values[6] = {min.x, min.y, min.z, max.x, max.y, max.z};
+
+          for (const float value : values) {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(uint32_t));
+            hash = (hash ^ bits) * 1099511628211ull;
+          }
+
+          // static actors which stopped moving are cached, animated ones never are
+          const bool isStatic = pEntity->getTypeId() == EActorType::Static &&
+                                !pEntity->hasPlayingAnimations() &&
+                                pEntity->getUnchangedFrameCount() >= RShadowCascades::staticCasterFrames;
+
+          shadows.entityCascades[i] = cascades;
+          shadows.entityStatic[i] = isStatic;
+          shadows.entitySignatures[i] = hash;
+        }
+      });
+
+  uint64_t signatures[RE_MAXCASCADES] = {};
+  uint64_t staticSignatures[RE_MAXCASCADES] = {};
+  uint32_t dirtyMask = 0u;
+
+  for (uint32_t i = 0; i < bindingCount; ++i) {
+    const uint8_t cascades = shadows.entityCascades[i];
+
+    if (!cascades) continue;
+
+    for (uint32_t cascadeIndex = 0; cascadeIndex < cascadeCount; ++cascadeIndex) {
+      if (cascades & (1u << cascadeIndex)) {
+        signatures[cascadeIndex] += shadows.entitySignatures[i];
+
+        if (shadows.entityStatic[i]) {
+          staticSignatures[cascadeIndex] += shadows.entitySignatures[i];
+        }
+      }
+    }
+
+    if (system.bindings[i].pEntity->hasPlayingAnimations()) {
+      dirtyMask |= cascades;
+    }
+  }
+
+  if (!shadows.isSchedulingEnabled) {
+    shadows.cascades.invalidate();
+  }
+
+  shadows.updateMasks[frameIndex] = shadows.cascades.schedule(signatures, dirtyMask);
+
+  if (!shadows.isStaticCachingEnabled) {
+    shadows.cascades.invalidateStaticCache();
+  }
+
+  shadows.cacheMasks[frameIndex] =
+      shadows.cascades.scheduleStaticCache(staticSignatures, shadows.updateMasks[frameIndex]);
+
+  for (uint32_t cascadeIndex = 0; cascadeIndex < cascadeCount; ++cascadeIndex) {
+    shadows.frameCascades[frameIndex][cascadeIndex] =
+        shadows.cascades.getRenderedCascade(cascadeIndex);
+  }
+}
+
+void core::MRenderer::clusterPointLights(const uint32_t frameIndex) {
+  RE_PROFILE_SCOPE("Light clustering");
+
+  RLightingUBO& data = lighting.data;
+  data.clusterGrid = glm::uvec4(RLightClusters::gridX, RLightClusters::gridY,
+                                RLightClusters::gridZ, 0u);
+  data.pointLightAddress = lighting.pointLightBuffers[frameIndex].deviceAddress;
+  data.clusterAddress = lighting.clusterBuffers[frameIndex].deviceAddress;
+  data.lightIndexAddress = lighting.lightIndexBuffers[frameIndex].deviceAddress;
+
+  ACamera* pCamera = core::actors.getCamera(RCAM_MAIN);
+
+  // lights past the budget are not shaded
+  const uint32_t lightCount = std::min(static_cast<uint32_t>(lighting.pointLights.size()),
+                                       static_cast<uint32_t>(config::scene::pointLightBudget));
+
+  if (!pCamera || lightCount == 0u) return;
+
+  const glm::mat4& view = pCamera->getView();
+  const glm::vec2 planes = pCamera->getNearAndFarPlane();
+
+  lighting.clusters.prepare(view, pCamera->getProjection(), planes.x, planes.y,
+                            lighting.pointLights.data(), lightCount);
+
+  core::jobs.parallelFor(RLightClusters::gridZ, 1u,
+                         [this](const uint32_t begin, const uint32_t end) {
+                           for (uint32_t slice = begin; slice < end; ++slice) {
+                             lighting.clusters.buildSlice(slice);
+                           }
+                         });
+
+  const uint32_t indexCount =
+      lighting.clusters.finalize(static_cast<uint32_t>(config::scene::lightIndexBudget));
+  const std::vector<RLightCluster>& clusters = lighting.clusters.getClusters();
+
+  // reported once until the clusters fit again, dropped lights are the farthest
+  const uint32_t cappedCount = lighting.clusters.getCappedClusterCount();
+  const uint32_t truncatedCount = lighting.clusters.getTruncatedClusterCount();
+  const bool isCapped = cappedCount > 0u || truncatedCount > 0u;
+
+  if (isCapped && !lighting.isClusterCapReported) {
+    RE_LOG(Warning,
+           "Point lights were dropped, %d clusters exceed %d lights, %d clusters "
+           "exceed the light index budget of %d.",
+           cappedCount, RLightClusters::maxClusterLights, truncatedCount,
+           static_cast<uint32_t>(config::scene::lightIndexBudget));
+  }
+
+  lighting.isClusterCapReported = isCapped;
+
+  memcpy(lighting.pointLightBuffers[frameIndex].allocInfo.pMappedData,
+         lighting.pointLights.data(), sizeof(RPointLight) * lightCount);
+  memcpy(lighting.clusterBuffers[frameIndex].allocInfo.pMappedData, clusters.data(),
+         sizeof(RLightCluster) * clusters.size());
+  memcpy(lighting.lightIndexBuffers[frameIndex].allocInfo.pMappedData,
+         lighting.clusters.getIndices().data(), sizeof(uint32_t) * indexCount);
+
+  // view space of the engine is left handed, depth is the view z
+  const glm::vec2 sliceScaleAndBias = lighting.clusters.getSliceScaleAndBias();
+
+  data.clusterViewProjection = pCamera->getProjectionView();
+  data.clusterDepthPlane = glm::vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+  data.clusterDepthParams =
+      glm::vec4(lighting.clusters.getNearPlane(), lighting.clusters.getFarPlane(),
+                sliceScaleAndBias.x, sliceScaleAndBias.y);
+  data.clusterGrid.w = lightCount;
+}
+
 void core::MRenderer::updateExposureLevel() {
   const float deltaTime = core::time.getDeltaTime();
   float brightnessData[256];
@@ -481,8 +1110,10 @@ void core::MRenderer::setImageLayout(VkCommandBuffer cmdBuffer, VkImage image,
     case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
     case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
     // Image layout will be used as a depth/stencil attachment.
-    // Make sure any writes to depth/stencil buffer have finished.
+    // Make sure any writes to depth/stencil buffer have finished,
+    // attachments may be loaded instead of cleared.
     imageMemoryBarrier.dstAccessMask =
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
     break;
 
@@ -951,11 +1582,29 @@ void core::MRenderer::beginCommandBuffer(VkCommandBuffer cmdBuffer, bool oneTime
 void core::MRenderer::flushCommandBuffer(VkCommandBuffer cmdBuffer, ECmdType type, bool free, bool useFence) {
   vkEndCommandBuffer(cmdBuffer);
 
+  // commands may read data that is still queued for upload
+  const uint64_t uploadValue = flushUploads();
+
   VkSubmitInfo submitInfo{};
   submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
   submitInfo.pCommandBuffers = &cmdBuffer;
   submitInfo.commandBufferCount = 1;
 
+  // graphics and transfer queues are already ordered after submitted uploads
+  const VkPipelineStageFlags uploadWaitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  VkTimelineSemaphoreSubmitInfo uploadWaitInfo{};
+
+  if (type == ECmdType::Compute && uploadValue > 0u) {
+    uploadWaitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    uploadWaitInfo.waitSemaphoreValueCount = 1;
+    uploadWaitInfo.pWaitSemaphoreValues = &uploadValue;
+
+    submitInfo.pNext = &uploadWaitInfo;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &upload.timeline;
+    submitInfo.pWaitDstStageMask = &uploadWaitStage;
+  }
+
   VkQueue cmdQueue = getCommandQueue(type);
   VkFence fence = VK_NULL_HANDLE;
 
@@ -966,10 +1615,14 @@ void core::MRenderer::flushCommandBuffer(VkCommandBuffer cmdBuffer, ECmdType typ
     vkCreateFence(logicalDevice.device, &fenceInfo, nullptr, &fence);
   }
 
-  vkQueueSubmit(cmdQueue, 1, &submitInfo, fence);
+  {
+    std::lock_guard<std::mutex> queueLock(sync.queueMutex);
+    vkQueueSubmit(cmdQueue, 1, &submitInfo, fence);
+  }
 
   switch (useFence) {
     case false: {
+    std::lock_guard<std::mutex> queueLock(sync.queueMutex);
     vkQueueWaitIdle(cmdQueue);
     break;
     }
@@ -1057,6 +1710,7 @@ uint32_t core::MRenderer::bindEntity(AEntity* pEntity) {
     auto& instanceData = primitive->instanceData.emplace_back();
     instanceData.instanceIndex = scene.currentInstanceUID++;
     instanceData.isVisible = true;
+    instanceData.bindingIndex = static_cast<int32_t>(system.bindings.size() - 1);
     instanceData.instanceBufferBlock.modelMatrixId = pEntity->getRootTransformBufferIndex();
     instanceData.instanceBufferBlock.nodeMatrixId = pEntity->getNodeTransformBufferIndex(pNode->index);
     instanceData.instanceBufferBlock.skinMatrixId = pEntity->getSkinTransformBufferIndex(pNode->skinIndex);
@@ -1067,8 +1721,8 @@ uint32_t core::MRenderer::bindEntity(AEntity* pEntity) {
   /*VkDrawIndexedIndirectCommand drawCommand{};
   drawCommand.firstInstance = 0;
   drawCommand.instanceCount = 1;
-  drawCommand.vertexOffset = scene.currentVertexOffset;
-  drawCommand.firstIndex = scene.currentIndexOffset;
+  drawCommand.vertexOffset = pModel->m_sceneVertexOffset;
+  drawCommand.firstIndex = pModel->m_sceneIndexOffset;
   drawCommand.indexCount = pModel->m_indexCount;
 
   system.drawCommands.emplace_back(drawCommand);*/
@@ -1104,30 +1758,209 @@ void core::MRenderer::unbindEntity(uint32_t index) {
 void core::MRenderer::clearBoundEntities() { system.bindings.clear(); }
 
 void core::MRenderer::uploadModelToSceneBuffer(WModel* pModel) {
-  // Copy vertex buffer
-  VkBufferCopy copyInfo{};
-  copyInfo.srcOffset = 0u;
-  copyInfo.dstOffset = scene.currentVertexOffset * sizeof(RVertex);
-  copyInfo.size = sizeof(RVertex) * pModel->m_vertexCount;
+  if (pModel->m_vertexCount == 0u || pModel->m_indexCount == 0u) {
+    RE_LOG(Error, "Can't upload model \"%s\" to scene buffers, it has no geometry.",
+           pModel->getName());
+    return;
+  }
+
+  // ranges released by destroyed models may be reused now
+  retireGeometryReleases(false);
+
+  const uint32_t vertexCount = pModel->m_vertexCount;
+  const uint32_t indexCount = pModel->m_indexCount;
+  uint32_t pageIndex = 0u;
+  uint32_t vertexOffset = RRangeAllocator::invalidOffset;
+  uint32_t indexOffset = RRangeAllocator::invalidOffset;
+
+  for (; pageIndex < scene.geometryPages.size(); ++pageIndex) {
+    auto& page = scene.geometryPages[pageIndex];
 
-  copyBuffer(&pModel->staging.vertexBuffer, &scene.vertexBuffer, &copyInfo);
+    if (page.vertexRanges.getLargestFreeRange() < vertexCount ||
+        page.indexRanges.getLargestFreeRange() < indexCount) {
+      continue;
+    }
+
+    vertexOffset = page.vertexRanges.allocate(vertexCount);
+    indexOffset = page.indexRanges.allocate(indexCount);
+    break;
+  }
+
+  // no page can fit the model, allocate a new one large enough for it
+  if (vertexOffset == RRangeAllocator::invalidOffset) {
+    if (createGeometryPage(
+            std::max(static_cast<uint32_t>(config::scene::vertexBudget), vertexCount),
+            std::max(static_cast<uint32_t>(config::scene::indexBudget), indexCount)) != RE_OK) {
+      RE_LOG(Critical, "Failed to allocate scene buffers for model \"%s\".",
+             pModel->getName());
+      return;
+    }
+
+    pageIndex = static_cast<uint32_t>(scene.geometryPages.size() - 1);
+    vertexOffset = scene.geometryPages[pageIndex].vertexRanges.allocate(vertexCount);
+    indexOffset = scene.geometryPages[pageIndex].indexRanges.allocate(indexCount);
+  }
 
-  // Copy index buffer
-  copyInfo.dstOffset = scene.currentIndexOffset * sizeof(uint32_t);
-  copyInfo.size = sizeof(uint32_t) * pModel->m_indexCount;
+  auto& page = scene.geometryPages[pageIndex];
 
-  copyBuffer(&pModel->staging.indexBuffer, &scene.indexBuffer, &copyInfo);
+  // Queue vertex and index data copies, submitted in a batch with other uploads
+  queueBufferUpload(&page.vertexBuffer, pModel->staging.vertices.data(),
+                    sizeof(RVertex) * vertexCount, vertexOffset * sizeof(RVertex));
+  queueBufferUpload(&page.indexBuffer, pModel->staging.indices.data(),
+                    sizeof(uint32_t) * indexCount, indexOffset * sizeof(uint32_t));
 
   // Set offsets in the model for future reference
-  pModel->m_sceneVertexOffset = scene.currentVertexOffset;
-  pModel->m_sceneIndexOffset = scene.currentIndexOffset;
+  pModel->m_sceneGeometryPage = static_cast<int32_t>(pageIndex);
+  pModel->m_sceneVertexOffset = vertexOffset;
+  pModel->m_sceneIndexOffset = indexOffset;
+  page.pModels.emplace(pModel);
 
   // Remove model staging data from memory
   pModel->clearStagingData();
+}
+
+void core::MRenderer::releaseModelFromSceneBuffer(WModel* pModel) {
+  const int32_t pageIndex = pModel->m_sceneGeometryPage;
+
+  // model was never uploaded or scene buffers are already destroyed
+  if (pageIndex < 0 || static_cast<size_t>(pageIndex) >= scene.geometryPages.size()) {
+    pModel->m_sceneGeometryPage = -1;
+    return;
+  }
 
-  // Move scene offsets
-  scene.currentVertexOffset += pModel->m_vertexCount;
-  scene.currentIndexOffset += pModel->m_indexCount;
+  scene.geometryPages[pageIndex].pModels.erase(pModel);
+
+  RGeometryRelease& release = scene.geometryReleases.emplace_back();
+  release.pageIndex = static_cast<uint32_t>(pageIndex);
+  release.vertexOffset = pModel->m_sceneVertexOffset;
+  release.vertexCount = pModel->m_vertexCount;
+  release.indexOffset = pModel->m_sceneIndexOffset;
+  release.indexCount = pModel->m_indexCount;
+  release.releaseFrame = renderView.framesRendered;
+
+  pModel->m_sceneGeometryPage = -1;
+}
+
+void core::MRenderer::retireGeometryReleases(const bool force) {
+  for (auto it = scene.geometryReleases.begin();
+       it != scene.geometryReleases.end();) {
+    if (!force &&
+        renderView.framesRendered < it->releaseFrame + MAX_FRAMES_IN_FLIGHT) {
+      ++it;
+      continue;
+    }
+
+    auto& page = scene.geometryPages[it->pageIndex];
+    page.vertexRanges.release(it->vertexOffset, it->vertexCount);
+    page.indexRanges.release(it->indexOffset, it->indexCount);
+
+    if ((it->pageIndex > 0u && page.pModels.empty()) ||
+        page.vertexRanges.getFragmentation() > config::scene::defragmentationThreshold ||
+        page.indexRanges.getFragmentation() > config::scene::defragmentationThreshold) {
+      scene.isDefragmentationPending = true;
+    }
+
+    it = scene.geometryReleases.erase(it);
+  }
+}
+
+TResult core::MRenderer::defragmentSceneBuffers() {
+  waitForUpload(flushUploads());
+  {
+    std::lock_guard<std::mutex> queueLock(sync.queueMutex);
+    vkDeviceWaitIdle(logicalDevice.device);
+  }
+  retireGeometryReleases(true);
+
+  // a failed attempt is not repeated until more ranges are released
+  scene.isDefragmentationPending = false;
+
+  for (uint32_t pageIndex = 0; pageIndex < scene.geometryPages.size();) {
+    auto& page = scene.geometryPages[pageIndex];
+
+    // additional pages are removed once empty, the first page is always kept
+    if (pageIndex > 0 && page.pModels.empty()) {
+      vmaDestroyBuffer(memAlloc, page.vertexBuffer.buffer,
+                       page.vertexBuffer.allocation);
+      vmaDestroyBuffer(memAlloc, page.indexBuffer.buffer,
+                       page.indexBuffer.allocation);
+
+      scene.geometryPages.erase(scene.geometryPages.begin() + pageIndex);
+
+      for (auto& remainingPage : scene.geometryPages) {
+        for (WModel* pModel : remainingPage.pModels) {
+          if (pModel->m_sceneGeometryPage > static_cast<int32_t>(pageIndex)) {
+            --pModel->m_sceneGeometryPage;
+          }
+        }
+      }
+
+      continue;
+    }
+
+    if (page.vertexRanges.getFragmentation() == 0.0f &&
+        page.indexRanges.getFragmentation() == 0.0f) {
+      ++pageIndex;
+      continue;
+    }
+
+    // pack every model of this page into new buffers of the same size
+    const uint32_t vertexCapacity = page.vertexRanges.getCapacity();
+    const uint32_t indexCapacity = page.indexRanges.getCapacity();
+
+    RBuffer vertexBuffer, indexBuffer;
+    if (createBuffer(EBufferType::DGPU_VERTEX, sizeof(RVertex) * vertexCapacity,
+                     vertexBuffer, nullptr) != RE_OK) {
+      RE_LOG(Error, "Failed to defragment scene buffers, couldn't create a vertex buffer.");
+      return RE_ERROR;
+    }
+
+    if (createBuffer(EBufferType::DGPU_INDEX, sizeof(uint32_t) * indexCapacity,
+                     indexBuffer, nullptr) != RE_OK) {
+      RE_LOG(Error, "Failed to defragment scene buffers, couldn't create an index buffer.");
+      vmaDestroyBuffer(memAlloc, vertexBuffer.buffer, vertexBuffer.allocation);
+      return RE_ERROR;
+    }
+
+    page.vertexRanges.reset(vertexCapacity);
+    page.indexRanges.reset(indexCapacity);
+
+    for (WModel* pModel : page.pModels) {
+      const uint32_t vertexOffset = page.vertexRanges.allocate(pModel->m_vertexCount);
+      const uint32_t indexOffset = page.indexRanges.allocate(pModel->m_indexCount);
+
+      VkBufferCopy copyInfo{};
+      copyInfo.srcOffset = pModel->m_sceneVertexOffset * sizeof(RVertex);
+      copyInfo.dstOffset = vertexOffset * sizeof(RVertex);
+      copyInfo.size = sizeof(RVertex) * pModel->m_vertexCount;
+
+      copyBuffer(&page.vertexBuffer, &vertexBuffer, &copyInfo);
+
+      copyInfo.srcOffset = pModel->m_sceneIndexOffset * sizeof(uint32_t);
+      copyInfo.dstOffset = indexOffset * sizeof(uint32_t);
+      copyInfo.size = sizeof(uint32_t) * pModel->m_indexCount;
+
+      copyBuffer(&page.indexBuffer, &indexBuffer, &copyInfo);
+
+      pModel->m_sceneVertexOffset = vertexOffset;
+      pModel->m_sceneIndexOffset = indexOffset;
+    }
+
+    vmaDestroyBuffer(memAlloc, page.vertexBuffer.buffer,
+                     page.vertexBuffer.allocation);
+    vmaDestroyBuffer(memAlloc, page.indexBuffer.buffer,
+                     page.indexBuffer.allocation);
+
+    page.vertexBuffer = vertexBuffer;
+    page.indexBuffer = indexBuffer;
+
+    ++pageIndex;
+  }
+
+  RE_LOG(Log, "Defragmented scene buffers, %d geometry pages in use.",
+         static_cast<int32_t>(scene.geometryPages.size()));
+
+  return RE_OK;
 }
 
 void core::MRenderer::setCamera(const char* name) {
@@ -1196,4 +2029,33 @@ void core::MRenderer::setShadowColor(const glm::vec3& color) {
 
 void core::MRenderer::setBloomIntensity(const float intensity) {
   lighting.data.bloomIntensity = intensity;
+}
+
+void core::MRenderer::setSkinningPrePass(const bool enable) {
+  skinning.isEnabled = enable;
+}
+
+void core::MRenderer::setOcclusionCulling(const bool enable) {
+  occlusion.isEnabled = enable;
+}
+
+void core::MRenderer::setMeshletCulling(const bool enable) {
+  meshlets.isEnabled = enable;
+}
+
+const std::unordered_map<std::string, RMeshletStatistics>&
+core::MRenderer::getMeshletStatistics() const {
+  return meshlets.statistics;
+}
+
+void core::MRenderer::resetMeshletStatistics() {
+  meshlets.statistics.clear();
+}
+
+void core::MRenderer::setShadowCascadeScheduling(const bool enable) {
+  shadows.isSchedulingEnabled = enable;
+}
+
+void core::MRenderer::setStaticShadowCaching(const bool enable) {
+  shadows.isStaticCachingEnabled = enable;
 }
\ No newline at end of file
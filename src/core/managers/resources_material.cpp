@@ -13,16 +13,19 @@ void core::MResources::initialize() {
   RMaterial* pMaterial = nullptr;
   m_materialIndices.resize(config::scene::sampledImageBudget / RE_MAXTEXTURES, nullptr);
   m_samplerIndices.resize(config::scene::sampledImageBudget, nullptr);
+  m_materialSlots.reset(static_cast<uint32_t>(m_materialIndices.size()));
+  m_samplerSlots.reset(static_cast<uint32_t>(m_samplerIndices.size()));
 
   // create the "default" material
-  RSamplerInfo samplerInfo{};
+  std::vector<RTextureLoadInfo> textureLoadInfos(6);
+  textureLoadInfos[0].filePath = RE_DEFAULTTEXTURE;
+  textureLoadInfos[1].filePath = "default/default_normal.ktx2";
+  textureLoadInfos[2].filePath = "default/default_metallicRoughness.ktx2";
+  textureLoadInfos[3].filePath = "default/default_occlusion.ktx2";
+  textureLoadInfos[4].filePath = RE_BLACKTEXTURE;
+  textureLoadInfos[5].filePath = RE_WHITETEXTURE;
 
-  loadTexture(RE_DEFAULTTEXTURE, &samplerInfo);
-  loadTexture("default/default_normal.ktx2", &samplerInfo);
-  loadTexture("default/default_metallicRoughness.ktx2", &samplerInfo);
-  loadTexture("default/default_occlusion.ktx2", &samplerInfo);
-  loadTexture(RE_BLACKTEXTURE, &samplerInfo);
-  loadTexture(RE_WHITETEXTURE, &samplerInfo);
+  loadTextures(textureLoadInfos);
 
   // Create default material
   RMaterialInfo materialInfo{};
@@ -36,7 +39,6 @@ void core::MResources::initialize() {
   materialInfo.name = RMAT_SHADOW;
   materialInfo.textures.baseColor = RTGT_SHADOW;
   materialInfo.doubleSided = false;
-  materialInfo.manageTextures = true;
   materialInfo.passFlags = EDynamicRenderingPass::Shadow;
 
   if (!(pMaterial = createMaterial(&materialInfo))) {
@@ -46,7 +48,11 @@ void core::MResources::initialize() {
   }
 
   core::renderer.getMaterialData()->pSunShadow = pMaterial;
-  core::renderer.getLightingData()->data.samplerArrayIndex[0] = pMaterial->pBaseColor->combinedSamplerIndex;
+
+  // render targets don't exist in headless mode
+  if (pMaterial->pBaseColor) {
+    core::renderer.getLightingData()->data.samplerArrayIndex[0] = pMaterial->pBaseColor->combinedSamplerIndex;
+  }
 
   materialInfo = RMaterialInfo{};
   materialInfo.name = RMAT_GBUFFER;
@@ -57,7 +63,6 @@ void core::MResources::initialize() {
   materialInfo.textures.emissive = RTGT_GEMISSIVE;
   materialInfo.alphaMode = EAlphaMode::Opaque;
   materialInfo.doubleSided = false;
-  materialInfo.manageTextures = true;
   materialInfo.passFlags = EDynamicRenderingPass::PBR;
 
   if (!(pMaterial = createMaterial(&materialInfo))) {
@@ -81,7 +86,6 @@ void core::MResources::initialize() {
   materialInfo.textures.extra1 = RTGT_PPAO;
   materialInfo.alphaMode = EAlphaMode::Opaque;
   materialInfo.doubleSided = false;
-  materialInfo.manageTextures = true;
   materialInfo.passFlags = EDynamicRenderingPass::Present;
 
   if (!(pMaterial = createMaterial(&materialInfo))) {
@@ -100,7 +104,6 @@ void core::MResources::initialize() {
   materialInfo.textures.occlusion = RTGT_PPAO;
   materialInfo.alphaMode = EAlphaMode::Opaque;
   materialInfo.doubleSided = false;
-  materialInfo.manageTextures = true;
   materialInfo.passFlags = EDynamicRenderingPass::PPBlur;
 
   if (!(pMaterial = createMaterial(&materialInfo))) {
@@ -113,54 +116,89 @@ void core::MResources::initialize() {
 }
 
 uint32_t core::MResources::getFreeCombinedSamplerIndex() {
-  for (uint32_t i = 0; i < m_samplerIndices.size(); ++i) {
-    if (m_samplerIndices[i] == nullptr) return i;
+  const uint32_t index = m_samplerSlots.allocate();
+
+  if (index == RIndexAllocator::invalidIndex) {
+    RE_LOG(Warning, "No more free sampler2D descriptor entries left.");
+    return -1;
   }
 
-  RE_LOG(Warning, "No more free sampler2D descriptor entries left.");
-  return -1;
+  return index;
+}
+
+void core::MResources::releaseCombinedSamplerIndex(const uint32_t index) {
+  if (!m_samplerSlots.release(index)) {
+    return;
+  }
+
+  m_samplerIndices[index] = nullptr;
+
+  // a queued write would reference an image that is about to be destroyed
+  std::erase_if(m_samplerWrites, [index](const auto& write) {
+    return write.first == index;
+  });
 }
 
 void core::MResources::updateMaterialDescriptorSet(RTexture* pTexture, EResourceType resourceType) {
   // Don't create duplicate entries if this texture was already written to descriptor set
-  if (pTexture->references > 0) return;
-
-  VkWriteDescriptorSet writeSet{};
-  writeSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-  writeSet.dstSet = core::renderer.getMaterialDescriptorSet();
-  writeSet.descriptorCount = 1;
+  if (pTexture->combinedSamplerIndex != -1) return;
 
   switch (resourceType) {
     case EResourceType::Sampler2D: {
-      uint32_t index = getFreeCombinedSamplerIndex();
-
-      VkDescriptorImageInfo imageInfo = pTexture->texture.imageInfo;
-
-      // HACK: this image is expected to be translated to a proper layout later
-      switch (imageInfo.imageLayout) {
-        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-        case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
-        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL: {
-          imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-          break;
-        }
-      }
+      writeCombinedSamplerDescriptor(pTexture, getFreeCombinedSamplerIndex());
+      return;
+    }
+    default: {
+      return;
+    }
+  }
+}
 
-      writeSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-      writeSet.dstBinding = 1;
-      writeSet.dstArrayElement = index;
-      writeSet.pImageInfo = &imageInfo;
+void core::MResources::writeCombinedSamplerDescriptor(RTexture* pTexture, const uint32_t index) {
+  if (index == -1) return;
 
-      vkUpdateDescriptorSets(core::renderer.logicalDevice.device, 1u, &writeSet, 0, nullptr);
+  VkDescriptorImageInfo imageInfo = pTexture->texture.imageInfo;
 
-      // Store index data
-      pTexture->combinedSamplerIndex = index;
-      m_samplerIndices[index] = pTexture;
+  // HACK: this image is expected to be translated to a proper layout later
+  switch (imageInfo.imageLayout) {
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+    case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL: {
+      imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+      break;
+    }
+  }
 
-      return;
+  m_samplerWrites.emplace_back(index, imageInfo);
+
+  // Store index data
+  pTexture->combinedSamplerIndex = index;
+  m_samplerIndices[index] = pTexture;
+}
+
+void core::MResources::updateMaterialSamplerIndex(RTexture* pTexture) {
+  for (auto& it : m_materials) {
+    RMaterial* pMaterial = it.second.get();
+
+    // same order as the sampler indices in the material block
+    RTexture* pMaterialTextures[RE_MAXTEXTURES] = {
+        pMaterial->pBaseColor, pMaterial->pNormal,   pMaterial->pMetalRoughness,
+        pMaterial->pOcclusion, pMaterial->pEmissive, pMaterial->pExtra0,
+        pMaterial->pExtra1,    pMaterial->pExtra2};
+
+    bool isUpdated = false;
+
+    for (uint8_t i = 0; i < RE_MAXTEXTURES; ++i) {
+      if (pMaterialTextures[i] == pTexture) {
+        pMaterial->pushConstantBlock.samplerIndex[i] = pTexture->combinedSamplerIndex;
+        isUpdated = true;
+      }
     }
-    default: {
-      return;
+
+    if (isUpdated && pMaterial->bufferIndex != -1) {
+      RSceneFragmentPCB* pMemAddress = (RSceneFragmentPCB*)core::renderer.getMaterialData()->buffer.allocInfo.pMappedData
+        + pMaterial->bufferIndex;
+      memcpy(pMemAddress, &pMaterial->pushConstantBlock, sizeof(RSceneFragmentPCB));
     }
   }
 }
@@ -183,6 +221,7 @@ RMaterial* core::MResources::createMaterial(
 
   RMaterial newMat;
   newMat.name = pDesc->name;
+  newMat.manageTextures = pDesc->manageTextures;
 
   newMat.pBaseColor = assignTexture(pDesc->textures.baseColor.c_str());
   newMat.pNormal = assignTexture(pDesc->textures.normal.c_str());
@@ -266,7 +305,7 @@ RMaterial* core::MResources::createMaterial(
     }
 
     // Check material for a single bit alpha and reassign it to OpaqueCullNone pass
-    if ((newMat.passFlags & EDynamicRenderingPass::BlendCullNone)
+    if ((newMat.passFlags & EDynamicRenderingPass::BlendCullNone) && newMat.pBaseColor
       && (newMat.pBaseColor->texture.imageFormat == VK_FORMAT_BC1_RGBA_SRGB_BLOCK
         || newMat.pBaseColor->texture.imageFormat == VK_FORMAT_BC1_RGBA_UNORM_BLOCK)) {
       newMat.passFlags ^= EDynamicRenderingPass::BlendCullNone;
@@ -314,6 +353,38 @@ uint32_t core::MResources::getMaterialCount() const noexcept {
   return static_cast<uint32_t>(m_materials.size());
 }
 
+void core::MResources::flushDescriptorWrites() {
+  if (m_samplerWrites.empty()) {
+    return;
+  }
+
+  std::vector<VkWriteDescriptorSet> writeSets(m_samplerWrites.size());
+  const VkDescriptorSet descriptorSet = core::renderer.getMaterialDescriptorSet();
+
+  // writes are applied in order, a later write to the same slot wins
+  for (size_t i = 0; i < m_samplerWrites.size(); ++i) {
+    VkWriteDescriptorSet& writeSet = writeSets[i];
+    writeSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeSet.dstSet = descriptorSet;
+    writeSet.descriptorCount = 1;
+    writeSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writeSet.dstBinding = 1;
+    writeSet.dstArrayElement = m_samplerWrites[i].first;
+    writeSet.pImageInfo = &m_samplerWrites[i].second;
+  }
+
+  vkUpdateDescriptorSets(core::renderer.logicalDevice.device,
+                         static_cast<uint32_t>(writeSets.size()),
+                         writeSets.data(), 0, nullptr);
+
+#ifndef NDEBUG
+  RE_LOG(Log, "Wrote %d combined sampler descriptors.",
+         static_cast<int32_t>(writeSets.size()));
+#endif
+
+  m_samplerWrites.clear();
+}
+
 uint32_t core::MResources::getMaterialBufferIndex(RMaterial* pMaterial) noexcept {
   if (pMaterial->bufferIndex != -1) {
     if (m_materialIndices[pMaterial->bufferIndex] != pMaterial) {
@@ -324,28 +395,40 @@ uint32_t core::MResources::getMaterialBufferIndex(RMaterial* pMaterial) noexcept
     return pMaterial->bufferIndex;
   }
 
-  uint32_t index = 0;
-  for (auto& it : m_materialIndices) {
-    if (it == nullptr) {
-      it = pMaterial;
-      return index;
-    }
+  const uint32_t index = m_materialSlots.allocate();
 
-    ++index;
+  if (index == RIndexAllocator::invalidIndex) {
+    return -1;
   }
 
-  return -1;
+  m_materialIndices[index] = pMaterial;
+  return index;
 }
 
 TResult core::MResources::deleteMaterial(const char* name) noexcept {
-  if (m_materials.contains(name)) {
-    m_materials.at(name).reset();
-    m_materials.erase(name);
+  auto it = m_materials.find(name);
+
+  if (it != m_materials.end()) {
+    RMaterial* pMaterial = it->second.get();
+
+    for (RTexture* pTexture : pMaterial->pLinearTextures) {
+      releaseTexture(pTexture, pMaterial->manageTextures);
+    }
+
+    // material block may still be read by frames in flight
+    if (pMaterial->bufferIndex != -1) {
+      m_releases.push_back({"", pMaterial->bufferIndex,
+                            core::renderer.renderView.framesRendered});
+    }
+
+    RE_LOG(Log, "Deleting material \"%s\".", name);
+
+    m_materials.erase(it);
 
     return RE_OK;
   }
 
-  RE_LOG(Warning, "Could not delete material \"%\", does not exist.", name);
+  RE_LOG(Warning, "Could not delete material \"%s\", does not exist.", name);
   return RE_WARNING;
 }
 
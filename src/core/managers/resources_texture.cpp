@@ -1,131 +1,467 @@
 #include "pch.h"
 #include "core/objects.h"
 #include "core/core.h"
+#include "core/managers/jobs.h"
 #include "core/managers/renderer.h"
 #include "core/material/texture.h"
 #include "core/managers/resources.h"
 
 #include "stb_image.h"
 
-TResult core::MResources::loadTexture(const std::string& filePath,
-                                   RSamplerInfo* pSamplerInfo, const bool createExtraViews) {
-  auto revert = [&](const char* name) { m_textures.erase(name); };
+namespace {
+// reads the whole file and transcodes Basis Universal data to a GPU format,
+// called by loader threads so it must not touch any Vulkan objects
+ktxTexture* readKTXTexture(const std::string& filePath,
+                           const bool useBlockCompression) {
+  const std::string fullPath = RE_PATH_TEXTURES + filePath;
+  ktxTexture* pKTXTexture = nullptr;
 
-  if (filePath == "") {
-    // nothing to load
-    return RE_WARNING;
+  KTX_error_code ktxResult = ktxTexture_CreateFromNamedFile(
+      fullPath.c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &pKTXTexture);
+
+  if (ktxResult != KTX_SUCCESS) {
+    RE_LOG(Error, "Failed reading texture \"%s\". KTX error %d.",
+           filePath.c_str(), ktxResult);
+    return nullptr;
   }
 
-  std::string fullPath = RE_PATH_TEXTURES + filePath;
+  if (pKTXTexture->classId == ktxTexture2_c &&
+      ktxTexture2_NeedsTranscoding(reinterpret_cast<ktxTexture2*>(pKTXTexture))) {
+    const ktx_transcode_fmt_e targetFormat =
+        useBlockCompression ? KTX_TTF_BC7_RGBA : KTX_TTF_RGBA32;
 
-  ktxTexture* pKTXTexture = nullptr;
-  KTX_error_code ktxResult;
-  RVkLogicalDevice* logicalDevice = &core::renderer.logicalDevice;
+    ktxResult = ktxTexture2_TranscodeBasis(
+        reinterpret_cast<ktxTexture2*>(pKTXTexture), targetFormat, 0);
 
-  ktxVulkanDeviceInfo* deviceInfo = ktxVulkanDeviceInfo_Create(
-      core::renderer.physicalDevice.device, logicalDevice->device,
-      logicalDevice->queues.transfer,
-      core::renderer.getCommandPool(ECmdType::Transfer), nullptr);
+    if (ktxResult != KTX_SUCCESS) {
+      RE_LOG(Error, "Failed transcoding texture \"%s\". KTX error %d.",
+             filePath.c_str(), ktxResult);
+      ktxTexture_Destroy(pKTXTexture);
+      return nullptr;
+    }
+  }
 
-  if (!deviceInfo) {
-    RE_LOG(Error, "Failed to retrieve Vulkan device info.");
-    return RE_ERROR;
+  return pKTXTexture;
+}
+
+// sizes of all mip levels, every level includes all of its layers and faces
+std::vector<uint64_t> getKTXLevelSizes(ktxTexture* pKTXTexture) {
+  std::vector<uint64_t> levelSizes(pKTXTexture->numLevels);
+
+  for (uint32_t level = 0; level < pKTXTexture->numLevels; ++level) {
+    levelSizes[level] = ktxTexture_GetImageSize(pKTXTexture, level) *
+                        pKTXTexture->numLayers * pKTXTexture->numFaces;
   }
 
-  ktxResult = ktxTexture_CreateFromNamedFile(
-      fullPath.c_str(), KTX_TEXTURE_CREATE_NO_FLAGS, &pKTXTexture);
+  return levelSizes;
+}
 
-  if (ktxResult != KTX_SUCCESS) {
-    RE_LOG(Error, "Failed reading texture. KTX error %d.", ktxResult);
-    return RE_ERROR;
+// format and layout are hashed too so that equal bytes of different
+// textures don't match
+uint64_t getKTXContentHash(ktxTexture* pKTXTexture) {
+  const uint64_t layout[] = {
+      static_cast<uint64_t>(ktxTexture_GetVkFormat(pKTXTexture)),
+      pKTXTexture->baseWidth, pKTXTexture->baseHeight, pKTXTexture->numLevels,
+      pKTXTexture->numLayers * pKTXTexture->numFaces};
+
+  return util::hashData(ktxTexture_GetData(pKTXTexture),
+                        ktxTexture_GetDataSize(pKTXTexture),
+                        util::hashData(layout, sizeof(layout)));
+}
+
+// textures are only shared if they are sampled and viewed the same way
+uint64_t getTextureLoadHash(const uint64_t contentHash,
+                            const RTextureLoadInfo& loadInfo) {
+  const uint64_t options[] = {
+      static_cast<uint64_t>(loadInfo.createSampler),
+      static_cast<uint64_t>(loadInfo.createSampler ? loadInfo.samplerInfo.filter : 0),
+      static_cast<uint64_t>(loadInfo.createSampler ? loadInfo.samplerInfo.addressMode : 0),
+      static_cast<uint64_t>(loadInfo.createExtraViews),
+      static_cast<uint64_t>(loadInfo.enableStreaming)};
+
+  return util::hashData(options, sizeof(options), contentHash);
+}
+
+// payload comparison with a loaded texture file, a hash match alone can be a
+// collision, container metadata and supercompression are not compared
+bool isEqualKTXTexture(ktxTexture* pKTXTexture, const std::string& filePath,
+                       const bool useBlockCompression) {
+  ktxTexture* pOtherTexture = readKTXTexture(filePath, useBlockCompression);
+
+  if (!pOtherTexture) {
+    return false;
   }
 
-  // create a texture record in the manager
-  if (!m_textures.try_emplace(filePath).second) {
-    // already loaded
-#ifndef NDEBUG
-    RE_LOG(Warning, "Texture \"%s\" already exists.", filePath.c_str());
-#endif
-    return RE_WARNING;
+  bool isEqual =
+      ktxTexture_GetVkFormat(pKTXTexture) == ktxTexture_GetVkFormat(pOtherTexture) &&
+      pKTXTexture->baseWidth == pOtherTexture->baseWidth &&
+      pKTXTexture->baseHeight == pOtherTexture->baseHeight &&
+      pKTXTexture->baseDepth == pOtherTexture->baseDepth &&
+      pKTXTexture->numLevels == pOtherTexture->numLevels &&
+      pKTXTexture->numLayers == pOtherTexture->numLayers &&
+      pKTXTexture->numFaces == pOtherTexture->numFaces &&
+      ktxTexture_GetDataSize(pKTXTexture) == ktxTexture_GetDataSize(pOtherTexture);
+
+  // levels must be laid out the same way for the payloads to mean the same
+  for (uint32_t level = 0; isEqual && level < pKTXTexture->numLevels; ++level) {
+    ktx_size_t offset = 0u, otherOffset = 0u;
+    isEqual = ktxTexture_GetImageOffset(pKTXTexture, level, 0u, 0u, &offset) == KTX_SUCCESS &&
+              ktxTexture_GetImageOffset(pOtherTexture, level, 0u, 0u, &otherOffset) == KTX_SUCCESS &&
+              offset == otherOffset &&
+              ktxTexture_GetImageSize(pKTXTexture, level) ==
+                  ktxTexture_GetImageSize(pOtherTexture, level);
   }
 
-  // prepare freshly created texture structure
-  RTexture* pNewTexture = &m_textures.at(filePath);
-  pNewTexture->name = filePath;
-  pNewTexture->isKTX = true;
-  pNewTexture->isCubemap = pKTXTexture->isCubemap;
-  pNewTexture->texture.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  isEqual = isEqual && memcmp(ktxTexture_GetData(pKTXTexture), ktxTexture_GetData(pOtherTexture),
+                              ktxTexture_GetDataSize(pKTXTexture)) == 0;
 
-  ktxResult = ktxTexture_VkUploadEx(
-      pKTXTexture, deviceInfo, &pNewTexture->texture, VK_IMAGE_TILING_OPTIMAL,
-      VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  ktxTexture_Destroy(pOtherTexture);
 
-  if (ktxResult != KTX_SUCCESS) {
-    RE_LOG(Error, "Failed uploading texture to GPU. KTX error %d.", ktxResult);
-    revert(filePath.c_str());
+  return isEqual;
+}
+
+void destroyDeviceTexture(RVulkanTexture& texture, VmaAllocation allocation) {
+  VkDevice device = core::renderer.logicalDevice.device;
+
+  vkDestroyImageView(device, texture.view, nullptr);
 
+  for (auto& mipView : texture.extraViews) {
+    vkDestroyImageView(device, mipView.imageView, nullptr);
+  }
+
+  for (auto& faceView : texture.cubemapFaceViews) {
+    vkDestroyImageView(device, faceView, nullptr);
+  }
+
+  vmaDestroyImage(core::renderer.memAlloc, texture.image, allocation);
+}
+
+// creates the device image described by the texture, its levels are either
+// uploaded or copied from a previous image of a streamed texture
+TResult createDeviceImage(RTexture* pTexture) {
+  RVulkanTexture& texture = pTexture->texture;
+
+  VkImageCreateInfo createInfo{};
+  createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+  createInfo.imageType = VK_IMAGE_TYPE_2D;
+  createInfo.format = texture.imageFormat;
+  createInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  createInfo.extent = {texture.width, texture.height, 1u};
+  createInfo.mipLevels = texture.levelCount;
+  createInfo.arrayLayers = texture.layerCount;
+  createInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+  createInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                     VK_IMAGE_USAGE_SAMPLED_BIT;
+  createInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+  createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  createInfo.flags = pTexture->isCubemap ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : NULL;
+
+  VmaAllocationCreateInfo allocCreateInfo{};
+  allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+  if (vmaCreateImage(core::renderer.memAlloc, &createInfo, &allocCreateInfo,
+                     &texture.image, &pTexture->allocation,
+                     &pTexture->allocationInfo) != VK_SUCCESS) {
+    RE_LOG(Error, "Failed to create image for \"%s\".", pTexture->name.c_str());
     return RE_ERROR;
   }
-  
-  ktxTexture_Destroy(pKTXTexture);
-  ktxVulkanDeviceInfo_Destruct(deviceInfo);
 
-  if (pNewTexture->setSampler(pSamplerInfo) != RE_OK) {
-    revert(filePath.c_str());
+  return RE_OK;
+}
+
+// creates device image for the KTX data and queues its mip levels for upload,
+// levels more detailed than baseMip are skipped
+TResult uploadKTXTexture(ktxTexture* pKTXTexture, RTexture* pTexture,
+                         const uint32_t baseMip) {
+  const VkFormat format = ktxTexture_GetVkFormat(pKTXTexture);
+
+  if (format == VK_FORMAT_UNDEFINED || pKTXTexture->numDimensions != 2) {
+    RE_LOG(Error, "Texture \"%s\" has unsupported format or dimensions.",
+           pTexture->name.c_str());
     return RE_ERROR;
   }
 
-  if (pNewTexture->createImageViews(createExtraViews) != RE_OK) {
-    revert(filePath.c_str());
+  if (pKTXTexture->generateMipmaps) {
+    RE_LOG(Warning,
+           "Texture \"%s\" requests mipmap generation, only stored levels will "
+           "be used.",
+           pTexture->name.c_str());
+  }
+
+  if (baseMip >= pKTXTexture->numLevels) {
+    RE_LOG(Error, "Texture \"%s\" has no mip level %d.", pTexture->name.c_str(),
+           baseMip);
     return RE_ERROR;
   }
 
-  if (pSamplerInfo) {
-    if (pNewTexture->createDescriptor() != RE_OK) {
-      revert(filePath.c_str());
-      return RE_ERROR;
+  // image memory is owned by VMA, not by the KTX library
+  pTexture->isKTX = false;
+  pTexture->isCubemap = pKTXTexture->isCubemap;
+  pTexture->residentMip = baseMip;
+
+  RVulkanTexture& texture = pTexture->texture;
+  texture.imageFormat = format;
+  texture.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  texture.width = std::max(pKTXTexture->baseWidth >> baseMip, 1u);
+  texture.height = std::max(pKTXTexture->baseHeight >> baseMip, 1u);
+  texture.depth = 1u;
+  texture.levelCount = pKTXTexture->numLevels - baseMip;
+  texture.layerCount = pKTXTexture->numLayers * pKTXTexture->numFaces;
+  texture.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+
+  if (createDeviceImage(pTexture) != RE_OK) {
+    return RE_ERROR;
+  }
+
+  // every level stores all of its layers and faces contiguously
+  const std::vector<uint64_t> levelSizes = getKTXLevelSizes(pKTXTexture);
+  std::vector<VkBufferImageCopy> regions(texture.levelCount);
+  std::vector<VkDeviceSize> regionSizes(texture.levelCount);
+
+  for (uint32_t level = 0; level < texture.levelCount; ++level) {
+    ktx_size_t offset = 0u;
+    ktxTexture_GetImageOffset(pKTXTexture, baseMip + level, 0, 0, &offset);
+
+    VkBufferImageCopy& region = regions[level];
+    region = VkBufferImageCopy{};
+    region.bufferOffset = offset;
+    region.imageSubresource.aspectMask = texture.aspectMask;
+    region.imageSubresource.mipLevel = level;
+    region.imageSubresource.baseArrayLayer = 0u;
+    region.imageSubresource.layerCount = texture.layerCount;
+    region.imageExtent = {std::max(texture.width >> level, 1u),
+                          std::max(texture.height >> level, 1u), 1u};
+
+    regionSizes[level] = levelSizes[baseMip + level];
+  }
+
+  return core::renderer.queueImageUpload(&texture, ktxTexture_GetData(pKTXTexture),
+                                         regions, regionSizes);
+}
+}  // namespace
+
+TResult core::MResources::loadTexture(const std::string& filePath,
+                                   RSamplerInfo* pSamplerInfo, const bool createExtraViews) {
+  std::vector<RTextureLoadInfo> loadInfos(1);
+  loadInfos[0].filePath = filePath;
+  loadInfos[0].samplerInfo = pSamplerInfo ? *pSamplerInfo : RSamplerInfo{};
+  loadInfos[0].createSampler = (pSamplerInfo != nullptr);
+  loadInfos[0].createExtraViews = createExtraViews;
+
+  loadTextures(loadInfos);
+
+  return loadInfos[0].result;
+}
+
+uint32_t core::MResources::loadTextures(std::vector<RTextureLoadInfo>& loadInfos) {
+  // materials are created without textures in headless mode
+  if (config::bHeadless) {
+    for (RTextureLoadInfo& loadInfo : loadInfos) {
+      loadInfo.result = RE_WARNING;
     }
+
+    return 0u;
   }
 
-  RE_LOG(Log, "Successfully loaded texture \"%s\".", filePath.c_str());
+  std::vector<RTextureLoadInfo*> pRequests;
 
-  return RE_OK;
+  for (RTextureLoadInfo& loadInfo : loadInfos) {
+    loadInfo.result = RE_WARNING;
+
+    if (loadInfo.filePath == "") {
+      // nothing to load
+      continue;
+    }
+
+    if (m_textures.contains(loadInfo.filePath) ||
+        m_textureAliases.contains(loadInfo.filePath) ||
+        std::find_if(pRequests.begin(), pRequests.end(),
+                     [&loadInfo](const RTextureLoadInfo* pRequest) {
+                       return pRequest->filePath == loadInfo.filePath;
+                     }) != pRequests.end()) {
+      // already loaded
+#ifndef NDEBUG
+      RE_LOG(Warning, "Texture \"%s\" already exists.", loadInfo.filePath.c_str());
+#endif
+      continue;
+    }
+
+    pRequests.emplace_back(&loadInfo);
+  }
+
+  if (pRequests.empty()) {
+    return 0u;
+  }
+
+  const bool useBlockCompression =
+      core::renderer.physicalDevice.deviceFeatures.features.textureCompressionBC;
+
+  std::vector<ktxTexture*> pKTXTextures(pRequests.size(), nullptr);
+  std::vector<uint64_t> contentHashes(pRequests.size(), 0u);
+  std::vector<std::atomic<bool>> isRead(pRequests.size());
+  RJobCounter readCounter;
+
+  // job workers read and transcode, this thread uploads in request order
+  for (size_t i = 0; i < pRequests.size(); ++i) {
+    core::jobs.run(
+        [&, i]() {
+          RE_PROFILE_SCOPE("Read KTX texture");
+          pKTXTextures[i] =
+              readKTXTexture(pRequests[i]->filePath, useBlockCompression);
+
+          if (pKTXTextures[i]) {
+            contentHashes[i] = getTextureLoadHash(
+                getKTXContentHash(pKTXTextures[i]), *pRequests[i]);
+          }
+
+          isRead[i].store(true);
+          isRead[i].notify_one();
+        },
+        &readCounter);
+  }
+
+  uint32_t loadedCount = 0u;
+
+  for (size_t i = 0; i < pRequests.size(); ++i) {
+    isRead[i].wait(false);
+
+    RTextureLoadInfo* pRequest = pRequests[i];
+    pRequest->result = RE_ERROR;
+
+    if (!pKTXTextures[i]) {
+      continue;
+    }
+
+    // same image data under a different path shares the loaded texture
+    auto hashIt = m_textureHashes.find(contentHashes[i]);
+
+    if (hashIt != m_textureHashes.end() &&
+        !isEqualKTXTexture(pKTXTextures[i], hashIt->second, useBlockCompression)) {
+      RE_LOG(Warning,
+             "Texture \"%s\" has the same hash as \"%s\" but different data, "
+             "loading it separately.",
+             pRequest->filePath.c_str(), hashIt->second.c_str());
+      hashIt = m_textureHashes.end();
+    }
+
+    if (hashIt != m_textureHashes.end()) {
+      m_textureAliases[pRequest->filePath] = hashIt->second;
+
+      ktxTexture_Destroy(pKTXTextures[i]);
+      pKTXTextures[i] = nullptr;
+
+      pRequest->result = RE_OK;
+      ++loadedCount;
+
+      RE_LOG(Log, "Texture \"%s\" has the same content as \"%s\", sharing it.",
+             pRequest->filePath.c_str(), hashIt->second.c_str());
+      continue;
+    }
+
+    // create a texture record in the manager
+    RTexture* pNewTexture = &m_textures.try_emplace(pRequest->filePath).first->second;
+    pNewTexture->name = pRequest->filePath;
+
+    RSamplerInfo* pSamplerInfo =
+        pRequest->createSampler ? &pRequest->samplerInfo : nullptr;
+
+    // streamed textures start with their tail levels only
+    ktxTexture* pKTXTexture = pKTXTextures[i];
+    uint32_t baseMip = 0u;
+
+    const bool isStreamed = pRequest->enableStreaming &&
+                            !pKTXTexture->isCubemap && pKTXTexture->numLevels > 1;
+
+    if (isStreamed) {
+      const uint32_t baseExtent =
+          std::max(pKTXTexture->baseWidth, pKTXTexture->baseHeight);
+
+      while (baseMip + 1 < pKTXTexture->numLevels &&
+             (baseExtent >> baseMip) > config::scene::textureTailExtent) {
+        ++baseMip;
+      }
+    }
+
+    TResult result = uploadKTXTexture(pKTXTexture, pNewTexture, baseMip);
+
+    if (result == RE_OK && isStreamed) {
+      pNewTexture->streamingId = m_streaming.streamer.addTexture(
+          getKTXLevelSizes(pKTXTexture), pKTXTexture->baseWidth,
+          pKTXTexture->baseHeight, baseMip);
+
+      if (pNewTexture->streamingId >= m_streaming.pTextures.size()) {
+        m_streaming.pTextures.resize(pNewTexture->streamingId + 1, nullptr);
+      }
+
+      m_streaming.pTextures[pNewTexture->streamingId] = pNewTexture;
+    }
+
+    // image data is already copied to the staging ring
+    ktxTexture_Destroy(pKTXTexture);
+    pKTXTextures[i] = nullptr;
+
+    if (result == RE_OK) {
+      result = pNewTexture->setSampler(pSamplerInfo);
+    }
+
+    if (result == RE_OK) {
+      result = pNewTexture->createImageViews(pRequest->createExtraViews);
+    }
+
+    if (result == RE_OK && pSamplerInfo) {
+      result = pNewTexture->createDescriptor();
+    }
+
+    if (result != RE_OK) {
+      // image may still be referenced by queued copies
+      core::renderer.waitForUpload(core::renderer.flushUploads());
+      destroyTexture(pRequest->filePath.c_str(), true);
+      continue;
+    }
+
+    pNewTexture->contentHash = contentHashes[i];
+    m_textureHashes.try_emplace(contentHashes[i], pRequest->filePath);
+
+    pRequest->result = RE_OK;
+    ++loadedCount;
+
+    RE_LOG(Log, "Successfully loaded texture \"%s\".", pRequest->filePath.c_str());
+  }
+
+  core::jobs.wait(&readCounter);
+  core::renderer.flushUploads();
+
+#ifndef NDEBUG
+  RE_LOG(Log, "Loaded %d of %d requested textures using %d job workers.",
+         loadedCount, static_cast<int32_t>(pRequests.size()),
+         core::jobs.getWorkerCount());
+#endif
+
+  return loadedCount;
 }
 
 TResult core::MResources::loadTextureToBuffer(const std::string& filePath,
                                               RBuffer& outBuffer) {
-  auto revert = [&](const char* name) { m_textures.erase(name); };
-
   if (filePath == "") {
     // nothing to load
     return RE_WARNING;
   }
 
-  std::string fullPath = RE_PATH_TEXTURES + filePath;
+  ktxTexture* pKTXTexture = readKTXTexture(
+      filePath,
+      core::renderer.physicalDevice.deviceFeatures.features.textureCompressionBC);
 
-  ktxTexture* pKTXTexture = nullptr;
-  KTX_error_code ktxResult;
-  RVkLogicalDevice* logicalDevice = &core::renderer.logicalDevice;
-
-  ktxVulkanDeviceInfo* deviceInfo = ktxVulkanDeviceInfo_Create(
-      core::renderer.physicalDevice.device, logicalDevice->device,
-      logicalDevice->queues.transfer,
-      core::renderer.getCommandPool(ECmdType::Transfer), nullptr);
-
-  if (!deviceInfo) {
-    RE_LOG(Error, "Failed to retrieve Vulkan device info.");
+  if (!pKTXTexture) {
     return RE_ERROR;
   }
 
-  ktxResult = ktxTexture_CreateFromNamedFile(
-      fullPath.c_str(), KTX_TEXTURE_CREATE_NO_FLAGS, &pKTXTexture);
+  TResult result = core::renderer.createBuffer(
+      EBufferType::STAGING, ktxTexture_GetDataSize(pKTXTexture), outBuffer,
+      ktxTexture_GetData(pKTXTexture));
 
-  if (ktxResult != KTX_SUCCESS) {
-    RE_LOG(Error, "Failed reading texture. KTX error %d.", ktxResult);
-    return RE_ERROR;
-  }
+  ktxTexture_Destroy(pKTXTexture);
 
-  return RE_OK;
+  return result;
 }
 
 TResult core::MResources::loadTexturePNG(const std::string& filePath,
@@ -346,36 +682,99 @@ TResult core::MResources::writeTexture(RTexture* pTexture, void* pData,
 }
 
 bool core::MResources::destroyTexture(const char* name, bool force) noexcept {
-  // TODO: maybe should check if texture is used by a material here and avoid
-  // destroying it unless explicitly forced
+  RTexture* pTexture = findTexture(name);
 
-  // TODO: make sure it is actually deleted from memory
-  if (m_textures.find(name) != m_textures.end()) {
-    m_textures.erase(name);
+  if (!pTexture) {
+    return false;
+  }
+
+  if (!force && pTexture->references > 0) {
+    RE_LOG(Warning,
+           "Texture \"%s\" is assigned to materials %d times and won't be "
+           "destroyed.",
+           pTexture->name.c_str(), pTexture->references);
+    return false;
+  }
+
+  const uint32_t streamingId = pTexture->streamingId;
+
+  if (streamingId != -1) {
+    // unfinished read has to complete before its data can be released
+    auto readIt = m_streaming.pendingReads.find(streamingId);
+
+    if (readIt != m_streaming.pendingReads.end()) {
+      core::jobs.wait(&readIt->second->counter);
+
+      if (ktxTexture* pKTXTexture = readIt->second->pKTXTexture) {
+        ktxTexture_Destroy(pKTXTexture);
+      }
+
+      m_streaming.pendingReads.erase(readIt);
+    }
+
+    m_streaming.streamer.removeTexture(streamingId);
+    m_streaming.pTextures[streamingId] = nullptr;
+  }
+
+  // queued descriptor write must not reference the destroyed image
+  const uint32_t samplerIndex = pTexture->combinedSamplerIndex;
+
+  if (samplerIndex != -1 && m_samplerIndices[samplerIndex] == pTexture) {
+    std::erase_if(m_samplerWrites, [samplerIndex](const auto& write) {
+      return write.first == samplerIndex;
+    });
+  }
+
+  // texture key may differ from the requested name if it was an alias
+  const std::string textureName = pTexture->name;
+
+  auto hashIt = m_textureHashes.find(pTexture->contentHash);
+
+  if (hashIt != m_textureHashes.end() && hashIt->second == textureName) {
+    m_textureHashes.erase(hashIt);
+  }
+
+  std::erase_if(m_textureAliases, [&textureName](const auto& alias) {
+    return alias.second == textureName;
+  });
+
+  m_textures.erase(textureName);
 
 #ifndef NDEBUG
-    RE_LOG(Log, "Destroyed texture '%s'.", name);
+  RE_LOG(Log, "Destroyed texture '%s'.", textureName.c_str());
 #endif
 
-    return true;
+  return true;
+}
+
+RTexture* core::MResources::findTexture(const char* name) noexcept {
+  auto it = m_textures.find(name);
+
+  if (it == m_textures.end()) {
+    auto aliasIt = m_textureAliases.find(name);
+
+    if (aliasIt == m_textureAliases.end()) {
+      return nullptr;
+    }
+
+    it = m_textures.find(aliasIt->second);
+
+    if (it == m_textures.end()) {
+      return nullptr;
+    }
   }
 
-  return false;
+  return &it->second;
 }
 
 RTexture* core::MResources::getTexture(
     const char* name) noexcept {
-  if (m_textures.contains(name)) {
-    return &m_textures.at(name);
-  }
-
-  return nullptr;
+  return findTexture(name);
 }
 
 RTexture* const core::MResources::assignTexture(
     const char* name) noexcept {
-  if (m_textures.contains(name)) {
-    RTexture* pTexture = &m_textures.at(name);
+  if (RTexture* pTexture = findTexture(name)) {
     updateMaterialDescriptorSet(pTexture, EResourceType::Sampler2D);
     pTexture->references++;
 
@@ -385,4 +784,288 @@ RTexture* const core::MResources::assignTexture(
   return nullptr;
 }
 
-void core::MResources::destroyAllTextures() { m_textures.clear(); }
\ No newline at end of file
+void core::MResources::releaseTexture(RTexture* pTexture,
+                                      const bool destroyUnused) {
+  if (pTexture->references > 0) {
+    pTexture->references--;
+  }
+
+  if (pTexture->references > 0 || !destroyUnused) {
+    return;
+  }
+
+  const uint32_t framesRendered = core::renderer.renderView.framesRendered;
+
+  auto it = std::find_if(m_releases.begin(), m_releases.end(),
+                         [pTexture](const RResourceRelease& release) {
+                           return release.textureName == pTexture->name;
+                         });
+
+  if (it != m_releases.end()) {
+    it->releaseFrame = framesRendered;
+    return;
+  }
+
+  m_releases.push_back({pTexture->name, static_cast<uint32_t>(-1), framesRendered});
+}
+
+void core::MResources::destroyReleasedResources(const bool force) {
+  const uint32_t framesRendered = core::renderer.renderView.framesRendered;
+
+  for (auto it = m_releases.begin(); it != m_releases.end();) {
+    if (!force && framesRendered < it->releaseFrame + MAX_FRAMES_IN_FLIGHT) {
+      ++it;
+      continue;
+    }
+
+    if (it->materialIndex != -1 && m_materialSlots.release(it->materialIndex)) {
+      m_materialIndices[it->materialIndex] = nullptr;
+    }
+
+    auto textureIt = m_textures.find(it->textureName);
+
+    // texture may have been assigned to a new material meanwhile
+    if (textureIt != m_textures.end() && textureIt->second.references == 0) {
+      const uint32_t samplerIndex = textureIt->second.combinedSamplerIndex;
+
+      if (samplerIndex != -1 && m_samplerIndices[samplerIndex] == &textureIt->second) {
+        releaseCombinedSamplerIndex(samplerIndex);
+      }
+
+      destroyTexture(it->textureName.c_str());
+    }
+
+    it = m_releases.erase(it);
+  }
+}
+
+void core::MResources::destroyAllTextures() {
+  for (auto& pendingRead : m_streaming.pendingReads) {
+    core::jobs.wait(&pendingRead.second->counter);
+
+    if (ktxTexture* pKTXTexture = pendingRead.second->pKTXTexture) {
+      ktxTexture_Destroy(pKTXTexture);
+    }
+  }
+
+  m_streaming.pendingReads.clear();
+  m_streaming.pTextures.clear();
+  m_streaming.streamer = RTextureStreamer{};
+  destroyRetiredTextures(true);
+
+  m_releases.clear();
+  m_samplerWrites.clear();
+  m_textureAliases.clear();
+  m_textureHashes.clear();
+  m_textures.clear();
+}
+
+void core::MResources::requestTextureDetail(RMaterial* pMaterial,
+                                            const float screenSize) {
+  if (!pMaterial) {
+    return;
+  }
+
+  for (RTexture* pTexture : pMaterial->pLinearTextures) {
+    if (pTexture->streamingId != -1) {
+      m_streaming.streamer.requestScreenSize(pTexture->streamingId, screenSize,
+                                             config::scene::textureMipBias);
+    }
+  }
+}
+
+void core::MResources::updateTextureStreaming() {
+  destroyRetiredTextures(false);
+
+  // swap in textures that were read since the last update
+  for (auto it = m_streaming.pendingReads.begin();
+       it != m_streaming.pendingReads.end();) {
+    if (!it->second->counter.isDone()) {
+      ++it;
+      continue;
+    }
+
+    const uint32_t streamingId = it->first;
+    ktxTexture* pKTXTexture = it->second->pKTXTexture;
+    it = m_streaming.pendingReads.erase(it);
+
+    RTexture* pTexture = m_streaming.pTextures[streamingId];
+
+    if (!pKTXTexture || swapStreamedTexture(pTexture, pKTXTexture) != RE_OK) {
+      // budget accounting follows what is actually on the device
+      m_streaming.streamer.setResidentMip(streamingId, pTexture->residentMip);
+    }
+
+    if (pKTXTexture) {
+      ktxTexture_Destroy(pKTXTexture);
+    }
+  }
+
+  m_streaming.streamer.setBudget(config::scene::textureBudget);
+  m_streaming.streamer.update(m_streaming.changes, config::scene::textureUploadLimit);
+
+  const bool useBlockCompression =
+      core::renderer.physicalDevice.deviceFeatures.features.textureCompressionBC;
+
+  for (const auto& change : m_streaming.changes) {
+    // pending read will be swapped in using the latest residency
+    if (m_streaming.pendingReads.contains(change.id)) {
+      continue;
+    }
+
+    RTexture* pTexture = m_streaming.pTextures[change.id];
+
+    if (!pTexture || pTexture->residentMip == change.residentMip) {
+      continue;
+    }
+
+    // dropped mips are copied out of the resident image, no read is needed
+    if (change.residentMip > pTexture->residentMip) {
+      if (swapStreamedTexture(pTexture, nullptr) != RE_OK) {
+        m_streaming.streamer.setResidentMip(change.id, pTexture->residentMip);
+      }
+
+      continue;
+    }
+
+    RStreamingRead* pRead =
+        (m_streaming.pendingReads[change.id] = std::make_unique<RStreamingRead>()).get();
+
+    core::jobs.run(
+        [pRead, name = pTexture->name, useBlockCompression]() {
+          RE_PROFILE_SCOPE("Stream KTX texture");
+          pRead->pKTXTexture = readKTXTexture(name, useBlockCompression);
+        },
+        &pRead->counter);
+  }
+}
+
+TResult core::MResources::swapStreamedTexture(RTexture* pTexture,
+                                              ktxTexture* pKTXTexture) {
+  const uint32_t targetMip =
+      m_streaming.streamer.getResidentMip(pTexture->streamingId);
+
+  if (targetMip == pTexture->residentMip) {
+    return RE_OK;
+  }
+
+  // previous image stays valid for frames still in flight
+  RRetiredTexture retired;
+  retired.texture = pTexture->texture;
+  retired.allocation = pTexture->allocation;
+  retired.combinedSamplerIndex = pTexture->combinedSamplerIndex;
+  retired.retireFrame = core::renderer.renderView.framesRendered;
+
+  const uint32_t previousMip = pTexture->residentMip;
+  const bool createExtraViews = !retired.texture.extraViews.empty();
+
+  pTexture->texture.image = VK_NULL_HANDLE;
+  pTexture->texture.view = VK_NULL_HANDLE;
+  pTexture->texture.extraViews.clear();
+  pTexture->texture.cubemapFaceViews.clear();
+  pTexture->allocation = nullptr;
+
+  TResult result = RE_OK;
+
+  if (pKTXTexture) {
+    result = uploadKTXTexture(pKTXTexture, pTexture, targetMip);
+  } else if (targetMip > previousMip) {
+    const uint32_t droppedMips = targetMip - previousMip;
+
+    pTexture->residentMip = targetMip;
+    pTexture->texture.width = std::max(retired.texture.width >> droppedMips, 1u);
+    pTexture->texture.height = std::max(retired.texture.height >> droppedMips, 1u);
+    pTexture->texture.levelCount = retired.texture.levelCount - droppedMips;
+    pTexture->texture.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    result = createDeviceImage(pTexture);
+
+    if (result == RE_OK) {
+      result = core::renderer.queueImageMipCopy(&retired.texture, &pTexture->texture,
+                                                droppedMips);
+    }
+  } else {
+    result = RE_ERROR;
+  }
+
+  if (result == RE_OK) {
+    result = pTexture->createImageViews(createExtraViews);
+  }
+
+  if (result == RE_OK) {
+    pTexture->texture.sampler = retired.texture.sampler;
+    result = pTexture->createDescriptor();
+  }
+
+  // descriptors used by frames in flight can't be rewritten, a free one is used
+  uint32_t samplerIndex = -1;
+
+  if (result == RE_OK && retired.combinedSamplerIndex != -1) {
+    samplerIndex = getFreeCombinedSamplerIndex();
+
+    if (samplerIndex == -1) {
+      result = RE_ERROR;
+    }
+  }
+
+  if (result != RE_OK) {
+    RE_LOG(Error, "Failed to stream mip level %d of texture \"%s\".", targetMip,
+           pTexture->name.c_str());
+
+    // new image may still be referenced by queued copies, it is retired too
+    RRetiredTexture failed;
+    failed.texture = pTexture->texture;
+    failed.allocation = pTexture->allocation;
+    failed.retireFrame = retired.retireFrame;
+    m_streaming.retiredTextures.emplace_back(std::move(failed));
+
+    pTexture->texture = retired.texture;
+    pTexture->allocation = retired.allocation;
+    pTexture->residentMip = previousMip;
+
+    return RE_ERROR;
+  }
+
+  if (samplerIndex != -1) {
+    writeCombinedSamplerDescriptor(pTexture, samplerIndex);
+    updateMaterialSamplerIndex(pTexture);
+  }
+
+  m_streaming.retiredTextures.emplace_back(std::move(retired));
+
+#ifndef NDEBUG
+  RE_LOG(Log, "Streamed texture \"%s\" from mip level %d to %d.",
+         pTexture->name.c_str(), previousMip, targetMip);
+#endif
+
+  return RE_OK;
+}
+
+void core::MResources::destroyRetiredTextures(const bool force) {
+  const uint32_t framesRendered = core::renderer.renderView.framesRendered;
+
+  for (auto it = m_streaming.retiredTextures.begin();
+       it != m_streaming.retiredTextures.end();) {
+    if (!force && framesRendered < it->retireFrame + MAX_FRAMES_IN_FLIGHT) {
+      ++it;
+      continue;
+    }
+
+    destroyDeviceTexture(it->texture, it->allocation);
+
+    if (it->combinedSamplerIndex != -1) {
+      releaseCombinedSamplerIndex(it->combinedSamplerIndex);
+    }
+
+    it = m_streaming.retiredTextures.erase(it);
+  }
+}
+
+void core::MResources::setTextureBudget(const uint64_t budget) {
+  config::scene::textureBudget = budget;
+  m_streaming.streamer.setBudget(budget);
+}
+
+const RTextureStreamer& core::MResources::getTextureStreamer() const {
+  return m_streaming.streamer;
+}
\ No newline at end of file
@@ -198,6 +198,10 @@ void core::MScript::jsonParseLights(const json* pLightData) noexcept {
         it.at("intensity").get_to(info.intensity);
       }
 
+      if (it.contains("radius")) {
+        it.at("radius").get_to(info.radius);
+      }
+
       if (it.contains("color")) {
         it.at("color").get_to(color);
 
@@ -1,23 +1,81 @@
 #include "pch.h"
 #include "core/managers/time.h"
 
+namespace {
+// seconds on a monotonic clock, doesn't depend on GLFW being initialized
+double getTimePoint() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+}  // namespace
+
 core::MTime::MTime() {
-  m_currentTimePoint = glfwGetTime();
+  m_currentTimePoint = getTimePoint();
   m_initialTimePoint = m_currentTimePoint;
 }
 
 float core::MTime::tickTimer() {
   m_oldTimePoint = m_currentTimePoint;
-  m_currentTimePoint = glfwGetTime();
+  m_currentTimePoint = getTimePoint();
+
+  const float measuredDeltaTime = static_cast<float>(m_currentTimePoint - m_oldTimePoint);
+  m_frameStatistics.addFrame(measuredDeltaTime * 1000.0f);
+
+  m_lastDeltaTime = (m_fixedDeltaTime > 0.0f) ? m_fixedDeltaTime : measuredDeltaTime;
+  updateSimulationStep(m_lastDeltaTime);
+
+  return m_lastDeltaTime;
+}
+
+void core::MTime::updateSimulationStep(const float deltaTime) {
+  if (m_tickDeltaTime <= 0.0f) {
+    m_simulationStep = {1u, deltaTime, 1.0f};
+    return;
+  }
+
+  m_accumulatedTime += deltaTime;
+
+  uint32_t tickCount = static_cast<uint32_t>(m_accumulatedTime / m_tickDeltaTime);
+
+  if (tickCount > m_maxTicksPerFrame) {
+    tickCount = m_maxTicksPerFrame;
+    m_accumulatedTime = std::fmod(m_accumulatedTime, static_cast<double>(m_tickDeltaTime));
+  } else {
+    m_accumulatedTime -= static_cast<double>(tickCount) * m_tickDeltaTime;
+  }
 
-  return m_lastDeltaTime = static_cast<float>(m_currentTimePoint - m_oldTimePoint);
+  m_simulationStep.tickCount = tickCount;
+  m_simulationStep.tickDeltaTime = m_tickDeltaTime;
+  m_simulationStep.interpolation = std::clamp(
+      static_cast<float>(m_accumulatedTime / m_tickDeltaTime), 0.0f, 1.0f);
 }
 
 float core::MTime::getDeltaTime() { return m_lastDeltaTime; }
 
 float core::MTime::getTimeSinceInitialization() {
   m_oldTimePoint = m_currentTimePoint;
-  m_currentTimePoint = glfwGetTime();
+  m_currentTimePoint = getTimePoint();
 
   return static_cast<float>(m_currentTimePoint - m_initialTimePoint);
 }
+
+void core::MTime::setFixedDeltaTime(const float deltaTime) {
+  m_fixedDeltaTime = std::max(deltaTime, 0.0f);
+
+  // fixed delta runs are reproducible only if they start between ticks
+  m_accumulatedTime = 0.0;
+}
+
+void core::MTime::setSimulationRate(const float rate) {
+  m_tickDeltaTime = (rate > 0.0f) ? 1.0f / rate : 0.0f;
+  m_accumulatedTime = 0.0;
+}
+
+float core::MTime::getSimulationRate() {
+  return (m_tickDeltaTime > 0.0f) ? 1.0f / m_tickDeltaTime : 0.0f;
+}
+
+void core::MTime::setMaxTicksPerFrame(const uint32_t maxTicks) {
+  m_maxTicksPerFrame = std::max(maxTicks, 1u);
+}
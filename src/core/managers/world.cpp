@@ -83,7 +83,8 @@ TResult core::MWorld::loadModelFromFile(const std::string& path,
 }
 
 TResult core::MWorld::createModel(EPrimitiveType type, std::string name,
-                                  int32_t arg0, int32_t arg1) {
+                                  int32_t arg0, int32_t arg1,
+                                  const WModelConfigInfo* pConfigInfo) {
 
   auto fValidateNode = [&](WModel::Node* pNode) {
     if (pNode->pMesh == nullptr) {
@@ -158,6 +159,28 @@ TResult core::MWorld::createModel(EPrimitiveType type, std::string name,
     }
   }
 
+  WPrimitive* pPrimitive = pNode->pMesh->pPrimitives.back().get();
+
+  // generators emit duplicated vertices along shared edges
+  if (pConfigInfo ? pConfigInfo->weldVertices : true) {
+    const uint32_t sourceVertexCount = static_cast<uint32_t>(vertices.size());
+    const uint32_t weldedVertexCount = WPrimitive::weldVertices(vertices, indices);
+    pPrimitive->vertexCount = static_cast<uint32_t>(vertices.size());
+
+    if (weldedVertexCount > 0) {
+      RE_LOG(Log, "Welded vertices of model \"%s\": %d -> %d (%.1f%% reduction).",
+             name.c_str(), sourceVertexCount, pPrimitive->vertexCount,
+             100.0f * static_cast<float>(weldedVertexCount) /
+                 static_cast<float>(sourceVertexCount));
+    }
+  }
+
+  if (pPrimitive->createTangentSpaceData) {
+    WPrimitive::generateTangents(vertices.data(), vertices.size(),
+                                 indices.data(), indices.size());
+    pPrimitive->createTangentSpaceData = false;
+  }
+
   // copy vertex and index data to local staging buffers and adjust offsets
   pModel->staging.vertices.insert(pModel->staging.vertices.begin(), vertices.begin(), vertices.end());
   pModel->staging.indices.insert(pModel->staging.indices.begin(), indices.begin(), indices.end());
@@ -190,7 +213,6 @@ TResult core::MWorld::createModel(EPrimitiveType type, std::string name,
     }
   }*/
 
-  pModel->createStagingBuffers();
   pModel->uploadToSceneBuffer();
 
   return RE_OK;
@@ -206,6 +228,20 @@ WModel* core::MWorld::getModel(const char* name) {
   return nullptr;
 }
 
+TResult core::MWorld::destroyModel(const char* name) {
+  if (!m_models.contains(name)) {
+    RE_LOG(Warning, "Failed to destroy model \"%s\". It does not exist.", name);
+    return RE_WARNING;
+  }
+
+  m_models.at(name)->clean();
+  m_models.erase(name);
+
+  RE_LOG(Log, "Model \"%s\" was successfully destroyed.", name);
+
+  return RE_OK;
+}
+
 void core::MWorld::destroyAllModels() {
   RE_LOG(Log, "Destroying all models.");
 
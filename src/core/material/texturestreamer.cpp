@@ -0,0 +1,268 @@
+#include "pch.h"
+#include "core/material/texturestreamer.h"
+
+uint64_t RTextureStreamer::getLevelRangeSize(const RStreamedTexture& texture,
+                                             const uint32_t firstMip) const {
+  uint64_t size = 0u;
+
+  for (uint32_t level = firstMip; level < texture.levelSizes.size(); ++level) {
+    size += texture.levelSizes[level];
+  }
+
+  return size;
+}
+
+uint32_t RTextureStreamer::addTexture(const std::vector<uint64_t>& levelSizes,
+                                      const uint32_t width,
+                                      const uint32_t height,
+                                      const uint32_t tailMip) {
+  if (levelSizes.empty()) {
+    return invalidId;
+  }
+
+  uint32_t id = invalidId;
+
+  if (!m_freeIds.empty()) {
+    id = m_freeIds.back();
+    m_freeIds.pop_back();
+  } else {
+    id = static_cast<uint32_t>(m_textures.size());
+    m_textures.emplace_back();
+  }
+
+  RStreamedTexture& texture = m_textures[id];
+  texture.levelSizes = levelSizes;
+  texture.width = width;
+  texture.height = height;
+  texture.tailMip = std::min(tailMip, static_cast<uint32_t>(levelSizes.size()) - 1);
+  texture.residentMip = texture.tailMip;
+  texture.requestedMip = texture.tailMip;
+  texture.lastUsedFrame = 0u;
+  texture.isActive = true;
+
+  m_residentSize += getLevelRangeSize(texture, texture.residentMip);
+
+  return id;
+}
+
+void RTextureStreamer::removeTexture(const uint32_t id) {
+  if (id >= m_textures.size() || !m_textures[id].isActive) {
+    return;
+  }
+
+  RStreamedTexture& texture = m_textures[id];
+  m_residentSize -= getLevelRangeSize(texture, texture.residentMip);
+
+  texture = RStreamedTexture{};
+  m_freeIds.emplace_back(id);
+}
+
+void RTextureStreamer::requestMip(const uint32_t id, const uint32_t mipLevel) {
+  if (id >= m_textures.size() || !m_textures[id].isActive) {
+    return;
+  }
+
+  RStreamedTexture& texture = m_textures[id];
+  const uint32_t clampedMip = std::min(mipLevel, texture.tailMip);
+
+  // first request of the frame replaces the previous one
+  if (texture.lastUsedFrame != m_frame) {
+    texture.requestedMip = clampedMip;
+    texture.lastUsedFrame = m_frame;
+    return;
+  }
+
+  texture.requestedMip = std::min(texture.requestedMip, clampedMip);
+}
+
+void RTextureStreamer::requestScreenSize(const uint32_t id,
+                                         const float screenSize,
+                                         const float mipBias) {
+  if (id >= m_textures.size() || !m_textures[id].isActive) {
+    return;
+  }
+
+  const RStreamedTexture& texture = m_textures[id];
+  requestMip(id, getDesiredMip(texture.width, texture.height,
+                               static_cast<uint32_t>(texture.levelSizes.size()),
+                               screenSize, mipBias));
+}
+
+void RTextureStreamer::update(std::vector<RResidencyChange>& outChanges,
+                              const uint64_t uploadLimit) {
+  outChanges.clear();
+
+  // residency is changed on copies first, only differences are reported
+  std::vector<uint32_t> targetMips(m_textures.size());
+  std::vector<uint32_t> upgradeIds;
+  std::vector<uint32_t> evictionIds;
+
+  for (uint32_t id = 0; id < m_textures.size(); ++id) {
+    const RStreamedTexture& texture = m_textures[id];
+    targetMips[id] = texture.residentMip;
+
+    if (!texture.isActive) {
+      continue;
+    }
+
+    const bool isUsed = (texture.lastUsedFrame == m_frame);
+
+    if (isUsed && texture.requestedMip < texture.residentMip) {
+      upgradeIds.emplace_back(id);
+    }
+
+    // unused textures and levels finer than requested are cached until evicted
+    if (texture.residentMip < texture.tailMip &&
+        (!isUsed || texture.residentMip < texture.requestedMip)) {
+      evictionIds.emplace_back(id);
+    }
+  }
+
+  // least recently used first
+  std::stable_sort(evictionIds.begin(), evictionIds.end(),
+                   [this](const uint32_t a, const uint32_t b) {
+                     return m_textures[a].lastUsedFrame < m_textures[b].lastUsedFrame;
+                   });
+
+  size_t evictionCursor = 0;
+
+  // drops the finest levels of evictable textures until the size fits
+  auto fMakeRoom = [&](const uint64_t size) {
+    while (m_residentSize + size > m_budget) {
+      if (evictionCursor >= evictionIds.size()) {
+        return false;
+      }
+
+      const uint32_t id = evictionIds[evictionCursor];
+      const RStreamedTexture& texture = m_textures[id];
+      const uint32_t floorMip = (texture.lastUsedFrame == m_frame)
+                                    ? texture.requestedMip
+                                    : texture.tailMip;
+
+      if (targetMips[id] >= floorMip) {
+        ++evictionCursor;
+        continue;
+      }
+
+      m_residentSize -= texture.levelSizes[targetMips[id]];
+      ++targetMips[id];
+    }
+
+    return true;
+  };
+
+  // over budget, e.g. after the budget was lowered
+  fMakeRoom(0u);
+
+  // the blurriest textures are raised first
+  std::stable_sort(upgradeIds.begin(), upgradeIds.end(),
+                   [this](const uint32_t a, const uint32_t b) {
+                     const RStreamedTexture& texA = m_textures[a];
+                     const RStreamedTexture& texB = m_textures[b];
+                     return texA.residentMip - texA.requestedMip >
+                            texB.residentMip - texB.requestedMip;
+                   });
+
+  // one level per texture and pass, every visible texture gets moderate
+  // detail before any of them gets its finest level
+  uint64_t uploadedSize = 0u;
+  bool isProgressing = true;
+
+  while (isProgressing) {
+    isProgressing = false;
+
+    for (const uint32_t id : upgradeIds) {
+      const RStreamedTexture& texture = m_textures[id];
+
+      if (targetMips[id] <= texture.requestedMip) {
+        continue;
+      }
+
+      const uint64_t levelSize = texture.levelSizes[targetMips[id] - 1];
+
+      if (uploadedSize + levelSize > uploadLimit) {
+        continue;
+      }
+
+      if (!fMakeRoom(levelSize)) {
+        continue;
+      }
+
+      m_residentSize += levelSize;
+      uploadedSize += levelSize;
+      --targetMips[id];
+      isProgressing = true;
+    }
+  }
+
+  for (uint32_t id = 0; id < m_textures.size(); ++id) {
+    RStreamedTexture& texture = m_textures[id];
+
+    if (!texture.isActive || targetMips[id] == texture.residentMip) {
+      continue;
+    }
+
+    texture.residentMip = targetMips[id];
+    outChanges.push_back({id, targetMips[id]});
+  }
+
+  ++m_frame;
+}
+
+void RTextureStreamer::setResidentMip(const uint32_t id,
+                                      const uint32_t mipLevel) {
+  if (id >= m_textures.size() || !m_textures[id].isActive) {
+    return;
+  }
+
+  RStreamedTexture& texture = m_textures[id];
+  m_residentSize -= getLevelRangeSize(texture, texture.residentMip);
+  texture.residentMip = std::min(mipLevel, texture.tailMip);
+  m_residentSize += getLevelRangeSize(texture, texture.residentMip);
+}
+
+uint32_t RTextureStreamer::getResidentMip(const uint32_t id) const {
+  return (id < m_textures.size()) ? m_textures[id].residentMip : 0u;
+}
+
+uint32_t RTextureStreamer::getTailMip(const uint32_t id) const {
+  return (id < m_textures.size()) ? m_textures[id].tailMip : 0u;
+}
+
+uint32_t RTextureStreamer::getTextureCount() const {
+  return static_cast<uint32_t>(m_textures.size() - m_freeIds.size());
+}
+
+uint32_t RTextureStreamer::getDesiredMip(const uint32_t width,
+                                         const uint32_t height,
+                                         const uint32_t levelCount,
+                                         const float screenSize,
+                                         const float mipBias) {
+  if (levelCount == 0u) {
+    return 0u;
+  }
+
+  const float texels = static_cast<float>(std::max(width, height));
+
+  // texture is expected to be mapped across the primitive once
+  const float mip =
+      std::log2(texels / std::max(screenSize, 1.0f)) + mipBias;
+
+  if (mip <= 0.0f) {
+    return 0u;
+  }
+
+  return std::min(static_cast<uint32_t>(mip), levelCount - 1);
+}
+
+float RTextureStreamer::getScreenSize(const float radius, const float distance,
+                                      const float projectionScale,
+                                      const float viewportHeight) {
+  // camera is inside or touching the sphere, full detail is required
+  if (distance <= radius) {
+    return std::numeric_limits<float>::max();
+  }
+
+  // not clamped to the viewport, parts of large primitives are seen up close
+  return radius * projectionScale * viewportHeight / distance;
+}
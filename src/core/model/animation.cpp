@@ -7,95 +7,166 @@
 // PRIVATE
 //
 
-void WAnimation::processFrame(WModel* pModel, const float time) {
-  // iterate through staged transformation blocks
-  for (auto& transformBlock : stagingData.transformData) {
-    auto* pNode = pModel->getNode(transformBlock.nodeIndex);
-
-    // iterate through frames and retrieve transformation data at a desired time
-    for (size_t i = 0; i < transformBlock.frameData.size() - 1; ++i) {
-      if ((time >= transformBlock.frameData[i].timeStamp) &&
-          (time <= transformBlock.frameData[i + 1].timeStamp)) {
-        // get interpolation coefficient based on time between frames
-        float u = std::max(0.0f, time - transformBlock.frameData[i].timeStamp) /
-                  (transformBlock.frameData[i + 1].timeStamp -
-                   transformBlock.frameData[i].timeStamp);
-
-        if (u <= 1.0f) {
-          switch (transformBlock.frameData[i].transformType) {
-            case ETransformType::Translation: {
-              glm::vec4 translation =
-                  glm::mix(transformBlock.frameData[i].transformData,
-                           transformBlock.frameData[i + 1].transformData, u);
-              pNode->staging.translation = glm::vec3(translation);
-              break;
-            }
-            case ETransformType::Scale: {
-              glm::vec4 scale =
-                  glm::mix(transformBlock.frameData[i].transformData,
-                           transformBlock.frameData[i + 1].transformData, u);
-              pNode->staging.scale = glm::vec3(scale);
-              break;
-            }
-            case ETransformType::Rotation: {
-              glm::quat q1;
-              q1.x = transformBlock.frameData[i].transformData.x;
-              q1.y = transformBlock.frameData[i].transformData.y;
-              q1.z = transformBlock.frameData[i].transformData.z;
-              q1.w = transformBlock.frameData[i].transformData.w;
-
-              glm::quat q2;
-              q2.x = transformBlock.frameData[i + 1].transformData.x;
-              q2.y = transformBlock.frameData[i + 1].transformData.y;
-              q2.z = transformBlock.frameData[i + 1].transformData.z;
-              q2.w = transformBlock.frameData[i + 1].transformData.w;
-
-              pNode->staging.rotation = glm::normalize(glm::slerp(q1, q2, u));
-              break;
-            }
-          }
-          // transform block data retrieved, exit loop
-          break;
-        }
-      }
+void WAnimation::createResamplingPose(WModel* pModel, ResamplingPose& outPose) {
+  // node indices resolved to pose positions once per resampling
+  std::unordered_map<int32_t, int32_t> poseIndices;
+
+  auto fAddNode = [&](auto& fSelf, WModel::Node* pNode, const int32_t parent) -> void {
+    const int32_t poseIndex = static_cast<int32_t>(outPose.nodes.size());
+    poseIndices[pNode->index] = poseIndex;
+
+    ResamplingNode& node = outPose.nodes.emplace_back();
+    node.parent = parent;
+    node.restMatrix = pNode->staging.nodeMatrix;
+    node.translation = pNode->staging.translation;
+    node.rotation = pNode->staging.rotation;
+    node.scale = pNode->staging.scale;
+
+    if (pNode->pMesh) {
+      outPose.meshNodes.emplace_back(pNode->index, poseIndex);
+
+      // node has mesh, store a reference to it in an animation
+      addNodeReference(pNode->name, pNode->index);
+    }
+
+    for (auto& pChild : pNode->pChildren) {
+      fSelf(fSelf, pChild.get(), poseIndex);
+    }
+  };
+
+  for (auto& pRootNode : pModel->getRootNodes()) {
+    fAddNode(fAddNode, pRootNode.get(), -1);
+  }
+
+  for (const auto& transformBlock : stagingData.transformData) {
+    auto it = poseIndices.find(transformBlock.nodeIndex);
+
+    if (it == poseIndices.end() || transformBlock.frameData.empty()) {
+      continue;
+    }
+
+    outPose.tracks.push_back({&transformBlock, it->second, 0});
+  }
+
+  // joint matrices are stored for skins of mesh nodes
+  outPose.skinCount = pModel->getSkinCount();
+
+  for (const auto& pNode : pModel->getAllNodes()) {
+    if (!pNode->pMesh || !pNode->pSkin) {
+      continue;
+    }
+
+    const int32_t skinIndex = pNode->pSkin->index;
+
+    if (std::find_if(outPose.skins.begin(), outPose.skins.end(),
+                     [skinIndex](const ResamplingSkin& skin) {
+                       return skin.skinIndex == skinIndex;
+                     }) != outPose.skins.end()) {
+      continue;
+    }
+
+    ResamplingSkin& skin = outPose.skins.emplace_back();
+    skin.skinIndex = skinIndex;
+    skin.pInverseBindMatrices = &pNode->pSkin->staging.inverseBindMatrices;
+
+    for (const auto& pJoint : pNode->pSkin->joints) {
+      skin.jointPoseIndices.emplace_back(poseIndices.at(pJoint->index));
     }
   }
+}
+
+void WAnimation::processFrame(ResamplingPose& pose, const float time) {
+  for (auto& track : pose.tracks) {
+    const auto& frameData = track.pBlock->frameData;
 
-  for (int32_t j = 0; j < pModel->getSkinCount(); ++j) {
-    pModel->getSkin(j)->staging.recalculateSkinMatrices = true;
+    // sample times only increase, so the cursor never has to move back
+    while (track.cursor + 1 < frameData.size() &&
+           frameData[track.cursor + 1].timeStamp <= time) {
+      ++track.cursor;
+    }
+
+    const StagingTransformFrame& frame = frameData[track.cursor];
+    const StagingTransformFrame& nextFrame =
+        (track.cursor + 1 < frameData.size()) ? frameData[track.cursor + 1] : frame;
+
+    // get interpolation coefficient based on time between frames,
+    // times outside of the track hold its first or last frame
+    const float frameTime = nextFrame.timeStamp - frame.timeStamp;
+    const float u = (frameTime > 0.0f)
+                        ? std::clamp((time - frame.timeStamp) / frameTime, 0.0f, 1.0f)
+                        : 0.0f;
+
+    ResamplingNode& node = pose.nodes[track.poseIndex];
+
+    switch (frame.transformType) {
+      case ETransformType::Translation: {
+        node.translation =
+            glm::vec3(glm::mix(frame.transformData, nextFrame.transformData, u));
+        break;
+      }
+      case ETransformType::Scale: {
+        node.scale =
+            glm::vec3(glm::mix(frame.transformData, nextFrame.transformData, u));
+        break;
+      }
+      case ETransformType::Rotation: {
+        glm::quat q1;
+        q1.x = frame.transformData.x;
+        q1.y = frame.transformData.y;
+        q1.z = frame.transformData.z;
+        q1.w = frame.transformData.w;
+
+        glm::quat q2;
+        q2.x = nextFrame.transformData.x;
+        q2.y = nextFrame.transformData.y;
+        q2.z = nextFrame.transformData.z;
+        q2.w = nextFrame.transformData.w;
+
+        node.rotation = glm::normalize(glm::slerp(q1, q2, u));
+        break;
+      }
+      default: {
+        break;
+      }
+    }
   }
 
-  // create accumulated matrices for every node
-  for (auto& rootNode : pModel->getRootNodes()) {
-    // propagate node transformation accumulating from parent to children
-    rootNode->propagateTransformation();
+  // accumulate matrices from parents to children
+  for (auto& node : pose.nodes) {
+    const glm::mat4 localMatrix = glm::translate(glm::mat4(1.0f), node.translation) *
+                                  glm::mat4(node.rotation) *
+                                  glm::scale(glm::mat4(1.0f), node.scale) *
+                                  node.restMatrix;
 
-    // set root and propagated transformation matrices and update joint matrices
-    rootNode->updateStagingNodeMatrices(this);
+    node.matrix = (node.parent > -1) ? pose.nodes[node.parent].matrix * localMatrix
+                                     : localMatrix;
   }
 
   // create a keyframe using accumulated matrices
-  addKeyFrame(pModel, time - stagingData.startTimeStamp);
+  addKeyFrame(pose, time - stagingData.startTimeStamp);
 }
 
-void WAnimation::addKeyFrame(WModel* pModel, const float timeStamp) {
+void WAnimation::addKeyFrame(const ResamplingPose& pose, const float timeStamp) {
   m_keyFrames.emplace_back(timeStamp);
 
   KeyFrame& keyFrame = m_keyFrames.back();
-  const int32_t skinCount = pModel->getSkinCount();
-  keyFrame.skinMatrices.resize(skinCount);
+  keyFrame.nodeMatrices.reserve(pose.meshNodes.size());
+  keyFrame.skinMatrices.resize(pose.skinCount);
 
-  for (const auto& pNode : pModel->getAllNodes()) {
-    if (pNode->pMesh) {
-      keyFrame.nodeMatrices[pNode->index] =
-          pNode->pMesh->stagingTransformBlock.nodeMatrix;
-
-      if (pNode->pSkin) {
-        if (keyFrame.skinMatrices[pNode->pSkin->index].empty()) {
-          keyFrame.skinMatrices[pNode->pSkin->index] =
-              pNode->pSkin->stagingTransformBlock.jointMatrices;
-        }
-      }
+  for (const auto& meshNode : pose.meshNodes) {
+    keyFrame.nodeMatrices[meshNode.first] = pose.nodes[meshNode.second].matrix;
+  }
+
+  for (const auto& skin : pose.skins) {
+    const size_t jointCount = skin.jointPoseIndices.size();
+    const size_t numJoints = std::min({jointCount, static_cast<size_t>(RE_MAXJOINTS),
+                                       skin.pInverseBindMatrices->size()});
+    auto& jointMatrices = keyFrame.skinMatrices[skin.skinIndex];
+    jointMatrices.resize(jointCount, glm::mat4(1.0f));
+
+    for (size_t i = 0; i < numJoints; ++i) {
+      jointMatrices[i] = pose.nodes[skin.jointPoseIndices[i]].matrix *
+                         (*skin.pInverseBindMatrices)[i];
     }
   }
 }
@@ -190,7 +261,7 @@ void WAnimation::resampleKeyFrames(WModel* pModel, const float framerate,
     RE_LOG(Error,
            "Can't resample frame data for animation '%s'. Required data is "
            "missing.",
-           m_name);
+           m_name.c_str());
 
     return;
   }
@@ -198,10 +269,14 @@ void WAnimation::resampleKeyFrames(WModel* pModel, const float framerate,
   const float timeStep = 1.0f / framerate * 1.0f;
   float time = stagingData.startTimeStamp;
 
+  ResamplingPose pose;
+  createResamplingPose(pModel, pose);
+
   m_keyFrames.clear();
+  m_keyFrames.reserve(static_cast<size_t>(stagingData.duration / timeStep) + 1u);
 
   while (time < stagingData.endTimeStamp) {
-    processFrame(pModel, time);
+    processFrame(pose, time);
     time += timeStep;
   }
 
@@ -1,41 +1,12 @@
 #include "pch.h"
 #include "core/core.h"
 #include "core/managers/animations.h"
+#include "core/managers/jobs.h"
 #include "core/managers/renderer.h"
 #include "core/managers/resources.h"
 #include "core/managers/time.h"
 #include "core/model/model.h"
 
-TResult WModel::createStagingBuffers() {
-  if (validateStagingData() != RE_OK) {
-    RE_LOG(Error, "Staging data is invalid for model \"%s\".", m_name.c_str());
-    return RE_ERROR; 
-  }
-
-  // create staging buffers for later copy to scene buffer
-#ifndef NDEBUG
-  RE_LOG(Log, "Creating staging buffers for this model.");
-#endif
-
-  VkDeviceSize vertexBufferSize = sizeof(RVertex) * staging.vertices.size();
-  VkDeviceSize indexBufferSize = sizeof(uint32_t) * staging.indices.size();
-
-  core::renderer.createBuffer(EBufferType::STAGING, vertexBufferSize,
-                              staging.vertexBuffer, staging.vertices.data());
-  core::renderer.createBuffer(EBufferType::STAGING, indexBufferSize,
-                              staging.indexBuffer, staging.indices.data());
-
-  // clear some of the raw staging data
-  staging.pInModel = nullptr;
-  staging.vertices.clear();
-  staging.indices.clear();
-
-  // mark that staging data still contains buffers
-  staging.isClean = false;
-
-  return RE_OK; 
-}
-
 TResult WModel::validateStagingData() {
   if (m_indexCount != staging.currentIndexOffset ||
       m_vertexCount != staging.currentVertexOffset ||
@@ -47,29 +18,55 @@ TResult WModel::validateStagingData() {
 }
 
 void WModel::clearStagingData() {
+  staging.pInModel = nullptr;
 
-  // this method was already called
-  if (staging.isClean) {
-    return;
-  }
+  // release memory, data is already copied to the upload ring
+  std::vector<RVertex>().swap(staging.vertices);
+  std::vector<uint32_t>().swap(staging.indices);
+}
 
-  staging.pInModel = nullptr;
+void WModel::createTangentSpaceData() {
+  std::vector<WPrimitive*> pPrimitives;
 
-  if (!staging.vertices.empty()) {
-    staging.vertices.clear();
+  for (WPrimitive* pPrimitive : m_pLinearPrimitives) {
+    if (pPrimitive->createTangentSpaceData) {
+      pPrimitives.emplace_back(pPrimitive);
+    }
   }
 
-  if (!staging.indices.empty()) {
-    staging.indices.clear();
+  if (pPrimitives.empty()) {
+    return;
   }
-  
-  vmaDestroyBuffer(core::renderer.memAlloc, staging.vertexBuffer.buffer,
-                     staging.vertexBuffer.allocation);
-  vmaDestroyBuffer(core::renderer.memAlloc, staging.indexBuffer.buffer,
-                     staging.indexBuffer.allocation);
-
-  // all staging data is guaranteed to be empty
-  staging.isClean = true;
+
+  // largest primitives go first so that threads finish at roughly the same time
+  std::sort(pPrimitives.begin(), pPrimitives.end(),
+            [](const WPrimitive* pA, const WPrimitive* pB) {
+              return pA->indexCount > pB->indexCount;
+            });
+
+  // every primitive owns a separate range of the staging data
+  core::jobs.parallelFor(
+      static_cast<uint32_t>(pPrimitives.size()), 1u,
+      [&](const uint32_t begin, const uint32_t end) {
+        for (uint32_t index = begin; index < end; ++index) {
+          RE_PROFILE_SCOPE("Generate tangents");
+          WPrimitive* pPrimitive = pPrimitives[index];
+
+          WPrimitive::generateTangents(
+              staging.vertices.data() + pPrimitive->vertexOffset,
+              pPrimitive->vertexCount,
+              staging.indices.data() + pPrimitive->indexOffset,
+              pPrimitive->indexCount);
+
+          pPrimitive->createTangentSpaceData = false;
+        }
+      });
+
+#ifndef NDEBUG
+  RE_LOG(Log, "Generated tangents for %d primitives of model '%s' using %d job workers.",
+         static_cast<int32_t>(pPrimitives.size()), m_name.c_str(),
+         core::jobs.getWorkerCount());
+#endif
 }
 
 void WModel::sortPrimitivesByMaterial() {
@@ -159,6 +156,11 @@ void WModel::resetUniformBlockData() {
 }
 
 void WModel::uploadToSceneBuffer() {
+  if (validateStagingData() != RE_OK) {
+    RE_LOG(Error, "Staging data is invalid for model \"%s\".", m_name.c_str());
+    return;
+  }
+
   core::renderer.uploadModelToSceneBuffer(this);
 }
 
@@ -264,6 +266,15 @@ TResult WModel::clean() {
   m_pLinearNodes.clear();
   m_pLinearPrimitives.clear();
 
+  // scene buffer ranges are reused after frames in flight are done with them
+  core::renderer.releaseModelFromSceneBuffer(this);
+
+  // unreferenced textures of deleted materials are destroyed the same way
+  for (const auto& materialName : m_materialList) {
+    core::resources.deleteMaterial(materialName.c_str());
+  }
+  m_materialList.clear();
+
   clearStagingData();
 
   RE_LOG(Log, "Model '%s' is prepared for deletion.", m_name.c_str());
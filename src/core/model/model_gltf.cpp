@@ -2,6 +2,7 @@
 #include "core/core.h"
 #include "core/managers/renderer.h"
 #include "core/managers/animations.h"
+#include "core/managers/jobs.h"
 #include "core/model/model.h"
 
 #include "tiny_gltf.h"
@@ -15,6 +16,8 @@ TResult WModel::createModel(const char* name, const tinygltf::Model* pInModel,
   }
 
   staging.pInModel = pInModel;
+  staging.weldVertices = pConfigInfo ? pConfigInfo->weldVertices : true;
+  staging.weldedVertexCount = 0u;
   const tinygltf::Model& gltfModel = *pInModel;
 
   m_name = name;
@@ -31,32 +34,36 @@ TResult WModel::createModel(const char* name, const tinygltf::Model* pInModel,
   // assign texture samplers for the current WModel
   setTextureSamplers();
 
-  // go through glTF model's texture records
-  for (const tinygltf::Texture& tex : gltfModel.textures) {
+  // go through glTF model's texture records, all textures are loaded as a
+  // single batch so that file reads and uploads of separate textures overlap
+  std::vector<RTextureLoadInfo> textureLoadInfos(gltfModel.textures.size());
+
+  for (size_t i = 0; i < gltfModel.textures.size(); ++i) {
+    const tinygltf::Texture& tex = gltfModel.textures[i];
     const tinygltf::Image* pImage = &gltfModel.images[tex.source];
 
     // get custom corresponding sampler data from WModel if present
-    RSamplerInfo textureSampler{};
     if (tex.sampler != -1) {
-      textureSampler = m_textureSamplers[tex.sampler];
+      textureLoadInfos[i].samplerInfo = m_textureSamplers[tex.sampler];
     }
 
-    // add empty path, should be changed later
-    texturePaths.emplace_back("");
-
-    // get texture name and load it though materials manager
-    if (pImage->uri == "") {
-      continue;
-    }
+    // empty path is skipped by the loader
+    textureLoadInfos[i].filePath = pImage->uri;
+    textureLoadInfos[i].enableStreaming = true;
 
 #ifndef NDEBUG
-    RE_LOG(Log, "Loading texture \"%s\" for model \"%s\".", pImage->uri.c_str(),
-           m_name.c_str());
+    if (pImage->uri != "") {
+      RE_LOG(Log, "Loading texture \"%s\" for model \"%s\".",
+             pImage->uri.c_str(), m_name.c_str());
+    }
 #endif
-    if (core::resources.loadTexture(pImage->uri.c_str(), &textureSampler) <
-        RE_ERROR) {
-      texturePaths.back() = pImage->uri;
-    };
+  }
+
+  core::resources.loadTextures(textureLoadInfos);
+
+  for (const RTextureLoadInfo& loadInfo : textureLoadInfos) {
+    // already loaded textures are reported as warnings and can still be used
+    texturePaths.emplace_back(loadInfo.result < RE_ERROR ? loadInfo.filePath : "");
   }
 
   // get glTF materials and convert them to RMaterial
@@ -76,6 +83,18 @@ TResult WModel::createModel(const char* name, const tinygltf::Model* pInModel,
     createNode(nullptr, gltfNode, gltfScene.nodes[n]);
   }
 
+  // welded primitives were packed tighter than the source vertex count
+  if (staging.weldedVertexCount > 0) {
+    const uint32_t sourceVertexCount = m_vertexCount;
+    m_vertexCount -= staging.weldedVertexCount;
+    staging.vertices.resize(m_vertexCount);
+
+    RE_LOG(Log, "Welded vertices of model \"%s\": %d -> %d (%.1f%% reduction).",
+           m_name.c_str(), sourceVertexCount, m_vertexCount,
+           100.0f * static_cast<float>(staging.weldedVertexCount) /
+               static_cast<float>(sourceVertexCount));
+  }
+
   // validate model staging buffers
   if (validateStagingData() != RE_OK) {
     RE_LOG(Error,
@@ -84,6 +103,9 @@ TResult WModel::createModel(const char* name, const tinygltf::Model* pInModel,
     return RE_ERROR;
   }
 
+  // generate missing tangents while vertex data is still in local staging memory
+  createTangentSpaceData();
+
   loadSkins();
 
   for (auto pNode : m_pLinearNodes) {
@@ -100,6 +122,12 @@ TResult WModel::createModel(const char* name, const tinygltf::Model* pInModel,
     }
   }
 
+  createSkinningStreams();
+
+  if (pConfigInfo && pConfigInfo->isOccluder) {
+    createOccluderData();
+  }
+
   if (pConfigInfo &&
       pConfigInfo->animationLoadMode > EAnimationLoadMode::OnDemand) {
     if (gltfModel.animations.size() > 0) {
@@ -111,8 +139,6 @@ TResult WModel::createModel(const char* name, const tinygltf::Model* pInModel,
 
   resetUniformBlockData();
 
-  createStagingBuffers();
-
   uploadToSceneBuffer();
 
   return RE_OK;
@@ -183,7 +209,8 @@ void WModel::createNode(WModel::Node* pParentNode,
       const tinygltf::Primitive& gltfPrimitive = gltfMesh.primitives[j];
       glm::vec3 posMin{0.0f}, posMax{0.0f};
       uint32_t vertexStart = 0, indexStart = 0, vertexCount = 0, indexCount = 0;
-      bool hasSkin = false, hasIndices = gltfPrimitive.indices > -1;
+      bool hasSkin = false, hasTangents = false,
+           hasIndices = gltfPrimitive.indices > -1;
 
       // prepare an array of RVertex and indices to store vertex and index data
       std::vector<RVertex> vertices;
@@ -196,6 +223,7 @@ void WModel::createNode(WModel::Node* pParentNode,
         const float* pBufferTexCoords0 = nullptr;
         const float* pBufferTexCoords1 = nullptr;
         const float* pBufferColors = nullptr;
+        const float* pBufferTangents = nullptr;
         const void* pBufferJoints = nullptr;
         const float* pBufferWeights = nullptr;
 
@@ -204,6 +232,7 @@ void WModel::createNode(WModel::Node* pParentNode,
         int32_t tex0ByteStride = 0;
         int32_t tex1ByteStride = 0;
         int32_t colorsByteStride = 0;
+        int32_t tangentsByteStride = 0;
         int32_t jointByteStride = 0;
         int32_t weightByteStride = 0;
 
@@ -291,6 +320,21 @@ void WModel::createNode(WModel::Node* pParentNode,
                   : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC3);
         }
 
+        // tangents, generated later if not provided
+        if (gltfPrimitive.attributes.contains("TANGENT")) {
+          const tinygltf::Accessor& accessor =
+              gltfModel.accessors[gltfPrimitive.attributes.at("TANGENT")];
+          const tinygltf::BufferView& view =
+              gltfModel.bufferViews[accessor.bufferView];
+          pBufferTangents = reinterpret_cast<const float*>(
+              &(gltfModel.buffers[view.buffer]
+                    .data[accessor.byteOffset + view.byteOffset]));
+          tangentsByteStride =
+              accessor.ByteStride(view)
+                  ? (accessor.ByteStride(view) / sizeof(float))
+                  : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC4);
+        }
+
         // skinning and joints
         if (gltfPrimitive.attributes.contains("JOINTS_0")) {
           const tinygltf::Accessor& jointAccessor =
@@ -323,6 +367,7 @@ void WModel::createNode(WModel::Node* pParentNode,
         }
 
         hasSkin = (pBufferJoints && pBufferWeights);
+        hasTangents = (pBufferTangents != nullptr);
 
         vertices.resize(posAccessor.count);
 
@@ -345,6 +390,10 @@ void WModel::createNode(WModel::Node* pParentNode,
               pBufferColors
                   ? glm::make_vec4(&pBufferColors[v * colorsByteStride])
                   : glm::vec4(1.0f);
+          vertex.tangent =
+              pBufferTangents
+                  ? glm::make_vec4(&pBufferTangents[v * tangentsByteStride])
+                  : glm::vec4(0.0f);
 
           if (hasSkin) {
             switch (jointComponentType) {
@@ -382,6 +431,10 @@ void WModel::createNode(WModel::Node* pParentNode,
           if (core::vulkan::applyGLTFLeftHandedFix) {
             vertex.pos.x = -vertex.pos.x;
             vertex.normal.x = -vertex.normal.x;
+
+            // mirroring flips tangent frame handedness
+            vertex.tangent.x = -vertex.tangent.x;
+            vertex.tangent.w = -vertex.tangent.w;
           }
         }
       }
@@ -438,13 +491,18 @@ void WModel::createNode(WModel::Node* pParentNode,
         }
       }
 
+      // merge split vertices before any per vertex data is derived
+      if (staging.weldVertices && hasIndices) {
+        staging.weldedVertexCount += WPrimitive::weldVertices(vertices, indices);
+      }
+
       RPrimitiveInfo primitiveInfo{};
       primitiveInfo.vertexOffset = staging.currentVertexOffset;
       primitiveInfo.indexOffset = staging.currentIndexOffset;
       primitiveInfo.vertexCount = static_cast<uint32_t>(vertices.size());
       primitiveInfo.indexCount = static_cast<uint32_t>(indices.size());
 
-      primitiveInfo.createTangentSpaceData = true;
+      primitiveInfo.createTangentSpaceData = !hasTangents;
       primitiveInfo.pVertexData = &vertices;
       primitiveInfo.pIndexData = &indices;
       primitiveInfo.pOwnerNode = pNode;
@@ -457,6 +515,9 @@ void WModel::createNode(WModel::Node* pParentNode,
       pPrimitive->pInitialMaterial = core::resources.getMaterial(
           m_materialList[gltfPrimitive.material].c_str());
 
+      // split into meshlets while local primitive data is still available
+      pPrimitive->generateMeshlets(vertices, indices);
+
       // copy vertex and index data to local staging buffers and adjust offsets
       std::copy(vertices.begin(), vertices.end(),
                 staging.vertices.begin() + staging.currentVertexOffset);
@@ -575,6 +636,9 @@ void WModel::parseMaterials(const std::vector<std::string>& texturePaths) {
 
     materialInfo.doubleSided = mat.doubleSided;
 
+    // textures are destroyed with the last material of the model using them
+    materialInfo.manageTextures = true;
+
     if (mat.name == "") {
       RE_LOG(
           Error,
@@ -666,6 +730,7 @@ void WModel::extractAnimations(const WModelConfigInfo* pConfigInfo) {
   }
 
   const tinygltf::Model& gltfModel = *staging.pInModel;
+  std::vector<WAnimation*> pAnimations;
 
   for (int32_t i = 0; i < gltfModel.animations.size(); ++i) {
     const tinygltf::Animation& gltfAnimation = gltfModel.animations[i];
@@ -802,8 +867,21 @@ void WModel::extractAnimations(const WModelConfigInfo* pConfigInfo) {
       pAnimation->setStagingTimeRange(startTime, endTime);
     }
 
-    pAnimation->resampleKeyFrames(this, pConfigInfo->framerate,
-                                  pConfigInfo->speed);
+    pAnimations.emplace_back(pAnimation);
+  }
+
+  // clips only read the model, each of them is resampled by a separate job
+  core::jobs.parallelFor(
+      static_cast<uint32_t>(pAnimations.size()), 1u,
+      [&](const uint32_t begin, const uint32_t end) {
+        for (uint32_t index = begin; index < end; ++index) {
+          RE_PROFILE_SCOPE("Resample animation");
+          pAnimations[index]->resampleKeyFrames(this, pConfigInfo->framerate,
+                                                pConfigInfo->speed);
+        }
+      });
+
+  for (WAnimation* pAnimation : pAnimations) {
     pAnimation->clearStagingTransformData();
 
     if (pConfigInfo->animationLoadMode >
@@ -855,7 +933,128 @@ void WModel::loadSkins() {
              accessor.count * sizeof(glm::mat4));
     }
 
-    pSkin->stagingTransformBlock.jointMatrices.resize(pSkin->joints.size());
+    createJointBounds(pSkin);
+
     ++index;
   }
 }
+
+void WModel::createJointBounds(Skin* pSkin) {
+  const size_t jointCount = pSkin->joints.size();
+  std::vector<glm::vec3> jointMin(jointCount, glm::vec3(std::numeric_limits<float>::max()));
+  std::vector<glm::vec3> jointMax(jointCount, glm::vec3(std::numeric_limits<float>::lowest()));
+
+  for (WPrimitive* pPrimitive : m_pLinearPrimitives) {
+    const Node* pNode = reinterpret_cast<Node*>(pPrimitive->pOwnerNode);
+
+    if (!pNode || pNode->skinIndex != pSkin->index) {
+      continue;
+    }
+
+    const uint32_t lastVertex = std::min(pPrimitive->vertexOffset + pPrimitive->vertexCount,
+                                         static_cast<uint32_t>(staging.vertices.size()));
+
+    for (uint32_t i = pPrimitive->vertexOffset; i < lastVertex; ++i) {
+      const RVertex& vertex = staging.vertices[i];
+
+      for (int32_t influence = 0; influence < 4; ++influence) {
+        const size_t jointIndex = static_cast<size_t>(vertex.joint[influence]);
+
+        if (vertex.weight[influence] <= 0.0f || jointIndex >= jointCount) {
+          continue;
+        }
+
+        jointMin[jointIndex] = glm::min(jointMin[jointIndex], vertex.pos);
+        jointMax[jointIndex] = glm::max(jointMax[jointIndex], vertex.pos);
+      }
+    }
+  }
+
+  auto& jointBounds = pSkin->jointBounds;
+  jointBounds.centers.clear();
+  jointBounds.extents.clear();
+  jointBounds.jointIndices.clear();
+
+  for (size_t jointIndex = 0; jointIndex < jointCount; ++jointIndex) {
+    if (jointMin[jointIndex].x > jointMax[jointIndex].x) {
+      continue;
+    }
+
+    jointBounds.centers.emplace_back((jointMin[jointIndex] + jointMax[jointIndex]) * 0.5f, 1.0f);
+    jointBounds.extents.emplace_back((jointMax[jointIndex] - jointMin[jointIndex]) * 0.5f, 0.0f);
+    jointBounds.jointIndices.emplace_back(static_cast<uint32_t>(jointIndex));
+  }
+}
+
+void WModel::createSkinningStreams() {
+  const uint32_t vertexCount = static_cast<uint32_t>(staging.vertices.size());
+
+  for (Node* pNode : m_pLinearNodes) {
+    if (!pNode->pMesh || pNode->skinIndex < 0) continue;
+
+    for (auto& pPrimitive : pNode->pMesh->pPrimitives) {
+      if (pPrimitive->vertexOffset + pPrimitive->vertexCount > vertexCount) continue;
+
+      auto& streams = pPrimitive->skinningStreams;
+      streams.positions.resize(pPrimitive->vertexCount);
+      streams.normals.resize(pPrimitive->vertexCount);
+      streams.joints.resize(pPrimitive->vertexCount);
+      streams.weights.resize(pPrimitive->vertexCount);
+
+      for (uint32_t i = 0; i < pPrimitive->vertexCount; ++i) {
+        const RVertex& vertex = staging.vertices[pPrimitive->vertexOffset + i];
+
+        streams.positions[i] = glm::vec4(vertex.pos, 1.0f);
+        streams.normals[i] = glm::vec4(vertex.normal, 0.0f);
+        streams.weights[i] = vertex.weight;
+
+        // palettes are limited to RE_MAXJOINTS matrices
+        uint32_t joints = 0u;
+        for (int32_t influence = 0; influence < 4; ++influence) {
+          const uint32_t joint = std::min(static_cast<uint32_t>(vertex.joint[influence]), RE_MAXJOINTS - 1u);
+          joints |= joint << (influence * 8);
+        }
+
+        streams.joints[i] = joints;
+      }
+    }
+  }
+}
+
+void WModel::createOccluderData() {
+  uint32_t triangleCount = 0u;
+
+  for (Node* pNode : m_pLinearNodes) {
+    if (!pNode->pMesh || pNode->skinIndex > -1) continue;
+
+    auto& occluder = pNode->pMesh->occluder;
+
+    for (auto& pPrimitive : pNode->pMesh->pPrimitives) {
+      // alpha tested and blended surfaces don't hide what's behind them
+      if (!pPrimitive->pInitialMaterial ||
+          !(pPrimitive->pInitialMaterial->passFlags &
+            (EDynamicRenderingPass::OpaqueCullBack | EDynamicRenderingPass::OpaqueCullNone))) {
+        continue;
+      }
+
+      if (pPrimitive->vertexOffset + pPrimitive->vertexCount > staging.vertices.size() ||
+          pPrimitive->indexOffset + pPrimitive->indexCount > staging.indices.size()) {
+        continue;
+      }
+
+      const uint32_t firstVertex = static_cast<uint32_t>(occluder.positions.size());
+
+      for (uint32_t i = 0; i < pPrimitive->vertexCount; ++i) {
+        occluder.positions.emplace_back(staging.vertices[pPrimitive->vertexOffset + i].pos, 1.0f);
+      }
+
+      for (uint32_t i = 0; i < pPrimitive->indexCount; ++i) {
+        occluder.indices.emplace_back(firstVertex + staging.indices[pPrimitive->indexOffset + i]);
+      }
+
+      triangleCount += pPrimitive->indexCount / 3u;
+    }
+  }
+
+  RE_LOG(Log, "Model \"%s\" has %d occluder triangles.", m_name.c_str(), triangleCount);
+}
@@ -8,40 +8,6 @@ WModel::Node::Node(WModel::Node* pParent, uint32_t index,
                    const std::string& name)
     : pParentNode(pParent), index(index), name(name) {}
 
-void WModel::Node::propagateTransformation(const glm::mat4& accumulatedMatrix) {
-  transformedNodeMatrix = accumulatedMatrix * getLocalMatrix();
-
-  for (auto& child : pChildren) {
-    child->propagateTransformation(transformedNodeMatrix);
-  }
-}
-
-void WModel::Node::updateStagingNodeMatrices(WAnimation* pOutAnimation) {
-  if (pMesh) {
-    pMesh->stagingTransformBlock.nodeMatrix = transformedNodeMatrix;
-
-    // node has mesh, store a reference to it in an animation
-    pOutAnimation->addNodeReference(this->name, this->index);
-
-    if (pSkin && pSkin->staging.recalculateSkinMatrices) {
-      // Update joint matrices
-      uint32_t numJoints = std::min(static_cast<uint32_t>(pSkin->joints.size()), RE_MAXJOINTS);
-
-      for (uint32_t i = 0; i < numJoints; i++) {
-        glm::mat4 jointMatrix = pSkin->joints[i]->transformedNodeMatrix *
-                                pSkin->staging.inverseBindMatrices[i];
-        pSkin->stagingTransformBlock.jointMatrices[i] = jointMatrix;
-      }
-
-      pSkin->staging.recalculateSkinMatrices = false;
-    }
-  }
-
-  for (auto& pChild : pChildren) {
-    pChild->updateStagingNodeMatrices(pOutAnimation);
-  }
-}
-
 glm::mat4 WModel::Node::getLocalMatrix() {
   return glm::translate(glm::mat4(1.0f), staging.translation) *
          glm::mat4(staging.rotation) *
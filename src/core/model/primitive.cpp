@@ -18,6 +18,7 @@ WPrimitive::WPrimitive(RPrimitiveInfo* pCreateInfo) {
   indexCount = pCreateInfo->indexCount;
 
   pOwnerNode = pCreateInfo->pOwnerNode;
+  createTangentSpaceData = pCreateInfo->createTangentSpaceData;
 }
 void WPrimitive::generatePlane(int32_t xDivisions, int32_t yDivisions,
                                std::vector<RVertex>& outVertices,
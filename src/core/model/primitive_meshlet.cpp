@@ -0,0 +1,228 @@
+#include "pch.h"
+#include "core/model/primitive.h"
+#include "util/math.h"
+
+void WPrimitive::generateMeshlets(const std::vector<RVertex>& vertexData,
+                                  const std::vector<uint32_t>& indexData) {
+  meshletData.meshlets.clear();
+  meshletData.vertexIndices.clear();
+  meshletData.triangleIndices.clear();
+
+  const size_t triangleCount = indexData.size() / 3;
+  const size_t vertexCount = vertexData.size();
+
+  if (triangleCount == 0 || vertexCount == 0) {
+    return;
+  }
+
+  // primitive vertex -> current meshlet vertex, 0xFF if not yet in the meshlet
+  constexpr uint8_t unassigned = 0xFF;
+  std::vector<uint8_t> localIndices(vertexCount, unassigned);
+
+  meshletData.meshlets.reserve(triangleCount / RE_MESHLETMAXTRIANGLES + 1);
+  meshletData.vertexIndices.reserve(vertexCount + vertexCount / 4);
+  meshletData.triangleIndices.reserve(triangleCount * 3);
+
+  WMeshlet meshlet{};
+
+  auto fFinalizeMeshlet = [&]() {
+    for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+      localIndices[meshletData.vertexIndices[meshlet.vertexOffset + i]] = unassigned;
+    }
+
+    setMeshletBounds(meshlet, vertexData);
+    meshletData.meshlets.emplace_back(meshlet);
+
+    meshlet = WMeshlet{};
+    meshlet.vertexOffset = static_cast<uint32_t>(meshletData.vertexIndices.size());
+    meshlet.triangleOffset = static_cast<uint32_t>(meshletData.triangleIndices.size());
+  };
+
+  for (size_t t = 0; t < triangleCount; ++t) {
+    const uint32_t* pTriangle = &indexData[t * 3];
+
+    if (pTriangle[0] >= vertexCount || pTriangle[1] >= vertexCount ||
+        pTriangle[2] >= vertexCount) {
+      continue;
+    }
+
+    uint32_t newVertices = 0u;
+    for (uint8_t k = 0; k < 3; ++k) {
+      newVertices += (localIndices[pTriangle[k]] == unassigned);
+    }
+
+    // greedy scan in index order keeps the original vertex cache locality
+    if (meshlet.vertexCount + newVertices > RE_MESHLETMAXVERTICES ||
+        meshlet.triangleCount + 1 > RE_MESHLETMAXTRIANGLES) {
+      fFinalizeMeshlet();
+    }
+
+    if (meshlet.triangleCount == 0) {
+      meshlet.indexOffset = static_cast<uint32_t>(t * 3);
+    }
+
+    for (uint8_t k = 0; k < 3; ++k) {
+      uint8_t& localIndex = localIndices[pTriangle[k]];
+
+      if (localIndex == unassigned) {
+        localIndex = static_cast<uint8_t>(meshlet.vertexCount++);
+        meshletData.vertexIndices.emplace_back(pTriangle[k]);
+      }
+
+      meshletData.triangleIndices.emplace_back(localIndex);
+    }
+
+    ++meshlet.triangleCount;
+    meshlet.indexCount = static_cast<uint32_t>(t * 3 + 3) - meshlet.indexOffset;
+  }
+
+  if (meshlet.triangleCount > 0) {
+    fFinalizeMeshlet();
+  }
+}
+
+void WPrimitive::setMeshletBounds(WMeshlet& meshlet,
+                                  const std::vector<RVertex>& vertexData) {
+  const uint32_t* pVertexIndices = &meshletData.vertexIndices[meshlet.vertexOffset];
+  const uint8_t* pTriangleIndices = &meshletData.triangleIndices[meshlet.triangleOffset];
+
+  // bounding sphere around the meshlet AABB center
+  glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+  glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+  for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+    const glm::vec3& pos = vertexData[pVertexIndices[i]].pos;
+    min = glm::min(min, pos);
+    max = glm::max(max, pos);
+  }
+
+  meshlet.center = (min + max) * 0.5f;
+  meshlet.radius = 0.0f;
+
+  for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+    meshlet.radius = std::max(
+        meshlet.radius, glm::distance(meshlet.center, vertexData[pVertexIndices[i]].pos));
+  }
+
+  // normal cone from triangle face normals, front faces wind counter clockwise
+  // in model space so the winding defines the facing, vertex normals may be
+  // authored to differ from it (e.g. foliage) and are not used
+  glm::vec3 faceNormals[RE_MESHLETMAXTRIANGLES];
+  uint32_t faceNormalCount = 0u;
+  glm::vec3 axis = glm::vec3(0.0f);
+
+  for (uint32_t t = 0; t < meshlet.triangleCount; ++t) {
+    const RVertex& v0 = vertexData[pVertexIndices[pTriangleIndices[t * 3]]];
+    const RVertex& v1 = vertexData[pVertexIndices[pTriangleIndices[t * 3 + 1]]];
+    const RVertex& v2 = vertexData[pVertexIndices[pTriangleIndices[t * 3 + 2]]];
+
+    glm::vec3 normal = glm::cross(v1.pos - v0.pos, v2.pos - v0.pos);
+    const float length = glm::length(normal);
+
+    // skip degenerate triangles
+    if (length < 1e-12f) {
+      continue;
+    }
+
+    normal /= length;
+
+    faceNormals[faceNormalCount++] = normal;
+    axis += normal;
+  }
+
+  meshlet.coneAxis = glm::vec3(0.0f);
+  meshlet.coneCutoff = 1.0f;
+
+  const float axisLength = glm::length(axis);
+
+  if (faceNormalCount == 0 || axisLength < 1e-6f) {
+    return;
+  }
+
+  axis /= axisLength;
+
+  float minDot = 1.0f;
+  for (uint32_t i = 0; i < faceNormalCount; ++i) {
+    minDot = std::min(minDot, glm::dot(axis, faceNormals[i]));
+  }
+
+  // cone spread is 90 degrees or wider, meshlet can never be fully back facing
+  if (minDot <= 0.0f) {
+    return;
+  }
+
+  meshlet.coneAxis = axis;
+  meshlet.coneCutoff = sqrtf(1.0f - minDot * minDot);
+}
+
+bool WPrimitive::isMeshletVisible(const WMeshlet& meshlet,
+                                  const glm::vec4* pFrustumPlanes,
+                                  const glm::vec3& cameraLocation,
+                                  const bool testNormalCone) const {
+  for (uint8_t i = 0; i < 6; ++i) {
+    const glm::vec4& plane = pFrustumPlanes[i];
+
+    if (glm::dot(glm::vec3(plane), meshlet.center) + plane.w < -meshlet.radius) {
+      return false;
+    }
+  }
+
+  if (testNormalCone && meshlet.coneCutoff < 1.0f) {
+    const glm::vec3 viewVector = meshlet.center - cameraLocation;
+
+    if (glm::dot(viewVector, meshlet.coneAxis) >=
+        meshlet.coneCutoff * glm::length(viewVector) + meshlet.radius) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+uint32_t WPrimitive::cullMeshlets(const glm::mat4* pModelMatrices, const uint32_t instanceCount,
+                                  const glm::mat4& projectionView,
+                                  const glm::vec3& cameraLocation, const bool testNormalCone,
+                                  std::vector<glm::uvec2>& outIndexRanges) const {
+  constexpr uint32_t maxInstances = 8u;
+
+  outIndexRanges.clear();
+
+  const uint32_t testedCount = std::min(instanceCount, maxInstances);
+  glm::vec4 frustumPlanes[maxInstances][6];
+  glm::vec3 cameraLocations[maxInstances];
+  bool testNormalCones[maxInstances];
+
+  // tests are done in primitive space, affine transforms keep the facing of
+  // triangles, mirrored instances flip their winding and skip the cone test
+  for (uint32_t i = 0; i < testedCount; ++i) {
+    math::getFrustumPlanes(projectionView * pModelMatrices[i], frustumPlanes[i]);
+    cameraLocations[i] = glm::vec3(glm::inverse(pModelMatrices[i]) * glm::vec4(cameraLocation, 1.0f));
+    testNormalCones[i] = testNormalCone && glm::determinant(glm::mat3(pModelMatrices[i])) > 0.0f;
+  }
+
+  uint32_t culledTriangleCount = 0u;
+
+  for (const WMeshlet& meshlet : meshletData.meshlets) {
+    // instances past the tested ones see every meshlet
+    bool isVisible = instanceCount > testedCount;
+
+    for (uint32_t i = 0; i < testedCount && !isVisible; ++i) {
+      isVisible = isMeshletVisible(meshlet, frustumPlanes[i], cameraLocations[i], testNormalCones[i]);
+    }
+
+    if (!isVisible) {
+      culledTriangleCount += meshlet.triangleCount;
+      continue;
+    }
+
+    if (!outIndexRanges.empty() &&
+        outIndexRanges.back().x + outIndexRanges.back().y == meshlet.indexOffset) {
+      outIndexRanges.back().y += meshlet.indexCount;
+      continue;
+    }
+
+    outIndexRanges.emplace_back(meshlet.indexOffset, meshlet.indexCount);
+  }
+
+  return culledTriangleCount;
+}
@@ -0,0 +1,104 @@
+#include "pch.h"
+#include "core/model/primitive.h"
+
+void WPrimitive::generateTangents(RVertex* pVertices, const size_t vertexCount,
+                                  const uint32_t* pIndices,
+                                  const size_t indexCount) noexcept {
+  if (!pVertices || !pIndices || vertexCount == 0 || indexCount < 3) {
+    return;
+  }
+
+  // aligned vec4 accumulators keep the math in SIMD registers
+  std::vector<glm::vec4> tangents(vertexCount, glm::vec4(0.0f));
+  std::vector<glm::vec4> bitangents(vertexCount, glm::vec4(0.0f));
+
+  for (size_t i = 0; i + 2 < indexCount; i += 3) {
+    const uint32_t indices[3] = {pIndices[i], pIndices[i + 1], pIndices[i + 2]};
+
+    if (indices[0] >= vertexCount || indices[1] >= vertexCount ||
+        indices[2] >= vertexCount) {
+      continue;
+    }
+
+    const glm::vec4 positions[3] = {glm::vec4(pVertices[indices[0]].pos, 0.0f),
+                                    glm::vec4(pVertices[indices[1]].pos, 0.0f),
+                                    glm::vec4(pVertices[indices[2]].pos, 0.0f)};
+
+    const glm::vec2& uv0 = pVertices[indices[0]].tex0;
+    const glm::vec2& uv1 = pVertices[indices[1]].tex0;
+    const glm::vec2& uv2 = pVertices[indices[2]].tex0;
+
+    const glm::vec4 edge1 = positions[1] - positions[0];
+    const glm::vec4 edge2 = positions[2] - positions[0];
+    const glm::vec2 deltaUV1 = uv1 - uv0;
+    const glm::vec2 deltaUV2 = uv2 - uv0;
+
+    const float determinant = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+
+    // degenerate texture mapping, shader will derive the tangent frame instead
+    if (fabsf(determinant) < 1e-12f) {
+      continue;
+    }
+
+    // glTF texture coordinates have their origin at the top left corner,
+    // flip V to match the MikkTSpace bitangent sign stored by glTF exporters
+    const float r = 1.0f / determinant;
+    const glm::vec4 tangent = (edge1 * deltaUV2.y - edge2 * deltaUV1.y) * r;
+    const glm::vec4 bitangent = (edge1 * deltaUV2.x - edge2 * deltaUV1.x) * r;
+
+    // like MikkTSpace, the face tangent is projected onto the plane of each
+    // corner normal and normalized, so only the corner angle weights it
+    for (uint8_t k = 0; k < 3; ++k) {
+      const glm::vec4 a = positions[(k + 1) % 3] - positions[k];
+      const glm::vec4 b = positions[(k + 2) % 3] - positions[k];
+      const float lengths = glm::length(a) * glm::length(b);
+
+      if (lengths < 1e-20f) {
+        continue;
+      }
+
+      const glm::vec4 normal = glm::vec4(pVertices[indices[k]].normal, 0.0f);
+      const glm::vec4 cornerTangent = tangent - normal * glm::dot(normal, tangent);
+      const glm::vec4 cornerBitangent = bitangent - normal * glm::dot(normal, bitangent);
+      const float tangentLength = glm::length(cornerTangent);
+      const float bitangentLength = glm::length(cornerBitangent);
+
+      // tangent along the normal leaves nothing to contribute
+      if (tangentLength < 1e-12f) {
+        continue;
+      }
+
+      const float angle = acosf(glm::clamp(glm::dot(a, b) / lengths, -1.0f, 1.0f));
+
+      tangents[indices[k]] += cornerTangent * (angle / tangentLength);
+
+      if (bitangentLength > 1e-12f) {
+        bitangents[indices[k]] += cornerBitangent * (angle / bitangentLength);
+      }
+    }
+  }
+
+  for (size_t v = 0; v < vertexCount; ++v) {
+    RVertex& vertex = pVertices[v];
+    const glm::vec4 normal = glm::vec4(vertex.normal, 0.0f);
+
+    // Gram-Schmidt orthogonalize against the vertex normal
+    glm::vec4 tangent = tangents[v] - normal * glm::dot(normal, tangents[v]);
+    const float length = glm::length(tangent);
+
+    if (length < 1e-12f) {
+      vertex.tangent = glm::vec4(0.0f);
+      continue;
+    }
+
+    tangent /= length;
+
+    const float handedness =
+        (glm::dot(glm::cross(vertex.normal, glm::vec3(tangent)),
+                  glm::vec3(bitangents[v])) < 0.0f)
+            ? -1.0f
+            : 1.0f;
+
+    vertex.tangent = glm::vec4(glm::vec3(tangent), handedness);
+  }
+}
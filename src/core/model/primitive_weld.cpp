@@ -0,0 +1,181 @@
+#include "pch.h"
+#include "core/model/primitive.h"
+
+namespace {
+// quantized vertex attributes, vertices with equal keys are considered equal
+constexpr uint32_t weldKeySize = 27u;
+using WeldKey = std::array<int32_t, weldKeySize>;
+
+int32_t quantize(const float value, const float steps) {
+  return static_cast<int32_t>(std::lroundf(value * steps));
+}
+
+void getWeldKey(const RVertex& vertex, const int32_t handedness, WeldKey& outKey) {
+  // steps per unit, positions are kept close to full float precision
+  constexpr float positionSteps = 65536.0f;
+  constexpr float directionSteps = 1024.0f;
+  constexpr float texCoordSteps = 65536.0f;
+  constexpr float weightSteps = 1024.0f;
+  constexpr float colorSteps = 255.0f;
+
+  uint32_t k = 0;
+
+  for (uint8_t i = 0; i < 3; ++i) {
+    outKey[k++] = quantize(vertex.pos[i], positionSteps);
+  }
+
+  for (uint8_t i = 0; i < 3; ++i) {
+    outKey[k++] = quantize(vertex.normal[i], directionSteps);
+  }
+
+  for (uint8_t i = 0; i < 2; ++i) {
+    outKey[k++] = quantize(vertex.tex0[i], texCoordSteps);
+    outKey[k++] = quantize(vertex.tex1[i], texCoordSteps);
+  }
+
+  for (uint8_t i = 0; i < 4; ++i) {
+    outKey[k++] = static_cast<int32_t>(vertex.joint[i]);
+    outKey[k++] = quantize(vertex.weight[i], weightSteps);
+    outKey[k++] = quantize(vertex.color[i], colorSteps);
+    outKey[k++] = quantize(vertex.tangent[i], directionSteps);
+  }
+
+  outKey[k++] = handedness;
+}
+
+// sign of the tangent frame generateTangents() would derive from the
+// triangles using each vertex, vertices with provided tangents get 0 as
+// their w already keeps mirrored texture mapping apart
+void getHandedness(const std::vector<RVertex>& vertexData,
+                   const std::vector<uint32_t>& indexData,
+                   std::vector<int32_t>& outHandedness) {
+  outHandedness.assign(vertexData.size(), 0);
+
+  for (size_t i = 0; i + 2 < indexData.size(); i += 3) {
+    const uint32_t indices[3] = {indexData[i], indexData[i + 1], indexData[i + 2]};
+
+    const glm::vec3 edge1 = vertexData[indices[1]].pos - vertexData[indices[0]].pos;
+    const glm::vec3 edge2 = vertexData[indices[2]].pos - vertexData[indices[0]].pos;
+    const glm::vec2 deltaUV1 = vertexData[indices[1]].tex0 - vertexData[indices[0]].tex0;
+    const glm::vec2 deltaUV2 = vertexData[indices[2]].tex0 - vertexData[indices[0]].tex0;
+
+    const float determinant = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+
+    if (fabsf(determinant) < 1e-12f) {
+      continue;
+    }
+
+    const glm::vec3 tangent = (edge1 * deltaUV2.y - edge2 * deltaUV1.y) / determinant;
+    const glm::vec3 bitangent = (edge1 * deltaUV2.x - edge2 * deltaUV1.x) / determinant;
+
+    for (const uint32_t index : indices) {
+      const RVertex& vertex = vertexData[index];
+
+      if (vertex.tangent != glm::vec4(0.0f)) {
+        continue;
+      }
+
+      outHandedness[index] +=
+          (glm::dot(glm::cross(vertex.normal, tangent), bitangent) < 0.0f) ? -1 : 1;
+    }
+  }
+
+  for (int32_t& handedness : outHandedness) {
+    handedness = (handedness > 0) - (handedness < 0);
+  }
+}
+
+uint64_t getWeldHash(const WeldKey& key) {
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ull;
+
+  for (const int32_t value : key) {
+    hash ^= static_cast<uint32_t>(value);
+    hash *= 1099511628211ull;
+  }
+
+  return hash;
+}
+}  // namespace
+
+uint32_t WPrimitive::weldVertices(std::vector<RVertex>& vertexData,
+                                  std::vector<uint32_t>& indexData) noexcept {
+  const size_t vertexCount = vertexData.size();
+
+  if (vertexCount < 2 || indexData.empty()) {
+    return 0u;
+  }
+
+  for (const uint32_t index : indexData) {
+    if (index >= vertexCount) {
+      RE_LOG(Error, "Vertex weld failed, index %d is out of bounds.", index);
+      return 0u;
+    }
+  }
+
+  // tangents may be generated after welding, a vertex on a mirrored texture
+  // seam must stay split so both sides keep their own tangent frame
+  std::vector<int32_t> handedness;
+  getHandedness(vertexData, indexData, handedness);
+
+  std::vector<WeldKey> keys(vertexCount);
+
+  for (size_t v = 0; v < vertexCount; ++v) {
+    getWeldKey(vertexData[v], handedness[v], keys[v]);
+  }
+
+  // open addressing table of vertex indices, kept at most half full
+  size_t tableSize = 1;
+  while (tableSize < vertexCount * 2) {
+    tableSize <<= 1;
+  }
+
+  constexpr uint32_t emptySlot = std::numeric_limits<uint32_t>::max();
+  std::vector<uint32_t> table(tableSize, emptySlot);
+
+  // maps every source vertex to the first vertex with an equal key
+  std::vector<uint32_t> canonical(vertexCount);
+
+  for (uint32_t v = 0; v < static_cast<uint32_t>(vertexCount); ++v) {
+    size_t slot = getWeldHash(keys[v]) & (tableSize - 1);
+
+    while (true) {
+      if (table[slot] == emptySlot) {
+        table[slot] = v;
+        canonical[v] = v;
+        break;
+      }
+
+      if (keys[table[slot]] == keys[v]) {
+        canonical[v] = table[slot];
+        break;
+      }
+
+      slot = (slot + 1) & (tableSize - 1);
+    }
+  }
+
+  // new vertices are ordered by first use in the index buffer, unreferenced
+  // vertices are dropped
+  std::vector<uint32_t> remap(vertexCount, emptySlot);
+  std::vector<RVertex> weldedVertices;
+  weldedVertices.reserve(vertexCount);
+
+  for (uint32_t& index : indexData) {
+    const uint32_t source = canonical[index];
+
+    if (remap[source] == emptySlot) {
+      remap[source] = static_cast<uint32_t>(weldedVertices.size());
+      weldedVertices.emplace_back(vertexData[source]);
+    }
+
+    index = remap[source];
+  }
+
+  const uint32_t removedCount =
+      static_cast<uint32_t>(vertexCount - weldedVertices.size());
+
+  vertexData = std::move(weldedVertices);
+
+  return removedCount;
+}
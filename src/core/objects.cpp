@@ -31,7 +31,7 @@ std::vector<VkVertexInputBindingDescription> RVertex::getBindingDescs() {
 }
 
 std::vector<VkVertexInputAttributeDescription> RVertex::getAttributeDescs() {
-  std::vector<VkVertexInputAttributeDescription> attrDescs(8);
+  std::vector<VkVertexInputAttributeDescription> attrDescs(10);
   
   // Vertex
   attrDescs[0].binding = 0;                         // binding defined by binding description of RVertex
@@ -75,5 +75,17 @@ std::vector<VkVertexInputAttributeDescription> RVertex::getAttributeDescs() {
   attrDescs[7].location = 7;
   attrDescs[7].offset = 0;
 
+  // Vertex, location 7 is taken by instance data
+  attrDescs[8].binding = 0;
+  attrDescs[8].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+  attrDescs[8].location = 8;
+  attrDescs[8].offset = offsetof(RVertex, tangent);
+
+  // Instance, first pre-skinned vertex relative to the drawn vertex index
+  attrDescs[9].binding = 1;
+  attrDescs[9].format = VK_FORMAT_R32_SINT;
+  attrDescs[9].location = 9;
+  attrDescs[9].offset = offsetof(RInstanceData, skinnedVertexBase);
+
   return attrDescs;
 }
\ No newline at end of file
@@ -0,0 +1,345 @@
+#include "pch.h"
+#include "core/occlusion.h"
+
+ROcclusionCuller::ROcclusionCuller(const uint32_t width, const uint32_t height) {
+  resize(width, height);
+}
+
+void ROcclusionCuller::resize(const uint32_t width, const uint32_t height) {
+  m_tileCountX = (width + tileSize - 1u) / tileSize;
+  m_tileCountY = (height + tileSize - 1u) / tileSize;
+  m_width = m_tileCountX * tileSize;
+  m_height = m_tileCountY * tileSize;
+
+  m_depth.assign(m_tileCountX * m_tileCountY * tileSize * tileSize,
+                 std::numeric_limits<float>::max());
+  m_tileDepth.assign(m_tileCountX * m_tileCountY, std::numeric_limits<float>::max());
+  m_bandTriangles.resize(m_tileCountY);
+  m_triangles.clear();
+}
+
+void ROcclusionCuller::reset(const glm::mat4& viewProjection) {
+  m_viewProjection = viewProjection;
+
+  std::fill(m_depth.begin(), m_depth.end(), std::numeric_limits<float>::max());
+  std::fill(m_tileDepth.begin(), m_tileDepth.end(), std::numeric_limits<float>::max());
+  m_triangles.clear();
+
+  for (auto& band : m_bandTriangles) {
+    band.clear();
+  }
+}
+
+void ROcclusionCuller::addOccluder(const glm::mat4& modelMatrix, const glm::vec4* pPositions,
+                                   const uint32_t vertexCount, const uint32_t* pIndices,
+                                   const uint32_t indexCount) {
+  if (m_width == 0u || vertexCount == 0u) return;
+
+  const glm::mat4 matrix = m_viewProjection * modelMatrix;
+
+  m_clipVertices.resize(vertexCount);
+  m_screenVertices.resize(vertexCount);
+
+  for (uint32_t i = 0; i < vertexCount; ++i) {
+    m_clipVertices[i] = matrix * glm::vec4(glm::vec3(pPositions[i]), 1.0f);
+
+    if (m_clipVertices[i].w >= minW) {
+      m_screenVertices[i] = toScreen(m_clipVertices[i]);
+    }
+  }
+
+  for (uint32_t i = 0; i + 2u < indexCount; i += 3u) {
+    if (pIndices[i] >= vertexCount || pIndices[i + 1] >= vertexCount ||
+        pIndices[i + 2] >= vertexCount) {
+      continue;
+    }
+
+    const glm::vec4* pVertices[3] = {&m_clipVertices[pIndices[i]],
+                                     &m_clipVertices[pIndices[i + 1]],
+                                     &m_clipVertices[pIndices[i + 2]]};
+
+    // triangles outside of a single side plane can't cover any pixel
+    uint32_t outsideMask = 0b111111u;
+    uint32_t nearCount = 0u;
+
+    for (const glm::vec4* pVertex : pVertices) {
+      const glm::vec4& v = *pVertex;
+      uint32_t mask = 0u;
+      mask |= (v.x > v.w) ? 0b1u : 0u;
+      mask |= (v.x < -v.w) ? 0b10u : 0u;
+      mask |= (v.y > v.w) ? 0b100u : 0u;
+      mask |= (v.y < -v.w) ? 0b1000u : 0u;
+      mask |= (v.w < minW) ? 0b10000u : 0u;
+      outsideMask &= mask;
+      nearCount += (v.w < minW) ? 1u : 0u;
+    }
+
+    if (outsideMask) continue;
+
+    if (nearCount == 0u) {
+      addTriangle(m_screenVertices[pIndices[i]], m_screenVertices[pIndices[i + 1]],
+                  m_screenVertices[pIndices[i + 2]]);
+      continue;
+    }
+
+    // clipped against the near plane into a triangle or a quad
+    glm::vec4 polygon[4];
+    uint32_t polygonSize = 0u;
+
+    for (uint32_t edge = 0; edge < 3u; ++edge) {
+      const glm::vec4& a = *pVertices[edge];
+      const glm::vec4& b = *pVertices[(edge + 1u) % 3u];
+      const bool isAInside = (a.w >= minW);
+      const bool isBInside = (b.w >= minW);
+
+      if (isAInside) {
+        polygon[polygonSize++] = a;
+      }
+
+      if (isAInside != isBInside) {
+        const float t = (minW - a.w) / (b.w - a.w);
+        polygon[polygonSize++] = a + (b - a) * t;
+      }
+    }
+
+    glm::vec3 screenPolygon[4];
+
+    for (uint32_t vertex = 0; vertex < polygonSize; ++vertex) {
+      screenPolygon[vertex] = toScreen(polygon[vertex]);
+    }
+
+    for (uint32_t vertex = 2u; vertex < polygonSize; ++vertex) {
+      addTriangle(screenPolygon[0], screenPolygon[vertex - 1u], screenPolygon[vertex]);
+    }
+  }
+}
+
+glm::vec3 ROcclusionCuller::toScreen(const glm::vec4& clip) const {
+  const float invW = 1.0f / clip.w;
+
+  return glm::vec3((clip.x * invW * 0.5f + 0.5f) * static_cast<float>(m_width),
+                   (clip.y * invW * 0.5f + 0.5f) * static_cast<float>(m_height),
+                   clip.z * invW);
+}
+
+void ROcclusionCuller::addTriangle(const glm::vec3& v0, const glm::vec3& v1,
+                                   const glm::vec3& v2) {
+  float x[3] = {v0.x, v1.x, v2.x};
+  float y[3] = {v0.y, v1.y, v2.y};
+  float z[3] = {v0.z, v1.z, v2.z};
+
+  float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+
+  if (std::abs(area) < 1e-6f) return;
+
+  // both windings are rasterized, edge functions expect a positive area
+  if (area < 0.0f) {
+    std::swap(x[1], x[2]);
+    std::swap(y[1], y[2]);
+    std::swap(z[1], z[2]);
+    area = -area;
+  }
+
+  // pixels are covered if their centers are inside
+  RTriangle triangle;
+  triangle.minX = std::max(static_cast<int32_t>(std::ceil(std::min({x[0], x[1], x[2]}) - 0.5f)), 0);
+  triangle.minY = std::max(static_cast<int32_t>(std::ceil(std::min({y[0], y[1], y[2]}) - 0.5f)), 0);
+  triangle.maxX = std::min(static_cast<int32_t>(std::floor(std::max({x[0], x[1], x[2]}) - 0.5f)),
+                           static_cast<int32_t>(m_width) - 1);
+  triangle.maxY = std::min(static_cast<int32_t>(std::floor(std::max({y[0], y[1], y[2]}) - 0.5f)),
+                           static_cast<int32_t>(m_height) - 1);
+
+  if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) return;
+
+  for (uint32_t edge = 0; edge < 3u; ++edge) {
+    const uint32_t a = edge;
+    const uint32_t b = (edge + 1u) % 3u;
+
+    triangle.edgeA[edge] = y[a] - y[b];
+    triangle.edgeB[edge] = x[b] - x[a];
+    triangle.edgeC[edge] = (y[b] - y[a]) * x[a] - (x[b] - x[a]) * y[a];
+  }
+
+  const float invArea = 1.0f / area;
+  triangle.depthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * invArea;
+  triangle.depthB = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * invArea;
+  triangle.depthC = z[0] - triangle.depthA * x[0] - triangle.depthB * y[0];
+
+  const uint32_t triangleIndex = static_cast<uint32_t>(m_triangles.size());
+  m_triangles.emplace_back(triangle);
+
+  for (int32_t band = triangle.minY / static_cast<int32_t>(tileSize);
+       band <= triangle.maxY / static_cast<int32_t>(tileSize); ++band) {
+    m_bandTriangles[band].emplace_back(triangleIndex);
+  }
+}
+
+void ROcclusionCuller::rasterizeBand(const uint32_t bandIndex) {
+  if (bandIndex >= m_tileCountY) return;
+
+  const __m256 offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+  const __m256 zero = _mm256_setzero_ps();
+  const int32_t bandY = static_cast<int32_t>(bandIndex * tileSize);
+  float* pBand = m_depth.data() + bandIndex * m_tileCountX * tileSize * tileSize;
+
+  for (const uint32_t triangleIndex : m_bandTriangles[bandIndex]) {
+    const RTriangle& triangle = m_triangles[triangleIndex];
+    const int32_t firstRow = std::max(triangle.minY, bandY);
+    const int32_t lastRow = std::min(triangle.maxY, bandY + static_cast<int32_t>(tileSize) - 1);
+    const uint32_t firstTile = static_cast<uint32_t>(triangle.minX) / tileSize;
+    const uint32_t lastTile = static_cast<uint32_t>(triangle.maxX) / tileSize;
+
+    for (uint32_t tileX = firstTile; tileX <= lastTile; ++tileX) {
+      float* pTile = pBand + tileX * tileSize * tileSize;
+      const __m256 x = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(tileX * tileSize)), offsets);
+
+      // row independent parts of edge and depth equations
+      const __m256 edgeX0 = _mm256_mul_ps(_mm256_set1_ps(triangle.edgeA[0]), x);
+      const __m256 edgeX1 = _mm256_mul_ps(_mm256_set1_ps(triangle.edgeA[1]), x);
+      const __m256 edgeX2 = _mm256_mul_ps(_mm256_set1_ps(triangle.edgeA[2]), x);
+      const __m256 depthX = _mm256_mul_ps(_mm256_set1_ps(triangle.depthA), x);
+
+      for (int32_t row = firstRow; row <= lastRow; ++row) {
+        const float y = static_cast<float>(row) + 0.5f;
+
+        const __m256 edge0 = _mm256_add_ps(edgeX0, _mm256_set1_ps(triangle.edgeB[0] * y + triangle.edgeC[0]));
+        const __m256 edge1 = _mm256_add_ps(edgeX1, _mm256_set1_ps(triangle.edgeB[1] * y + triangle.edgeC[1]));
+        const __m256 edge2 = _mm256_add_ps(edgeX2, _mm256_set1_ps(triangle.edgeB[2] * y + triangle.edgeC[2]));
+
+        const __m256 coverage =
+            _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(edge0, zero, _CMP_GE_OQ),
+                                        _mm256_cmp_ps(edge1, zero, _CMP_GE_OQ)),
+                          _mm256_cmp_ps(edge2, zero, _CMP_GE_OQ));
+
+        if (_mm256_movemask_ps(coverage) == 0) continue;
+
+        float* pRow = pTile + (row - bandY) * tileSize;
+        const __m256 depth = _mm256_add_ps(depthX, _mm256_set1_ps(triangle.depthB * y + triangle.depthC));
+        const __m256 current = _mm256_loadu_ps(pRow);
+
+        _mm256_storeu_ps(pRow, _mm256_blendv_ps(current, _mm256_min_ps(current, depth), coverage));
+      }
+    }
+  }
+
+  // coarse level keeps the farthest depth of every tile
+  for (uint32_t tileX = 0; tileX < m_tileCountX; ++tileX) {
+    const float* pTile = pBand + tileX * tileSize * tileSize;
+    __m256 farthest = _mm256_loadu_ps(pTile);
+
+    for (uint32_t row = 1u; row < tileSize; ++row) {
+      farthest = _mm256_max_ps(farthest, _mm256_loadu_ps(pTile + row * tileSize));
+    }
+
+    __m128 half = _mm_max_ps(_mm256_castps256_ps128(farthest), _mm256_extractf128_ps(farthest, 1));
+    half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 0b01));
+
+    m_tileDepth[bandIndex * m_tileCountX + tileX] = _mm_cvtss_f32(half);
+  }
+}
+
+bool ROcclusionCuller::isVisible(const glm::vec3& min, const glm::vec3& max) const {
+  if (m_width == 0u) return true;
+
+  // corners are the clip space minimum corner offset by scaled matrix columns
+  const glm::vec4 origin = m_viewProjection * glm::vec4(min, 1.0f);
+  const glm::vec4 size = glm::vec4(max - min, 0.0f);
+  const glm::vec4 axisX = m_viewProjection[0] * size.x;
+  const glm::vec4 axisY = m_viewProjection[1] * size.y;
+  const glm::vec4 axisZ = m_viewProjection[2] * size.z;
+
+  glm::vec3 ndcMin(std::numeric_limits<float>::max());
+  glm::vec3 ndcMax(std::numeric_limits<float>::lowest());
+  uint32_t nearCount = 0u;
+
+  for (uint32_t corner = 0; corner < 8u; ++corner) {
+    glm::vec4 clip = origin;
+    if (corner & 0b1u) clip += axisX;
+    if (corner & 0b10u) clip += axisY;
+    if (corner & 0b100u) clip += axisZ;
+
+    if (clip.w < minW) {
+      ++nearCount;
+      continue;
+    }
+
+    const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+    ndcMin = glm::min(ndcMin, ndc);
+    ndcMax = glm::max(ndcMax, ndc);
+  }
+
+  // boxes behind the camera are hidden, those crossing the near plane aren't
+  if (nearCount == 8u) return false;
+  if (nearCount > 0u) return true;
+
+  const float width = static_cast<float>(m_width);
+  const float height = static_cast<float>(m_height);
+  const float minX = (ndcMin.x * 0.5f + 0.5f) * width;
+  const float maxX = (ndcMax.x * 0.5f + 0.5f) * width;
+  const float minY = (ndcMin.y * 0.5f + 0.5f) * height;
+  const float maxY = (ndcMax.y * 0.5f + 0.5f) * height;
+
+  if (maxX < 0.0f || minX > width || maxY < 0.0f || minY > height || ndcMin.z > 1.0f) {
+    return false;
+  }
+
+  // every pixel touched by the projected box is tested
+  const int32_t firstX = std::max(static_cast<int32_t>(minX), 0);
+  const int32_t firstY = std::max(static_cast<int32_t>(minY), 0);
+  const int32_t lastX = std::min(static_cast<int32_t>(maxX), static_cast<int32_t>(m_width) - 1);
+  const int32_t lastY = std::min(static_cast<int32_t>(maxY), static_cast<int32_t>(m_height) - 1);
+  const float nearestDepth = ndcMin.z;
+
+  const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+  const __m256 depth = _mm256_set1_ps(nearestDepth);
+  const __m256 columnMin = _mm256_set1_ps(static_cast<float>(firstX));
+  const __m256 columnMax = _mm256_set1_ps(static_cast<float>(lastX));
+
+  for (int32_t tileY = firstY / static_cast<int32_t>(tileSize);
+       tileY <= lastY / static_cast<int32_t>(tileSize); ++tileY) {
+    const int32_t tileMinY = tileY * static_cast<int32_t>(tileSize);
+    const int32_t firstRow = std::max(firstY, tileMinY);
+    const int32_t lastRow = std::min(lastY, tileMinY + static_cast<int32_t>(tileSize) - 1);
+
+    for (int32_t tileX = firstX / static_cast<int32_t>(tileSize);
+         tileX <= lastX / static_cast<int32_t>(tileSize); ++tileX) {
+      const uint32_t tileIndex = tileY * m_tileCountX + tileX;
+
+      // every pixel of the tile is nearer than the box
+      if (nearestDepth > m_tileDepth[tileIndex]) continue;
+
+      const int32_t tileMinX = tileX * static_cast<int32_t>(tileSize);
+
+      if (firstX <= tileMinX && lastX >= tileMinX + static_cast<int32_t>(tileSize) - 1 &&
+          firstRow == tileMinY && lastRow == tileMinY + static_cast<int32_t>(tileSize) - 1) {
+        return true;
+      }
+
+      // partially covered tile, only pixels inside the box count
+      const __m256 columns = _mm256_add_ps(lanes, _mm256_set1_ps(static_cast<float>(tileMinX)));
+      const __m256 columnMask = _mm256_and_ps(_mm256_cmp_ps(columns, columnMin, _CMP_GE_OQ),
+                                              _mm256_cmp_ps(columns, columnMax, _CMP_LE_OQ));
+      const float* pTile = m_depth.data() + tileIndex * tileSize * tileSize;
+
+      for (int32_t row = firstRow; row <= lastRow; ++row) {
+        const __m256 rowDepth = _mm256_loadu_ps(pTile + (row - tileMinY) * tileSize);
+        const __m256 isFarther = _mm256_cmp_ps(rowDepth, depth, _CMP_GE_OQ);
+
+        if (_mm256_movemask_ps(_mm256_and_ps(isFarther, columnMask))) {
+          return true;
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+float ROcclusionCuller::getDepth(const uint32_t x, const uint32_t y) const {
+  if (x >= m_width || y >= m_height) return std::numeric_limits<float>::max();
+
+  const uint32_t tileIndex = (y / tileSize) * m_tileCountX + x / tileSize;
+
+  return m_depth[tileIndex * tileSize * tileSize + (y % tileSize) * tileSize + x % tileSize];
+}
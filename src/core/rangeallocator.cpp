@@ -0,0 +1,118 @@
+#include "pch.h"
+#include "core/rangeallocator.h"
+
+RRangeAllocator::RRangeAllocator(const uint32_t capacity) { reset(capacity); }
+
+void RRangeAllocator::insertFreeRange(const uint32_t offset,
+                                      const uint32_t size) {
+  m_freeByOffset.emplace(offset, size);
+  m_freeBySize.emplace(size, offset);
+}
+
+void RRangeAllocator::eraseFreeRange(
+    std::map<uint32_t, uint32_t>::iterator it) {
+  auto range = m_freeBySize.equal_range(it->second);
+
+  for (auto sizeIt = range.first; sizeIt != range.second; ++sizeIt) {
+    if (sizeIt->second == it->first) {
+      m_freeBySize.erase(sizeIt);
+      break;
+    }
+  }
+
+  m_freeByOffset.erase(it);
+}
+
+void RRangeAllocator::reset(const uint32_t capacity) {
+  m_freeByOffset.clear();
+  m_freeBySize.clear();
+  m_capacity = capacity;
+  m_allocated = 0u;
+
+  if (capacity > 0u) {
+    insertFreeRange(0u, capacity);
+  }
+}
+
+uint32_t RRangeAllocator::allocate(const uint32_t size) {
+  if (size == 0u) {
+    return invalidOffset;
+  }
+
+  // smallest free range that can hold the requested size
+  auto sizeIt = m_freeBySize.lower_bound(size);
+
+  if (sizeIt == m_freeBySize.end()) {
+    return invalidOffset;
+  }
+
+  const uint32_t offset = sizeIt->second;
+  const uint32_t rangeSize = sizeIt->first;
+
+  m_freeBySize.erase(sizeIt);
+  m_freeByOffset.erase(offset);
+
+  if (rangeSize > size) {
+    insertFreeRange(offset + size, rangeSize - size);
+  }
+
+  m_allocated += size;
+
+  return offset;
+}
+
+void RRangeAllocator::release(const uint32_t offset, const uint32_t size) {
+  if (size == 0u || offset == invalidOffset) {
+    return;
+  }
+
+#ifndef NDEBUG
+  if (offset + size > m_capacity || size > m_allocated) {
+    RE_LOG(Error, "Released range at %d of size %d is out of allocator bounds.",
+           offset, size);
+    return;
+  }
+#endif
+
+  uint32_t mergedOffset = offset;
+  uint32_t mergedSize = size;
+
+  // merge with the following free range
+  auto nextIt = m_freeByOffset.lower_bound(offset);
+
+  if (nextIt != m_freeByOffset.end() && nextIt->first == offset + size) {
+    mergedSize += nextIt->second;
+    eraseFreeRange(nextIt);
+  }
+
+  // merge with the preceding free range
+  auto previousIt = m_freeByOffset.lower_bound(offset);
+
+  if (previousIt != m_freeByOffset.begin()) {
+    --previousIt;
+
+    if (previousIt->first + previousIt->second == offset) {
+      mergedOffset = previousIt->first;
+      mergedSize += previousIt->second;
+      eraseFreeRange(previousIt);
+    }
+  }
+
+  insertFreeRange(mergedOffset, mergedSize);
+  m_allocated -= size;
+}
+
+uint32_t RRangeAllocator::getLargestFreeRange() const {
+  return m_freeBySize.empty() ? 0u : m_freeBySize.rbegin()->first;
+}
+
+float RRangeAllocator::getFragmentation() const {
+  const uint32_t freeSize = getFreeSize();
+
+  if (freeSize == 0u) {
+    return 0.0f;
+  }
+
+  return 1.0f - static_cast<float>(getLargestFreeRange()) /
+                    static_cast<float>(freeSize);
+}
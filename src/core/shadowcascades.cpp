@@ -0,0 +1,215 @@
+#include "pch.h"
+#include "core/shadowcascades.h"
+
+RShadowCascades::RShadowCascades() {
+  // distant cascades cover more of the view with fewer texels per unit
+  for (uint32_t i = 0; i < maxCascades; ++i) {
+    m_updateIntervals[i] = (i < 2u) ? 1u : 1u << (i - 1u);
+  }
+}
+
+void RShadowCascades::setup(const uint32_t cascadeCount, const uint32_t resolution) {
+  m_cascadeCount = std::min(cascadeCount, maxCascades);
+  m_resolution = std::max(resolution, 4u);
+
+  invalidate();
+  invalidateStaticCache();
+}
+
+void RShadowCascades::setSplitLambda(const float lambda) {
+  m_splitLambda = std::clamp(lambda, 0.0f, 1.0f);
+}
+
+void RShadowCascades::setUpdateInterval(const uint32_t cascadeIndex,
+                                        const uint32_t frameInterval) {
+  if (cascadeIndex >= maxCascades) return;
+
+  m_updateIntervals[cascadeIndex] = std::max(frameInterval, 1u);
+}
+
+void RShadowCascades::invalidate() {
+  for (uint32_t i = 0; i < maxCascades; ++i) {
+    m_states[i].isValid = false;
+    m_scheduled[i].isValid = false;
+  }
+}
+
+void RShadowCascades::invalidateStaticCache() {
+  for (uint32_t i = 0; i < maxCascades; ++i) {
+    m_states[i].isCacheValid = false;
+    m_scheduled[i].isCacheValid = false;
+  }
+}
+
+void RShadowCascades::fit(const glm::mat4& view, const glm::mat4& projection,
+                          const float nearPlane, const float shadowDistance,
+                          const glm::vec3& lightDirection) {
+  // small sun movement is ignored to keep cascades from being updated every frame
+  const glm::vec3 direction = glm::normalize(lightDirection);
+
+  if (glm::dot(direction, m_lightDirection) < lightDirectionTolerance) {
+    m_lightDirection = direction;
+  }
+
+  const glm::vec3 up = (fabsf(m_lightDirection.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f)
+                                                             : glm::vec3(0.0f, 1.0f, 0.0f);
+  const glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), m_lightDirection, up);
+  const glm::mat4 inverseView = glm::inverse(view);
+
+  const float nearDepth = std::max(nearPlane, 1e-4f);
+  const float farDepth = std::max(shadowDistance, nearDepth * 1.001f);
+  m_casterDistance = farDepth;
+
+  // view space position of a clip space corner at a view depth
+  auto getCorner = [&projection](const float clipX, const float clipY, const float depth) {
+    const float w = projection[2][3] * depth + projection[3][3];
+    return glm::vec3(
+        (clipX * w - projection[2][0] * depth - projection[3][0]) / projection[0][0],
+        (clipY * w - projection[2][1] * depth - projection[3][1]) / projection[1][1], depth);
+  };
+
+  float sliceNear = nearDepth;
+
+  for (uint32_t i = 0; i < m_cascadeCount; ++i) {
+    const float ratio = static_cast<float>(i + 1u) / m_cascadeCount;
+    const float logSplit = nearDepth * powf(farDepth / nearDepth, ratio);
+    const float uniformSplit = nearDepth + (farDepth - nearDepth) * ratio;
+    const float sliceFar = m_splitLambda * logSplit + (1.0f - m_splitLambda) * uniformSplit;
+
+    glm::vec3 corners[8];
+    glm::vec3 centroid = glm::vec3(0.0f);
+    uint32_t cornerIndex = 0u;
+
+    for (const float depth : {sliceNear, sliceFar}) {
+      for (const float clipY : {-1.0f, 1.0f}) {
+        for (const float clipX : {-1.0f, 1.0f}) {
+          corners[cornerIndex] = getCorner(clipX, clipY, depth);
+          centroid += corners[cornerIndex++];
+        }
+      }
+    }
+
+    centroid /= 8.0f;
+
+    // computed in view space, the radius stays the same when the view rotates
+    float coverRadius = 0.0f;
+
+    for (const glm::vec3& corner : corners) {
+      coverRadius = std::max(coverRadius, glm::length(corner - centroid));
+    }
+
+    // box is grown by a texel so snapping never uncovers the slice
+    const float margin = (m_updateIntervals[i] > 1u) ? 1.0f + scheduledMargin : 1.0f;
+    const float radius = coverRadius * margin * m_resolution / (m_resolution - 2u);
+    const float texelSize = 2.0f * radius / m_resolution;
+
+    RShadowCascade& cascade = m_fitted[i];
+    cascade.lightView = lightView;
+    cascade.worldCenter = glm::vec3(inverseView * glm::vec4(centroid, 1.0f));
+    cascade.center = glm::floor(glm::vec3(lightView * glm::vec4(cascade.worldCenter, 1.0f)) / texelSize) * texelSize;
+    cascade.radius = radius;
+    cascade.coverRadius = coverRadius;
+    cascade.nearZ = cascade.center.z - radius - m_casterDistance;
+    cascade.farZ = cascade.center.z + radius;
+    cascade.splitDepth = sliceFar;
+    cascade.viewProjection =
+        glm::ortho(cascade.center.x - radius, cascade.center.x + radius,
+                   cascade.center.y - radius, cascade.center.y + radius,
+                   cascade.nearZ, cascade.farZ) * lightView;
+
+    sliceNear = sliceFar;
+  }
+}
+
+bool RShadowCascades::intersects(const uint32_t cascadeIndex, const glm::vec3& min,
+                                 const glm::vec3& max) const {
+  const RShadowCascade& cascade = m_fitted[cascadeIndex];
+  const glm::mat3 rotation = glm::mat3(cascade.lightView);
+
+  // light space box enclosing the world space box
+  const glm::vec3 extent = (max - min) * 0.5f;
+  const glm::vec3 center = rotation * ((min + max) * 0.5f);
+  const glm::vec3 lightExtent = glm::abs(rotation[0]) * extent.x +
+                                glm::abs(rotation[1]) * extent.y +
+                                glm::abs(rotation[2]) * extent.z;
+
+  return fabsf(center.x - cascade.center.x) <= cascade.radius + lightExtent.x &&
+         fabsf(center.y - cascade.center.y) <= cascade.radius + lightExtent.y &&
+         center.z + lightExtent.z >= cascade.nearZ &&
+         center.z - lightExtent.z <= cascade.farZ;
+}
+
+bool RShadowCascades::covers(const RShadowCascade& rendered, const RShadowCascade& fitted) {
+  const glm::vec3 center = glm::vec3(rendered.lightView * glm::vec4(fitted.worldCenter, 1.0f));
+
+  return fabsf(center.x - rendered.center.x) + fitted.coverRadius <= rendered.radius &&
+         fabsf(center.y - rendered.center.y) + fitted.coverRadius <= rendered.radius &&
+         center.z - fitted.coverRadius >= rendered.center.z - rendered.radius &&
+         center.z + fitted.coverRadius <= rendered.farZ;
+}
+
+uint32_t RShadowCascades::schedule(const uint64_t* pCasterSignatures, const uint32_t dirtyMask) {
+  uint32_t updateMask = 0u;
+
+  for (uint32_t i = 0; i < m_cascadeCount; ++i) {
+    const RState& state = m_states[i];
+    const RShadowCascade& fitted = m_fitted[i];
+    RState& scheduled = m_scheduled[i];
+    scheduled = state;
+
+    // a view leaving the rendered box can't wait for the next scheduled update
+    const bool isForced = !state.isValid || !covers(state.rendered, fitted);
+    const bool isDirty = (dirtyMask & (1u << i)) ||
+                         pCasterSignatures[i] != state.casterSignature ||
+                         fitted.center != state.rendered.center ||
+                         fitted.radius != state.rendered.radius ||
+                         fitted.lightView != state.rendered.lightView;
+
+    // cascades sharing an interval are updated on different frames
+    const uint32_t interval = m_updateIntervals[i];
+    const bool isScheduled = (m_frame % interval) == (i % interval);
+
+    if (isForced || (isDirty && isScheduled)) {
+      scheduled.rendered = fitted;
+      scheduled.casterSignature = pCasterSignatures[i];
+      scheduled.isValid = true;
+      updateMask |= 1u << i;
+    }
+  }
+
+  ++m_frame;
+
+  return updateMask;
+}
+
+void RShadowCascades::commit(const uint32_t updateMask) {
+  for (uint32_t i = 0; i < m_cascadeCount; ++i) {
+    if (!(updateMask & (1u << i))) continue;
+
+    // static caches only change with their cascade update
+    m_states[i] = m_scheduled[i];
+  }
+}
+
+uint32_t RShadowCascades::scheduleStaticCache(const uint64_t* pStaticSignatures,
+                                              const uint32_t updateMask) {
+  uint32_t cacheMask = 0u;
+
+  for (uint32_t i = 0; i < m_cascadeCount; ++i) {
+    if (!(updateMask & (1u << i))) continue;
+
+    const RState& state = m_states[i];
+    RState& scheduled = m_scheduled[i];
+
+    // static casters are rendered with the box of the cascade update
+    if (!state.isCacheValid || pStaticSignatures[i] != state.staticSignature ||
+        scheduled.rendered.viewProjection != state.cachedViewProjection) {
+      scheduled.cachedViewProjection = scheduled.rendered.viewProjection;
+      scheduled.staticSignature = pStaticSignatures[i];
+      scheduled.isCacheValid = true;
+      cacheMask |= 1u << i;
+    }
+  }
+
+  return cacheMask;
+}
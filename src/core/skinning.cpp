@@ -0,0 +1,155 @@
+#include "pch.h"
+#include "core/objects.h"
+#include "core/skinning.h"
+#include "util/math.h"
+
+RSkinningScheduler::RSkinningScheduler(const uint32_t vertexCapacity) {
+  reset(vertexCapacity);
+}
+
+void RSkinningScheduler::reset(const uint32_t vertexCapacity) {
+  m_work.clear();
+  m_batches.clear();
+  m_dispatches.clear();
+  m_vertexCapacity = vertexCapacity;
+  m_vertexCount = 0u;
+  m_requestCount = 0u;
+}
+
+uint32_t RSkinningScheduler::schedule(const uint32_t pageIndex,
+                                      const uint32_t srcVertexOffset,
+                                      const uint32_t vertexCount,
+                                      const uint32_t skinIndex) {
+  if (vertexCount == 0u) {
+    return invalidOffset;
+  }
+
+  RWork work;
+  work.pageIndex = pageIndex;
+  work.srcVertexOffset = srcVertexOffset;
+  work.vertexCount = vertexCount;
+  work.skinIndex = skinIndex;
+
+  auto it = m_work.find(work);
+
+  if (it != m_work.end()) {
+    ++m_requestCount;
+    return it->dstVertexOffset;
+  }
+
+  if (vertexCount > m_vertexCapacity - m_vertexCount) {
+    return invalidOffset;
+  }
+
+  work.dstVertexOffset = m_vertexCount;
+  m_vertexCount += vertexCount;
+  ++m_requestCount;
+
+  m_work.emplace(work);
+
+  return work.dstVertexOffset;
+}
+
+void RSkinningScheduler::finalize() {
+  m_batches.clear();
+  m_dispatches.clear();
+
+  std::vector<RWork> work(m_work.begin(), m_work.end());
+
+  // a dispatch reads a single page, output order is kept within the page
+  std::sort(work.begin(), work.end(), [](const RWork& a, const RWork& b) {
+    return (a.pageIndex != b.pageIndex) ? a.pageIndex < b.pageIndex
+                                        : a.dstVertexOffset < b.dstVertexOffset;
+  });
+
+  m_batches.reserve(work.size() + m_vertexCount / batchSize);
+
+  for (const RWork& entry : work) {
+    if (m_dispatches.empty() || m_dispatches.back().pageIndex != entry.pageIndex) {
+      RSkinningDispatch& dispatch = m_dispatches.emplace_back();
+      dispatch.pageIndex = entry.pageIndex;
+      dispatch.firstBatch = static_cast<uint32_t>(m_batches.size());
+    }
+
+    for (uint32_t offset = 0u; offset < entry.vertexCount; offset += batchSize) {
+      RSkinningBatch& batch = m_batches.emplace_back();
+      batch.srcVertexOffset = entry.srcVertexOffset + offset;
+      batch.dstVertexOffset = entry.dstVertexOffset + offset;
+      batch.vertexCount = std::min(batchSize, entry.vertexCount - offset);
+      batch.skinIndex = entry.skinIndex;
+    }
+
+    m_dispatches.back().batchCount =
+        static_cast<uint32_t>(m_batches.size()) - m_dispatches.back().firstBatch;
+  }
+}
+
+void RSkinningScheduler::skinVertices(const RVertex* pVertices,
+                                      const uint32_t vertexCount,
+                                      const glm::mat4* pJointMatrices,
+                                      const glm::mat4* pPrevJointMatrices,
+                                      RSkinnedVertex* pOutVertices) {
+  // tangents are skinned as directions (w is 0.0) after the positions of the
+  // same chunk, their normals are unused
+  glm::vec4 positions[batchSize * 2];
+  glm::vec4 normals[batchSize * 2] = {};
+  uint32_t joints[batchSize * 2];
+  glm::vec4 weights[batchSize * 2];
+  glm::vec4 outPositions[batchSize * 2];
+  glm::vec4 outNormals[batchSize * 2];
+  glm::vec4 prevPositions[batchSize];
+  glm::vec4 prevNormals[batchSize];
+
+  for (uint32_t first = 0u; first < vertexCount; first += batchSize) {
+    const uint32_t count = std::min(batchSize, vertexCount - first);
+
+    for (uint32_t i = 0; i < count; ++i) {
+      const RVertex& vertex = pVertices[first + i];
+
+      positions[i] = glm::vec4(vertex.pos, 1.0f);
+      positions[count + i] = glm::vec4(glm::vec3(vertex.tangent), 0.0f);
+      normals[i] = glm::vec4(vertex.normal, 0.0f);
+      joints[i] = static_cast<uint32_t>(vertex.joint.x) |
+                  static_cast<uint32_t>(vertex.joint.y) << 8 |
+                  static_cast<uint32_t>(vertex.joint.z) << 16 |
+                  static_cast<uint32_t>(vertex.joint.w) << 24;
+      joints[count + i] = joints[i];
+      weights[i] = vertex.weight;
+      weights[count + i] = vertex.weight;
+    }
+
+    math::skinVertices(pJointMatrices, positions, normals, joints, weights, count * 2u,
+                       outPositions, outNormals);
+    math::skinVertices(pPrevJointMatrices, positions, normals, joints, weights, count,
+                       prevPositions, prevNormals);
+
+    for (uint32_t i = 0; i < count; ++i) {
+      RSkinnedVertex& outVertex = pOutVertices[first + i];
+
+      outVertex.position = outPositions[i];
+      outVertex.prevPosition = prevPositions[i];
+      outVertex.normal = outNormals[i];
+      outVertex.tangent = glm::vec4(glm::vec3(outPositions[count + i]),
+                                    pVertices[first + i].tangent.w);
+    }
+  }
+}
+
+void RSkinningScheduler::execute(const RVertex* const* pPageVertices,
+                                 const uint8_t* pSkinBlocks,
+                                 const size_t skinBlockSize,
+                                 RSkinnedVertex* pOutVertices) const {
+  for (const RSkinningDispatch& dispatch : m_dispatches) {
+    const RVertex* pVertices = pPageVertices[dispatch.pageIndex];
+
+    for (uint32_t i = 0; i < dispatch.batchCount; ++i) {
+      const RSkinningBatch& batch = m_batches[dispatch.firstBatch + i];
+      const glm::mat4* pJointMatrices = reinterpret_cast<const glm::mat4*>(
+          pSkinBlocks + skinBlockSize * batch.skinIndex);
+
+      skinVertices(pVertices + batch.srcVertexOffset, batch.vertexCount,
+                   pJointMatrices, pJointMatrices + RE_MAXJOINTS,
+                   pOutVertices + batch.dstVertexOffset);
+    }
+  }
+}
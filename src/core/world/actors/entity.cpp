@@ -1,8 +1,11 @@
 #include "pch.h"
+#include "util/math.h"
 #include "core/core.h"
 #include "core/managers/animations.h"
+#include "core/managers/jobs.h"
 #include "core/managers/renderer.h"
 #include "core/model/model.h"
+#include "core/occlusion.h"
 #include "core/world/actors/entity.h"
 
 AEntity::AnimatedSkinBinding* AEntity::getAnimatedSkinBinding(const int32_t skinIndex) {
@@ -14,15 +17,30 @@ AEntity::AnimatedSkinBinding* AEntity::getAnimatedSkinBinding(const int32_t skin
 }
 
 AEntity::AnimatedNodeBinding* AEntity::getAnimatedNodeBinding(const int32_t nodeIndex) {
-  for (auto& node : m_animatedNodes) {
-    if (node.nodeIndex == nodeIndex) return &node;
+  return getAnimatedNodeBindingAt(getAnimatedNodeSlot(nodeIndex));
+}
+
+AEntity::AnimatedNodeBinding* AEntity::getAnimatedNodeBindingAt(const int32_t slot) {
+  if (slot > -1 && static_cast<size_t>(slot) < m_animatedNodes.size()) {
+    return &m_animatedNodes[static_cast<size_t>(slot)];
   }
 
   return nullptr;
 }
 
+int32_t AEntity::getAnimatedNodeSlot(const int32_t nodeIndex) const {
+  if (nodeIndex > -1 && static_cast<size_t>(nodeIndex) < m_nodeBindingSlots.size()) {
+    return m_nodeBindingSlots[static_cast<size_t>(nodeIndex)];
+  }
+
+  return -1;
+}
+
 void AEntity::updateTransformBuffers() noexcept {
   for (auto& skin : m_animatedSkins) {
+    // shared palette is written once by the animations manager
+    if (skin.pSharedSkin) continue;
+
     int8_t* pSkinMemoryAddress = static_cast<int8_t*>(core::renderer.getSceneBuffers()
       ->skinTransformBuffer.allocInfo.pMappedData) + skin.skinTransformBufferOffset;
 
@@ -56,6 +74,45 @@ void AEntity::updateTransformBuffers() noexcept {
   }
 }
 
+void AEntity::setSharedSkin(const int32_t skinIndex,
+                            const AnimatedSkinBinding* pSharedSkin) {
+  AnimatedSkinBinding* pSkin = getAnimatedSkinBinding(skinIndex);
+
+  if (!pSkin || pSkin->pSharedSkin == pSharedSkin) {
+    return;
+  }
+
+  // own palette continues from the last shared pose, which is also written
+  // to the buffer so the next update makes it the previous pose
+  if (!pSharedSkin) {
+    pSkin->transformBufferBlock.jointMatrices =
+        pSkin->pSharedSkin->transformBufferBlock.jointMatrices;
+
+    int8_t* pSkinMemoryAddress = static_cast<int8_t*>(core::renderer.getSceneBuffers()
+      ->skinTransformBuffer.allocInfo.pMappedData) + pSkin->skinTransformBufferOffset;
+
+    memcpy(pSkinMemoryAddress, pSkin->transformBufferBlock.jointMatrices.data(),
+           sizeof(glm::mat4) * pSkin->transformBufferBlock.jointMatrices.size());
+  }
+
+  pSkin->pSharedSkin = pSharedSkin;
+
+  if (m_instanceIndex == -1) {
+    return;
+  }
+
+  const uint32_t skinMatrixId = (pSharedSkin) ? pSharedSkin->skinTransformBufferIndex
+                                              : pSkin->skinTransformBufferIndex;
+
+  for (WPrimitive* pPrimitive : m_pModel->m_pLinearPrimitives) {
+    const WModel::Node* pNode = reinterpret_cast<WModel::Node*>(pPrimitive->pOwnerNode);
+
+    if (pNode->skinIndex == skinIndex && m_instanceIndex < pPrimitive->instanceData.size()) {
+      pPrimitive->instanceData[m_instanceIndex].instanceBufferBlock.skinMatrixId = skinMatrixId;
+    }
+  }
+}
+
 void AEntity::setModel(WModel* pModel) {
   if (!pModel) {
     RE_LOG(Error, "Failed to set model for actor '%s', received nullptr.",
@@ -69,6 +126,15 @@ void AEntity::setModel(WModel* pModel) {
 
   std::vector<WModel::Node*>& pNodes = m_pModel->getAllNodes();
 
+  // Node indices are dense, a table is faster than searching bindings
+  int32_t maxNodeIndex = -1;
+
+  for (const auto& pNode : pNodes) {
+    maxNodeIndex = std::max(maxNodeIndex, pNode->index);
+  }
+
+  m_nodeBindingSlots.assign(static_cast<size_t>(maxNodeIndex + 1), -1);
+
   // Create skin list
   const size_t skinCount = pModel->m_pSkins.size();
   m_animatedSkins.resize(skinCount);
@@ -77,6 +143,7 @@ void AEntity::setModel(WModel* pModel) {
     // Skins should be stored sequentially in the model, but this index check is here just in case they aren't
     const int32_t modelSkinIndex = pModel->m_pSkins[skinIndex]->index;
     m_animatedSkins[modelSkinIndex].skinIndex = pModel->m_pSkins[skinIndex]->index;
+    m_animatedSkins[modelSkinIndex].pSharedSkin = nullptr;
     m_animatedSkins[modelSkinIndex].transformBufferBlock.jointMatrices.resize(pModel->m_pSkins[skinIndex]->joints.size());
 
     // Set all matrices to identity to avoid NaN results in case no animation will be set
@@ -88,6 +155,7 @@ void AEntity::setModel(WModel* pModel) {
   // Create node list for all animated nodes
   for (auto& pNode : pNodes) {
     if (pNode->pMesh) {
+      m_nodeBindingSlots[static_cast<size_t>(pNode->index)] = static_cast<int32_t>(m_animatedNodes.size());
       m_animatedNodes.emplace_back();
       m_animatedNodes.back().nodeIndex = pNode->index;
 
@@ -102,7 +170,7 @@ void AEntity::setModel(WModel* pModel) {
 
 WModel* AEntity::getModel() { return m_pModel; }
 
-void AEntity::updateModel() {
+void AEntity::updateModel(const float interpolation) {
   if (m_pModel && m_bindIndex != -1) {
     glm::mat4* pMemAddress = static_cast<glm::mat4*>(core::renderer.getSceneBuffers()
                              ->rootTransformBuffer.allocInfo.pMappedData) + m_rootTransformBufferIndex * 2;
@@ -111,13 +179,109 @@ void AEntity::updateModel() {
     // Copy previous frame transform
     memcpy(pPreviousDataAddress, pMemAddress, sizeof(glm::mat4));
 
-    const glm::mat4* pMatrix = &getRootTransformationMatrix(); 
-    memcpy(pMemAddress, pMatrix, sizeof(glm::mat4));
+    // transformation history, the matrix update below clears the status
+    const bool isMoving = wasUpdated() ||
+                          m_tickTransforms[0].translation != m_tickTransforms[1].translation ||
+                          m_tickTransforms[0].rotation != m_tickTransforms[1].rotation ||
+                          m_tickTransforms[0].scaling != m_tickTransforms[1].scaling;
+
+    if (isMoving) {
+      m_unchangedFrameCount = 0u;
+    } else if (m_unchangedFrameCount < std::numeric_limits<uint32_t>::max()) {
+      ++m_unchangedFrameCount;
+    }
+
+    // also updates attachments
+    const glm::mat4* pMatrix = &getRootTransformationMatrix();
+
+    if (interpolation >= 1.0f || m_storedTickCount < 2u) {
+      m_modelMatrix = *pMatrix;
+      memcpy(pMemAddress, pMatrix, sizeof(glm::mat4));
+      updateTransformBuffers();
+      updateBounds(*pMatrix);
+      return;
+    }
+
+    const auto& previous = m_tickTransforms[0];
+    const auto& latest = m_tickTransforms[1];
+    const glm::vec3 translation = glm::mix(previous.translation, latest.translation, interpolation);
+
+    // Scale Rotation Translation (SRT) order
+    glm::mat4 modelMatrix = glm::scale(glm::mix(previous.scaling, latest.scaling, interpolation)) *
+                            glm::mat4_cast(glm::slerp(previous.rotation, latest.rotation, interpolation));
+    copyVec3ToMatrix(&translation.x, &modelMatrix[3][0]);
+    m_modelMatrix = modelMatrix;
+    memcpy(pMemAddress, &modelMatrix, sizeof(glm::mat4));
 
     updateTransformBuffers();
+    updateBounds(modelMatrix);
   }
 }
 
+void AEntity::updateBounds(const glm::mat4& modelMatrix) noexcept {
+  glm::vec4 min(std::numeric_limits<float>::max());
+  glm::vec4 max(std::numeric_limits<float>::lowest());
+
+  for (WModel::Node* pNode : m_pModel->m_pLinearNodes) {
+    const AnimatedNodeBinding* pNodeBinding =
+        (pNode->pMesh) ? getAnimatedNodeBindingAt(m_nodeBindingSlots[static_cast<size_t>(pNode->index)]) : nullptr;
+
+    if (!pNodeBinding) continue;
+
+    glm::vec4 nodeMin(std::numeric_limits<float>::max());
+    glm::vec4 nodeMax(std::numeric_limits<float>::lowest());
+
+    const AnimatedSkinBinding* pSkinBinding = pNodeBinding->pSkinBinding;
+
+    if (pSkinBinding && pNode->pSkin && !pNode->pSkin->jointBounds.jointIndices.empty()) {
+      if (pSkinBinding->pSharedSkin) {
+        pSkinBinding = pSkinBinding->pSharedSkin;
+      }
+
+      const auto& jointMatrices = pSkinBinding->transformBufferBlock.jointMatrices;
+      const auto& jointBounds = pNode->pSkin->jointBounds;
+
+      math::expandSkinnedBounds(jointMatrices.data(), static_cast<uint32_t>(jointMatrices.size()),
+                                jointBounds.centers.data(), jointBounds.extents.data(),
+                                jointBounds.jointIndices.data(), jointBounds.jointIndices.size(),
+                                nodeMin, nodeMax);
+    } else if (pNode->pMesh->extent.isValid) {
+      nodeMin = glm::vec4(pNode->pMesh->extent.min, 1.0f);
+      nodeMax = glm::vec4(pNode->pMesh->extent.max, 1.0f);
+    }
+
+    if (nodeMin.x > nodeMax.x) continue;
+
+    math::expandBounds(modelMatrix * pNodeBinding->transformBufferBlock.nodeMatrix,
+                       (nodeMin + nodeMax) * 0.5f, (nodeMax - nodeMin) * 0.5f, min, max);
+  }
+
+  m_bounds.isValid = (min.x <= max.x);
+  m_bounds.min = glm::vec3(min);
+  m_bounds.max = glm::vec3(max);
+}
+
+bool AEntity::getBoundingBox(glm::vec3& outMin, glm::vec3& outMax) const {
+  if (m_bounds.isValid) {
+    outMin = m_bounds.min;
+    outMax = m_bounds.max;
+  }
+
+  return m_bounds.isValid;
+}
+
+void AEntity::storeTickTransform(const float weight) {
+  m_tickTransforms[0] = m_tickTransforms[1];
+
+  auto& latest = m_tickTransforms[1];
+  const float tickWeight = (m_storedTickCount == 0u) ? 1.0f : weight;
+
+  latest.translation = glm::mix(latest.translation, m_transformationData.translation, tickWeight);
+  latest.rotation = glm::slerp(latest.rotation, m_transformationData.rotation, tickWeight);
+  latest.scaling = glm::mix(latest.scaling, m_transformationData.scaling, tickWeight);
+  m_storedTickCount = std::min(m_storedTickCount + 1u, 2u);
+}
+
 void AEntity::bindToRenderer() {
   if (m_bindIndex > -1) {
     RE_LOG(Warning, "Entity \"%s\" is already bound to renderer.",
@@ -177,10 +341,8 @@ uint32_t AEntity::getRootTransformBufferOffset() {
 }
 
 uint32_t AEntity::getNodeTransformBufferIndex(int32_t nodeIndex) {
-  for (const auto& it : m_animatedNodes) {
-    if (it.nodeIndex == nodeIndex) {
-      return it.nodeTransformBufferIndex;
-    }
+  if (const AnimatedNodeBinding* pBinding = getAnimatedNodeBinding(nodeIndex)) {
+    return pBinding->nodeTransformBufferIndex;
   }
 
   RE_LOG(Warning, "Requested node '%d' is missing for actor '%s'.", nodeIndex,
@@ -190,10 +352,8 @@ uint32_t AEntity::getNodeTransformBufferIndex(int32_t nodeIndex) {
 }
 
 uint32_t AEntity::getNodeTransformBufferOffset(int32_t nodeIndex) {
-  for (const auto& it : m_animatedNodes) {
-    if (it.nodeIndex == nodeIndex) {
-      return it.nodeTransformBufferOffset;
-    }
+  if (const AnimatedNodeBinding* pBinding = getAnimatedNodeBinding(nodeIndex)) {
+    return pBinding->nodeTransformBufferOffset;
   }
 
   RE_LOG(Warning, "Requested node '%d' is missing for actor '%s'.", nodeIndex,
@@ -291,3 +451,116 @@ void AEntity::playAnimation(const WAnimationInfo* pAnimationInfo) {
   //  }
   //}
 }
+
+uint32_t AEntity::skinPrimitives(std::vector<SkinnedPrimitive>& outPrimitives) {
+  outPrimitives.clear();
+
+  if (!m_pModel) return 0u;
+
+  RE_PROFILE_SCOPE("AEntity::skinPrimitives");
+
+  // node and joint matrices are combined into a palette per skinned node
+  struct RSkinningWork {
+    uint32_t paletteIndex = 0u;
+    SkinnedPrimitive* pOutput = nullptr;
+  };
+
+  std::vector<glm::mat4> palettes;
+  std::vector<RSkinningWork> work;
+  uint32_t vertexCount = 0u;
+
+  for (WModel::Node* pNode : m_pModel->m_pLinearNodes) {
+    const AnimatedNodeBinding* pNodeBinding =
+        (pNode->pMesh) ? getAnimatedNodeBindingAt(m_nodeBindingSlots[static_cast<size_t>(pNode->index)]) : nullptr;
+
+    if (!pNodeBinding || !pNodeBinding->pSkinBinding) continue;
+
+    const AnimatedSkinBinding* pSkinBinding = pNodeBinding->pSkinBinding;
+
+    if (pSkinBinding->pSharedSkin) {
+      pSkinBinding = pSkinBinding->pSharedSkin;
+    }
+
+    const glm::mat4& nodeMatrix = pNodeBinding->transformBufferBlock.nodeMatrix;
+    const auto& jointMatrices = pSkinBinding->transformBufferBlock.jointMatrices;
+    const uint32_t jointCount =
+        std::min(static_cast<uint32_t>(jointMatrices.size()), RE_MAXJOINTS);
+    const uint32_t paletteIndex = static_cast<uint32_t>(palettes.size());
+
+    // missing joints keep vertices in node space like an identity joint
+    palettes.resize(palettes.size() + RE_MAXJOINTS, nodeMatrix);
+
+    for (uint32_t i = 0; i < jointCount; ++i) {
+      palettes[paletteIndex + i] = nodeMatrix * jointMatrices[i];
+    }
+
+    for (auto& pPrimitive : pNode->pMesh->pPrimitives) {
+      if (pPrimitive->skinningStreams.positions.empty()) continue;
+
+      work.push_back({paletteIndex, nullptr});
+      outPrimitives.emplace_back().pPrimitive = pPrimitive.get();
+      vertexCount += static_cast<uint32_t>(pPrimitive->skinningStreams.positions.size());
+    }
+  }
+
+  for (uint32_t i = 0; i < work.size(); ++i) {
+    work[i].pOutput = &outPrimitives[i];
+  }
+
+  // largest primitives first so the last jobs are the short ones
+  std::sort(work.begin(), work.end(), [](const RSkinningWork& a, const RSkinningWork& b) {
+    return a.pOutput->pPrimitive->vertexCount > b.pOutput->pPrimitive->vertexCount;
+  });
+
+  core::jobs.parallelFor(
+      static_cast<uint32_t>(work.size()), 1u,
+      [&work, &palettes](const uint32_t begin, const uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+          SkinnedPrimitive& output = *work[i].pOutput;
+          const auto& streams = output.pPrimitive->skinningStreams;
+          const uint32_t count = static_cast<uint32_t>(streams.positions.size());
+
+          output.positions.resize(count);
+          output.normals.resize(count);
+
+          math::skinVertices(&palettes[work[i].paletteIndex], streams.positions.data(),
+                             streams.normals.data(), streams.joints.data(),
+                             streams.weights.data(), count, output.positions.data(),
+                             output.normals.data());
+        }
+      });
+
+  return vertexCount;
+}
+
+void AEntity::addOccluders(ROcclusionCuller& culler) {
+  if (!m_pModel) return;
+
+  for (WModel::Node* pNode : m_pModel->m_pLinearNodes) {
+    if (!pNode->pMesh || pNode->pMesh->occluder.indices.empty()) continue;
+
+    const AnimatedNodeBinding* pNodeBinding =
+        getAnimatedNodeBindingAt(m_nodeBindingSlots[static_cast<size_t>(pNode->index)]);
+
+    if (!pNodeBinding) continue;
+
+    const auto& occluder = pNode->pMesh->occluder;
+
+    culler.addOccluder(m_modelMatrix * pNodeBinding->transformBufferBlock.nodeMatrix,
+                       occluder.positions.data(),
+                       static_cast<uint32_t>(occluder.positions.size()),
+                       occluder.indices.data(),
+                       static_cast<uint32_t>(occluder.indices.size()));
+  }
+}
+
+bool AEntity::getRenderedNodeMatrix(const int32_t nodeIndex, glm::mat4& outMatrix) const {
+  const int32_t slot = getAnimatedNodeSlot(nodeIndex);
+
+  if (slot < 0 || static_cast<size_t>(slot) >= m_animatedNodes.size()) {
+    return false;
+  }
+
+  outMatrix = m_modelMatrix * m_animatedNodes[static_cast<size_t>(slot)].transformBufferBlock.nodeMatrix;
+  return true;
+}
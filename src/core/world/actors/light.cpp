@@ -19,6 +19,10 @@ void ALight::setLightProperties(const glm::vec4& newProperties) {
   m_lightProperties = newProperties;
 }
 
+void ALight::setLightRadius(float newRadius) {
+  m_lightRadius = std::max(newRadius, 0.0f);
+}
+
 const glm::vec4& ALight::getLightProperties() { return m_lightProperties; }
 
 const glm::vec3 ALight::getLightColor() {
@@ -27,6 +31,8 @@ const glm::vec3 ALight::getLightColor() {
 
 const float ALight::getLightIntensity() { return m_lightProperties.a; }
 
+const float ALight::getLightRadius() { return m_lightRadius; }
+
 void ALight::setAsShadowCaster(const bool isShadowCaster) {
   m_isShadowCaster = isShadowCaster;
 }
@@ -1,8 +1,43 @@
 #include "pch.h"
+#include "config.h"
 #include "core/core.h"
+#include "core/managers/benchmark.h"
+#include "tests/tests.h"
+#include "util/util.h"
 
-int wmain()
+int wmain(int argc, wchar_t* argv[])
 {
+  // [-test] [-headless] [-jobs <workers>] [-benchmark <script.json> [-report <report.json>]]
+  const wchar_t* benchmarkPath = nullptr;
+  std::string reportPath;
+  bool bRunTests = false;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::wcscmp(argv[i], L"-test") == 0) {
+      bRunTests = true;
+    } else if (std::wcscmp(argv[i], L"-headless") == 0) {
+      config::bHeadless = true;
+    } else if (std::wcscmp(argv[i], L"-jobs") == 0 && i + 1 < argc) {
+      config::jobWorkers = static_cast<uint32_t>(std::wcstoul(argv[++i], nullptr, 10));
+    } else if (std::wcscmp(argv[i], L"-benchmark") == 0 && i + 1 < argc) {
+      benchmarkPath = argv[++i];
+    } else if (std::wcscmp(argv[i], L"-report") == 0 && i + 1 < argc) {
+      reportPath = util::toString(argv[++i]);
+    }
+  }
+
+  // runs engine system tests instead of the application
+  if (bRunTests) {
+    return (tests::run() == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  // a benchmark without its script would never finish
+  if (benchmarkPath &&
+      core::benchmark.loadScript(benchmarkPath, reportPath.empty() ? nullptr : reportPath.c_str()) != RE_OK) {
+    std::cerr << "Failed to load benchmark script.\n";
+    return EXIT_FAILURE;
+  }
+
 	// run application
   try {
     core::run();
@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/framestatistics.h"
+#include "tests/tests.h"
+
+void tests::testFrameStatistics(RTestContext& context) {
+  context.begin("Frame statistics");
+
+  // 100 frames of 10 ms with four slow ones
+  RFrameStatistics statistics(100u);
+  statistics.setHitchThreshold(2.0f, 8.0f);
+  statistics.setHistogramBucketWidth(2.0f);
+
+  for (uint32_t frame = 0; frame < 100u; ++frame) {
+    float frameTime = 10.0f;
+
+    switch (frame) {
+      case 10u: frameTime = 30.0f; break;
+      case 20u: frameTime = 40.0f; break;
+      case 30u: frameTime = 25.0f; break;
+      case 40u: frameTime = 40.0f; break;
+    }
+
+    statistics.addFrame(frameTime);
+  }
+
+  RFrameStatistics::RSummary summary = statistics.getSummary();
+
+  RE_CHECK(context, summary.frameCount == 100u);
+  RE_CHECK(context, std::abs(summary.averageTime - 10.95f) < 0.001f);
+  RE_CHECK(context, summary.minTime == 10.0f);
+  RE_CHECK(context, summary.p50Time == 10.0f);
+  RE_CHECK(context, summary.p95Time == 10.0f);
+  RE_CHECK(context, summary.p99Time == 40.0f);
+
+  // earliest of equally slow frames, hitches are slower than twice the median
+  RE_CHECK(context, summary.worstTime == 40.0f);
+  RE_CHECK(context, summary.worstFrame == 20u);
+  RE_CHECK(context, summary.hitchTime == 20.0f);
+  RE_CHECK(context, summary.hitchCount == 4u);
+
+  RE_CHECK(context, summary.histogram[5] == 96u);
+  RE_CHECK(context, summary.histogram[12] == 1u);
+  RE_CHECK(context, summary.histogram[15] == 1u);
+  RE_CHECK(context, summary.histogram[20] == 2u);
+
+  // window keeps the latest frames, frame indices count from the reset,
+  // slow frames past the last bucket land in it
+  statistics.setWindowSize(10u);
+
+  for (uint32_t frame = 0; frame < 15u; ++frame) {
+    statistics.addFrame((frame == 3u || frame == 12u) ? 100.0f : 4.0f);
+  }
+
+  summary = statistics.getSummary();
+
+  RE_CHECK(context, statistics.getSampleCount() == 10u);
+  RE_CHECK(context, summary.worstFrame == 12u);
+  RE_CHECK(context, summary.histogram[RFrameStatistics::histogramBucketCount - 1] == 1u);
+  RE_CHECK(context, summary.histogram[2] == 9u);
+
+  // fast frames under the minimum hitch time are not hitches
+  RE_CHECK(context, summary.hitchTime == 8.0f);
+  RE_CHECK(context, summary.hitchCount == 1u);
+
+  statistics.reset();
+  RE_CHECK(context, statistics.getSummary().frameCount == 0u);
+}
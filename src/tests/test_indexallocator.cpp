@@ -0,0 +1,55 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/indexallocator.h"
+#include "tests/tests.h"
+
+void tests::testIndexAllocator(RTestContext& context) {
+  context.begin("Index allocator");
+
+  // capacity spans more than one word of used bits
+  constexpr uint32_t capacity = 130u;
+  RIndexAllocator allocator(capacity);
+
+  // indices are handed out lowest first
+  bool isInOrder = true;
+
+  for (uint32_t i = 0; i < capacity; ++i) {
+    isInOrder &= (allocator.allocate() == i);
+  }
+
+  RE_CHECK(context, isInOrder);
+  RE_CHECK(context, allocator.getAllocatedCount() == capacity);
+  RE_CHECK(context, allocator.isAllocated(0u) && allocator.isAllocated(129u));
+
+  // exhausted allocator keeps failing until something is released
+  RE_CHECK(context, allocator.allocate() == RIndexAllocator::invalidIndex);
+  RE_CHECK(context, allocator.allocate() == RIndexAllocator::invalidIndex);
+
+  // released indices are reused, the latest one first
+  RE_CHECK(context, allocator.release(64u));
+  RE_CHECK(context, allocator.release(3u));
+  RE_CHECK(context, !allocator.isAllocated(64u) && !allocator.isAllocated(3u));
+  RE_CHECK(context, allocator.getAllocatedCount() == capacity - 2u);
+
+  RE_CHECK(context, allocator.allocate() == 3u);
+  RE_CHECK(context, allocator.allocate() == 64u);
+  RE_CHECK(context, allocator.allocate() == RIndexAllocator::invalidIndex);
+
+  // double and out of range releases are rejected without changing counts
+  RE_CHECK(context, allocator.release(10u));
+  RE_CHECK(context, !allocator.release(10u));
+  RE_CHECK(context, !allocator.release(capacity));
+  RE_CHECK(context, !allocator.release(RIndexAllocator::invalidIndex));
+  RE_CHECK(context, allocator.getAllocatedCount() == capacity - 1u);
+  RE_CHECK(context, !allocator.isAllocated(capacity));
+
+  // reset frees everything
+  allocator.reset(4u);
+  RE_CHECK(context, allocator.getAllocatedCount() == 0u);
+  RE_CHECK(context, allocator.getCapacity() == 4u);
+  RE_CHECK(context, allocator.allocate() == 0u);
+
+  // empty allocator has nothing to give
+  RIndexAllocator emptyAllocator;
+  RE_CHECK(context, emptyAllocator.allocate() == RIndexAllocator::invalidIndex);
+}
@@ -0,0 +1,126 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/managers/jobs.h"
+#include "tests/tests.h"
+
+void tests::testJobs(RTestContext& context) {
+  context.begin("Jobs");
+
+  // jobs run in place until the system is initialized
+  {
+    RJobCounter counter;
+    bool hasRun = false;
+    core::jobs.run([&hasRun]() { hasRun = true; }, &counter);
+
+    RE_CHECK(context, hasRun);
+    RE_CHECK(context, counter.isDone());
+  }
+
+  core::jobs.initialize(3u);
+  RE_CHECK(context, core::jobs.getWorkerCount() == 3u);
+
+  // every queued job runs exactly once
+  {
+    constexpr uint32_t jobCount = 4096u;
+    std::atomic<uint32_t> sum = 0u;
+    RJobCounter counter;
+
+    for (uint32_t i = 0; i < jobCount; ++i) {
+      core::jobs.run([&sum, i]() { sum.fetch_add(i + 1u); }, &counter);
+    }
+
+    core::jobs.wait(&counter);
+
+    RE_CHECK(context, counter.isDone());
+    RE_CHECK(context, sum.load() == jobCount * (jobCount + 1u) / 2u);
+  }
+
+  // jobs queued by jobs are waited for through the same counter
+  {
+    constexpr uint32_t jobCount = 64u;
+    std::atomic<uint32_t> finishedCount = 0u;
+    RJobCounter counter;
+
+    for (uint32_t i = 0; i < jobCount; ++i) {
+      core::jobs.run(
+          [&finishedCount, &counter]() {
+            core::jobs.run([&finishedCount]() { finishedCount.fetch_add(1u); },
+                           &counter);
+            finishedCount.fetch_add(1u);
+          },
+          &counter);
+    }
+
+    core::jobs.wait(&counter);
+
+    RE_CHECK(context, finishedCount.load() == jobCount * 2u);
+  }
+
+  // dependent jobs start after all jobs of their dependency have finished
+  {
+    constexpr uint32_t jobCount = 16u;
+    std::atomic<uint32_t> finishedCount = 0u;
+    uint32_t observedCount = 0u;
+    RJobCounter firstCounter;
+    RJobCounter secondCounter;
+
+    for (uint32_t i = 0; i < jobCount; ++i) {
+      core::jobs.run(
+          [&finishedCount]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            finishedCount.fetch_add(1u);
+          },
+          &firstCounter);
+    }
+
+    core::jobs.run([&finishedCount, &observedCount]() {
+      observedCount = finishedCount.load();
+    }, &secondCounter, &firstCounter);
+
+    core::jobs.wait(&secondCounter);
+
+    RE_CHECK(context, observedCount == jobCount);
+    RE_CHECK(context, firstCounter.isDone());
+  }
+
+  // waiting thread sleeps while the only job runs on a worker
+  {
+    std::atomic<bool> hasFinished = false;
+    RJobCounter counter;
+
+    core::jobs.run(
+        [&hasFinished]() {
+          std::this_thread::sleep_for(std::chrono::milliseconds(20));
+          hasFinished = true;
+        },
+        &counter);
+
+    core::jobs.wait(&counter);
+
+    RE_CHECK(context, hasFinished.load());
+  }
+
+  // every index is visited once, with automatic and explicit batch sizes
+  for (const uint32_t batchSize : {0u, 1u, 7u, 100000u}) {
+    constexpr uint32_t count = 10000u;
+    std::vector<std::atomic<uint32_t>> visits(count);
+
+    core::jobs.parallelFor(count, batchSize,
+                           [&visits](const uint32_t begin, const uint32_t end) {
+                             for (uint32_t i = begin; i < end; ++i) {
+                               visits[i].fetch_add(1u);
+                             }
+                           });
+
+    bool isVisitedOnce = true;
+
+    for (const auto& visit : visits) {
+      isVisitedOnce &= (visit.load() == 1u);
+    }
+
+    RE_CHECK(context, isVisitedOnce);
+  }
+
+  core::jobs.deinitialize();
+  RE_CHECK(context, core::jobs.getWorkerCount() == 0u);
+}
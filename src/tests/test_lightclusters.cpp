@@ -0,0 +1,101 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/objects.h"
+#include "core/lightclusters.h"
+#include "tests/tests.h"
+
+namespace {
+void build(RLightClusters& clusters, const glm::mat4& projection,
+           const std::vector<RPointLight>& lights, const uint32_t indexCapacity) {
+  clusters.prepare(glm::mat4(1.0f), projection, 0.1f, 100.0f, lights.data(),
+                   static_cast<uint32_t>(lights.size()));
+
+  for (uint32_t slice = 0; slice < RLightClusters::gridZ; ++slice) {
+    clusters.buildSlice(slice);
+  }
+
+  clusters.finalize(indexCapacity);
+}
+
+// cluster of a view space position, same as the shader lookup
+const RLightCluster& getCluster(const RLightClusters& clusters, const glm::mat4& projection,
+                                const glm::vec3& position) {
+  const glm::vec4 clipPosition = projection * glm::vec4(position, 1.0f);
+  const glm::vec2 ndc = glm::vec2(clipPosition) / clipPosition.w;
+  const glm::vec2 sliceScaleAndBias = clusters.getSliceScaleAndBias();
+
+  const uint32_t x = static_cast<uint32_t>((ndc.x * 0.5f + 0.5f) * RLightClusters::gridX);
+  const uint32_t y = static_cast<uint32_t>((ndc.y * 0.5f + 0.5f) * RLightClusters::gridY);
+  const uint32_t z = static_cast<uint32_t>(logf(position.z) * sliceScaleAndBias.x +
+                                           sliceScaleAndBias.y);
+
+  return clusters.getClusters()[(z * RLightClusters::gridY + y) * RLightClusters::gridX + x];
+}
+}  // namespace
+
+void tests::testLightClusters(RTestContext& context) {
+  context.begin("Light clusters");
+
+  const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+  const glm::vec3 nearPosition(0.3f, 0.2f, 5.0f);
+  const glm::vec3 farPosition(-20.0f, 10.0f, 60.0f);
+
+  RLightClusters clusters;
+
+  // single light is found in its cluster and not in a distant one
+  std::vector<RPointLight> lights(1u);
+  lights[0].location = glm::vec4(nearPosition, 0.5f);
+  build(clusters, projection, lights, 1u << 20);
+
+  const RLightCluster& singleCluster = getCluster(clusters, projection, nearPosition);
+  RE_CHECK(context, singleCluster.lightCount == 1u);
+  RE_CHECK(context, clusters.getIndices()[singleCluster.firstLight] == 0u);
+  RE_CHECK(context, getCluster(clusters, projection, farPosition).lightCount == 0u);
+  RE_CHECK(context, clusters.getCappedClusterCount() == 0u);
+  RE_CHECK(context, clusters.getTruncatedClusterCount() == 0u);
+
+  // a cluster overlapped by more lights than it holds keeps the nearest ones,
+  // distant lights cover the whole view
+  constexpr uint32_t nearCount = RLightClusters::maxClusterLights;
+  constexpr uint32_t farCount = 40u;
+  lights.resize(nearCount + farCount);
+
+  for (uint32_t i = 0; i < nearCount + farCount; ++i) {
+    const float offset = 0.001f * static_cast<float>(i);
+
+    lights[i].location = (i < nearCount)
+                             ? glm::vec4(nearPosition + offset, 0.5f)
+                             : glm::vec4(glm::vec3(0.0f, 0.0f, 60.0f) + offset, 200.0f);
+  }
+
+  // far lights come first in the candidate order
+  std::rotate(lights.begin(), lights.begin() + nearCount, lights.end());
+  build(clusters, projection, lights, 1u << 20);
+
+  const RLightCluster& nearCluster = getCluster(clusters, projection, nearPosition);
+  bool isNearestKept = true;
+
+  for (uint32_t i = 0; i < nearCluster.lightCount; ++i) {
+    isNearestKept &= (clusters.getIndices()[nearCluster.firstLight + i] >= farCount);
+  }
+
+  RE_CHECK(context, nearCluster.lightCount == RLightClusters::maxClusterLights);
+  RE_CHECK(context, isNearestKept);
+  RE_CHECK(context, getCluster(clusters, projection, farPosition).lightCount == farCount);
+  RE_CHECK(context, clusters.getCappedClusterCount() > 0u);
+  RE_CHECK(context, clusters.getTruncatedClusterCount() == 0u);
+
+  // the index capacity is filled up, clusters past it are cut short
+  constexpr uint32_t indexCapacity = 1000u;
+  build(clusters, projection, lights, indexCapacity);
+
+  uint32_t clusteredCount = 0u;
+
+  for (const RLightCluster& cluster : clusters.getClusters()) {
+    clusteredCount += cluster.lightCount;
+  }
+
+  RE_CHECK(context, clusters.getIndices().size() == indexCapacity);
+  RE_CHECK(context, clusteredCount == indexCapacity);
+  RE_CHECK(context, clusters.getTruncatedClusterCount() > 0u);
+}
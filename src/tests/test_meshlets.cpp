@@ -0,0 +1,133 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/model/primitive.h"
+#include "tests/tests.h"
+
+namespace {
+// grid of quads on the XZ plane facing up, one unit per quad
+void createGrid(const uint32_t size, std::vector<RVertex>& outVertices,
+                std::vector<uint32_t>& outIndices) {
+  for (uint32_t z = 0; z <= size; ++z) {
+    for (uint32_t x = 0; x <= size; ++x) {
+      RVertex& vertex = outVertices.emplace_back();
+      vertex.pos = glm::vec3(static_cast<float>(x), 0.0f, static_cast<float>(z));
+      vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+  }
+
+  for (uint32_t z = 0; z < size; ++z) {
+    for (uint32_t x = 0; x < size; ++x) {
+      const uint32_t a = z * (size + 1) + x;
+      const uint32_t c = a + size + 1;
+      outIndices.insert(outIndices.end(), {a, c, a + 1, a + 1, c, c + 1});
+    }
+  }
+}
+
+uint32_t getRangeIndexCount(const std::vector<glm::uvec2>& indexRanges) {
+  uint32_t indexCount = 0u;
+
+  for (const glm::uvec2& indexRange : indexRanges) {
+    indexCount += indexRange.y;
+  }
+
+  return indexCount;
+}
+
+// neighbouring visible meshlets leave no touching ranges
+bool isMerged(const std::vector<glm::uvec2>& indexRanges) {
+  for (size_t i = 1; i < indexRanges.size(); ++i) {
+    if (indexRanges[i - 1].x + indexRanges[i - 1].y >= indexRanges[i].x) return false;
+  }
+
+  return true;
+}
+}  // namespace
+
+void tests::testMeshlets(RTestContext& context) {
+  context.begin("Meshlets");
+
+  constexpr uint32_t gridSize = 64u;
+
+  std::vector<RVertex> vertices;
+  std::vector<uint32_t> indices;
+  createGrid(gridSize, vertices, indices);
+
+  RPrimitiveInfo primitiveInfo;
+  primitiveInfo.vertexCount = static_cast<uint32_t>(vertices.size());
+  primitiveInfo.indexCount = static_cast<uint32_t>(indices.size());
+
+  WPrimitive primitive(&primitiveInfo);
+  primitive.generateMeshlets(vertices, indices);
+
+  // meshlets cover primitive indices in order without gaps
+  const auto& meshlets = primitive.meshletData.meshlets;
+  uint32_t nextIndex = 0u;
+  bool isCovered = meshlets.size() > 1u;
+
+  for (const WMeshlet& meshlet : meshlets) {
+    isCovered &= (meshlet.indexOffset == nextIndex && meshlet.indexCount == meshlet.triangleCount * 3u);
+    nextIndex = meshlet.indexOffset + meshlet.indexCount;
+  }
+
+  RE_CHECK(context, isCovered);
+  RE_CHECK(context, nextIndex == primitive.indexCount);
+
+  const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 1000.0f);
+  const glm::mat4 identity = glm::mat4(1.0f);
+  const uint32_t triangleCount = primitive.indexCount / 3u;
+  std::vector<glm::uvec2> indexRanges;
+
+  // camera above a corner sees only part of the grid, visible meshlets are
+  // drawn as merged ranges
+  glm::vec3 cameraLocation(4.0f, 6.0f, 4.0f);
+  glm::mat4 view = glm::lookAt(cameraLocation, cameraLocation + glm::vec3(0.0f, -1.0f, 0.001f),
+                               glm::vec3(0.0f, 0.0f, 1.0f));
+
+  uint32_t culledCount =
+      primitive.cullMeshlets(&identity, 1u, projection * view, cameraLocation, true, indexRanges);
+
+  RE_CHECK(context, culledCount > 0u && culledCount < triangleCount);
+  RE_CHECK(context, getRangeIndexCount(indexRanges) == primitive.indexCount - culledCount * 3u);
+  RE_CHECK(context, isMerged(indexRanges));
+
+  // an instance moved under the camera keeps the meshlets it sees
+  const glm::mat4 movedInstance =
+      glm::translate(glm::mat4(1.0f), glm::vec3(-static_cast<float>(gridSize) + 8.0f, 0.0f, 0.0f));
+  const glm::mat4 instances[2] = {identity, movedInstance};
+
+  std::vector<glm::uvec2> movedRanges;
+  primitive.cullMeshlets(&instances[1], 1u, projection * view, cameraLocation, true, movedRanges);
+  const uint32_t combinedCount =
+      primitive.cullMeshlets(instances, 2u, projection * view, cameraLocation, true, indexRanges);
+
+  RE_CHECK(context, combinedCount < culledCount);
+  RE_CHECK(context, getRangeIndexCount(indexRanges) > getRangeIndexCount(movedRanges));
+  RE_CHECK(context, isMerged(indexRanges));
+
+  // camera below the grid sees it from behind, the cone test culls everything
+  cameraLocation = glm::vec3(32.0f, -100.0f, 32.0f);
+  view = glm::lookAt(cameraLocation, cameraLocation + glm::vec3(0.0f, 1.0f, 0.001f),
+                     glm::vec3(0.0f, 0.0f, 1.0f));
+
+  RE_CHECK(context, primitive.cullMeshlets(&identity, 1u, projection * view, cameraLocation,
+                                           true, indexRanges) == triangleCount);
+  RE_CHECK(context, indexRanges.empty());
+  RE_CHECK(context, primitive.cullMeshlets(&identity, 1u, projection * view, cameraLocation,
+                                           false, indexRanges) == 0u);
+
+  // mirrored instances skip the cone test, too many instances skip culling
+  const glm::mat4 mirroredInstance = glm::scale(glm::mat4(1.0f), glm::vec3(-1.0f, 1.0f, 1.0f));
+  const glm::vec3 mirroredLocation(-32.0f, -100.0f, 32.0f);
+  const glm::mat4 mirroredView =
+      glm::lookAt(mirroredLocation, mirroredLocation + glm::vec3(0.0f, 1.0f, 0.001f),
+                  glm::vec3(0.0f, 0.0f, 1.0f));
+
+  RE_CHECK(context, primitive.cullMeshlets(&mirroredInstance, 1u, projection * mirroredView,
+                                           mirroredLocation, true, indexRanges) == 0u);
+
+  const std::vector<glm::mat4> manyInstances(9u, identity);
+  RE_CHECK(context, primitive.cullMeshlets(manyInstances.data(), 9u, projection * view,
+                                           cameraLocation, true, indexRanges) == 0u);
+  RE_CHECK(context, indexRanges.size() == 1u && indexRanges[0].y == primitive.indexCount);
+}
@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/occlusion.h"
+#include "tests/tests.h"
+
+namespace {
+// occluder quad of two triangles in the xy plane at depth z
+void addQuad(ROcclusionCuller& culler, const float minX, const float minY,
+             const float maxX, const float maxY, const float z) {
+  const glm::vec4 positions[4] = {{minX, minY, z, 1.0f}, {maxX, minY, z, 1.0f},
+                                  {maxX, maxY, z, 1.0f}, {minX, maxY, z, 1.0f}};
+  const uint32_t indices[6] = {0u, 1u, 2u, 0u, 2u, 3u};
+
+  culler.addOccluder(glm::mat4(1.0f), positions, 4u, indices, 6u);
+}
+
+void rasterize(ROcclusionCuller& culler) {
+  for (uint32_t band = 0; band < culler.getBandCount(); ++band) {
+    culler.rasterizeBand(band);
+  }
+}
+}  // namespace
+
+void tests::testOcclusion(RTestContext& context) {
+  context.begin("Occlusion");
+
+  // clip space is world space, so depth is z and pixels map linearly to xy
+  ROcclusionCuller culler(100u, 60u);
+
+  RE_CHECK(context, culler.getWidth() == 104u);
+  RE_CHECK(context, culler.getHeight() == 64u);
+
+  culler.reset(glm::mat4(1.0f));
+  rasterize(culler);
+
+  RE_CHECK(context, culler.getDepth(10u, 10u) == std::numeric_limits<float>::max());
+  RE_CHECK(context, culler.isVisible(glm::vec3(-0.1f, -0.1f, 0.8f), glm::vec3(0.1f, 0.1f, 0.9f)));
+
+  // full view occluder hides boxes behind it, not those in front of it or
+  // crossing it
+  culler.reset(glm::mat4(1.0f));
+  addQuad(culler, -1.0f, -1.0f, 1.0f, 1.0f, 0.5f);
+  rasterize(culler);
+
+  RE_CHECK(context, culler.getTriangleCount() == 2u);
+  RE_CHECK(context, std::abs(culler.getDepth(0u, 0u) - 0.5f) < 1e-5f);
+  RE_CHECK(context, std::abs(culler.getDepth(103u, 63u) - 0.5f) < 1e-5f);
+  RE_CHECK(context, !culler.isVisible(glm::vec3(-0.2f, -0.2f, 0.7f), glm::vec3(0.2f, 0.2f, 0.8f)));
+  RE_CHECK(context, culler.isVisible(glm::vec3(-0.2f, -0.2f, 0.2f), glm::vec3(0.2f, 0.2f, 0.3f)));
+  RE_CHECK(context, culler.isVisible(glm::vec3(-0.2f, -0.2f, 0.4f), glm::vec3(0.2f, 0.2f, 0.6f)));
+
+  // boxes outside of the view or behind the camera are hidden
+  RE_CHECK(context, !culler.isVisible(glm::vec3(2.0f, -0.2f, 0.2f), glm::vec3(3.0f, 0.2f, 0.3f)));
+  RE_CHECK(context, !culler.isVisible(glm::vec3(-0.2f, -0.2f, 1.2f), glm::vec3(0.2f, 0.2f, 1.5f)));
+
+  // occluder covering the left half, box partially in a covered tile
+  culler.reset(glm::mat4(1.0f));
+  addQuad(culler, -1.0f, -1.0f, 0.0f, 1.0f, 0.5f);
+  rasterize(culler);
+
+  RE_CHECK(context, !culler.isVisible(glm::vec3(-0.8f, -0.2f, 0.7f), glm::vec3(-0.2f, 0.2f, 0.8f)));
+  RE_CHECK(context, culler.isVisible(glm::vec3(0.2f, -0.2f, 0.7f), glm::vec3(0.8f, 0.2f, 0.8f)));
+  RE_CHECK(context, culler.isVisible(glm::vec3(-0.3f, -0.2f, 0.7f), glm::vec3(0.3f, 0.2f, 0.8f)));
+
+  // rasterized depth matches the nearest triangle covering each pixel center
+  std::mt19937 generator(5u);
+  std::uniform_real_distribution<float> positionDistribution(-1.3f, 1.3f);
+  std::uniform_real_distribution<float> depthDistribution(0.1f, 0.9f);
+
+  std::vector<glm::vec4> positions;
+  std::vector<uint32_t> indices;
+
+  for (uint32_t i = 0; i < 600u; ++i) {
+    positions.emplace_back(positionDistribution(generator), positionDistribution(generator),
+                           depthDistribution(generator), 1.0f);
+    indices.emplace_back(i);
+  }
+
+  culler.reset(glm::mat4(1.0f));
+  culler.addOccluder(glm::mat4(1.0f), positions.data(), static_cast<uint32_t>(positions.size()),
+                     indices.data(), static_cast<uint32_t>(indices.size()));
+  rasterize(culler);
+
+  const float width = static_cast<float>(culler.getWidth());
+  const float height = static_cast<float>(culler.getHeight());
+  uint32_t missedCount = 0u;
+  float depthError = 0.0f;
+
+  for (uint32_t y = 0; y < culler.getHeight(); ++y) {
+    for (uint32_t x = 0; x < culler.getWidth(); ++x) {
+      const float pixelX = static_cast<float>(x) + 0.5f;
+      const float pixelY = static_cast<float>(y) + 0.5f;
+      float nearestDepth = std::numeric_limits<float>::max();
+
+      for (size_t i = 0; i < positions.size(); i += 3) {
+        glm::vec3 v[3];
+
+        for (uint32_t corner = 0; corner < 3; ++corner) {
+          const glm::vec4& position = positions[i + corner];
+          v[corner] = glm::vec3((position.x * 0.5f + 0.5f) * width,
+                                (position.y * 0.5f + 0.5f) * height, position.z);
+        }
+
+        auto fEdge = [pixelX, pixelY](const glm::vec3& a, const glm::vec3& b) {
+          return (b.x - a.x) * (pixelY - a.y) - (b.y - a.y) * (pixelX - a.x);
+        };
+
+        const float area = fEdge(v[0], v[1]) + fEdge(v[1], v[2]) + fEdge(v[2], v[0]);
+        const float weight0 = fEdge(v[1], v[2]) / area;
+        const float weight1 = fEdge(v[2], v[0]) / area;
+        const float weight2 = fEdge(v[0], v[1]) / area;
+
+        // pixel centers close to an edge may go either way
+        if (weight0 > 1e-5f && weight1 > 1e-5f && weight2 > 1e-5f) {
+          nearestDepth = std::min(nearestDepth,
+                                  weight0 * v[0].z + weight1 * v[1].z + weight2 * v[2].z);
+        }
+      }
+
+      if (nearestDepth == std::numeric_limits<float>::max()) {
+        continue;
+      }
+
+      const float depth = culler.getDepth(x, y);
+
+      if (depth == std::numeric_limits<float>::max()) {
+        ++missedCount;
+        continue;
+      }
+
+      depthError = std::max(depthError, std::abs(depth - nearestDepth));
+    }
+  }
+
+  RE_CHECK(context, missedCount == 0u);
+  RE_CHECK(context, depthError < 1e-4f);
+}
@@ -0,0 +1,124 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/managers/profiler.h"
+#include "tests/tests.h"
+
+namespace {
+using ETimeline = core::MProfiler::ETimeline;
+
+constexpr float timeTolerance = 1e-3f;   // milliseconds
+
+bool isNear(const float a, const float b) {
+  return std::abs(a - b) < timeTolerance;
+}
+
+bool hasStatistics(const char* name, const ETimeline timeline) {
+  for (const auto& it : core::profiler.getAllStatistics(timeline)) {
+    if (it.first == name) {
+      return true;
+    }
+  }
+
+  return false;
+}
+}  // namespace
+
+void tests::testProfiler(RTestContext& context) {
+  context.begin("Profiler");
+
+  core::profiler.setEnabled(true);
+  core::profiler.reset();
+
+  // nested scopes, statistics are updated when the next frame begins
+  constexpr uint32_t frameCount = 3u;
+
+  for (uint32_t i = 0; i < frameCount; ++i) {
+    {
+      RE_PROFILE_SCOPE("Test.Outer");
+      {
+        RE_PROFILE_SCOPE("Test.Inner");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+
+    core::profiler.beginFrame();
+  }
+
+  const auto outer = core::profiler.getStatistics("Test.Outer");
+  const auto inner = core::profiler.getStatistics("Test.Inner");
+
+  RE_CHECK(context, inner.sampleCount == frameCount);
+  RE_CHECK(context, outer.sampleCount == frameCount);
+  RE_CHECK(context, inner.minTime >= 1.0f);
+  RE_CHECK(context, inner.minTime <= inner.averageTime);
+  RE_CHECK(context, inner.averageTime <= inner.maxTime);
+  RE_CHECK(context, outer.averageTime >= inner.averageTime);
+
+  // scopes that didn't run keep their samples
+  core::profiler.beginFrame();
+  RE_CHECK(context,
+           core::profiler.getStatistics("Test.Inner").sampleCount == frameCount);
+
+  // events of the same name are summed per frame, timelines are separate
+  const uint64_t time = core::profiler.getTime();
+  core::profiler.addEvent("Test.Sum", time, 1000000u, ETimeline::CPU);
+  core::profiler.addEvent("Test.Sum", time, 2000000u, ETimeline::CPU);
+  core::profiler.addEvent("Test.Pass", time, 1500000u, ETimeline::GPU);
+  core::profiler.beginFrame();
+
+  RE_CHECK(context, isNear(core::profiler.getStatistics("Test.Sum").lastTime, 3.0f));
+  RE_CHECK(context, isNear(core::profiler.getStatistics("Test.Pass", ETimeline::GPU).lastTime, 1.5f));
+  RE_CHECK(context, core::profiler.getStatistics("Test.Pass").sampleCount == 0u);
+  RE_CHECK(context, !hasStatistics("Test.Sum", ETimeline::GPU));
+
+  // scopes of other threads
+  std::thread worker([]() {
+    core::profiler.setThreadName("Test worker");
+    RE_PROFILE_SCOPE("Test.Worker");
+  });
+  worker.join();
+  core::profiler.beginFrame();
+
+  RE_CHECK(context, hasStatistics("Test.Worker", ETimeline::CPU));
+
+  // disabled profiler ignores events
+  core::profiler.setEnabled(false);
+  core::profiler.addEvent("Test.Disabled", core::profiler.getTime(), 1000000u,
+                          ETimeline::CPU);
+  core::profiler.setEnabled(true);
+  core::profiler.beginFrame();
+
+  RE_CHECK(context, !hasStatistics("Test.Disabled", ETimeline::CPU));
+
+  // trace contains CPU and GPU events of captured frames
+  const std::string tracePath = "test_profiler_trace.json";
+  RE_CHECK(context, core::profiler.exportChromeTrace(tracePath) == RE_OK);
+
+  std::ifstream traceFile(tracePath);
+  const nlohmann::json trace =
+      nlohmann::json::parse(traceFile, nullptr, false);
+  traceFile.close();
+  std::remove(tracePath.c_str());
+
+  bool hasInnerEvent = false;
+  bool hasGPUEvent = false;
+
+  if (RE_CHECK(context, trace.contains("traceEvents"))) {
+    for (const auto& event : trace["traceEvents"]) {
+      if (event.value("ph", "") != "X") {
+        continue;
+      }
+
+      hasInnerEvent |= (event.value("name", "") == "Test.Inner");
+      hasGPUEvent |= (event.value("cat", "") == "gpu");
+    }
+  }
+
+  RE_CHECK(context, hasInnerEvent);
+  RE_CHECK(context, hasGPUEvent);
+
+  core::profiler.reset();
+
+  RE_CHECK(context, core::profiler.getAllStatistics().empty());
+  RE_CHECK(context, core::profiler.getAllStatistics(ETimeline::GPU).empty());
+}
@@ -0,0 +1,73 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/rangeallocator.h"
+#include "tests/tests.h"
+
+void tests::testRangeAllocator(RTestContext& context) {
+  context.begin("Range allocator");
+
+  RRangeAllocator allocator(100u);
+
+  // ranges are handed out back to back
+  const uint32_t first = allocator.allocate(10u);
+  const uint32_t second = allocator.allocate(20u);
+  const uint32_t third = allocator.allocate(30u);
+
+  RE_CHECK(context, first == 0u && second == 10u && third == 30u);
+  RE_CHECK(context, allocator.getAllocatedSize() == 60u);
+  RE_CHECK(context, allocator.getLargestFreeRange() == 40u);
+  RE_CHECK(context, allocator.getFragmentation() == 0.0f);
+  RE_CHECK(context, allocator.allocate(0u) == RRangeAllocator::invalidOffset);
+  RE_CHECK(context, allocator.allocate(41u) == RRangeAllocator::invalidOffset);
+
+  // a hole between allocations fragments free space
+  allocator.release(second, 20u);
+
+  RE_CHECK(context, allocator.getFreeSize() == 60u);
+  RE_CHECK(context, allocator.getLargestFreeRange() == 40u);
+  RE_CHECK(context, allocator.getFragmentation() > 0.3f && allocator.getFragmentation() < 0.4f);
+
+  // best fit takes the hole instead of splitting the larger tail
+  RE_CHECK(context, allocator.allocate(15u) == second);
+  RE_CHECK(context, allocator.getLargestFreeRange() == 40u);
+  allocator.release(second, 15u);
+
+  // released neighbours merge with the hole, then with the tail into one range
+  allocator.release(first, 10u);
+  RE_CHECK(context, allocator.allocate(30u) == first);
+  allocator.release(first, 30u);
+
+  allocator.release(third, 30u);
+  RE_CHECK(context, allocator.getAllocatedSize() == 0u);
+  RE_CHECK(context, allocator.getLargestFreeRange() == 100u);
+  RE_CHECK(context, allocator.getFragmentation() == 0.0f);
+
+  // every other released range leaves free space scattered, too small for
+  // a request that the total free size could hold
+  allocator.reset(100u);
+  uint32_t offsets[10];
+
+  for (uint32_t i = 0; i < 10u; ++i) {
+    offsets[i] = allocator.allocate(10u);
+  }
+
+  RE_CHECK(context, allocator.getFreeSize() == 0u);
+  RE_CHECK(context, allocator.allocate(1u) == RRangeAllocator::invalidOffset);
+
+  for (uint32_t i = 0; i < 10u; i += 2u) {
+    allocator.release(offsets[i], 10u);
+  }
+
+  RE_CHECK(context, allocator.getFreeSize() == 50u);
+  RE_CHECK(context, allocator.getLargestFreeRange() == 10u);
+  RE_CHECK(context, allocator.getFragmentation() == 0.8f);
+  RE_CHECK(context, allocator.allocate(20u) == RRangeAllocator::invalidOffset);
+
+  // releasing the rest coalesces everything again
+  for (uint32_t i = 1; i < 10u; i += 2u) {
+    allocator.release(offsets[i], 10u);
+  }
+
+  RE_CHECK(context, allocator.getLargestFreeRange() == 100u);
+  RE_CHECK(context, allocator.allocate(100u) == 0u);
+}
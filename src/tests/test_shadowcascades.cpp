@@ -0,0 +1,84 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/shadowcascades.h"
+#include "tests/tests.h"
+
+void tests::testShadowCascades(RTestContext& context) {
+  context.begin("Shadow cascades");
+
+  constexpr uint32_t cascadeCount = 4u;
+  constexpr uint32_t allCascades = (1u << cascadeCount) - 1u;
+
+  const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 1.8f, 1.0f),
+                                     glm::vec3(0.0f, 1.0f, 0.0f));
+  const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+  const glm::vec3 lightDirection = glm::normalize(glm::vec3(0.3f, -1.0f, 0.5f));
+
+  RShadowCascades cascades;
+  cascades.setup(cascadeCount, 1024u);
+  cascades.fit(view, projection, 0.1f, 64.0f, lightDirection);
+
+  uint64_t signatures[cascadeCount] = {1u, 2u, 3u, 4u};
+
+  // every cascade is rendered first, a schedule that wasn't committed is repeated
+  uint32_t updateMask = cascades.schedule(signatures, 0u);
+  RE_CHECK(context, updateMask == allCascades);
+  RE_CHECK(context, cascades.getRenderedCascade(0u).viewProjection ==
+                        cascades.getFittedCascade(0u).viewProjection);
+
+  updateMask = cascades.schedule(signatures, 0u);
+  RE_CHECK(context, updateMask == allCascades);
+
+  // committed cascades are kept while nothing changes
+  cascades.commit(updateMask);
+
+  for (uint32_t frame = 0; frame < 8u; ++frame) {
+    updateMask = cascades.schedule(signatures, 0u);
+    cascades.commit(updateMask);
+    RE_CHECK(context, updateMask == 0u);
+  }
+
+  // changed casters of a cascade updated every frame are rendered until committed
+  signatures[0] = 5u;
+
+  updateMask = cascades.schedule(signatures, 0u);
+  RE_CHECK(context, updateMask == 1u);
+
+  updateMask = cascades.schedule(signatures, 0u);
+  RE_CHECK(context, updateMask == 1u);
+
+  cascades.commit(updateMask);
+  RE_CHECK(context, cascades.schedule(signatures, 0u) == 0u);
+
+  // invalidating between scheduling and committing still forces an update
+  signatures[1] = 6u;
+  updateMask = cascades.schedule(signatures, 0u);
+  RE_CHECK(context, updateMask == 2u);
+
+  cascades.invalidate();
+  cascades.commit(updateMask);
+  RE_CHECK(context, cascades.schedule(signatures, 0u) == allCascades);
+
+  // static caches are rendered with their cascade update until it is committed
+  const uint64_t staticSignatures[cascadeCount] = {7u, 8u, 9u, 10u};
+  cascades.setup(cascadeCount, 1024u);
+
+  for (uint32_t frame = 0; frame < 2u; ++frame) {
+    updateMask = cascades.schedule(signatures, 0u);
+    RE_CHECK(context, cascades.scheduleStaticCache(staticSignatures, updateMask) == allCascades);
+  }
+
+  cascades.commit(updateMask);
+
+  // moving casters leave the cache of their cascade untouched
+  updateMask = cascades.schedule(signatures, 1u);
+  RE_CHECK(context, updateMask == 1u);
+  RE_CHECK(context, cascades.scheduleStaticCache(staticSignatures, updateMask) == 0u);
+
+  // a cache emptied before its frame is committed is rendered again
+  cascades.invalidateStaticCache();
+  cascades.commit(updateMask);
+
+  updateMask = cascades.schedule(signatures, 1u);
+  RE_CHECK(context, cascades.scheduleStaticCache(staticSignatures, updateMask) == 1u);
+}
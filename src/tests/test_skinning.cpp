@@ -0,0 +1,107 @@
+#include "pch.h"
+#include "core/core.h"
+#include "tests/tests.h"
+#include "util/math.h"
+
+void tests::testSkinning(RTestContext& context) {
+  context.begin("Skinning");
+
+  if (!math::isAVX2Supported()) {
+    RE_LOG(Warning, "AVX2 isn't supported, skinVertices() is compared with itself.");
+  }
+
+  constexpr uint32_t jointCount = 128u;
+  constexpr uint32_t mirroredJoint = 5u;
+  constexpr uint32_t vertexCount = 4099u;   // not a multiple of any vector width
+  constexpr float tolerance = 1e-4f;
+
+  std::mt19937 generator(7u);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  auto fRandom = [&generator, &distribution]() { return distribution(generator); };
+
+  // rotated, translated and non-uniformly scaled joints, one mirrors
+  std::vector<glm::mat4> jointMatrices(jointCount);
+
+  for (glm::mat4& jointMatrix : jointMatrices) {
+    const glm::vec3 axis = glm::normalize(glm::vec3(fRandom(), fRandom(), fRandom() + 2.0f));
+    const glm::vec3 scale(1.0f + 0.3f * fRandom(), 1.0f + 0.3f * fRandom(),
+                          1.0f + 0.3f * fRandom());
+
+    jointMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(fRandom(), fRandom(), fRandom()));
+    jointMatrix = glm::scale(glm::rotate(jointMatrix, fRandom() * 3.0f, axis), scale);
+  }
+
+  jointMatrices[mirroredJoint] = glm::scale(glm::mat4(1.0f), glm::vec3(-1.0f, 1.0f, 1.0f));
+
+  std::vector<glm::vec4> positions(vertexCount);
+  std::vector<glm::vec4> normals(vertexCount);
+  std::vector<glm::vec4> weights(vertexCount);
+  std::vector<uint32_t> joints(vertexCount);
+
+  for (uint32_t i = 0; i < vertexCount; ++i) {
+    positions[i] = glm::vec4(fRandom(), fRandom(), fRandom(), 1.0f);
+    normals[i] = glm::vec4(glm::normalize(glm::vec3(fRandom(), fRandom(), fRandom())), 0.0f);
+
+    const glm::vec4 weight(std::abs(fRandom()), std::abs(fRandom()),
+                           std::abs(fRandom()), std::abs(fRandom()));
+    weights[i] = weight / (weight.x + weight.y + weight.z + weight.w);
+
+    for (uint32_t influence = 0; influence < 4; ++influence) {
+      joints[i] |= (generator() % jointCount) << (influence * 8u);
+    }
+  }
+
+  // fully mirrored vertex and a vertex without influence
+  joints[0] = mirroredJoint * 0x01010101u;
+  weights[1] = glm::vec4(0.0f);
+
+  std::vector<glm::vec4> outPositions(vertexCount);
+  std::vector<glm::vec4> outNormals(vertexCount);
+  std::vector<glm::vec4> referencePositions(vertexCount);
+  std::vector<glm::vec4> referenceNormals(vertexCount);
+
+  math::skinVertices(jointMatrices.data(), positions.data(), normals.data(),
+                     joints.data(), weights.data(), vertexCount,
+                     outPositions.data(), outNormals.data());
+  math::skinVerticesScalar(jointMatrices.data(), positions.data(), normals.data(),
+                           joints.data(), weights.data(), vertexCount,
+                           referencePositions.data(), referenceNormals.data());
+
+  float positionError = 0.0f;
+  float normalError = 0.0f;
+  float referenceError = 0.0f;
+
+  for (uint32_t i = 0; i < vertexCount; ++i) {
+    positionError = std::max(positionError, glm::length(outPositions[i] - referencePositions[i]));
+    normalError = std::max(normalError, glm::length(outNormals[i] - referenceNormals[i]));
+
+    if (i == 1u) {
+      continue;
+    }
+
+    // scalar path against the blended matrix and its inverse transpose
+    glm::mat4 skinMatrix(0.0f);
+
+    for (uint32_t influence = 0; influence < 4; ++influence) {
+      skinMatrix += weights[i][influence] * jointMatrices[(joints[i] >> (influence * 8u)) & 0xFF];
+    }
+
+    const glm::vec3 normal = glm::normalize(
+        glm::transpose(glm::inverse(glm::mat3(skinMatrix))) * glm::vec3(normals[i]));
+
+    referenceError = std::max(referenceError,
+                              glm::length(skinMatrix * positions[i] - referencePositions[i]));
+    referenceError = std::max(referenceError,
+                              glm::length(normal - glm::vec3(referenceNormals[i])));
+  }
+
+  RE_CHECK(context, positionError < tolerance);
+  RE_CHECK(context, normalError < tolerance);
+  RE_CHECK(context, referenceError < 1e-3f);
+
+  // mirrored normals keep their facing, vertices without influence collapse
+  const glm::vec3 mirroredNormal(-normals[0].x, normals[0].y, normals[0].z);
+  RE_CHECK(context, glm::length(glm::vec3(outNormals[0]) - mirroredNormal) < tolerance);
+  RE_CHECK(context, outPositions[1] == glm::vec4(0.0f));
+  RE_CHECK(context, outNormals[1] == glm::vec4(0.0f));
+}
@@ -0,0 +1,162 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/objects.h"
+#include "core/skinning.h"
+#include "tests/tests.h"
+
+namespace {
+constexpr uint32_t jointCount = 4u;
+
+// cs_skinning with the normal normalized, prevPosition is left out
+RSkinnedVertex skinVertex(const RVertex& vertex, const glm::mat4* pJointMatrices) {
+  const glm::mat4 skinMatrix = vertex.weight.x * pJointMatrices[static_cast<uint32_t>(vertex.joint.x)] +
+                               vertex.weight.y * pJointMatrices[static_cast<uint32_t>(vertex.joint.y)] +
+                               vertex.weight.z * pJointMatrices[static_cast<uint32_t>(vertex.joint.z)] +
+                               vertex.weight.w * pJointMatrices[static_cast<uint32_t>(vertex.joint.w)];
+  const glm::mat3 skinMatrix3 = glm::mat3(skinMatrix);
+
+  RSkinnedVertex outVertex;
+  outVertex.position = skinMatrix * glm::vec4(vertex.pos, 1.0f);
+  outVertex.normal = glm::vec4(
+      glm::normalize(glm::transpose(glm::inverse(skinMatrix3)) * vertex.normal), 0.0f);
+  outVertex.tangent = glm::vec4(skinMatrix3 * glm::vec3(vertex.tangent), vertex.tangent.w);
+
+  return outVertex;
+}
+
+bool isNear(const glm::vec4& a, const glm::vec4& b) {
+  return glm::all(glm::lessThanEqual(glm::abs(a - b), glm::vec4(1e-4f)));
+}
+}  // namespace
+
+void tests::testSkinningScheduler(RTestContext& context) {
+  context.begin("Skinning scheduler");
+
+  RSkinningScheduler scheduler(200u);
+
+  // instances sharing vertices and a joint palette share skinned vertices
+  const uint32_t first = scheduler.schedule(0u, 0u, 150u, 0u);
+  const uint32_t second = scheduler.schedule(1u, 10u, 20u, 0u);
+
+  RE_CHECK(context, first == 0u && second == 150u);
+  RE_CHECK(context, scheduler.schedule(0u, 0u, 150u, 0u) == first);
+  RE_CHECK(context, scheduler.getRequestCount() == 3u);
+  RE_CHECK(context, scheduler.getSkinnedVertexCount() == 170u);
+
+  // a different palette needs its own vertices, work that doesn't fit is
+  // refused as a whole
+  RE_CHECK(context, scheduler.schedule(0u, 0u, 150u, 1u) == RSkinningScheduler::invalidOffset);
+  RE_CHECK(context, scheduler.schedule(0u, 0u, 0u, 0u) == RSkinningScheduler::invalidOffset);
+  RE_CHECK(context, scheduler.getSkinnedVertexCount() == 170u);
+  RE_CHECK(context, scheduler.getRequestCount() == 3u);
+
+  const uint32_t third = scheduler.schedule(0u, 0u, 30u, 1u);
+
+  RE_CHECK(context, third == 170u);
+  RE_CHECK(context, scheduler.getSkinnedVertexCount() == scheduler.getVertexCapacity());
+  RE_CHECK(context, scheduler.schedule(1u, 0u, 1u, 0u) == RSkinningScheduler::invalidOffset);
+  RE_CHECK(context, scheduler.schedule(1u, 10u, 20u, 0u) == second);
+
+  // work is split into batches of at most batchSize vertices, one dispatch
+  // per page with batches in output order
+  scheduler.finalize();
+
+  const std::vector<RSkinningBatch>& batches = scheduler.getBatches();
+  const std::vector<RSkinningDispatch>& dispatches = scheduler.getDispatches();
+
+  RE_CHECK(context, batches.size() == 5u && dispatches.size() == 2u);
+  RE_CHECK(context, dispatches[0].pageIndex == 0u && dispatches[0].firstBatch == 0u &&
+                        dispatches[0].batchCount == 4u);
+  RE_CHECK(context, dispatches[1].pageIndex == 1u && dispatches[1].firstBatch == 4u &&
+                        dispatches[1].batchCount == 1u);
+  RE_CHECK(context, batches[0].vertexCount == 64u && batches[1].vertexCount == 64u &&
+                        batches[2].vertexCount == 22u);
+  RE_CHECK(context, batches[2].srcVertexOffset == 128u && batches[2].dstVertexOffset == 128u);
+  RE_CHECK(context, batches[3].srcVertexOffset == 0u && batches[3].dstVertexOffset == third &&
+                        batches[3].vertexCount == 30u && batches[3].skinIndex == 1u);
+  RE_CHECK(context, batches[4].srcVertexOffset == 10u && batches[4].dstVertexOffset == second &&
+                        batches[4].vertexCount == 20u);
+
+  // executed batches skin every scheduled vertex with the palette of its block
+  std::mt19937 generator(11u);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  auto fRandom = [&generator, &distribution]() { return distribution(generator); };
+
+  std::vector<RVertex> pages[2] = {std::vector<RVertex>(150u), std::vector<RVertex>(30u)};
+
+  for (std::vector<RVertex>& page : pages) {
+    for (uint32_t i = 0; i < page.size(); ++i) {
+      RVertex& vertex = page[i];
+      vertex.pos = glm::vec3(fRandom(), fRandom(), fRandom());
+      vertex.normal = glm::normalize(glm::vec3(fRandom(), fRandom(), fRandom() + 2.0f));
+      vertex.tangent = glm::vec4(glm::normalize(glm::vec3(fRandom() + 2.0f, fRandom(), fRandom())),
+                                 (i % 2u) ? 1.0f : -1.0f);
+      vertex.joint = glm::vec4(i % jointCount, (i + 1u) % jointCount, (i + 2u) % jointCount,
+                               (i + 3u) % jointCount);
+
+      const glm::vec4 weight(fRandom() + 1.5f, fRandom() + 1.5f, fRandom() + 1.5f, fRandom() + 1.5f);
+      vertex.weight = weight / (weight.x + weight.y + weight.z + weight.w);
+    }
+  }
+
+  // blocks hold the joint palette followed by the previous one
+  constexpr size_t skinBlockSize = sizeof(glm::mat4) * RE_MAXJOINTS * 2u;
+  std::vector<uint8_t> skinBlocks(skinBlockSize * 2u);
+
+  for (uint32_t block = 0; block < 2u; ++block) {
+    glm::mat4* pJointMatrices = reinterpret_cast<glm::mat4*>(skinBlocks.data() + skinBlockSize * block);
+
+    for (uint32_t joint = 0; joint < RE_MAXJOINTS * 2u; ++joint) {
+      const glm::vec3 axis = glm::normalize(glm::vec3(fRandom(), fRandom(), fRandom() + 2.0f));
+
+      pJointMatrices[joint] =
+          glm::translate(glm::mat4(1.0f), glm::vec3(fRandom(), fRandom(), fRandom()));
+      pJointMatrices[joint] = glm::rotate(pJointMatrices[joint], fRandom() * 3.0f, axis);
+      pJointMatrices[joint] = glm::scale(
+          pJointMatrices[joint],
+          glm::vec3(1.0f + 0.3f * fRandom(), 1.0f + 0.3f * fRandom(), 1.0f + 0.3f * fRandom()));
+    }
+  }
+
+  const RVertex* pPageVertices[2] = {pages[0].data(), pages[1].data()};
+  std::vector<RSkinnedVertex> skinnedVertices(scheduler.getSkinnedVertexCount());
+  scheduler.execute(pPageVertices, skinBlocks.data(), skinBlockSize, skinnedVertices.data());
+
+  struct RExpected {
+    uint32_t pageIndex;
+    uint32_t srcVertexOffset;
+    uint32_t dstVertexOffset;
+    uint32_t vertexCount;
+    uint32_t skinIndex;
+  };
+
+  const RExpected expectedWork[3] = {
+      {0u, 0u, first, 150u, 0u}, {1u, 10u, second, 20u, 0u}, {0u, 0u, third, 30u, 1u}};
+  bool isSkinned = true;
+
+  for (const RExpected& work : expectedWork) {
+    const glm::mat4* pJointMatrices =
+        reinterpret_cast<const glm::mat4*>(skinBlocks.data() + skinBlockSize * work.skinIndex);
+
+    for (uint32_t i = 0; i < work.vertexCount; ++i) {
+      const RVertex& vertex = pages[work.pageIndex][work.srcVertexOffset + i];
+      const RSkinnedVertex& skinnedVertex = skinnedVertices[work.dstVertexOffset + i];
+      const RSkinnedVertex expected = skinVertex(vertex, pJointMatrices);
+      const RSkinnedVertex expectedPrev = skinVertex(vertex, pJointMatrices + RE_MAXJOINTS);
+
+      isSkinned &= isNear(skinnedVertex.position, expected.position);
+      isSkinned &= isNear(skinnedVertex.prevPosition, expectedPrev.position);
+      isSkinned &= isNear(skinnedVertex.normal, expected.normal);
+      isSkinned &= isNear(skinnedVertex.tangent, expected.tangent);
+    }
+  }
+
+  RE_CHECK(context, isSkinned);
+
+  // a new frame starts empty, earlier work is no longer shared
+  scheduler.reset(100u);
+
+  RE_CHECK(context, scheduler.getSkinnedVertexCount() == 0u && scheduler.getRequestCount() == 0u);
+  RE_CHECK(context, scheduler.schedule(0u, 0u, 150u, 0u) == RSkinningScheduler::invalidOffset);
+  RE_CHECK(context, scheduler.schedule(1u, 10u, 20u, 0u) == 0u);
+}
@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "core/core.h"
+#include "core/material/texturestreamer.h"
+#include "tests/tests.h"
+
+void tests::testTextureStreamer(RTestContext& context) {
+  context.begin("Texture streamer");
+
+  // three levels per texture, the coarsest one is always resident
+  const std::vector<uint64_t> levelSizes = {64u, 16u, 4u};
+  constexpr uint64_t fullSize = 84u;
+  constexpr uint64_t noUploadLimit = std::numeric_limits<uint64_t>::max();
+
+  RTextureStreamer streamer;
+  streamer.setBudget(2u * fullSize + 4u);
+
+  const uint32_t textureA = streamer.addTexture(levelSizes, 256u, 256u, 2u);
+  const uint32_t textureB = streamer.addTexture(levelSizes, 256u, 256u, 2u);
+  const uint32_t textureC = streamer.addTexture(levelSizes, 256u, 256u, 2u);
+  std::vector<RTextureStreamer::RResidencyChange> changes;
+
+  RE_CHECK(context, streamer.getTextureCount() == 3u);
+  RE_CHECK(context, streamer.getResidentSize() == 12u);
+
+  // requested levels are uploaded within the upload limit, one level per
+  // texture at a time
+  streamer.requestMip(textureA, 0u);
+  streamer.requestMip(textureB, 0u);
+  streamer.update(changes, 32u);
+
+  RE_CHECK(context, changes.size() == 2u);
+  RE_CHECK(context, streamer.getResidentMip(textureA) == 1u);
+  RE_CHECK(context, streamer.getResidentMip(textureB) == 1u);
+
+  streamer.requestMip(textureA, 0u);
+  streamer.requestMip(textureB, 0u);
+  streamer.update(changes, noUploadLimit);
+
+  RE_CHECK(context, streamer.getResidentMip(textureA) == 0u);
+  RE_CHECK(context, streamer.getResidentMip(textureB) == 0u);
+  RE_CHECK(context, streamer.getResidentSize() == streamer.getBudget());
+
+  // unused levels stay cached while they fit
+  streamer.requestMip(textureA, 0u);
+  streamer.update(changes, noUploadLimit);
+
+  RE_CHECK(context, changes.empty());
+  RE_CHECK(context, streamer.getResidentMip(textureB) == 0u);
+
+  // a new request evicts the least recently used texture first
+  streamer.requestMip(textureA, 0u);
+  streamer.requestMip(textureC, 0u);
+  streamer.update(changes, noUploadLimit);
+
+  RE_CHECK(context, streamer.getResidentMip(textureA) == 0u);
+  RE_CHECK(context, streamer.getResidentMip(textureB) == 2u);
+  RE_CHECK(context, streamer.getResidentMip(textureC) == 0u);
+  RE_CHECK(context, streamer.getResidentSize() <= streamer.getBudget());
+
+  // requests that don't fit are left unserved instead of exceeding the budget
+  streamer.requestMip(textureA, 0u);
+  streamer.requestMip(textureB, 0u);
+  streamer.requestMip(textureC, 0u);
+  streamer.update(changes, noUploadLimit);
+
+  RE_CHECK(context, streamer.getResidentMip(textureB) == 2u);
+  RE_CHECK(context, streamer.getResidentSize() <= streamer.getBudget());
+
+  // a lowered budget drops levels of textures no longer requested
+  streamer.setBudget(fullSize + 8u);
+  streamer.requestMip(textureC, 0u);
+  streamer.update(changes, noUploadLimit);
+
+  RE_CHECK(context, streamer.getResidentMip(textureA) == 2u);
+  RE_CHECK(context, streamer.getResidentMip(textureC) == 0u);
+  RE_CHECK(context, streamer.getResidentSize() == fullSize + 8u);
+
+  // levels finer than requested make room, requested ones are kept
+  streamer.requestMip(textureC, 1u);
+  streamer.requestMip(textureA, 0u);
+  streamer.update(changes, noUploadLimit);
+
+  RE_CHECK(context, streamer.getResidentMip(textureC) == 1u);
+  RE_CHECK(context, streamer.getResidentMip(textureA) == 1u);
+  RE_CHECK(context, streamer.getResidentSize() <= streamer.getBudget());
+
+  // removed textures return their size and id
+  streamer.removeTexture(textureB);
+  RE_CHECK(context, streamer.getTextureCount() == 2u);
+  RE_CHECK(context, streamer.addTexture(levelSizes, 256u, 256u, 2u) == textureB);
+
+  // screen size picks the level with about one texel per pixel
+  RE_CHECK(context, RTextureStreamer::getDesiredMip(256u, 256u, 9u, 256.0f) == 0u);
+  RE_CHECK(context, RTextureStreamer::getDesiredMip(256u, 256u, 9u, 64.0f) == 2u);
+  RE_CHECK(context, RTextureStreamer::getDesiredMip(256u, 256u, 9u, 0.5f) == 8u);
+}
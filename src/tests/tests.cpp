@@ -0,0 +1,49 @@
+#include "pch.h"
+#include "core/core.h"
+#include "tests/tests.h"
+
+void tests::RTestContext::begin(const char* testName) {
+  m_testName = testName;
+  RE_LOG(Log, "Running test '%s'.", testName);
+}
+
+bool tests::RTestContext::check(const bool condition, const char* expression,
+                                const char* file, const int32_t line) {
+  ++m_checkCount;
+
+  if (!condition) {
+    ++m_failedCount;
+    RE_LOG(Error, "Test '%s' failed '%s' at %s:%d.", m_testName, expression,
+           file, line);
+  }
+
+  return condition;
+}
+
+uint32_t tests::run() {
+  RTestContext context;
+
+  testProfiler(context);
+  testFrameStatistics(context);
+  testJobs(context);
+  testRangeAllocator(context);
+  testIndexAllocator(context);
+  testTextureStreamer(context);
+  testSkinning(context);
+  testSkinningScheduler(context);
+  testOcclusion(context);
+  testMeshlets(context);
+  testLightClusters(context);
+  testShadowCascades(context);
+
+  const uint32_t failedCount = context.getFailedCount();
+
+  if (failedCount > 0u) {
+    RE_LOG(Error, "%d of %d test checks failed.", failedCount,
+           context.getCheckCount());
+  } else {
+    RE_LOG(Log, "All %d test checks passed.", context.getCheckCount());
+  }
+
+  return failedCount;
+}
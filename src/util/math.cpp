@@ -1,6 +1,95 @@
 #include "pch.h"
 #include "util/math.h"
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+// transformed box center and half extent, extent uses absolute matrix values
+inline void transformBox(const glm::mat4& matrix, const __m128 center,
+                         const __m128 extent, __m128& outCenter, __m128& outExtent) {
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+  outCenter = _mm_fmadd_ps(matrix[0].data, _mm_shuffle_ps(center, center, _MM_SHUFFLE(0, 0, 0, 0)), matrix[3].data);
+  outCenter = _mm_fmadd_ps(matrix[1].data, _mm_shuffle_ps(center, center, _MM_SHUFFLE(1, 1, 1, 1)), outCenter);
+  outCenter = _mm_fmadd_ps(matrix[2].data, _mm_shuffle_ps(center, center, _MM_SHUFFLE(2, 2, 2, 2)), outCenter);
+
+  outExtent = _mm_mul_ps(_mm_and_ps(matrix[0].data, absMask), _mm_shuffle_ps(extent, extent, _MM_SHUFFLE(0, 0, 0, 0)));
+  outExtent = _mm_fmadd_ps(_mm_and_ps(matrix[1].data, absMask), _mm_shuffle_ps(extent, extent, _MM_SHUFFLE(1, 1, 1, 1)), outExtent);
+  outExtent = _mm_fmadd_ps(_mm_and_ps(matrix[2].data, absMask), _mm_shuffle_ps(extent, extent, _MM_SHUFFLE(2, 2, 2, 2)), outExtent);
+}
+
+// w component of the result is 0
+inline __m128 cross(const __m128 a, const __m128 b) {
+  const __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+  const __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+  const __m128 result = _mm_fmsub_ps(a, bYZX, _mm_mul_ps(aYZX, b));
+  return _mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+// a vertex per iteration, blended matrix columns are kept in two 256 bit registers
+void skinVerticesAVX2(const glm::mat4* pJointMatrices, const glm::vec4* pPositions,
+                      const glm::vec4* pNormals, const uint32_t* pJoints,
+                      const glm::vec4* pWeights, const uint32_t vertexCount,
+                      glm::vec4* pOutPositions, glm::vec4* pOutNormals) {
+  const __m256i xyIndices = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+  const __m256i zwIndices = _mm256_setr_epi32(2, 2, 2, 2, 3, 3, 3, 3);
+  const __m128 signMask = _mm_set1_ps(-0.0f);
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  for (uint32_t i = 0; i < vertexCount; ++i) {
+    const uint32_t joints = pJoints[i];
+    const float* pJoint0 = &pJointMatrices[joints & 0xFF][0][0];
+    const float* pJoint1 = &pJointMatrices[(joints >> 8) & 0xFF][0][0];
+    const float* pJoint2 = &pJointMatrices[(joints >> 16) & 0xFF][0][0];
+    const float* pJoint3 = &pJointMatrices[joints >> 24][0][0];
+
+    const __m256 weight0 = _mm256_set1_ps(pWeights[i].x);
+    const __m256 weight1 = _mm256_set1_ps(pWeights[i].y);
+    const __m256 weight2 = _mm256_set1_ps(pWeights[i].z);
+    const __m256 weight3 = _mm256_set1_ps(pWeights[i].w);
+
+    __m256 columns01 = _mm256_mul_ps(weight0, _mm256_loadu_ps(pJoint0));
+    __m256 columns23 = _mm256_mul_ps(weight0, _mm256_loadu_ps(pJoint0 + 8));
+    columns01 = _mm256_fmadd_ps(weight1, _mm256_loadu_ps(pJoint1), columns01);
+    columns23 = _mm256_fmadd_ps(weight1, _mm256_loadu_ps(pJoint1 + 8), columns23);
+    columns01 = _mm256_fmadd_ps(weight2, _mm256_loadu_ps(pJoint2), columns01);
+    columns23 = _mm256_fmadd_ps(weight2, _mm256_loadu_ps(pJoint2 + 8), columns23);
+    columns01 = _mm256_fmadd_ps(weight3, _mm256_loadu_ps(pJoint3), columns01);
+    columns23 = _mm256_fmadd_ps(weight3, _mm256_loadu_ps(pJoint3 + 8), columns23);
+
+    // (c0 * x + c2 * z | c1 * y + c3 * w), halves are summed afterwards
+    const __m256 position = _mm256_castps128_ps256(pPositions[i].data);
+    __m256 result = _mm256_mul_ps(columns01, _mm256_permutevar8x32_ps(position, xyIndices));
+    result = _mm256_fmadd_ps(columns23, _mm256_permutevar8x32_ps(position, zwIndices), result);
+
+    pOutPositions[i].data = _mm_add_ps(_mm256_castps256_ps128(result), _mm256_extractf128_ps(result, 1));
+
+    // inverse transpose is the cofactor matrix divided by the determinant,
+    // only the sign of the determinant matters for a normalized result
+    const __m128 column0 = _mm256_castps256_ps128(columns01);
+    const __m128 column1 = _mm256_extractf128_ps(columns01, 1);
+    const __m128 column2 = _mm256_castps256_ps128(columns23);
+    const __m128 cofactor0 = cross(column1, column2);
+    const __m128 cofactor1 = cross(column2, column0);
+    const __m128 cofactor2 = cross(column0, column1);
+
+    const __m128 normal = pNormals[i].data;
+    __m128 outNormal = _mm_mul_ps(cofactor0, _mm_shuffle_ps(normal, normal, _MM_SHUFFLE(0, 0, 0, 0)));
+    outNormal = _mm_fmadd_ps(cofactor1, _mm_shuffle_ps(normal, normal, _MM_SHUFFLE(1, 1, 1, 1)), outNormal);
+    outNormal = _mm_fmadd_ps(cofactor2, _mm_shuffle_ps(normal, normal, _MM_SHUFFLE(2, 2, 2, 2)), outNormal);
+
+    const __m128 determinant = _mm_dp_ps(column0, cofactor0, 0x7F);
+    const __m128 lengthSq = _mm_dp_ps(outNormal, outNormal, 0x7F);
+    const __m128 scale = _mm_and_ps(_mm_cmpgt_ps(lengthSq, _mm_setzero_ps()),
+                                    _mm_div_ps(one, _mm_sqrt_ps(lengthSq)));
+
+    pOutNormals[i].data = _mm_mul_ps(outNormal, _mm_xor_ps(scale, _mm_and_ps(determinant, signMask)));
+  }
+}
+}  // namespace
+
 glm::mat4 math::interpolate(const glm::mat4& first, const glm::mat4& second,
                             const float coefficient) {
   glm::mat4 outMatrix = glm::mat4(1.0f);
@@ -67,4 +156,154 @@ void math::getHaltonJitter(std::vector<glm::vec2>& outVector, const int32_t widt
     outVector[i] = {fGetHaltonValue(i + 1, 2), fGetHaltonValue(i + 1, 3)};
     outVector[i] = {(outVector[i].x * 2.0f - 1.0f) * widthCoef, (outVector[i].y * 2.0f - 1.0f) * heightCoef};
   }
-}
\ No newline at end of file
+}
+
+void math::getFrustumPlanes(const glm::mat4& matrix, glm::vec4* pOutPlanes) {
+  glm::vec4 rows[4];
+  for (int i = 0; i < 4; ++i) {
+    rows[i] = glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]);
+  }
+
+  pOutPlanes[0] = rows[3] + rows[0];
+  pOutPlanes[1] = rows[3] - rows[0];
+  pOutPlanes[2] = rows[3] + rows[1];
+  pOutPlanes[3] = rows[3] - rows[1];
+  pOutPlanes[4] = rows[2];
+  pOutPlanes[5] = rows[3] - rows[2];
+
+  for (int i = 0; i < 6; ++i) {
+    pOutPlanes[i] /= glm::length(glm::vec3(pOutPlanes[i]));
+  }
+}
+void math::expandBounds(const glm::mat4& matrix, const glm::vec4& center,
+                        const glm::vec4& extent, glm::vec4& outMin,
+                        glm::vec4& outMax) {
+  __m128 boxCenter, boxExtent;
+  transformBox(matrix, center.data, extent.data, boxCenter, boxExtent);
+
+  outMin.data = _mm_min_ps(outMin.data, _mm_sub_ps(boxCenter, boxExtent));
+  outMax.data = _mm_max_ps(outMax.data, _mm_add_ps(boxCenter, boxExtent));
+}
+
+void math::expandSkinnedBounds(const glm::mat4* pJointMatrices,
+                               const uint32_t jointCount,
+                               const glm::vec4* pCenters,
+                               const glm::vec4* pExtents,
+                               const uint32_t* pJointIndices,
+                               const size_t boxCount, glm::vec4& outMin,
+                               glm::vec4& outMax) {
+  __m128 boundsMin = outMin.data;
+  __m128 boundsMax = outMax.data;
+  __m128 boxCenter, boxExtent;
+
+  for (size_t i = 0; i < boxCount; ++i) {
+    if (pJointIndices[i] >= jointCount) continue;
+
+    transformBox(pJointMatrices[pJointIndices[i]], pCenters[i].data,
+                 pExtents[i].data, boxCenter, boxExtent);
+
+    boundsMin = _mm_min_ps(boundsMin, _mm_sub_ps(boxCenter, boxExtent));
+    boundsMax = _mm_max_ps(boundsMax, _mm_add_ps(boxCenter, boxExtent));
+  }
+
+  outMin.data = boundsMin;
+  outMax.data = boundsMax;
+}
+
+bool math::isAVX2Supported() {
+  static const bool isSupported = []() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+
+    if (info[0] < 7) {
+      return false;
+    }
+
+    __cpuid(info, 1);
+    const bool hasFMA = (info[2] & (1 << 12)) != 0;
+    const bool hasOSXSAVE = (info[2] & (1 << 27)) != 0;
+
+    __cpuidex(info, 7, 0);
+    const bool hasAVX2 = (info[1] & (1 << 5)) != 0;
+
+    // OS has to preserve YMM registers
+    return hasFMA && hasOSXSAVE && hasAVX2 && (_xgetbv(0) & 0x6) == 0x6;
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+  }();
+
+  return isSupported;
+}
+
+void math::skinVertices(const glm::mat4* pJointMatrices, const glm::vec4* pPositions,
+                        const glm::vec4* pNormals, const uint32_t* pJoints,
+                        const glm::vec4* pWeights, const uint32_t vertexCount,
+                        glm::vec4* pOutPositions, glm::vec4* pOutNormals) {
+  if (isAVX2Supported()) {
+    skinVerticesAVX2(pJointMatrices, pPositions, pNormals, pJoints, pWeights,
+                     vertexCount, pOutPositions, pOutNormals);
+    return;
+  }
+
+  skinVerticesScalar(pJointMatrices, pPositions, pNormals, pJoints, pWeights,
+                     vertexCount, pOutPositions, pOutNormals);
+}
+
+void math::skinVerticesScalar(const glm::mat4* pJointMatrices, const glm::vec4* pPositions,
+                              const glm::vec4* pNormals, const uint32_t* pJoints,
+                              const glm::vec4* pWeights, const uint32_t vertexCount,
+                              glm::vec4* pOutPositions, glm::vec4* pOutNormals) {
+  auto fCross = [](const float* a, const float* b, float* pOut) {
+    pOut[0] = a[1] * b[2] - a[2] * b[1];
+    pOut[1] = a[2] * b[0] - a[0] * b[2];
+    pOut[2] = a[0] * b[1] - a[1] * b[0];
+  };
+
+  for (uint32_t i = 0; i < vertexCount; ++i) {
+    const float* pWeight = &pWeights[i].x;
+    float matrix[16] = {};
+
+    for (uint32_t influence = 0; influence < 4; ++influence) {
+      const uint32_t joint = (pJoints[i] >> (influence * 8)) & 0xFF;
+      const float* pJoint = &pJointMatrices[joint][0][0];
+
+      for (uint32_t element = 0; element < 16; ++element) {
+        matrix[element] += pWeight[influence] * pJoint[element];
+      }
+    }
+
+    const float* pPosition = &pPositions[i].x;
+    float* pOutPosition = &pOutPositions[i].x;
+
+    for (uint32_t row = 0; row < 4; ++row) {
+      pOutPosition[row] = matrix[row] * pPosition[0] + matrix[4 + row] * pPosition[1] +
+                          matrix[8 + row] * pPosition[2] + matrix[12 + row] * pPosition[3];
+    }
+
+    float cofactors[3][3];
+    fCross(matrix + 4, matrix + 8, cofactors[0]);
+    fCross(matrix + 8, matrix, cofactors[1]);
+    fCross(matrix, matrix + 4, cofactors[2]);
+
+    const float* pNormal = &pNormals[i].x;
+    float normal[3];
+
+    for (uint32_t row = 0; row < 3; ++row) {
+      normal[row] = cofactors[0][row] * pNormal[0] + cofactors[1][row] * pNormal[1] +
+                    cofactors[2][row] * pNormal[2];
+    }
+
+    const float determinant = matrix[0] * cofactors[0][0] + matrix[1] * cofactors[0][1] +
+                              matrix[2] * cofactors[0][2];
+    const float lengthSq = normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2];
+    float scale = (lengthSq > 0.0f) ? 1.0f / std::sqrt(lengthSq) : 0.0f;
+
+    if (determinant < 0.0f) {
+      scale = -scale;
+    }
+
+    pOutNormals[i] = glm::vec4(normal[0] * scale, normal[1] * scale, normal[2] * scale, 0.0f);
+  }
+}
@@ -154,4 +154,46 @@ const VkDeviceSize getVulkanAlignedSize(VkDeviceSize originalSize,
                                         VkDeviceSize minAlignment) {
   return (originalSize + minAlignment - 1) & ~(minAlignment - 1);
 }
+
+uint64_t hashData(const void* pData, const size_t dataSize,
+                  const uint64_t seed) {
+  // MurmurHash3 style mixing of 8 byte words, a rotation keeps the position
+  // of every bit relevant unlike plain multiplication
+  auto fRotate = [](const uint64_t value, const int32_t shift) {
+    return (value << shift) | (value >> (64 - shift));
+  };
+
+  auto fMix = [&fRotate](uint64_t hash, uint64_t word) {
+    word *= 0x87c37b91114253d5ull;
+    word = fRotate(word, 31);
+    word *= 0x4cf5ad432745937full;
+
+    hash ^= word;
+    return fRotate(hash, 27) * 5u + 0x52dce729u;
+  };
+
+  const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+  uint64_t hash = seed;
+
+  size_t offset = 0;
+  for (; offset + sizeof(uint64_t) <= dataSize; offset += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, pBytes + offset, sizeof(uint64_t));
+    hash = fMix(hash, word);
+  }
+
+  uint64_t tail = 0u;
+  memcpy(&tail, pBytes + offset, dataSize - offset);
+  hash = fMix(hash, tail);
+  hash ^= dataSize;
+
+  // final avalanche
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 33;
+
+  return hash;
+}
 }  // namespace util
\ No newline at end of file